@@ -0,0 +1,151 @@
+/**
+ * @file benchmark.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+benchmark_state::benchmark_state(double min_seconds, std::size_t max_iterations)
+    : min_time(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(min_seconds))),
+      max_iterations(max_iterations), iterations(0), is_started(false), is_paused(false), start(), elapsed() {}
+
+bool benchmark_state::keep_running() {
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if(!is_started) {
+
+        is_started = true;
+        start = now;
+        return true;
+
+    }
+
+    if(!is_paused)
+        elapsed += now - start;
+    is_paused = false;
+
+    ++iterations;
+    if(elapsed >= min_time || iterations >= max_iterations)
+        return false;
+
+    start = std::chrono::steady_clock::now();
+    return true;
+
+}
+
+void benchmark_state::pause() {
+
+    if(is_paused)
+        return;
+
+    elapsed += std::chrono::steady_clock::now() - start;
+    is_paused = true;
+
+}
+
+void benchmark_state::resume() {
+
+    if(!is_paused)
+        return;
+
+    is_paused = false;
+    start = std::chrono::steady_clock::now();
+
+}
+
+std::size_t benchmark_state::get_iterations() const {
+    return iterations;
+}
+
+double benchmark_state::get_seconds() const {
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+benchmark_t::benchmark_t(const std::string & name, int argc, char * argv[])
+    : name(name), filter(), min_seconds(0.5), is_json(false), case_results() {
+
+    for(int pos = 1; pos < argc; ++pos) {
+
+        std::string argument = argv[pos];
+        if(argument.compare(0, 9, "--filter=") == 0)
+            filter = argument.substr(9);
+        else if(argument.compare(0, 11, "--min-time=") == 0)
+            min_seconds = std::atof(argument.c_str() + 11);
+        else if(argument == "--json")
+            is_json = true;
+        else
+            std::cerr << name << ": unknown argument " << argument << '\n';
+
+    }
+
+}
+
+bool benchmark_t::is_selected(const std::string & case_name) const {
+
+    return filter.empty() || case_name.find(filter) != std::string::npos;
+
+}
+
+benchmark_t & benchmark_t::run(const std::string & case_name, std::size_t items, const std::function<void(benchmark_state &)> & body) {
+
+    if(!is_selected(case_name))
+        return *this;
+
+    benchmark_state state(min_seconds, 1000000);
+    body(state);
+
+    return report(case_name, state.get_iterations(), state.get_seconds(), items);
+
+}
+
+benchmark_t & benchmark_t::report(const std::string & case_name, std::size_t iterations, double seconds, std::size_t items) {
+
+    case_results.push_back(result{ case_name, iterations, seconds, items });
+
+    // written as they finish, long suites show progress
+    const result & last = case_results.back();
+    const double milliseconds = last.iterations ? last.seconds * 1000 / last.iterations : 0;
+    const double items_per_second = last.seconds > 0 ? last.items * static_cast<double>(last.iterations) / last.seconds : 0;
+
+    char line[256];
+    if(is_json)
+        std::snprintf(line, sizeof(line), "{\"benchmark\": \"%s\", \"case\": \"%s\", \"iterations\": %zu, \"ms_per_iteration\": %.6f, \"items_per_second\": %.1f}\n",
+                      name.c_str(), last.name.c_str(), last.iterations, milliseconds, items_per_second);
+    else
+        std::snprintf(line, sizeof(line), "%-40s %10zu %14.3f ms %16.1f items/s\n", (name + "/" + last.name).c_str(), last.iterations, milliseconds, items_per_second);
+    std::cout << line << std::flush;
+
+    return *this;
+
+}
+
+int benchmark_t::results() const {
+
+    if(!is_json)
+        std::cout << name << ": " << case_results.size() << " cases\n";
+
+    return 0;
+
+}
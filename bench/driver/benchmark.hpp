@@ -0,0 +1,129 @@
+/**
+ * @file benchmark.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_BENCHMARK_HPP
+#define INCLUDED_BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * benchmark_state
+ *
+ * Timing of one benchmark case.  The case runs its body while keep_running,
+ * which is until the body has taken the minimum time, and pauses the clock
+ * around per iteration setup:
+ *
+ *   while(state.keep_running()) {
+ *       state.pause();
+ *       ... setup ...
+ *       state.resume();
+ *       ... measured ...
+ *   }
+ */
+class benchmark_state {
+
+private:
+
+    std::chrono::steady_clock::duration min_time;
+    std::size_t max_iterations;
+
+    std::size_t iterations;
+    bool is_started;
+    bool is_paused;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration elapsed;
+
+public:
+
+    benchmark_state(double min_seconds, std::size_t max_iterations);
+
+    bool keep_running();
+
+    void pause();
+    void resume();
+
+    std::size_t get_iterations() const;
+    double get_seconds() const;
+
+};
+
+/**
+ * benchmark_t
+ *
+ * Runs and reports the cases of a benchmark executable.  Cases are named
+ * group/size, e.g. relationships/1000, so a scaling regression shows as a
+ * time per item growing with the size.  Command line:
+ *
+ *   --filter=text    only runs the cases whose name contains text
+ *   --min-time=s     seconds each case runs for, default 0.5
+ *   --json           a JSON object per case instead of a table
+ */
+class benchmark_t {
+
+private:
+
+    struct result {
+
+        std::string name;
+        std::size_t iterations;
+        double seconds;
+        std::size_t items;
+
+    };
+
+    std::string name;
+    std::string filter;
+    double min_seconds;
+    bool is_json;
+
+    std::vector<result> case_results;
+
+public:
+
+    benchmark_t(const std::string & name, int argc, char * argv[]);
+
+    /** items the body processes per iteration, e.g. classes, give the throughput, 0 for none */
+    benchmark_t & run(const std::string & case_name, std::size_t items, const std::function<void(benchmark_state &)> & body);
+
+    /** a time measured within a case, e.g. a phase recorded by srcuml_stats, over iterations */
+    benchmark_t & report(const std::string & case_name, std::size_t iterations, double seconds, std::size_t items);
+
+    bool is_selected(const std::string & case_name) const;
+
+    /** writes the results, 0 as the exit status */
+    int results() const;
+
+};
+
+/** keeps the value of a computation from being optimized away */
+template<typename T>
+void benchmark_keep(const T & value) {
+
+    static const void * volatile sink;
+    sink = &value;
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file srcml_corpus.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <srcml_corpus.hpp>
+
+#include <srcuml_dispatcher.hpp>
+#include <srcuml_collector.hpp>
+#include <srcSAXController.hpp>
+#include <ClassPolicySingleEvent.hpp>
+
+#include <random>
+
+static std::string class_name(std::size_t number) {
+
+    return "Class" + std::to_string(number);
+
+}
+
+static std::string type_element(const std::string & type, const char * modifier = nullptr) {
+
+    std::string element = "<type><name>" + type + "</name>";
+    if(modifier)
+        element += "<modifier>" + std::string(modifier) + "</modifier>";
+    return element + "</type>";
+
+}
+
+static void write_class(std::string & srcml, const corpus_shape & shape, std::size_t number, std::mt19937 & random) {
+
+    std::uniform_int_distribution<std::size_t> pick(0, shape.classes - 1);
+
+    srcml += "<class>class <name>" + class_name(number) + "</name>";
+    if(shape.inheritence_depth && number % (shape.inheritence_depth + 1) != 0)
+        srcml += " <super_list>: <super><specifier>public</specifier> <name>" + class_name(number - 1) + "</name></super></super_list>";
+    srcml += "<block>{<private type=\"default\">\n</private><private>private:\n";
+
+    // composition, association and aggregation in turn
+    static const char * const modifiers[] = { nullptr, "*", "&amp;" };
+    for(std::size_t pos = 0; pos < shape.attributes; ++pos)
+        srcml += "\t<decl_stmt><decl>" + type_element(class_name(pick(random)), modifiers[pos % 3])
+               + " <name>attribute" + std::to_string(pos) + "</name></decl>;</decl_stmt>\n";
+
+    srcml += "</private><public>public:\n";
+    for(std::size_t pos = 0; pos < shape.functions; ++pos) {
+
+        srcml += "\t<function>" + type_element("int") + " <name>function" + std::to_string(pos)
+               + "</name><parameter_list>(<parameter><decl>" + type_element(class_name(pick(random)), "&amp;")
+               + " <name>parameter</name></decl></parameter>)</parameter_list> <block>{<block_content>\n";
+
+        for(std::size_t statement = 0; statement < shape.statements; ++statement) {
+
+            const std::string variable = "local" + std::to_string(statement);
+            if(statement % 2 == 0)
+                srcml += "\t\t<decl_stmt><decl>" + type_element(class_name(pick(random))) + " <name>" + variable + "</name></decl>;</decl_stmt>\n";
+            else
+                srcml += "\t\t<expr_stmt><expr><name>count</name> <operator>+=</operator> <literal type=\"number\">"
+                       + std::to_string(statement) + "</literal></expr>;</expr_stmt>\n";
+
+        }
+
+        srcml += "\t\t<return>return <expr><name>count</name></expr>;</return>\n\t</block_content>}</block></function>\n";
+
+    }
+
+    srcml += "</public>}</block>;</class>";
+
+}
+
+std::string make_srcml_corpus(const corpus_shape & shape) {
+
+    std::mt19937 random(shape.seed);
+    const std::size_t per_unit = shape.classes_per_unit ? shape.classes_per_unit : 1;
+
+    std::string srcml = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                        "<unit xmlns=\"http://www.srcML.org/srcML/src\" revision=\"1.0.0\" url=\"corpus/\">\n\n";
+
+    for(std::size_t first = 0; first < shape.classes; first += per_unit) {
+
+        srcml += "<unit revision=\"1.0.0\" language=\"C++\" filename=\"corpus/unit" + std::to_string(first / per_unit) + ".hpp\">";
+        for(std::size_t number = first; number < shape.classes && number < first + per_unit; ++number) {
+
+            write_class(srcml, shape, number, random);
+            srcml += '\n';
+
+        }
+        srcml += "</unit>\n\n";
+
+    }
+
+    return srcml + "</unit>\n";
+
+}
+
+std::vector<std::shared_ptr<srcuml_class>> collect_corpus_classes(const std::string & srcml) {
+
+    srcuml_collector collector;
+    srcuml_dispatcher<ClassPolicy> dispatcher(&collector);
+    srcSAXController controller(srcml);
+    controller.parse(&dispatcher);
+
+    return std::move(collector.get_classes());
+
+}
@@ -0,0 +1,64 @@
+/**
+ * @file srcml_corpus.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCML_CORPUS_HPP
+#define INCLUDED_SRCML_CORPUS_HPP
+
+#include <srcuml_class.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * corpus_shape
+ *
+ * Shape of a synthetic srcML archive.  Class i inherits from class i - 1
+ * unless i is a multiple of inheritence_depth + 1, so the classes form chains
+ * of inheritence_depth generalizations.  The attribute, parameter and local
+ * variable types are other classes picked at random from seed, so the same
+ * shape always gives the same archive.
+ */
+struct corpus_shape {
+
+    std::size_t classes = 1000;
+    std::size_t inheritence_depth = 3;
+    // attributes of each class, each typed by another class
+    std::size_t attributes = 4;
+    // member functions of each class, each with a parameter of another class
+    std::size_t functions = 4;
+    // statements in the body of each function
+    std::size_t statements = 8;
+    // classes in each unit of the archive
+    std::size_t classes_per_unit = 1;
+
+    unsigned seed = 1;
+
+};
+
+/** srcML 1.0 archive of C++ header units of the shape */
+std::string make_srcml_corpus(const corpus_shape & shape);
+
+/** classes of an archive as srcuml_handler collects them, e.g. as the input of the later phases */
+std::vector<std::shared_ptr<srcuml_class>> collect_corpus_classes(const std::string & srcml);
+
+#endif
@@ -0,0 +1,332 @@
+/**
+ * @file srcuml_regression.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+
+  End to end performance regression check of srcuml over pinned real corpora,
+  the srcML and OGDF submodules and the car_shop sample.  Each output type is a
+  run of its own, measured for wall time, peak RSS and output size, and compared
+  with a baseline file.  A run fails when its time or memory grows, or its
+  output size changes, by more than the threshold.  Timings depend on the
+  machine, so the baseline is recorded on the machine that checks it:
+
+  Usage: srcuml_regression --srcuml bin/srcuml --root path_to_srcUML_repo --baseline baseline.txt
+                           [--update] [--threshold 0.25] [--runs 3] [--filter text]
+
+  */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/** an input of srcuml, relative to the repository, and where it is vendored from */
+struct corpus {
+
+    const char * name;
+    const char * path;
+
+};
+
+static const corpus CORPORA[] = {
+    { "car_shop", "src/generator/test/car_shop/car.srcml.xml" },
+    { "srcSAXEventDispatch", "srcSAXEventDispatch/src" },
+    { "ogdf", "ogdf/include/ogdf" },
+};
+
+static const char * const OUTPUT_TYPES[] = { "dot", "yuml", "svg_sugiyama", "svg_multi", "svg_overview", "layout_json" };
+
+/** what a run of srcuml is measured by, the median over the runs */
+struct measurement {
+
+    double wall_ms = 0;
+    long peak_rss_kib = 0;
+    long output_bytes = 0;
+
+};
+
+/** baseline file, a line per run: name wall_ms peak_rss_kib output_bytes, # starts a comment */
+static std::map<std::string, measurement> read_baseline(const std::string & filename) {
+
+    std::map<std::string, measurement> baseline;
+
+    std::ifstream in(filename);
+    std::string line;
+    while(std::getline(in, line)) {
+
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream fields(line);
+        std::string name;
+        measurement recorded;
+        if(fields >> name >> recorded.wall_ms >> recorded.peak_rss_kib >> recorded.output_bytes)
+            baseline[name] = recorded;
+
+    }
+
+    return baseline;
+
+}
+
+static void write_baseline(const std::string & filename, const std::map<std::string, measurement> & measurements) {
+
+    std::ofstream out(filename);
+    out << "# srcuml_regression baseline, see bench/regression/srcuml_regression.cpp\n"
+        << "# name wall_ms peak_rss_kib output_bytes\n";
+
+    for(const std::pair<const std::string, measurement> & run : measurements) {
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s %.1f %ld %ld\n", run.first.c_str(), run.second.wall_ms, run.second.peak_rss_kib, run.second.output_bytes);
+        out << line;
+
+    }
+
+}
+
+static bool exists(const std::string & path) {
+
+    struct stat status;
+    return stat(path.c_str(), &status) == 0;
+
+}
+
+/** one run of srcuml, its peak RSS is its own, not the harness' */
+static bool run_srcuml(const std::string & srcuml, const std::string & input, const std::string & type,
+                       const std::string & output, measurement & result) {
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    pid_t child = fork();
+    if(child < 0)
+        return false;
+
+    if(child == 0) {
+
+        // srcuml reports its inputs on stdout
+        int null = open("/dev/null", O_WRONLY);
+        if(null >= 0) {
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+        }
+
+        execl(srcuml.c_str(), srcuml.c_str(), input.c_str(), "-t", type.c_str(), "-o", output.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if(wait4(child, &status, 0, &usage) != child)
+        return false;
+
+    result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // kilobytes on Linux
+    result.peak_rss_kib = usage.ru_maxrss;
+
+    struct stat output_status;
+    result.output_bytes = stat(output.c_str(), &output_status) == 0 ? static_cast<long>(output_status.st_size) : 0;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+}
+
+template<typename T>
+static T median(std::vector<T> values) {
+
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+
+}
+
+/** a description of each metric over the threshold, none if the run did not regress */
+static std::vector<std::string> regressions(const measurement & baseline, const measurement & current, double threshold) {
+
+    std::vector<std::string> found;
+    char text[160];
+
+    // times under 50 ms are noise
+    if(current.wall_ms > 50 && current.wall_ms > baseline.wall_ms * (1 + threshold)) {
+        std::snprintf(text, sizeof(text), "wall time %.1f ms, baseline %.1f ms", current.wall_ms, baseline.wall_ms);
+        found.push_back(text);
+    }
+
+    // and by more than a MiB
+    if(current.peak_rss_kib > baseline.peak_rss_kib * (1 + threshold) && current.peak_rss_kib - baseline.peak_rss_kib > 1024) {
+        std::snprintf(text, sizeof(text), "peak RSS %ld KiB, baseline %ld KiB", current.peak_rss_kib, baseline.peak_rss_kib);
+        found.push_back(text);
+    }
+
+    // smaller is a regression too, the output lost something
+    const double size_change = baseline.output_bytes ? std::abs(current.output_bytes - baseline.output_bytes) / static_cast<double>(baseline.output_bytes) : 0;
+    if(size_change > threshold) {
+        std::snprintf(text, sizeof(text), "output %ld bytes, baseline %ld bytes", current.output_bytes, baseline.output_bytes);
+        found.push_back(text);
+    }
+
+    return found;
+
+}
+
+int main(int argc, char * argv[]) {
+
+    std::string srcuml = "bin/srcuml";
+    std::string root = ".";
+    std::string baseline_file = "bench/regression/baseline.txt";
+    std::string filter;
+    bool update = false;
+    double threshold = 0.25;
+    std::size_t runs = 3;
+
+    for(int pos = 1; pos < argc; ++pos) {
+
+        const std::string argument = argv[pos];
+        const bool has_value = pos + 1 < argc;
+        if(argument == "--update")
+            update = true;
+        else if(argument == "--srcuml" && has_value)
+            srcuml = argv[++pos];
+        else if(argument == "--root" && has_value)
+            root = argv[++pos];
+        else if(argument == "--baseline" && has_value)
+            baseline_file = argv[++pos];
+        else if(argument == "--filter" && has_value)
+            filter = argv[++pos];
+        else if(argument == "--threshold" && has_value)
+            threshold = std::atof(argv[++pos]);
+        else if(argument == "--runs" && has_value)
+            runs = std::max(1, std::atoi(argv[++pos]));
+        else {
+            std::cerr << "Usage: srcuml_regression --srcuml bin/srcuml --root path_to_srcUML_repo --baseline baseline.txt [--update] [--threshold 0.25] [--runs 3] [--filter text]\n";
+            return 1;
+        }
+
+    }
+
+    const std::map<std::string, measurement> baseline = read_baseline(baseline_file);
+    // runs left out by --filter keep their baseline
+    std::map<std::string, measurement> measurements = baseline;
+
+    char directory_template[] = "/tmp/srcuml_regression_XXXXXX";
+    const char * directory = mkdtemp(directory_template);
+    if(!directory) {
+        std::cerr << "Error: Unable to create a directory for the outputs\n";
+        return 1;
+    }
+
+    std::size_t failures = 0;
+    for(const corpus & input : CORPORA) {
+
+        const std::string path = root + "/" + input.path;
+        if(!exists(path)) {
+            std::cout << input.name << ": skipped, " << path << " is missing (git submodule update --init)\n";
+            continue;
+        }
+
+        for(const char * type : OUTPUT_TYPES) {
+
+            const std::string name = std::string(input.name) + "/" + type;
+            if(!filter.empty() && name.find(filter) == std::string::npos)
+                continue;
+
+            const std::string output = std::string(directory) + "/" + input.name + "." + type;
+
+            std::vector<double> times;
+            std::vector<long> rss, sizes;
+            bool is_run = true;
+            for(std::size_t run = 0; run < runs && is_run; ++run) {
+
+                measurement current;
+                is_run = run_srcuml(srcuml, path, type, output, current);
+                times.push_back(current.wall_ms);
+                rss.push_back(current.peak_rss_kib);
+                sizes.push_back(current.output_bytes);
+
+            }
+
+            std::remove(output.c_str());
+
+            if(!is_run) {
+                std::cout << name << ": FAILED, srcuml did not finish\n";
+                ++failures;
+                continue;
+            }
+
+            measurement current;
+            current.wall_ms = median(times);
+            current.peak_rss_kib = median(rss);
+            current.output_bytes = median(sizes);
+
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-36s %10.1f ms %10ld KiB %12ld bytes", name.c_str(), current.wall_ms, current.peak_rss_kib, current.output_bytes);
+            std::cout << line;
+
+            std::map<std::string, measurement>::const_iterator recorded = baseline.find(name);
+            if(update) {
+                std::cout << "  recorded\n";
+            } else if(recorded == baseline.end()) {
+                std::cout << "  no baseline, record one with --update\n";
+            } else {
+
+                std::vector<std::string> found = regressions(recorded->second, current, threshold);
+                if(found.empty()) {
+                    std::cout << "  ok\n";
+                } else {
+                    ++failures;
+                    std::cout << "  REGRESSED\n";
+                    for(const std::string & regression : found)
+                        std::cout << "    " << regression << '\n';
+                }
+
+            }
+
+            measurements[name] = current;
+
+        }
+
+    }
+
+    rmdir(directory);
+
+    if(update)
+        write_baseline(baseline_file, measurements);
+
+    if(failures)
+        std::cout << "Error: " << failures << " runs regressed beyond " << threshold * 100 << "% or failed\n";
+
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,93 @@
+/**
+ * @file bench_class.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+#include <srcml_corpus.hpp>
+
+#include <srcuml_class.hpp>
+#include <srcuml_class_table.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_stats.hpp>
+
+#include <sstream>
+
+/** summaries of srcuml_class as the unit cache and models write and read them, the class table and finalization */
+int main(int argc, char * argv[]) {
+
+    benchmark_t bench("class", argc, argv);
+
+    for(std::size_t number_classes : { 100, 1000, 5000 }) {
+
+        corpus_shape shape;
+        shape.classes = number_classes;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+        const std::string size = std::to_string(number_classes);
+
+        std::string summaries;
+        bench.run("write_summary/" + size, number_classes, [&](benchmark_state & state) {
+            while(state.keep_running()) {
+
+                std::ostringstream out;
+                for(const std::shared_ptr<srcuml_class> & aclass : classes)
+                    aclass->write(out);
+                summaries = out.str();
+
+            }
+        });
+
+        bench.run("read_summary/" + size, number_classes, [&](benchmark_state & state) {
+            while(state.keep_running()) {
+
+                std::istringstream in(summaries);
+                std::vector<std::shared_ptr<srcuml_class>> read;
+                for(std::size_t pos = 0; pos < number_classes; ++pos)
+                    read.push_back(std::make_shared<srcuml_class>(in));
+                benchmark_keep(read);
+
+            }
+        });
+
+        bench.run("table/" + size, number_classes, [&](benchmark_state & state) {
+            while(state.keep_running()) {
+
+                srcuml_class_table table(classes);
+                benchmark_keep(table);
+
+            }
+        });
+
+        // finalization resolves inheritence, it is timed within the relationship analysis
+        if(bench.is_selected("finalize/" + size)) {
+
+            srcuml_stats stats;
+            benchmark_state state(0.5, 1000000);
+            while(state.keep_running())
+                benchmark_keep(srcuml_relationships(classes, 1, &stats).get_relationships().size());
+
+            bench.report("finalize/" + size, state.get_iterations(), stats.get_time("relationships.inheritence") / 1000, number_classes);
+
+        }
+
+    }
+
+    return bench.results();
+
+}
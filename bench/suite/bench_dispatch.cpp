@@ -0,0 +1,94 @@
+/**
+ * @file bench_dispatch.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+#include <srcml_corpus.hpp>
+
+#include <srcuml_dispatcher.hpp>
+#include <srcuml_collector.hpp>
+#include <srcuml_arena.hpp>
+#include <srcSAXController.hpp>
+#include <ClassPolicySingleEvent.hpp>
+
+/** SAX dispatch of the classes of an archive with each event profile, with and without streaming */
+static std::size_t parse(const std::string & srcml, event_profile profile, bool streaming) {
+
+    srcuml_arena arena;
+    srcuml_collector collector(streaming, profile != STRUCTURE_ONLY_PROFILE, &arena);
+    srcuml_dispatcher<ClassPolicy> dispatcher(&collector, profile);
+    srcSAXController controller(srcml);
+    controller.parse(&dispatcher);
+
+    return collector.get_classes().size();
+
+}
+
+int main(int argc, char * argv[]) {
+
+    benchmark_t bench("dispatch", argc, argv);
+
+    for(std::size_t classes : { 100, 1000, 5000 }) {
+
+        corpus_shape shape;
+        shape.classes = classes;
+        const std::string srcml = make_srcml_corpus(shape);
+        const std::string size = std::to_string(classes);
+
+        bench.run("full/" + size, classes, [&](benchmark_state & state) {
+            while(state.keep_running())
+                benchmark_keep(parse(srcml, FULL_PROFILE, false));
+        });
+
+        bench.run("full_streaming/" + size, classes, [&](benchmark_state & state) {
+            while(state.keep_running())
+                benchmark_keep(parse(srcml, FULL_PROFILE, true));
+        });
+
+        bench.run("dependencies/" + size, classes, [&](benchmark_state & state) {
+            while(state.keep_running())
+                benchmark_keep(parse(srcml, DEPENDENCIES_PROFILE, false));
+        });
+
+        bench.run("structure_only/" + size, classes, [&](benchmark_state & state) {
+            while(state.keep_running())
+                benchmark_keep(parse(srcml, STRUCTURE_ONLY_PROFILE, false));
+        });
+
+    }
+
+    // function bodies dominate real code, the dispatch should scale with their size
+    for(std::size_t statements : { 8, 64, 256 }) {
+
+        corpus_shape shape;
+        shape.classes = 500;
+        shape.statements = statements;
+        const std::string srcml = make_srcml_corpus(shape);
+
+        bench.run("body_statements/" + std::to_string(statements), shape.classes * shape.functions * statements, [&](benchmark_state & state) {
+            while(state.keep_running())
+                benchmark_keep(parse(srcml, FULL_PROFILE, false));
+        });
+
+    }
+
+    return bench.results();
+
+}
@@ -0,0 +1,103 @@
+/**
+ * @file bench_layout.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+#include <srcml_corpus.hpp>
+
+#include <srcuml_relationship.hpp>
+#include <svg_layout.hpp>
+
+#include <unordered_map>
+
+/** graph of the classes and their merged relationships, each node sized like a small class box */
+struct corpus_graph {
+
+    ogdf::Graph graph;
+    ogdf::GraphAttributes attributes;
+
+    corpus_graph(std::vector<std::shared_ptr<srcuml_class>> & classes) : graph(), attributes() {
+
+        attributes.init(graph, ogdf::GraphAttributes::nodeGraphics | ogdf::GraphAttributes::edgeGraphics);
+
+        std::unordered_map<srcuml_symbol, ogdf::node> nodes;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+            ogdf::node v = graph.newNode();
+            attributes.width(v) = 120;
+            attributes.height(v) = 20 * (2 + aclass->get_attribute_labels().size() + aclass->get_operation_labels().size());
+            nodes[aclass->get_name_symbol()] = v;
+
+        }
+
+        srcuml_relationships relationships(classes);
+        for(const srcuml_edge & edge : relationships.merge_edges(true)) {
+
+            auto source = nodes.find(edge.source);
+            auto destination = nodes.find(edge.destination);
+            if(source != nodes.end() && destination != nodes.end() && source->second != destination->second)
+                graph.newEdge(source->second, destination->second);
+
+        }
+
+    }
+
+};
+
+/** each engine of svg_layout at the sizes it is chosen for */
+int main(int argc, char * argv[]) {
+
+    benchmark_t bench("layout", argc, argv);
+
+    static const char * const engines[] = { "optimal", "fast", "fast_simple" };
+    const std::vector<std::vector<std::size_t>> sizes = { { 25, 100, 300 }, { 100, 1000, 3000 }, { 1000, 3000, 10000 } };
+
+    for(int engine = OPTIMAL_LAYOUT; engine <= FAST_SIMPLE_LAYOUT; ++engine) {
+
+        for(std::size_t number_classes : sizes[engine]) {
+
+            const std::string name = std::string(engines[engine]) + "/" + std::to_string(number_classes);
+            if(!bench.is_selected(name))
+                continue;
+
+            corpus_shape shape;
+            shape.classes = number_classes;
+            shape.statements = 2;
+            std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+
+            bench.run(name, number_classes, [&](benchmark_state & state) {
+                while(state.keep_running()) {
+
+                    state.pause();
+                    corpus_graph drawing(classes);
+                    state.resume();
+
+                    benchmark_keep(svg_layout::run(drawing.attributes, static_cast<layout_engine>(engine)));
+
+                }
+            });
+
+        }
+
+    }
+
+    return bench.results();
+
+}
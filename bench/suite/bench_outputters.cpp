@@ -0,0 +1,93 @@
+/**
+ * @file bench_outputters.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+#include <srcml_corpus.hpp>
+
+#include <srcuml_relationship.hpp>
+#include <dot_outputter.hpp>
+#include <yuml_outputter.hpp>
+#include <svg_sugiyama_outputter.hpp>
+#include <svg_multi_outputter.hpp>
+#include <svg_three_outputter.hpp>
+#include <svg_overview_outputter.hpp>
+#include <layout_outputter.hpp>
+
+#include <ostream>
+#include <streambuf>
+
+/** discards what is written, the outputters are measured without the disk */
+class null_buffer : public std::streambuf {
+
+protected:
+
+    virtual int overflow(int character) override {
+        return character;
+    }
+
+    virtual std::streamsize xsputn(const char *, std::streamsize count) override {
+        return count;
+    }
+
+};
+
+/** every outputter type on the same analyzed classes, as srcuml_handler runs them */
+int main(int argc, char * argv[]) {
+
+    benchmark_t bench("outputters", argc, argv);
+
+    null_buffer buffer;
+    std::ostream out(&buffer);
+
+    for(std::size_t number_classes : { 100, 1000 }) {
+
+        corpus_shape shape;
+        shape.classes = number_classes;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+        const std::vector<srcuml_relationship> relationships = srcuml_relationships(classes).get_relationships();
+        const std::string size = std::to_string(number_classes);
+
+        auto measure = [&](const std::string & name, const std::function<srcuml_outputter *()> & make) {
+            bench.run(name + "/" + size, number_classes, [&](benchmark_state & state) {
+                while(state.keep_running()) {
+
+                    std::unique_ptr<srcuml_outputter> outputter(make());
+                    outputter->use_relationships(relationships);
+                    benchmark_keep(outputter->output(out, classes));
+
+                }
+            });
+        };
+
+        measure("dot", []() { return new dot_outputter(); });
+        measure("yuml", []() { return new yuml_outputter(); });
+        measure("svg_sugiyama", []() { return new svg_sugiyama_outputter(); });
+        measure("svg_multi", []() { return new svg_multi_outputter(); });
+        measure("svg_three", []() { return new svg_three_outputter(true); });
+        measure("svg_overview", []() { return new svg_overview_outputter(); });
+        measure("layout_json", []() { return new layout_outputter(JSON_LAYOUT); });
+        measure("layout_binary", []() { return new layout_outputter(BINARY_LAYOUT); });
+
+    }
+
+    return bench.results();
+
+}
@@ -0,0 +1,86 @@
+/**
+ * @file bench_relationships.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark.hpp>
+#include <srcml_corpus.hpp>
+
+#include <srcuml_relationship.hpp>
+#include <srcuml_stats.hpp>
+
+/** analyzes the classes threads at a time, the whole analysis and each of its passes */
+static void analyze(benchmark_t & bench, const std::string & name, std::vector<std::shared_ptr<srcuml_class>> & classes, std::size_t threads) {
+
+    if(!bench.is_selected(name))
+        return;
+
+    srcuml_stats stats;
+    benchmark_state state(0.5, 1000000);
+    while(state.keep_running())
+        benchmark_keep(srcuml_relationships(classes, threads, &stats).get_relationships().size());
+
+    bench.report(name, state.get_iterations(), state.get_seconds(), classes.size());
+    for(const char * pass : { "relationships.table", "relationships.inheritence", "relationships.attributes", "relationships.dependencies" })
+        bench.report(name + "/" + (pass + 14), state.get_iterations(), stats.get_time(pass) / 1000, classes.size());
+
+}
+
+int main(int argc, char * argv[]) {
+
+    benchmark_t bench("relationships", argc, argv);
+
+    for(std::size_t number_classes : { 100, 1000, 10000 }) {
+
+        corpus_shape shape;
+        shape.classes = number_classes;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+
+        analyze(bench, "serial/" + std::to_string(number_classes), classes, 1);
+        analyze(bench, "threads_4/" + std::to_string(number_classes), classes, 4);
+
+    }
+
+    // deep hierarchies serialize the inheritence waves
+    for(std::size_t depth : { 1, 10, 100 }) {
+
+        corpus_shape shape;
+        shape.classes = 2000;
+        shape.inheritence_depth = depth;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+
+        analyze(bench, "depth_" + std::to_string(depth) + "/2000", classes, 4);
+
+    }
+
+    // attribute fan-out drives the attribute pass
+    for(std::size_t attributes : { 1, 16, 64 }) {
+
+        corpus_shape shape;
+        shape.classes = 2000;
+        shape.attributes = attributes;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+
+        analyze(bench, "attributes_" + std::to_string(attributes) + "/2000", classes, 1);
+
+    }
+
+    return bench.results();
+
+}
@@ -0,0 +1,366 @@
+/**
+ * @file bench_scorecard.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+
+  Scorecard of the layout engines: the quality of each drawing beside what it
+  cost, over corpora of growing size, to pick svg_layout's optimal_limit and
+  the engine of a project from measurements.
+
+  Usage: bench_scorecard [--filter=text] [--sizes=25,100,...] [--json]
+
+  Each engine lays out each corpus once, in a child process, so a case's peak
+  memory is its own and a layout that does not finish only loses its row.  A
+  row has the layout time, the growth of the peak resident memory, the edge
+  crossings and bends, the total edge length and the area of the drawing.
+  Crossings are counted geometrically between edge segments, so they compare
+  across engines, Sugiyama's own count is of its layers only.
+
+  */
+
+#include <srcml_corpus.hpp>
+
+#include <srcuml_relationship.hpp>
+#include <srcuml_stats.hpp>
+#include <srcuml_utilities.hpp>
+#include <svg_layout.hpp>
+
+#include <ogdf/energybased/FMMMLayout.h>
+
+#include <iostream>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+/** graph of the classes and their merged relationships, each node sized like a small class box, see bench_layout */
+struct corpus_graph {
+
+    ogdf::Graph graph;
+    ogdf::GraphAttributes attributes;
+
+    corpus_graph(std::vector<std::shared_ptr<srcuml_class>> & classes) : graph(), attributes() {
+
+        attributes.init(graph, ogdf::GraphAttributes::nodeGraphics | ogdf::GraphAttributes::edgeGraphics);
+
+        std::unordered_map<srcuml_symbol, ogdf::node> nodes;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+            ogdf::node v = graph.newNode();
+            attributes.width(v) = 120;
+            attributes.height(v) = 20 * (2 + aclass->get_attribute_labels().size() + aclass->get_operation_labels().size());
+            nodes[aclass->get_name_symbol()] = v;
+
+        }
+
+        srcuml_relationships relationships(classes);
+        for(const srcuml_edge & edge : relationships.merge_edges(true)) {
+
+            auto source = nodes.find(edge.source);
+            auto destination = nodes.find(edge.destination);
+            if(source != nodes.end() && destination != nodes.end() && source->second != destination->second)
+                graph.newEdge(source->second, destination->second);
+
+        }
+
+    }
+
+};
+
+/** a row of the scorecard, written by the child that laid it out */
+struct score {
+
+    double milliseconds;
+    std::uint64_t peak_bytes;
+    std::uint64_t crossings;
+    std::uint64_t bends;
+    double edge_length;
+    double area;
+
+};
+
+struct segment {
+
+    ogdf::DPoint first;
+    ogdf::DPoint second;
+    int edge;
+
+};
+
+/** -1, 0 or 1 as c is right of, on or left of the line through a and b */
+static int orientation(const ogdf::DPoint & a, const ogdf::DPoint & b, const ogdf::DPoint & c) {
+
+    const double cross = (b.m_x - a.m_x) * (c.m_y - a.m_y) - (b.m_y - a.m_y) * (c.m_x - a.m_x);
+    return (cross > 1e-9) - (cross < -1e-9);
+
+}
+
+/** crossing in the interior of both, segments touching at an end, e.g. at a shared node, do not cross */
+static bool is_crossing(const segment & one, const segment & two) {
+
+    return orientation(one.first, one.second, two.first) * orientation(one.first, one.second, two.second) < 0
+        && orientation(two.first, two.second, one.first) * orientation(two.first, two.second, one.second) < 0;
+
+}
+
+/**
+ * Crossings between segments of different edges.  The segments are bucketed
+ * in a uniform grid of about one cell per segment, and each pair sharing a
+ * cell is tested once.
+ */
+static std::uint64_t count_crossings(const std::vector<segment> & segments) {
+
+    if(segments.size() < 2)
+        return 0;
+
+    double min_x = segments.front().first.m_x, min_y = segments.front().first.m_y, max_x = min_x, max_y = min_y;
+    for(const segment & part : segments) {
+
+        min_x = std::min({ min_x, part.first.m_x, part.second.m_x });
+        max_x = std::max({ max_x, part.first.m_x, part.second.m_x });
+        min_y = std::min({ min_y, part.first.m_y, part.second.m_y });
+        max_y = std::max({ max_y, part.first.m_y, part.second.m_y });
+
+    }
+
+    const std::size_t columns = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(segments.size()))));
+    const double cell_width = std::max(1.0, (max_x - min_x) / columns), cell_height = std::max(1.0, (max_y - min_y) / columns);
+    const auto column = [&](double x) { return std::min(columns - 1, static_cast<std::size_t>((x - min_x) / cell_width)); };
+    const auto row = [&](double y) { return std::min(columns - 1, static_cast<std::size_t>((y - min_y) / cell_height)); };
+
+    std::vector<std::vector<std::size_t>> cells(columns * columns);
+    for(std::size_t pos = 0; pos < segments.size(); ++pos) {
+
+        const segment & part = segments[pos];
+        for(std::size_t y = row(std::min(part.first.m_y, part.second.m_y)); y <= row(std::max(part.first.m_y, part.second.m_y)); ++y)
+            for(std::size_t x = column(std::min(part.first.m_x, part.second.m_x)); x <= column(std::max(part.first.m_x, part.second.m_x)); ++x)
+                cells[y * columns + x].push_back(pos);
+
+    }
+
+    // last segment tested against each, so a pair sharing several cells is tested once
+    std::vector<std::size_t> tested(segments.size(), segments.size());
+    std::uint64_t crossings = 0;
+    for(std::size_t pos = 0; pos < segments.size(); ++pos) {
+
+        const segment & part = segments[pos];
+        for(std::size_t y = row(std::min(part.first.m_y, part.second.m_y)); y <= row(std::max(part.first.m_y, part.second.m_y)); ++y) {
+            for(std::size_t x = column(std::min(part.first.m_x, part.second.m_x)); x <= column(std::max(part.first.m_x, part.second.m_x)); ++x) {
+
+                for(std::size_t other : cells[y * columns + x]) {
+
+                    if(other <= pos || tested[other] == pos || segments[other].edge == part.edge)
+                        continue;
+
+                    tested[other] = pos;
+                    crossings += is_crossing(part, segments[other]);
+
+                }
+
+            }
+        }
+
+    }
+
+    return crossings;
+
+}
+
+/** the quality of the drawing, each edge running from the center of its source through its bends to the center of its target */
+static void measure(const ogdf::GraphAttributes & attributes, score & result) {
+
+    std::vector<segment> segments;
+    result.bends = 0;
+    result.edge_length = 0;
+
+    int edge = 0;
+    for(ogdf::edge e : attributes.constGraph().edges) {
+
+        ogdf::DPoint previous(attributes.x(e->source()), attributes.y(e->source()));
+        const ogdf::DPolyline & bends = attributes.bends(e);
+        result.bends += bends.size();
+
+        std::vector<ogdf::DPoint> points(bends.begin(), bends.end());
+        points.emplace_back(attributes.x(e->target()), attributes.y(e->target()));
+        for(const ogdf::DPoint & point : points) {
+
+            result.edge_length += std::hypot(point.m_x - previous.m_x, point.m_y - previous.m_y);
+            segments.push_back(segment{ previous, point, edge });
+            previous = point;
+
+        }
+
+        ++edge;
+
+    }
+
+    result.crossings = count_crossings(segments);
+
+    const std::vector<double> extent = svg_layout::extent(attributes);
+    result.area = extent[2] * extent[3];
+
+}
+
+enum scorecard_engine { OPTIMAL_ENGINE, FAST_ENGINE, FAST_SIMPLE_ENGINE, FORCE_ENGINE };
+
+static const char * const engine_names[] = { "optimal", "fast", "fast_simple", "force" };
+
+static void lay_out(ogdf::GraphAttributes & attributes, scorecard_engine engine) {
+
+    if(engine != FORCE_ENGINE) {
+        svg_layout::run(attributes, static_cast<layout_engine>(engine));
+        return;
+    }
+
+    // as svg_overview lays out
+    ogdf::FMMMLayout fmmm;
+    fmmm.useHighLevelOptions(true);
+    fmmm.unitEdgeLength(50.0);
+    fmmm.newInitialPlacement(true);
+    fmmm.qualityVersusSpeed(ogdf::FMMMOptions::QualityVsSpeed::NiceAndIncredibleSpeed);
+    fmmm.call(attributes);
+
+}
+
+/** lays out the classes in a child, false if it failed */
+static bool score_layout(std::vector<std::shared_ptr<srcuml_class>> & classes, scorecard_engine engine, score & result) {
+
+    int channel[2];
+    if(pipe(channel) != 0)
+        return false;
+
+    const pid_t child = fork();
+    if(child < 0) {
+
+        close(channel[0]);
+        close(channel[1]);
+        return false;
+
+    }
+
+    if(child == 0) {
+
+        close(channel[0]);
+
+        corpus_graph drawing(classes);
+
+        // a child's peak starts at its resident memory when forked
+        const std::uint64_t resident = srcuml_stats::resident_rss();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        lay_out(drawing.attributes, engine);
+
+        score measured = score();
+        measured.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const std::uint64_t peak = srcuml_stats::peak_rss();
+        measured.peak_bytes = peak > resident ? peak - resident : 0;
+        measure(drawing.attributes, measured);
+
+        const bool is_written = write(channel[1], &measured, sizeof(measured)) == static_cast<ssize_t>(sizeof(measured));
+        _exit(is_written ? 0 : 1);
+
+    }
+
+    close(channel[1]);
+    const bool is_read = read(channel[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(channel[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    return is_read && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+}
+
+/** each engine over corpora of each size, the optimal engine only up to svg_layout's default optimal_limit */
+int main(int argc, char * argv[]) {
+
+    std::string filter;
+    std::vector<std::size_t> sizes = { 25, 100, 300, 1000, 3000 };
+    bool is_json = false;
+
+    for(int pos = 1; pos < argc; ++pos) {
+
+        std::string argument = argv[pos];
+        if(argument.compare(0, 9, "--filter=") == 0) {
+            filter = argument.substr(9);
+        } else if(argument.compare(0, 8, "--sizes=") == 0) {
+            sizes.clear();
+            for(const std::string & size : srcuml::split(argument.substr(8), ','))
+                sizes.push_back(std::strtoul(size.c_str(), nullptr, 10));
+        } else if(argument == "--json") {
+            is_json = true;
+        } else {
+            std::cerr << "scorecard: unknown argument " << argument << '\n';
+        }
+
+    }
+
+    static const std::size_t OPTIMAL_LIMIT = 300;
+
+    if(!is_json)
+        std::printf("%-24s %8s %8s %12s %10s %10s %8s %14s %14s\n",
+                    "case", "classes", "edges", "layout ms", "peak MiB", "crossings", "bends", "edge length", "area");
+
+    for(std::size_t number_classes : sizes) {
+
+        corpus_shape shape;
+        shape.classes = number_classes;
+        shape.statements = 2;
+        std::vector<std::shared_ptr<srcuml_class>> classes = collect_corpus_classes(make_srcml_corpus(shape));
+        const std::size_t number_edges = corpus_graph(classes).graph.numberOfEdges();
+
+        for(int engine = OPTIMAL_ENGINE; engine <= FORCE_ENGINE; ++engine) {
+
+            const std::string name = std::string(engine_names[engine]) + "/" + std::to_string(number_classes);
+            if((!filter.empty() && name.find(filter) == std::string::npos) || (engine == OPTIMAL_ENGINE && number_classes > OPTIMAL_LIMIT))
+                continue;
+
+            score result = score();
+            if(!score_layout(classes, static_cast<scorecard_engine>(engine), result)) {
+                std::cerr << "scorecard: " << name << " failed\n";
+                continue;
+            }
+
+            if(is_json)
+                std::printf("{\"benchmark\": \"scorecard\", \"case\": \"%s\", \"classes\": %zu, \"edges\": %zu, \"layout_ms\": %.3f, \"peak_bytes\": %llu, "
+                            "\"crossings\": %llu, \"bends\": %llu, \"edge_length\": %.1f, \"area\": %.1f}\n",
+                            name.c_str(), number_classes, number_edges, result.milliseconds, static_cast<unsigned long long>(result.peak_bytes),
+                            static_cast<unsigned long long>(result.crossings), static_cast<unsigned long long>(result.bends), result.edge_length, result.area);
+            else
+                std::printf("%-24s %8zu %8zu %12.3f %10.1f %10llu %8llu %14.1f %14.1f\n",
+                            name.c_str(), number_classes, number_edges, result.milliseconds, result.peak_bytes / (1024.0 * 1024.0),
+                            static_cast<unsigned long long>(result.crossings), static_cast<unsigned long long>(result.bends), result.edge_length, result.area);
+            std::fflush(stdout);
+
+        }
+
+    }
+
+    return 0;
+
+}
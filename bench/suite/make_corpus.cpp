@@ -0,0 +1,79 @@
+/**
+ * @file make_corpus.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+
+  Writes a synthetic srcML archive for benchmarks and profiling, see corpus_shape.
+
+  Usage: make_corpus archive.xml [--classes N] [--depth N] [--attributes N]
+                                 [--functions N] [--statements N] [--per-unit N] [--seed N]
+
+  */
+
+#include <srcml_corpus.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char * argv[]) {
+
+    if(argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: make_corpus archive.xml [--classes N] [--depth N] [--attributes N] [--functions N] [--statements N] [--per-unit N] [--seed N]\n";
+        return 1;
+    }
+
+    corpus_shape shape;
+    for(int pos = 2; pos + 1 < argc; pos += 2) {
+
+        const std::size_t value = std::strtoul(argv[pos + 1], nullptr, 10);
+        if(std::strcmp(argv[pos], "--classes") == 0)
+            shape.classes = value;
+        else if(std::strcmp(argv[pos], "--depth") == 0)
+            shape.inheritence_depth = value;
+        else if(std::strcmp(argv[pos], "--attributes") == 0)
+            shape.attributes = value;
+        else if(std::strcmp(argv[pos], "--functions") == 0)
+            shape.functions = value;
+        else if(std::strcmp(argv[pos], "--statements") == 0)
+            shape.statements = value;
+        else if(std::strcmp(argv[pos], "--per-unit") == 0)
+            shape.classes_per_unit = value;
+        else if(std::strcmp(argv[pos], "--seed") == 0)
+            shape.seed = static_cast<unsigned>(value);
+        else {
+            std::cerr << "Error: Unknown option " << argv[pos] << '\n';
+            return 1;
+        }
+
+    }
+
+    std::ofstream out(argv[1]);
+    if(!out) {
+        std::cerr << "Error: Unable to write " << argv[1] << '\n';
+        return 1;
+    }
+
+    out << make_srcml_corpus(shape);
+    return 0;
+
+}
@@ -23,17 +23,35 @@
 
   Count each the occurrences of each srcML element.
 
-  Input: input_file.xml
+  Input: input_file.xml, or source files and directories
   Useage: srcuml input_file.xml
+          srcuml src/ main.cpp
   
   */
 
 #include <srcuml_handler.hpp>
+#include "srcuml_server.hpp"
+#include "srcuml_watcher.hpp"
+#include "srcuml_batch.hpp"
+#include <srcuml_output.hpp>
+#include <srcuml_stats.hpp>
+#include <srcuml_trace.hpp>
+#include <srcuml_archive.hpp>
+#include <srcuml_cancel.hpp>
+#include <srcuml_member_filter.hpp>
+#include <srcuml_yuml.hpp>
+#include <srcuml_diff.hpp>
+#include <srcuml_query.hpp>
+#include <svg_layout.hpp>
 #include <boost/program_options.hpp>
 
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <cstdlib>
 
 /**
  * main
@@ -45,8 +63,28 @@
 int main(int argc, char * argv[]) {
 
 	std::ostream * out = &std::cout;
-	std::string input_file;
-	std::string type = "svg_sugiyama";
+	std::vector<std::string> input_files;
+	std::string model_file;
+	std::vector<std::string> merge_files;
+	std::vector<std::string> diff_files;
+	std::string yuml_file;
+	std::string query;
+	std::string socket_path;
+	std::vector<std::string> output_files;
+	std::vector<output_compression> compressions;
+	bool watch = false;
+	std::string batch_manifest;
+	std::string batch_output;
+	std::string batch_archive;
+	std::size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+	std::size_t workers = 0;
+	int status = 0;
+	srcuml_options options;
+	srcuml_stats stats;
+	std::string stats_format;
+	std::string trace_file;
+	std::unique_ptr<srcuml_cancel> deadline;
+	std::vector<std::unique_ptr<srcuml_artifact>> artifacts;
 
 	try {
 
@@ -55,9 +93,66 @@ int main(int argc, char * argv[]) {
 		po::options_description desc("Usage: srcuml input_file.xml [-flags]");
 		desc.add_options()
 			("help,h", "Produce help message")
-			("output,o", po::value<std::string>(), "Set output file")
-			("input", po::value<std::string>(), "An xml file generated by srcML")
-			("type,t", po::value<std::string>(), "Type of output. Can be {\nsvg_multi\nsvg_three\nsvg_sugiyama,\ndot,\nyuml\n} Default: svg_sugiyama")
+			("output,o", po::value<std::string>(), "Set output file, comma separated with one file per output type")
+			("compress", po::value<std::string>(), "Compression of the output files. Can be {\nnone,\ngzip\n} Default: gzip for .svgz and .gz files, otherwise none")
+			("input", po::value<std::vector<std::string>>(), "An xml file generated by srcML, which may be gzip, zstd or zip compressed, several of them parsed into one model, - or a pipe for srcML read as it is written, or source files and directories to convert with libsrcml")
+			("type,t", po::value<std::string>(), "Type of output, comma separated for several. Can be {\nsvg_multi\nsvg_three\nsvg_overview (force-directed, class names only, for very large systems)\nsvg_hierarchy (generalizations only, laid out as a forest in linear time)\nsvg_sugiyama,\nlayout_json (svg_sugiyama coordinates for other renderers),\nlayout_binary,\ndot,\nyuml\n} Default: svg_sugiyama")
+			("stream", "Free the srcML data of each class once it is summarized, only its summary is kept. The input and the summaries of every class stay in memory until the output is written. The default, kept for existing scripts")
+			("skip-unchanged", "Only write the --output files whose classes, relationships or options changed since they were written, each through a temporary file")
+			("early-output", "Write each dot or yuml class as soon as it is parsed and the relationships at the end, instead of after the whole input is parsed")
+			("parse-order", "Output the classes and relationships in the order parsed instead of sorted by qualified name. By default reordering the input does not change the output, with --early-output only the relationships are sorted")
+			("threads,j", po::value<std::size_t>(), "Number of threads used to parse the units of an archive and run the outputters. Default: 1")
+			("top-classes", po::value<std::size_t>(), "Only draw this many classes, those ranked highest by their relationships with generalizations weighted most, as an overview of a large system. Paths through the classes left out are drawn as dependencies. Default: every class")
+			("cache", po::value<std::string>(), "Directory caching the classes of each unit, unchanged units are not parsed again")
+			("cache-memory", po::value<std::size_t>(), "MiB of unit summaries kept in memory by the cache of --serve, --watch and --cache, the least recently used past it are read from --cache again. Default: 256")
+			("emit-model", po::value<std::string>(), "Save the analyzed classes and relationships to a binary model file")
+			("from-model", po::value<std::string>(), "Render a model file saved with --emit-model instead of parsing srcML")
+			("shard", po::value<std::string>(), "Only parse the units of shard index/count, e.g. 0/4, by a hash of their filename, and save them to --emit-model as a partial model")
+			("query", po::value<std::string>(), "Answer a question about the --from-model classes instead of rendering them, one qualified class per line. Can be {\ndependents name,\nsubclasses name (transitive),\nimplementers name (transitive),\nowners type (of an attribute of the type),\ninterfaces\n}")
+			("include", po::value<std::string>(), "Comma separated globs of the unit filenames parsed, e.g. src/net/**, ** crosses directories. Others are skipped before they are parsed")
+			("exclude", po::value<std::string>(), "Comma separated globs of the unit filenames skipped before they are parsed, e.g. *_test.cpp")
+			("include-classes", po::value<std::string>(), "Comma separated globs of the qualified class names kept, a namespace ends in ::, e.g. net::")
+			("exclude-classes", po::value<std::string>(), "Comma separated globs of the qualified class names dropped before they are summarized")
+			("duplicates", po::value<std::string>(), "What is done with classes of the same name parsed from several units. Can be {\nkeep,\nmerge (copies with the same members are drawn once),\nnewest (only the last parsed is drawn)\n} Default: keep")
+			("merge", po::value<std::string>(), "Merge the comma separated models, e.g. of every --shard, analyze and render them instead of parsing srcML")
+			("diff", po::value<std::vector<std::string>>()->multitoken(), "Render only what changed from the base to the head model, e.g. --diff base.model head.model, with the classes and relationships next to it")
+			("from-yuml", po::value<std::string>(), "Output a yUML diagram, e.g. written with -t yuml, as the --type instead of parsing srcML")
+			("serve", po::value<std::string>(), "Serve requests on a Unix domain socket, keeping the unit cache warm. The request metrics answers the OpenMetrics of the requests served. With --from-model, a request of only the output types renders the model")
+			("workers", po::value<std::size_t>(), "Number of --serve worker processes, forked once the --from-model model is loaded so they share its memory. Default: requests are served by the server itself")
+			("batch", po::value<std::string>(), "Run each job of a manifest in this process, a job per line: inputs -> comma separated outputs")
+			("batch-output", po::value<std::string>(), "Run each input as a job of its own, writing the outputs of this comma separated template, {name} is the input's name, e.g. diagrams/{name}.svg")
+			("jobs", po::value<std::size_t>(), "Number of --batch jobs running at a time. Default: the number of cores")
+			("archive", po::value<std::string>(), "Archive the --batch outputs are written into, as entries named by their paths, instead of files. Can be {\n.tar,\n.tar.gz,\n.tgz,\n.zip\n}")
+			("watch", "Regenerate the output whenever an input changes")
+			("containers", po::value<std::string>(), "File of extra container and smart pointer templates, one \"name like\" pair per line, e.g. absl::flat_hash_map unordered_map")
+			("layout-budget", po::value<std::size_t>(), "Milliseconds the optimal svg_sugiyama layout may take before a fast layout is used instead. Graphs with more than --optimal-limit classes always use a fast layout. Default: no limit")
+			("optimal-limit", po::value<std::size_t>(), "Most classes a graph may have to be given the optimal layout, larger graphs use a fast layout. Default: 300")
+			("layout-components", "Lay out each connected component of the svg_sugiyama graph separately, using --threads, and pack them together")
+			("layout-cache", po::value<std::string>(), "File keeping svg_sugiyama drawings between runs, unchanged components (see --layout-components) are not laid out again. svg_three keeps the drawings of its bands (see --three-bands) in the file with .three appended")
+			("svg-patch", po::value<std::string>(), "File the changes to the svg_sugiyama drawing since the last run with the same --layout-cache are written to, as JSON lines of added, removed, replaced and moved node and edge groups keyed by their id, for a live viewer")
+			("raise-edges", "Draw the SVG edges passing over classes other than their own over those classes instead of hidden beneath them")
+			("crossmin-runs", po::value<std::size_t>(), "Crossing minimization runs of svg_sugiyama, each with one of three heuristics and its own seeded start and made across --threads, the drawing with the fewest crossings is kept. The drawing does not depend on --threads. Default: 1")
+			("three-bands", "Lay out svg_three as side by side Boundary, Control and Entity bands, each laid out in parallel, instead of the much slower ClusterPlanarizationLayout")
+			("clusters", po::value<std::string>(), "What svg_multi clusters classes by. Can be {\nnamespace,\ndirectory\n} Default: namespace")
+			("cluster-directory", po::value<std::string>(), "Directory svg_multi writes one SVG per cluster to, next to the summary")
+			("tiles", po::value<std::string>(), "Directory the SVG outputs are also written to as a grid of tiles, with a JSON manifest of the tiles and class positions for a viewer")
+			("tile-size", po::value<double>(), "Width and height of a tile in layout units. Default: 2000")
+			("focus", po::value<std::string>(), "Only draw the classes around this class, qualified or not")
+			("depth", po::value<std::size_t>(), "Relationships followed from the --focus class, in either direction. Default: 1")
+			("edge-detail", po::value<std::string>(), "Comma separated edge aggregations for large diagrams. Can be {\nimplied (dependencies drawn as the pair's structural relationship),\ntransitive (dependencies also reached through two other edges are dropped),\nbundle (edges between the same two namespaces drawn as one thicker edge)\n}")
+			("stats", po::value<std::string>()->implicit_value("text"), "Write the time of each phase, counts of the parsed and drawn classes and the peak memory to stderr when done. Can be {\ntext,\njson\n} Default: text")
+			("deadline", po::value<std::size_t>(), "Milliseconds the run may take. At the deadline parsing stops, the relationships found so far are kept and the layouts fall back to faster ones, so a degraded diagram is still written. Default: no limit")
+			("trace", po::value<std::string>(), "File a trace of the run is written to when done, in the Chrome trace event format for Perfetto, with a span for each phase, unit parsed, class finalized and OGDF layout call on its thread")
+			("progress", "Write an event to stderr, a JSON object per line, as each phase starts and ends and when the deadline cuts one short")
+			("max-classes", po::value<std::size_t>(), "Classes beyond which the SVG outputs are drawn as svg_overview, without dependencies and with member counts instead of members. Default: no limit")
+			("max-edges", po::value<std::size_t>(), "Relationships drawn from a class, its dependencies are dropped first. Default: no limit")
+			("max-label-lines", po::value<std::size_t>(), "Attributes and operations of a class beyond which only their counts are drawn. Default: no limit")
+			("max-members", po::value<std::size_t>(), "Attributes, and operations, drawn for a class, public ones first, the rest are drawn as a count. Default: no limit")
+			("members-file", po::value<std::string>(), "File every member of the classes cut short by --max-members is written to, as yUML")
+			("memory-limit", po::value<std::size_t>(), "Soft cap in MiB of the resident memory, past it srcML data is freed while parsing and the output degrades as with --max-classes. Default: no limit")
+			("profile,p", po::value<std::string>(), "srcML events to process. Can be {\nfull,\ndependencies,\nstructure-only\n} Default: full")
+			("hide-members", po::value<std::string>(), "Comma separated method stereotypes and visibilities of the attributes and operations left out of the diagrams, e.g. get,set,private, or none. Default: get,set")
+			("stereotypes", "Classify the method and class stereotypes from the function bodies while parsing, instead of running stereotype.xsl over the archive first")
 		;
 
 		po::positional_options_description p;
@@ -74,44 +169,415 @@ int main(int argc, char * argv[]) {
 
 		if(vm.count("input")) {
 
-			std::cout << "Input file is: " << vm["input"].as<string>() << ".\n";
-			input_file = vm["input"].as<std::string>();
+			input_files = vm["input"].as<std::vector<std::string>>();
+			for(const std::string & input_file : input_files)
+				std::cout << "Input file is: " << input_file << ".\n";
+
+			if(vm.count("batch-output"))
+				batch_output = vm["batch-output"].as<std::string>();
+
+		} else if(vm.count("batch")) {
+
+			batch_manifest = vm["batch"].as<std::string>();
+			std::cout << "Batch manifest is: " << batch_manifest << ".\n";
+
+		} else if(vm.count("serve")) {
+
+			socket_path = vm["serve"].as<std::string>();
+			if(vm.count("from-model"))
+				model_file = vm["from-model"].as<std::string>();
+
+		} else if(vm.count("from-model")) {
+
+			model_file = vm["from-model"].as<std::string>();
+			std::cout << "Model file is: " << model_file << ".\n";
+
+		} else if(vm.count("merge")) {
+
+			merge_files = srcuml::split(vm["merge"].as<std::string>(), ',');
+			std::cout << "Merging " << merge_files.size() << " models.\n";
+
+		} else if(vm.count("diff")) {
+
+			diff_files = vm["diff"].as<std::vector<std::string>>();
+			if(diff_files.size() != 2)
+				throw std::string("Error: --diff needs a base and a head model");
+			std::cout << "Diffing " << diff_files[0] << " and " << diff_files[1] << ".\n";
+
+		} else if(vm.count("from-yuml")) {
+
+			yuml_file = vm["from-yuml"].as<std::string>();
+			std::cout << "yUML file is: " << yuml_file << ".\n";
 
 		} else {
 			std::cout << "Error: Require an input file.\nUsage: srcuml input_file.xml [-flags]\n";
 			return 1;
 		}
 
+		watch = vm.count("watch");
+
 		if (vm.count("output")) {
-			std::string temp = vm["output"].as<std::string>();
-			std::cout << "Ouput file is: " << vm["output"].as<std::string>() << ".\n";
-			out = new std::ofstream(vm["output"].as<std::string>());
+			std::string outputs = vm["output"].as<std::string>();
+			std::cout << "Ouput file is: " << outputs << ".\n";
+
+			output_files = srcuml::split(outputs, ',');
+			for(const std::string & output_file : output_files)
+				compressions.push_back(vm.count("compress") ? parse_output_compression(vm["compress"].as<std::string>())
+															: compression_of(output_file));
+
+			if(!watch && vm.count("skip-unchanged")) {
+
+				if(vm.count("early-output"))
+					throw std::string("Error: --skip-unchanged cannot write the output early");
+
+				for(std::size_t pos = 0; pos < output_files.size(); ++pos) {
+					artifacts.emplace_back(new srcuml_artifact(output_files[pos], compressions[pos]));
+					options.artifacts.push_back(artifacts.back().get());
+				}
+
+			} else if(!watch) {
+
+				for(std::size_t pos = 0; pos < output_files.size(); ++pos)
+					options.outputs.push_back(open_output(output_files[pos], compressions[pos]));
+
+			}
+
+			if(options.outputs.size() == 1) {
+				out = options.outputs.front();
+				options.outputs.clear();
+			}
+
 		} else {
 			std::cout << "Using cout as default output.\n";
 		}
 
 		if(vm.count("type")) {
-			type = vm["type"].as<std::string>();
-			std::cout << "Type: " << type << std::endl;
+			options.type = vm["type"].as<std::string>();
+			std::cout << "Type: " << options.type << std::endl;
+		}
+
+		if(vm.count("stream")) {
+			options.streaming = true;
+		}
+
+		if(vm.count("early-output")) {
+			options.early_output = true;
+		}
+
+		if(vm.count("parse-order")) {
+			options.sorted = false;
+		}
+
+		if(vm.count("jobs")) {
+			jobs = std::max<std::size_t>(1, vm["jobs"].as<std::size_t>());
+		}
+
+		if(vm.count("workers")) {
+			if(socket_path.empty())
+				throw std::string("Error: --workers serve the requests of a server, it needs --serve");
+			workers = vm["workers"].as<std::size_t>();
+		}
+
+		if(vm.count("archive")) {
+			if(batch_manifest.empty() && batch_output.empty())
+				throw std::string("Error: --archive holds the outputs of a batch, it needs --batch or --batch-output");
+			batch_archive = vm["archive"].as<std::string>();
+			if(!srcuml_archive::is_archive(batch_archive))
+				throw std::string("Error: Unknown archive ") + batch_archive + ". Can be {.tar, .tar.gz, .tgz, .zip}";
+		}
+
+		if(vm.count("threads")) {
+			options.threads = std::max<std::size_t>(1, vm["threads"].as<std::size_t>());
+		}
+
+		if(vm.count("cache-memory")) {
+			options.cache_memory = vm["cache-memory"].as<std::size_t>() * 1024 * 1024;
+		}
+
+		if(vm.count("cache")) {
+			options.cache_directory = vm["cache"].as<std::string>();
+		}
+
+		if(vm.count("emit-model")) {
+			options.emit_model = vm["emit-model"].as<std::string>();
+		}
+
+		if(vm.count("query")) {
+			query = vm["query"].as<std::string>();
+			if(model_file.empty())
+				throw std::string("Error: --query answers from a model, it needs --from-model");
+		}
+
+		if(vm.count("shard")) {
+			options.shard = srcuml_shard::parse(vm["shard"].as<std::string>());
+			if(options.emit_model.empty())
+				throw std::string("Error: --shard saves a partial model, it needs --emit-model");
+		}
+
+		if(vm.count("include")) {
+			options.filter.include_paths = srcuml::split(vm["include"].as<std::string>(), ',');
+		}
+
+		if(vm.count("exclude")) {
+			options.filter.exclude_paths = srcuml::split(vm["exclude"].as<std::string>(), ',');
+		}
+
+		if(vm.count("include-classes")) {
+			options.filter.include_classes = srcuml::split(vm["include-classes"].as<std::string>(), ',');
+		}
+
+		if(vm.count("exclude-classes")) {
+			options.filter.exclude_classes = srcuml::split(vm["exclude-classes"].as<std::string>(), ',');
+		}
+
+		if(vm.count("containers")) {
+			srcuml_container_registry::instance().load(vm["containers"].as<std::string>());
+		}
+
+		if(vm.count("hide-members")) {
+			srcuml_member_filter::instance().set_rules(vm["hide-members"].as<std::string>());
+		}
+
+		if(vm.count("layout-budget")) {
+			options.layout_budget = vm["layout-budget"].as<std::size_t>();
+		}
+
+		if(vm.count("optimal-limit")) {
+			options.optimal_limit = vm["optimal-limit"].as<std::size_t>();
+		}
+
+		if(vm.count("layout-components")) {
+			options.layout_components = true;
+		}
+
+		if(vm.count("layout-cache")) {
+			options.layout_cache = vm["layout-cache"].as<std::string>();
+		}
+
+		if(vm.count("svg-patch")) {
+			if(options.layout_cache.empty())
+				throw std::string("Error: --svg-patch patches the drawing kept with the layout, it needs --layout-cache");
+			options.svg_patch = vm["svg-patch"].as<std::string>();
+		}
+
+		if(vm.count("raise-edges")) {
+			options.raise_edges = true;
+		}
+
+		if(vm.count("crossmin-runs")) {
+			options.crossmin_runs = std::max<std::size_t>(1, vm["crossmin-runs"].as<std::size_t>());
+		}
+
+		if(vm.count("three-bands")) {
+			options.three_bands = true;
+		}
+
+		if(vm.count("duplicates")) {
+			options.duplicates = parse_duplicate_policy(vm["duplicates"].as<std::string>());
+		}
+
+		if(vm.count("clusters")) {
+			options.clusters = parse_cluster_source(vm["clusters"].as<std::string>());
+		}
+
+		if(vm.count("cluster-directory")) {
+			options.cluster_directory = vm["cluster-directory"].as<std::string>();
+		}
+
+		if(vm.count("tiles")) {
+			options.tile_directory = vm["tiles"].as<std::string>();
+		}
+
+		if(vm.count("tile-size")) {
+			options.tile_size = vm["tile-size"].as<double>();
+		}
+
+		if(vm.count("focus")) {
+			options.focus = vm["focus"].as<std::string>();
+		}
+
+		if(vm.count("depth")) {
+			options.focus_depth = vm["depth"].as<std::size_t>();
+		}
+
+		if(vm.count("top-classes")) {
+			options.top_classes = vm["top-classes"].as<std::size_t>();
+		}
+
+		if(vm.count("edge-detail")) {
+			options.edge_detail = parse_edge_detail(vm["edge-detail"].as<std::string>());
+		}
+
+		if(vm.count("profile")) {
+			options.profile = parse_event_profile(vm["profile"].as<std::string>());
+		}
+
+		if(vm.count("stereotypes")) {
+			options.stereotypes = true;
+		}
+
+		if(vm.count("max-classes")) {
+			options.max_classes = vm["max-classes"].as<std::size_t>();
+		}
+
+		if(vm.count("max-edges")) {
+			options.max_edges_per_class = vm["max-edges"].as<std::size_t>();
+		}
+
+		if(vm.count("max-label-lines")) {
+			options.max_label_lines = vm["max-label-lines"].as<std::size_t>();
+		}
+
+		if(vm.count("max-members")) {
+			options.max_members = vm["max-members"].as<std::size_t>();
+		}
+
+		if(vm.count("members-file")) {
+			options.members_file = vm["members-file"].as<std::string>();
+		}
+
+		if(vm.count("memory-limit")) {
+			options.memory_limit = vm["memory-limit"].as<std::size_t>() * 1024 * 1024;
+		}
+
+		if(vm.count("stats")) {
+			stats_format = vm["stats"].as<std::string>();
+			if(stats_format != "text" && stats_format != "json")
+				throw std::string("Error: Unknown stats format ") + stats_format + ". Can be {text, json}";
+			options.stats = &stats;
+		}
+
+		if(vm.count("progress")) {
+			stats.report_progress(&std::cerr);
+			options.stats = &stats;
+		}
+
+		if(vm.count("trace")) {
+			trace_file = vm["trace"].as<std::string>();
+			srcuml_trace::instance().start();
+		}
+
+		if(vm.count("deadline") && vm["deadline"].as<std::size_t>() > 0) {
+			deadline.reset(new srcuml_cancel(vm["deadline"].as<std::size_t>()));
+			options.cancel = deadline.get();
 		}
 
 	} catch(std::exception& e) {
 		std::cerr << "error: " << e.what() << "\n";
 		return 1;
 
+	} catch(std::string& e) {
+		std::cerr << e << "\n";
+		return 1;
+
 	} catch(...) {
 		std::cerr << "Exception of unknown type!\n";
 	}
 
 	try {
-		srcuml_handler handler(input_file, *out, type);
+		if(!batch_manifest.empty() || !batch_output.empty()) {
+			srcuml_batch batch(options, jobs);
+			if(!batch_archive.empty())
+				batch.use_archive(batch_archive);
+			if(!batch_manifest.empty())
+				batch.read_manifest(batch_manifest);
+			else
+				batch.add_inputs(input_files, batch_output);
+
+			std::size_t failures = batch.run();
+			if(failures) {
+				std::cout << "Error: " << failures << " batch jobs failed" << std::endl;
+				status = 1;
+			}
+		} else if(!socket_path.empty()) {
+			srcuml_server server(socket_path, options, workers);
+			if(!model_file.empty())
+				server.load_model(model_file);
+			server.run();
+		} else if(watch) {
+			srcuml_watcher watcher(input_files, output_files, compressions, options);
+			watcher.run();
+		} else if(!yuml_file.empty()) {
+			if(options.type == "dot") {
+				std::ifstream yuml(yuml_file);
+				if(!yuml)
+					throw std::string("Error: Unable to open ") + yuml_file;
+				srcuml_yuml_dot_writer::convert(yuml, *out);
+			} else {
+				// other outputs lay out the classes of the diagram, dot is converted as it is read
+				srcuml_model model = srcuml_yuml_model_builder::load(yuml_file);
+				srcuml_handler handler(model, *out, options);
+			}
+		} else if(!diff_files.empty()) {
+			srcuml_model base = srcuml_model::load(diff_files[0]);
+			srcuml_model head = srcuml_model::load(diff_files[1]);
+			if(base.get_is_partial() || head.get_is_partial())
+				throw std::string("Error: --diff needs analyzed models, merge the shards first");
+
+			srcuml_diff diff(base, head);
+			std::cout << "Classes: " << diff.get_classes(srcuml_diff::ADDED) << " added, " << diff.get_classes(srcuml_diff::REMOVED) << " removed, "
+					  << diff.get_classes(srcuml_diff::MODIFIED) << " modified.\n"
+					  << "Relationships: " << diff.get_relationships(srcuml_diff::ADDED) << " added, "
+					  << diff.get_relationships(srcuml_diff::REMOVED) << " removed.\n";
+
+			if(diff.is_empty()) {
+				std::cout << "No architectural changes.\n";
+			} else {
+				srcuml_model model = diff.get_model();
+				srcuml_handler handler(model, *out, options);
+			}
+		} else if(!merge_files.empty()) {
+			srcuml_model model = srcuml_model::merge(merge_files);
+			srcuml_handler handler(model, *out, options);
+		} else if(!model_file.empty() && !query.empty()) {
+			srcuml_model model = srcuml_model::load(model_file);
+			if(model.get_is_partial())
+				throw std::string("Error: --query needs an analyzed model, merge the shards first");
+			srcuml_query(model.get_classes(), model.get_relationships()).answer(query, *out);
+		} else if(!model_file.empty()) {
+			srcuml_model model = srcuml_model::load(model_file);
+			srcuml_handler handler(model, *out, options);
+		} else if(input_files.size() == 1 && srcuml_descriptor_reader::is_stream(input_files.front())) {
+			srcuml_descriptor_reader input(input_files.front());
+			srcuml_handler handler(input, *out, options);
+		} else if(input_files.size() == 1 && srcuml_compressed_reader::compression_of(input_files.front()) != NO_INPUT_COMPRESSION) {
+			srcuml_compressed_reader input(input_files.front());
+			srcuml_handler handler(input, *out, options);
+		} else if(srcuml_source::is_srcml_file(input_files)) {
+			srcuml_handler handler(input_files.front().c_str(), *out, options);
+		} else {
+			srcuml_handler handler(input_files, *out, options);
+		}
 	} catch(std::string& e) {
 		std::cout << e << std::endl;
 	}
 
+	if(stats_format == "json")
+		stats.write_json(std::cerr);
+	else if(!stats_format.empty())
+		stats.write_text(std::cerr);
+
+	if(!trace_file.empty()) {
+		std::ofstream trace(trace_file);
+		srcuml_trace::instance().write_json(trace);
+		if(!trace) {
+			std::cout << "Error: Unable to write trace " << trace_file << std::endl;
+			status = 1;
+		}
+	}
 
 	if(out != &std::cout)
 		delete out;
 
-	return 0;
+	for(std::ostream * output : options.outputs)
+		delete output;
+
+	// the output is written, an abandoned optimal layout cannot be interrupted and is not waited for
+	if(svg_layout::running_abandoned() != 0) {
+		std::cout.flush();
+		std::cerr.flush();
+		std::_Exit(status);
+	}
+
+	return status;
 }
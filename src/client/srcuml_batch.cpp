@@ -0,0 +1,233 @@
+/**
+ * @file srcuml_batch.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "srcuml_batch.hpp"
+
+#include <srcuml_handler.hpp>
+#include <srcuml_output.hpp>
+#include <srcuml_archive.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <libxml/parser.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+srcuml_batch::srcuml_batch(const srcuml_options & options, std::size_t concurrency)
+	: options(options), concurrency(std::max<std::size_t>(1, concurrency)), jobs(), archive() {
+
+	this->options.outputs.clear();
+
+}
+
+void srcuml_batch::add_job(const std::vector<std::string> & inputs, const std::vector<std::string> & outputs) {
+
+	if(inputs.empty() || outputs.empty())
+		throw std::string("Error: A batch job needs inputs and outputs");
+
+	jobs.push_back({ inputs, outputs });
+
+}
+
+void srcuml_batch::read_manifest(const std::string & filename) {
+
+	std::ifstream manifest(filename);
+	if(!manifest)
+		throw std::string("Error: Unable to read batch manifest ") + filename;
+
+	std::string line;
+	for(std::size_t line_number = 1; std::getline(manifest, line); ++line_number) {
+
+		std::size_t first = line.find_first_not_of(" \t\r");
+		if(first == std::string::npos || line[first] == '#')
+			continue;
+
+		std::size_t arrow = line.find("->");
+		if(arrow == std::string::npos)
+			throw std::string("Error: Missing -> on line ") + std::to_string(line_number) + " of " + filename;
+
+		std::vector<std::string> inputs;
+		std::istringstream input_list(line.substr(0, arrow));
+		for(std::string input; input_list >> input;)
+			inputs.push_back(input);
+
+		std::vector<std::string> outputs;
+		std::istringstream output_list(line.substr(arrow + 2));
+		for(std::string output; output_list >> output;)
+			for(const std::string & file : srcuml::split(output, ','))
+				if(!file.empty())
+					outputs.push_back(file);
+
+		add_job(inputs, outputs);
+
+	}
+
+}
+
+void srcuml_batch::add_inputs(const std::vector<std::string> & inputs, const std::string & output_template) {
+
+	for(const std::string & input : inputs) {
+
+		// a directory is named by its last component
+		std::string trimmed = input;
+		while(trimmed.size() > 1 && trimmed.back() == '/')
+			trimmed.pop_back();
+
+		std::string name = boost::filesystem::path(trimmed).stem().string();
+
+		std::vector<std::string> outputs;
+		for(std::string output : srcuml::split(output_template, ',')) {
+
+			for(std::size_t pos = output.find("{name}"); pos != std::string::npos; pos = output.find("{name}", pos + name.size()))
+				output.replace(pos, 6, name);
+
+			outputs.push_back(output);
+
+		}
+
+		add_job({ input }, outputs);
+
+	}
+
+}
+
+void srcuml_batch::use_archive(const std::string & archive_file) {
+
+	archive = archive_file;
+
+}
+
+std::size_t srcuml_batch::run() const {
+
+	// libxml2 must be initialized before parsers are created on other threads
+	xmlInitParser();
+
+	std::atomic<std::size_t> next_job(0);
+	std::atomic<std::size_t> failures(0);
+
+	// declared before the writer, so the writer's thread is done with it first
+	std::unique_ptr<srcuml_archive> output_archive;
+	if(!archive.empty())
+		output_archive.reset(new srcuml_archive(archive));
+
+	srcuml_async_writer writer;
+	if(output_archive)
+		writer.use_archive([&output_archive](const std::string & name, const std::string & data) { output_archive->add(name, data); });
+	std::mutex report_mutex;
+
+	auto work = [&]() {
+
+		for(std::size_t pos = next_job++; pos < jobs.size(); pos = next_job++) {
+
+			try {
+
+				run_job(jobs[pos], writer);
+
+			} catch(const std::string & error) {
+
+				++failures;
+				std::lock_guard<std::mutex> lock(report_mutex);
+				std::cerr << jobs[pos].outputs.front() << ": " << error << '\n';
+
+			} catch(const std::exception & error) {
+
+				++failures;
+				std::lock_guard<std::mutex> lock(report_mutex);
+				std::cerr << jobs[pos].outputs.front() << ": error: " << error.what() << '\n';
+
+			}
+
+		}
+
+	};
+
+	std::vector<std::thread> workers;
+	for(std::size_t worker = 1; worker < std::min(concurrency, jobs.size()); ++worker)
+		workers.emplace_back(work);
+
+	work();
+
+	for(std::thread & worker : workers)
+		worker.join();
+
+	for(const std::string & error : writer.finish()) {
+		++failures;
+		std::cerr << error << '\n';
+	}
+
+	if(output_archive) {
+
+		try {
+			output_archive->close();
+		} catch(const std::string & error) {
+			++failures;
+			std::cerr << error << '\n';
+		}
+
+	}
+
+	return failures;
+
+}
+
+void srcuml_batch::run_job(const job & ajob, srcuml_async_writer & writer) const {
+
+	srcuml_options job_options = options;
+
+	std::vector<std::unique_ptr<std::ostream>> streams;
+	for(const std::string & output : ajob.outputs) {
+
+		streams.emplace_back(writer.open(output));
+
+		job_options.outputs.push_back(streams.back().get());
+
+	}
+
+	std::ostream & out = *streams.front();
+	if(streams.size() == 1)
+		job_options.outputs.clear();
+
+	try {
+
+		if(srcuml_source::is_srcml_file(ajob.inputs)) {
+			srcuml_handler handler(ajob.inputs.front().c_str(), out, job_options);
+		} else {
+			srcuml_handler handler(ajob.inputs, out, job_options);
+		}
+
+	} catch(...) {
+
+		// the outputs of a failed job are incomplete, none is archived or kept
+		for(const std::unique_ptr<std::ostream> & stream : streams)
+			static_cast<srcuml_async_stream &>(*stream).abandon();
+		throw;
+
+	}
+
+}
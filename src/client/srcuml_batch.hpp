@@ -0,0 +1,95 @@
+/**
+ * @file srcuml_batch.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_BATCH_HPP
+#define INCLUDED_SRCUML_BATCH_HPP
+
+#include <srcuml_options.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class srcuml_async_writer;
+
+/**
+ * srcuml_batch
+ *
+ * Runs many diagrams in one process: each job parses, analyzes, lays out and
+ * renders its inputs to its outputs, and jobs are taken by a fixed number of
+ * worker threads.  The outputs are written by a srcuml_async_writer, so a
+ * worker moves on to its next job while the last is still being written.  A
+ * failed job or output is reported and the others still run.
+ *
+ * A manifest has a job per line, its inputs then "->" then its comma
+ * separated outputs:
+ *
+ *   module_a.xml -> diagrams/module_a.svg
+ *   src/b/ include/b/ -> diagrams/b.svg,diagrams/b.dot
+ *
+ * Blank lines and lines starting with # are skipped.
+ *
+ * With use_archive, the outputs are entries of a single archive instead,
+ * named by their paths, see srcuml_archive.
+ */
+class srcuml_batch {
+
+private:
+
+	struct job {
+		std::vector<std::string> inputs;
+		std::vector<std::string> outputs;
+	};
+
+	srcuml_options options;
+	std::size_t concurrency;
+	std::vector<job> jobs;
+	// archive the outputs are written into, empty writes files
+	std::string archive;
+
+public:
+
+	/** options are those of every job, concurrency jobs run at a time */
+	srcuml_batch(const srcuml_options & options, std::size_t concurrency);
+
+	void add_job(const std::vector<std::string> & inputs, const std::vector<std::string> & outputs);
+
+	void read_manifest(const std::string & filename);
+
+	/**
+	 * A job for each input, whose outputs are output_template with {name} replaced
+	 * by the input's name without its extension, e.g. out/{name}.svg
+	 */
+	void add_inputs(const std::vector<std::string> & inputs, const std::string & output_template);
+
+	/** outputs are written into the archive file instead, its format by its extension */
+	void use_archive(const std::string & archive_file);
+
+	/** runs every job, returns the number of jobs and outputs that failed */
+	std::size_t run() const;
+
+private:
+
+	void run_job(const job & ajob, srcuml_async_writer & writer) const;
+
+};
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @file srcuml_server.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "srcuml_server.hpp"
+
+#include <srcuml_handler.hpp>
+
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+srcuml_server::srcuml_server(const std::string & socket_path, const srcuml_options & options, std::size_t workers)
+	: socket_path(socket_path), options(options), cache(options.cache_directory, options.profile, options.stereotypes, options.cache_memory),
+	  model(), has_model(false), workers(workers), listen_fd(-1) {
+
+	this->options.cache = &cache;
+	this->options.outputs.clear();
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(socket_path.size() >= sizeof(address.sun_path))
+		throw std::string("Error: Socket path too long ") + socket_path;
+	std::strcpy(address.sun_path, socket_path.c_str());
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listen_fd < 0)
+		throw std::string("Error: Unable to create socket");
+
+	unlink(socket_path.c_str());
+	if(bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+		|| listen(listen_fd, 16) != 0) {
+
+		close(listen_fd);
+		throw std::string("Error: Unable to listen on ") + socket_path;
+
+	}
+
+}
+
+srcuml_server::~srcuml_server() {
+
+	if(listen_fd >= 0) {
+
+		close(listen_fd);
+		unlink(socket_path.c_str());
+
+	}
+
+}
+
+void srcuml_server::load_model(const std::string & filename) {
+
+	model = srcuml_model::load(filename);
+	if(model.get_is_partial())
+		throw std::string("Error: --serve needs an analyzed model, merge the shards first");
+
+	// rendered now, not lazily in each worker, which would copy every class's page
+	for(const std::shared_ptr<srcuml_class> & aclass : model.get_classes()) {
+
+		aclass->get_attribute_labels();
+		aclass->get_operation_labels();
+
+	}
+
+	has_model = true;
+	std::cout << "Serving " << model.get_classes().size() << " classes of " << filename << ".\n";
+
+}
+
+void srcuml_server::run() {
+
+	std::cout << "Listening on " << socket_path << ".\n";
+
+	if(workers)
+		run_workers();
+	else
+		serve_requests();
+
+}
+
+void srcuml_server::serve_requests() {
+
+	bool running = true;
+	while(running) {
+
+		int connection_fd = accept(listen_fd, nullptr, nullptr);
+		if(connection_fd < 0)
+			continue;
+
+		running = serve(connection_fd);
+		close(connection_fd);
+
+	}
+
+}
+
+/**
+ * Forks the workers, and again for any that dies, until one serves quit. A worker dying soon
+ * after it is forked is forked again after a delay doubling with each such death, and the
+ * server stops after MAX_QUICK_DEATHS of them in a row.
+ */
+void srcuml_server::run_workers() {
+
+	static const std::chrono::seconds QUICK_DEATH(1);
+	static const std::chrono::milliseconds FIRST_BACKOFF(100);
+	static const std::chrono::milliseconds MAX_BACKOFF(5000);
+	static const std::size_t MAX_QUICK_DEATHS = 10;
+
+	std::vector<pid_t> pids;
+	std::vector<std::chrono::steady_clock::time_point> forked;
+	std::chrono::milliseconds backoff(0);
+	std::size_t quick_deaths = 0;
+
+	try {
+
+		while(pids.size() < workers) {
+
+			pids.push_back(fork_worker());
+			forked.push_back(std::chrono::steady_clock::now());
+
+		}
+
+		std::cout << "Forked " << workers << " workers.\n";
+
+		while(true) {
+
+			int status = 0;
+			const pid_t pid = waitpid(-1, &status, 0);
+			if(pid < 0) {
+
+				if(errno == EINTR)
+					continue;
+				break;
+
+			}
+
+			std::vector<pid_t>::iterator worker = std::find(pids.begin(), pids.end(), pid);
+			if(worker == pids.end())
+				continue;
+
+			if(WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+
+				pids.erase(worker);
+				break;
+
+			}
+
+			const std::size_t pos = worker - pids.begin();
+			if(std::chrono::steady_clock::now() - forked[pos] < QUICK_DEATH) {
+
+				if(++quick_deaths >= MAX_QUICK_DEATHS)
+					throw std::string("Error: Server workers died ") + std::to_string(quick_deaths) + " times in a row as soon as they were forked";
+
+				backoff = std::min(MAX_BACKOFF, backoff.count() == 0 ? FIRST_BACKOFF : backoff * 2);
+
+			} else {
+
+				quick_deaths = 0;
+				backoff = std::chrono::milliseconds(0);
+
+			}
+
+			std::cout << "Worker " << pid << " died, forking another";
+			if(backoff.count() != 0)
+				std::cout << " in " << backoff.count() << " ms";
+			std::cout << ".\n";
+
+			std::this_thread::sleep_for(backoff);
+			*worker = fork_worker();
+			forked[pos] = std::chrono::steady_clock::now();
+
+		}
+
+	} catch(...) {
+
+		stop_workers(pids);
+		throw;
+
+	}
+
+	stop_workers(pids);
+
+}
+
+/** a worker serves requests until quit, exiting without the server's destructor, which would remove the socket */
+pid_t srcuml_server::fork_worker() {
+
+	std::cout.flush();
+
+	const pid_t pid = fork();
+	if(pid < 0)
+		throw std::string("Error: Unable to fork a server worker");
+
+	if(pid == 0) {
+
+		int status = 0;
+		try {
+			serve_requests();
+		} catch(...) {
+			status = 1;
+		}
+
+		std::cout.flush();
+		_exit(status);
+
+	}
+
+	return pid;
+
+}
+
+void srcuml_server::stop_workers(const std::vector<pid_t> & pids) {
+
+	for(pid_t pid : pids)
+		kill(pid, SIGTERM);
+
+	for(pid_t pid : pids)
+		waitpid(pid, nullptr, 0);
+
+}
+
+/** returns false on a quit request */
+bool srcuml_server::serve(int connection_fd) {
+
+	std::string request;
+	char buffer[4096];
+	ssize_t count;
+	while(request.find('\n') == std::string::npos && (count = recv(connection_fd, buffer, sizeof(buffer), 0)) > 0)
+		request.append(buffer, count);
+
+	request = request.substr(0, request.find('\n'));
+	srcuml::trim(request);
+	if(request == "quit")
+		return false;
+
+	std::istringstream request_stream(request);
+	std::string type;
+	request_stream >> type;
+
+	std::vector<std::string> input_files;
+	std::string input_file;
+	while(request_stream >> input_file)
+		input_files.push_back(input_file);
+
+	std::string response;
+	if(request == "metrics")
+		response = write_metrics(false);
+	else if(type == "GET" && !input_files.empty() && input_files.front() == "/metrics")
+		response = write_metrics(true);
+	else if(input_files.empty() && (!has_model || type.empty()))
+		response = "Error: Require an output type and an input file.\n";
+	else
+		response = render(type, input_files);
+
+	std::size_t sent = 0;
+	while(sent < response.size()) {
+
+		ssize_t result = send(connection_fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+		if(result <= 0)
+			break;
+
+		sent += result;
+
+	}
+
+	return true;
+
+}
+
+std::string srcuml_server::render(const std::string & type, const std::vector<std::string> & input_files) {
+
+	// the names of the request are dropped with its classes, those of the model stay
+	srcuml_symbol_scope symbols;
+
+	srcuml_options request_options = options;
+	request_options.type = type;
+
+	// each request is timed on its own for the metrics
+	srcuml_stats request_stats;
+	request_options.stats = &request_stats;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::ostringstream out;
+	std::string error;
+
+	try {
+
+		if(input_files.empty()) {
+			// the handler copies the list of classes, so what a request drops is not dropped from the model
+			srcuml_handler handler(model, out, request_options);
+		} else if(srcuml_source::is_srcml_file(input_files)) {
+			srcuml_handler handler(input_files.front().c_str(), out, request_options);
+		} else {
+			srcuml_handler handler(input_files, out, request_options);
+		}
+
+	} catch(const std::string & thrown) {
+		error = thrown + "\n";
+	} catch(const std::exception & thrown) {
+		error = std::string("Error: ") + thrown.what() + "\n";
+	}
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	metrics.record(type, request_stats, elapsed.count(), !error.empty());
+
+	if(options.stats) {
+
+		for(const std::pair<std::string, double> & time : request_stats.get_times())
+			options.stats->add_time(time.first, time.second);
+		for(const std::pair<std::string, std::uint64_t> & count : request_stats.get_counts())
+			options.stats->add_count(count.first, count.second);
+
+	}
+
+	return error.empty() ? out.str() : error;
+
+}
+
+std::string srcuml_server::write_metrics(bool is_http) {
+
+	metrics.set_gauge("unit_cache_entries", cache.size());
+	metrics.set_gauge("unit_cache_bytes", cache.get_bytes());
+
+	std::ostringstream body;
+	metrics.write_openmetrics(body);
+	if(!is_http)
+		return body.str();
+
+	const std::string & text = body.str();
+	return std::string("HTTP/1.0 200 OK\r\nContent-Type: ") + srcuml_metrics::content_type()
+		+ "\r\nContent-Length: " + std::to_string(text.size()) + "\r\n\r\n" + text;
+
+}
@@ -0,0 +1,101 @@
+/**
+ * @file srcuml_server.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SERVER_HPP
+#define INCLUDED_SRCUML_SERVER_HPP
+
+#include <srcuml_options.hpp>
+#include <srcuml_cache.hpp>
+#include <srcuml_metrics.hpp>
+#include <srcuml_model.hpp>
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * srcuml_server
+ *
+ * Renders diagrams on request over a Unix domain socket, keeping the unit
+ * cache warm between requests.
+ *
+ * A request is one line: the output types followed by the input paths,
+ * separated by spaces.  The response is the rendered output, or a line
+ * starting with "Error:", and the connection is closed.  The request
+ * "quit" stops the server.
+ *
+ * The request "metrics" answers the metrics of the requests served so far in
+ * the OpenMetrics text format, see srcuml_metrics.  So does an HTTP request
+ * line "GET /metrics", with an HTTP response, for a Prometheus scrape through
+ * a proxy of the socket.
+ *
+ * With a model loaded, a request of only the output types renders the model.
+ * The requests may be served by worker processes forked once the model is
+ * loaded, each accepting on the socket, so the model is read from memory
+ * shared copy-on-write instead of loaded by every worker.  The metrics are
+ * then those of the worker serving the request.  A worker that dies is
+ * forked again, and the server stops once a worker serves quit.
+ */
+class srcuml_server {
+
+private:
+
+	std::string socket_path;
+	srcuml_options options;
+	srcuml_cache cache;
+	srcuml_metrics metrics;
+
+	srcuml_model model;
+	bool has_model;
+
+	std::size_t workers;
+	int listen_fd;
+
+public:
+
+	/** workers is the number of worker processes, 0 serves the requests in this process */
+	srcuml_server(const std::string & socket_path, const srcuml_options & options, std::size_t workers = 0);
+	~srcuml_server();
+
+	srcuml_server(const srcuml_server &) = delete;
+	srcuml_server & operator=(const srcuml_server &) = delete;
+
+	/** the analyzed model rendered by requests without inputs, before run so the workers share it */
+	void load_model(const std::string & filename);
+
+	/** serves requests one at a time, in each worker, until quit */
+	void run();
+
+private:
+
+	void serve_requests();
+	void run_workers();
+	pid_t fork_worker();
+	void stop_workers(const std::vector<pid_t> & pids);
+
+	bool serve(int connection_fd);
+	std::string write_metrics(bool is_http);
+	std::string render(const std::string & type, const std::vector<std::string> & input_files);
+
+};
+
+#endif
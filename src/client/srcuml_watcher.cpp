@@ -0,0 +1,171 @@
+/**
+ * @file srcuml_watcher.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "srcuml_watcher.hpp"
+
+#include <srcuml_handler.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+srcuml_watcher::srcuml_watcher(const std::vector<std::string> & input_files, const std::vector<std::string> & output_files,
+							   const std::vector<output_compression> & compressions, const srcuml_options & options)
+	: input_files(input_files), output_files(output_files), compressions(compressions), options(options),
+	  cache(options.cache_directory, options.profile, options.stereotypes, options.cache_memory), graph(), renderings(output_files.size()), inotify_fd(-1) {
+
+	this->options.cache = &cache;
+	this->options.graph = &graph;
+	this->options.outputs.clear();
+
+	inotify_fd = inotify_init1(IN_CLOEXEC);
+	if(inotify_fd < 0)
+		throw std::string("Error: Unable to watch for changes");
+
+}
+
+srcuml_watcher::~srcuml_watcher() {
+
+	if(inotify_fd >= 0)
+		close(inotify_fd);
+
+}
+
+void srcuml_watcher::run() {
+
+	while(true) {
+
+		add_watches();
+
+		try {
+			render();
+		} catch(const std::string & error) {
+			std::cout << error << std::endl;
+		}
+
+		wait_for_change();
+
+	}
+
+}
+
+void srcuml_watcher::render() {
+
+	std::vector<std::unique_ptr<std::ostringstream>> streams;
+	for(std::size_t pos = 0; pos < output_files.size(); ++pos) {
+
+		streams.emplace_back(new std::ostringstream());
+		if(output_files.size() > 1)
+			options.outputs.push_back(streams.back().get());
+
+	}
+
+	std::ostream & out = output_files.empty() ? std::cout : *streams.front();
+
+	try {
+
+		if(srcuml_source::is_srcml_file(input_files)) {
+			srcuml_handler handler(input_files.front().c_str(), out, options);
+		} else {
+			srcuml_handler handler(input_files, out, options);
+		}
+
+	} catch(...) {
+
+		options.outputs.clear();
+		throw;
+
+	}
+
+	options.outputs.clear();
+
+	const srcuml_relationship_delta & delta = graph.get_delta();
+	if(!delta.added.empty() || !delta.removed.empty())
+		std::cout << delta.added.size() << " relationships added, " << delta.removed.size() << " removed.\n";
+
+	for(std::size_t pos = 0; pos < output_files.size(); ++pos) {
+
+		std::string rendering = streams[pos]->str();
+		if(rendering == renderings[pos])
+			continue;
+
+		std::unique_ptr<std::ostream> output(open_output(output_files[pos], compressions[pos]));
+		*output << rendering;
+		renderings[pos] = std::move(rendering);
+
+		std::cout << "Updated " << output_files[pos] << ".\n";
+
+	}
+
+}
+
+/** directories are watched recursively, a srcML file through its directory so renames are seen */
+void srcuml_watcher::add_watches() {
+
+	const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+	for(const std::string & input_file : input_files) {
+
+		boost::filesystem::path path(input_file);
+		if(!boost::filesystem::is_directory(path)) {
+
+			boost::filesystem::path parent = path.parent_path();
+			inotify_add_watch(inotify_fd, parent.empty() ? "." : parent.string().c_str(), mask);
+			continue;
+
+		}
+
+		// adding an existing watch again only updates its mask
+		inotify_add_watch(inotify_fd, path.string().c_str(), mask);
+		for(boost::filesystem::recursive_directory_iterator itr(path), end; itr != end; ++itr) {
+
+			if(boost::filesystem::is_directory(itr->status()))
+				inotify_add_watch(inotify_fd, itr->path().string().c_str(), mask);
+
+		}
+
+	}
+
+}
+
+/** blocks until a change, then waits for the burst of events an editor save produces to settle */
+void srcuml_watcher::wait_for_change() {
+
+	char buffer[4096];
+
+	pollfd watch = { inotify_fd, POLLIN, 0 };
+	poll(&watch, 1, -1);
+
+	do {
+
+		if(read(inotify_fd, buffer, sizeof(buffer)) < 0)
+			break;
+
+	} while(poll(&watch, 1, 200) > 0);
+
+}
@@ -0,0 +1,77 @@
+/**
+ * @file srcuml_watcher.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_WATCHER_HPP
+#define INCLUDED_SRCUML_WATCHER_HPP
+
+#include <srcuml_options.hpp>
+#include <srcuml_cache.hpp>
+#include <srcuml_relationship_graph.hpp>
+#include <srcuml_output.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * srcuml_watcher
+ *
+ * Regenerates the diagrams whenever an input changes.  Unchanged units are
+ * loaded from an in-memory cache, only the relationships of changed classes
+ * are regenerated and output files are only rewritten when their rendering
+ * changed.
+ */
+class srcuml_watcher {
+
+private:
+
+	std::vector<std::string> input_files;
+	std::vector<std::string> output_files;
+	std::vector<output_compression> compressions;
+	srcuml_options options;
+	srcuml_cache cache;
+	srcuml_relationship_graph graph;
+
+	std::vector<std::string> renderings;
+
+	int inotify_fd;
+
+public:
+
+	/** no output files writes every rendering to std::cout, compressions are by output file */
+	srcuml_watcher(const std::vector<std::string> & input_files, const std::vector<std::string> & output_files,
+				   const std::vector<output_compression> & compressions, const srcuml_options & options);
+	~srcuml_watcher();
+
+	srcuml_watcher(const srcuml_watcher &) = delete;
+	srcuml_watcher & operator=(const srcuml_watcher &) = delete;
+
+	/** renders, then re-renders after every change, does not return */
+	void run();
+
+private:
+
+	void render();
+	void add_watches();
+	void wait_for_change();
+
+};
+
+#endif
@@ -22,108 +22,63 @@
 #ifndef INCLUDED_DOT_OUTPUTTER_HPP
 #define INCLUDED_DOT_OUTPUTTER_HPP
 
-#include <srcuml_outputter.hpp>
+#include <srcuml_text_outputter.hpp>
 
-class dot_outputter : srcuml_outputter {
+class dot_outputter : public srcuml_text_outputter {
+
+private:
+
+	// node of each class symbol, the first class with the name keeps it
+	std::unordered_map<srcuml_symbol, std::string> class_number_map;
+
+	// name each class was written with, by class number
+	std::vector<std::string> written_names;
 
 public:
 
 	dot_outputter(){};
 
-	bool output(std::ostream & out, std::vector<std::shared_ptr<srcuml_class>> & classes){
-
-		srcuml_relationships relationships = analyze_relationships(classes);
+	void write_header(srcuml_text_sink & out){
 
 		out << "digraph hierarchy {\n";//size=\"5, 5\"\n";
         out << "node[shape=record,style=filled,fillcolor=gray95]\n";
         out << "edge[dir=\"both\", arrowtail=\"empty\", arrowhead=\"empty\", labeldistance=\"2.0\"]\n";
 
-        std::map<std::string, std::string> class_number_map;
-
-        int class_num = 0;
-        std::string class_word = "class";
+	}
 
-        //Classes
+	void write_class(srcuml_text_sink & out, const srcuml_class & aclass){
 
-        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+        std::string class_wn = "class" + std::to_string(written_names.size());
 
-            std::string class_wn = class_word + std::to_string(class_num);
+        class_number_map.insert(std::pair<srcuml_symbol, std::string>(aclass.get_name_symbol(), class_wn));
+        written_names.push_back(aclass.get_srcuml_name());
 
-        	class_number_map.insert(std::pair<std::string, std::string>(aclass->get_srcuml_name(), class_wn));
+        write_node(out, aclass, class_wn);
 
-    		out << class_wn << "[label = \"{ ";
-    		out << aclass->get_srcuml_name();
-    		if(aclass->get_has_field() || aclass->get_has_method())//private members
-            	out << '|';
+	}
 
-        	for(const srcuml_attribute & attribute : aclass->get_attributes()) {//private members
-            	if(attribute.get_is_static()) {
-                	static_outputter::output(out, attribute);
-            	} else {
-                	out << attribute;
-            	}
-            	out << "\\n";
-        	}
+	void write_relationships(srcuml_text_sink & out, const std::vector<std::shared_ptr<srcuml_class>> & classes,
+							 const srcuml_relationships & relationships){
 
-        	if(aclass->get_has_method())//private members
-            	out << '|';
+        // classes written before the analysis found them to be interfaces or abstract are labeled again
+        for(std::size_t class_num = 0; class_num < classes.size() && class_num < written_names.size(); ++class_num) {
 
-        	for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
-            	for(const FunctionPolicy::FunctionData * function : aclass->get_data().methods[access]) { //private members
-                	srcuml_operation op(function, (ClassPolicy::AccessSpecifier)access);
-                	if(op.get_stereotypes().count("set") > 0){continue;}
-                	if(op.get_stereotypes().count("get") > 0){continue;}
-                	if(function->isStatic) {
-                    	static_outputter::output(out, op);
-                	} else {
-                    	out << op;
-                	}
-                	out << "\\n";
-            	}
-        	}
+            const srcuml_class & aclass = *classes[class_num];
+            if(aclass.get_srcuml_name() != written_names[class_num])
+                write_node(out, aclass, "class" + std::to_string(class_num));
 
-        	out << "}\"]\n";
-            class_num++;
         }
 
         //Relations
 
-        for(const srcuml_relationship relationship : relationships.get_relationships()) {
+        for(const srcuml_relationship & relationship : relationships.get_relationships()) {
             
-        	const std::map<std::string, std::string>::const_iterator current_class = class_number_map.find(relationship.get_source());
+        	const std::unordered_map<srcuml_symbol, std::string>::const_iterator current_class = class_number_map.find(relationship.get_source_symbol());
         	out << current_class->second << "->";
-        	const std::map<std::string, std::string>::const_iterator second_class = class_number_map.find(relationship.get_destination());
+        	const std::unordered_map<srcuml_symbol, std::string>::const_iterator second_class = class_number_map.find(relationship.get_destination_symbol());
         	out << second_class->second;
 
-        	switch(relationship.type) {
-
-            	case DEPENDENCY: {
-                	out << "[arrowhead=\"vee\", arrowtail=\"none\", style=\"dashed\"]\n";
-                	break;
-            	}
-            	case ASSOCIATION:
-            	case BIDIRECTIONAL: {
-                	out << "[arrowhead=\"none\"]\n"; //currently same as generalization
-                	break;
-	            }
-    	        case AGGREGATION: {
-        	        out << "[arrowhead=\"none\", arrowtail=\"odiamond\"]\n";
-            	    break;
-            	}
-            	case COMPOSITION: {
-                	out << "[arrowhead=\"vee\", arrowtail=\"diamond\"]\n";
-                	break;
-            	}
-            	case GENERALIZATION: {
-                	out << "[arrowhead=\"none\"]\n";
-                	break;
-            	}
-            	case REALIZATION: {
-                	out << "[arrowhead=\"none\", style=\"dashed\"]\n";
-                	break;
-            	}
-
-        	}
+        	out << edge_attributes(relationship.type) << '\n';
 
         }
 
@@ -131,6 +86,65 @@ public:
 
 	}
 
+	/** DOT attributes of the edge of a relationship of type */
+	static const char * edge_attributes(relationship_type type){
+
+		switch(type) {
+
+			case DEPENDENCY:
+				return "[arrowhead=\"vee\", arrowtail=\"none\", style=\"dashed\"]";
+			case ASSOCIATION:
+			case BIDIRECTIONAL:
+				return "[arrowhead=\"none\"]"; //currently same as generalization
+			case AGGREGATION:
+				return "[arrowhead=\"none\", arrowtail=\"odiamond\"]";
+			case COMPOSITION:
+				return "[arrowhead=\"vee\", arrowtail=\"diamond\"]";
+			case GENERALIZATION:
+				return "[arrowhead=\"none\"]";
+			case REALIZATION:
+				return "[arrowhead=\"none\", style=\"dashed\"]";
+			default:
+				return "";
+
+		}
+
+	}
+
+private:
+
+	static void write_node(srcuml_text_sink & out, const srcuml_class & aclass, const std::string & class_wn){
+
+    	out << class_wn << "[label = \"{ ";
+    	out << aclass.get_srcuml_name();
+    	if(aclass.get_has_field() || aclass.get_has_method())//private members
+            out << '|';
+
+        for(const srcuml_member_label & attribute : aclass.get_attribute_labels()) {//private members
+            if(attribute.is_static) {
+                static_outputter::output(out, attribute.text);
+            } else {
+                out << attribute.text;
+            }
+            out << "\\n";
+        }
+
+        if(aclass.get_has_method())//private members
+            out << '|';
+
+        for(const srcuml_member_label & op : aclass.get_operation_labels()) { //private members
+            if(op.is_static) {
+                static_outputter::output(out, op.text);
+            } else {
+                out << op.text;
+            }
+            out << "\\n";
+        }
+
+        out << "}\"]\n";
+
+	}
+
 };
 
-#endif
\ No newline at end of file
+#endif
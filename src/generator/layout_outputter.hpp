@@ -0,0 +1,158 @@
+#ifndef INCLUDED_LAYOUT_OUTPUTTER_HPP
+#define INCLUDED_LAYOUT_OUTPUTTER_HPP
+
+#include <svg_sugiyama_outputter.hpp>
+#include <srcuml_serialize.hpp>
+#include <srcuml_utilities.hpp>
+
+/** encoding of the coordinates written by layout_outputter */
+enum layout_format { JSON_LAYOUT, BINARY_LAYOUT };
+
+/**
+ * layout_outputter
+ *
+ * Lays out the classes as svg_sugiyama does, but writes the coordinates for
+ * a renderer of its own instead of drawing them.  Nodes are given by id,
+ * class name, center, width and height; edges by source and target id,
+ * relationship kind and bend points.
+ *
+ * JSON, without whitespace:
+ *
+ *   {"bounds":[x,y,width,height],
+ *    "nodes":[{"id":0,"name":"A","x":10,"y":20,"width":30,"height":40},...],
+ *    "edges":[{"source":0,"target":1,"kind":"generalization","bends":[[x,y],...]},...]}
+ *
+ * Binary, sizes and doubles as in srcuml_serialize:
+ *
+ *   "SRCUMLLAYOUT" VERSION x y width height
+ *   node count, of each node: id name x y width height
+ *   edge count, of each edge: source target kind bend count, bend x y, ...
+ */
+class layout_outputter : public svg_sugiyama_outputter {
+
+public:
+
+	enum : std::size_t { VERSION = 1 };
+
+	/** the other parameters as for svg_sugiyama_outputter */
+	layout_outputter(layout_format format, std::size_t layout_budget = 0, bool layout_components = false, std::size_t threads = 1,
+					 const std::string & layout_cache = "", std::size_t crossmin_runs = 1)
+		: svg_sugiyama_outputter(layout_budget, layout_components, threads, layout_cache, crossmin_runs), format(format) {}
+
+	static const char * kind_name(relationship_type type) {
+
+		switch(type) {
+
+			case DEPENDENCY:     return "dependency";
+			case ASSOCIATION:    return "association";
+			case BIDIRECTIONAL:  return "bidirectional";
+			case AGGREGATION:    return "aggregation";
+			case COMPOSITION:    return "composition";
+			case GENERALIZATION: return "generalization";
+			case REALIZATION:    return "realization";
+			default:             return "none";
+
+		}
+
+	}
+
+protected:
+
+	void draw(std::ostream &out, const svg_arrows &, const std::vector<svg_label> &, const std::string &){
+
+		if(format == BINARY_LAYOUT)
+			write_binary(out);
+		else
+			write_json(out);
+
+	}
+
+private:
+
+	layout_format format;
+
+	void write_json(std::ostream &out){
+
+		const DRect box = ga.boundingBox();
+		out << "{\"bounds\":[" << srcuml::json_number(box.p1().m_x) << ',' << srcuml::json_number(box.p1().m_y)
+			<< ',' << srcuml::json_number(box.width()) << ',' << srcuml::json_number(box.height()) << "],\"nodes\":[";
+
+		bool is_first = true;
+		for(node v : g.nodes){
+
+			out << (is_first ? "" : ",")
+				<< "{\"id\":" << v->index() << ",\"name\":\"" << srcuml::json_escape(ga.label(v))
+				<< "\",\"x\":" << srcuml::json_number(ga.x(v)) << ",\"y\":" << srcuml::json_number(ga.y(v))
+				<< ",\"width\":" << srcuml::json_number(ga.width(v)) << ",\"height\":" << srcuml::json_number(ga.height(v)) << '}';
+			is_first = false;
+
+		}
+
+		out << "],\"edges\":[";
+
+		is_first = true;
+		for(edge e : g.edges){
+
+			out << (is_first ? "" : ",")
+				<< "{\"source\":" << e->source()->index() << ",\"target\":" << e->target()->index()
+				<< ",\"kind\":\"" << kind_name(relationship_types[e]) << "\",\"bends\":[";
+
+			bool is_first_bend = true;
+			for(const DPoint & bend : ga.bends(e)){
+				out << (is_first_bend ? "[" : ",[") << srcuml::json_number(bend.m_x) << ',' << srcuml::json_number(bend.m_y) << ']';
+				is_first_bend = false;
+			}
+
+			out << "]}";
+			is_first = false;
+
+		}
+
+		out << "]}\n";
+
+	}
+
+	void write_binary(std::ostream &out){
+
+		out.write("SRCUMLLAYOUT", 12);
+		srcuml::write_size(out, VERSION);
+
+		const DRect box = ga.boundingBox();
+		srcuml::write_double(out, box.p1().m_x);
+		srcuml::write_double(out, box.p1().m_y);
+		srcuml::write_double(out, box.width());
+		srcuml::write_double(out, box.height());
+
+		srcuml::write_size(out, g.numberOfNodes());
+		for(node v : g.nodes){
+
+			srcuml::write_size(out, v->index());
+			srcuml::write_string(out, ga.label(v));
+			srcuml::write_double(out, ga.x(v));
+			srcuml::write_double(out, ga.y(v));
+			srcuml::write_double(out, ga.width(v));
+			srcuml::write_double(out, ga.height(v));
+
+		}
+
+		srcuml::write_size(out, g.numberOfEdges());
+		for(edge e : g.edges){
+
+			srcuml::write_size(out, e->source()->index());
+			srcuml::write_size(out, e->target()->index());
+			srcuml::write_size(out, relationship_types[e]);
+
+			const DPolyline & bends = ga.bends(e);
+			srcuml::write_size(out, bends.size());
+			for(const DPoint & bend : bends){
+				srcuml::write_double(out, bend.m_x);
+				srcuml::write_double(out, bend.m_y);
+			}
+
+		}
+
+	}
+
+};
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file srcuml_adjacency.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_ADJACENCY_HPP
+#define INCLUDED_SRCUML_ADJACENCY_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_symbol.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <numeric>
+#include <cstdint>
+
+/**
+ * srcuml_adjacency
+ *
+ * Neighbors of each class through the relationships, built once after the
+ * analysis and only read afterwards, so it is shared by the graph algorithms
+ * (focus, queries and ranking) and their threads.  Classes sharing a name are
+ * one vertex, numbered in the order of the classes.  Outgoing and incoming
+ * arcs are kept in compressed rows, one row per vertex and relationship type,
+ * in the order of the relationships, so the arcs of a vertex of any or of
+ * one type are a single contiguous range.  Relationships to a name that is
+ * not a class have no arcs.
+ */
+class srcuml_adjacency {
+
+public:
+
+    enum : std::size_t { NUMBER_TYPES = NONE_TYPE };
+
+    /** the neighbor and the position of the relationship in the relationships indexed */
+    struct arc {
+
+        std::uint32_t vertex;
+        std::uint32_t relationship;
+
+    };
+
+    /** arcs of a row, or of consecutive rows */
+    class arcs {
+
+    private:
+
+        const arc * first;
+        const arc * last;
+
+    public:
+
+        arcs(const arc * first, const arc * last) : first(first), last(last) {}
+
+        const arc * begin() const { return first; }
+        const arc * end() const { return last; }
+        std::size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+
+    };
+
+private:
+
+    std::unordered_map<srcuml_symbol, std::size_t> positions;
+    std::vector<srcuml_symbol> symbols;
+
+    // the arcs of row vertex * NUMBER_TYPES + type start at starts[row]
+    std::vector<std::size_t> out_starts;
+    std::vector<arc> out_arcs;
+    std::vector<std::size_t> in_starts;
+    std::vector<arc> in_arcs;
+
+    static std::size_t row(std::size_t vertex, relationship_type type) {
+        return vertex * NUMBER_TYPES + type;
+    }
+
+public:
+
+    srcuml_adjacency() : positions(), symbols(), out_starts(1, 0), out_arcs(), in_starts(1, 0), in_arcs() {}
+
+    srcuml_adjacency(const std::vector<std::shared_ptr<srcuml_class>> & classes, const std::vector<srcuml_relationship> & relationships)
+        : positions(), symbols(), out_starts(), out_arcs(), in_starts(), in_arcs() {
+
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(positions.emplace(aclass->get_name_symbol(), symbols.size()).second)
+                symbols.push_back(aclass->get_name_symbol());
+
+        // vertices of each relationship, size() for a name that is not a class
+        std::vector<std::pair<std::size_t, std::size_t>> ends;
+        ends.reserve(relationships.size());
+
+        // counted, then filled in the order of the relationships
+        out_starts.assign(symbols.size() * NUMBER_TYPES + 1, 0);
+        in_starts.assign(symbols.size() * NUMBER_TYPES + 1, 0);
+        for(const srcuml_relationship & relationship : relationships) {
+
+            ends.emplace_back(vertex(relationship.get_source_symbol()), vertex(relationship.get_destination_symbol()));
+            if(ends.back().first == size() || ends.back().second == size() || relationship.get_type() >= NONE_TYPE)
+                continue;
+
+            ++out_starts[row(ends.back().first, relationship.get_type()) + 1];
+            ++in_starts[row(ends.back().second, relationship.get_type()) + 1];
+
+        }
+
+        std::partial_sum(out_starts.begin(), out_starts.end(), out_starts.begin());
+        std::partial_sum(in_starts.begin(), in_starts.end(), in_starts.begin());
+
+        out_arcs.resize(out_starts.back());
+        in_arcs.resize(in_starts.back());
+        std::vector<std::size_t> out_next(out_starts.begin(), out_starts.end() - 1);
+        std::vector<std::size_t> in_next(in_starts.begin(), in_starts.end() - 1);
+        for(std::size_t pos = 0; pos < relationships.size(); ++pos) {
+
+            const std::size_t source = ends[pos].first, destination = ends[pos].second;
+            const relationship_type type = relationships[pos].get_type();
+            if(source == size() || destination == size() || type >= NONE_TYPE)
+                continue;
+
+            out_arcs[out_next[row(source, type)]++] = arc{ std::uint32_t(destination), std::uint32_t(pos) };
+            in_arcs[in_next[row(destination, type)]++] = arc{ std::uint32_t(source), std::uint32_t(pos) };
+
+        }
+
+    }
+
+    /** number of vertices */
+    std::size_t size() const {
+        return symbols.size();
+    }
+
+    /** the vertex of a class name, size() if it is not a class */
+    std::size_t vertex(srcuml_symbol symbol) const {
+
+        std::unordered_map<srcuml_symbol, std::size_t>::const_iterator itr = positions.find(symbol);
+        return itr == positions.end() ? size() : itr->second;
+
+    }
+
+    srcuml_symbol symbol(std::size_t vertex) const {
+        return symbols[vertex];
+    }
+
+    /** relationships from the vertex, of every type */
+    arcs outgoing(std::size_t vertex) const {
+        return arcs(out_arcs.data() + out_starts[vertex * NUMBER_TYPES], out_arcs.data() + out_starts[(vertex + 1) * NUMBER_TYPES]);
+    }
+
+    arcs outgoing(std::size_t vertex, relationship_type type) const {
+        return arcs(out_arcs.data() + out_starts[row(vertex, type)], out_arcs.data() + out_starts[row(vertex, type) + 1]);
+    }
+
+    /** relationships to the vertex, of every type */
+    arcs incoming(std::size_t vertex) const {
+        return arcs(in_arcs.data() + in_starts[vertex * NUMBER_TYPES], in_arcs.data() + in_starts[(vertex + 1) * NUMBER_TYPES]);
+    }
+
+    arcs incoming(std::size_t vertex, relationship_type type) const {
+        return arcs(in_arcs.data() + in_starts[row(vertex, type)], in_arcs.data() + in_starts[row(vertex, type) + 1]);
+    }
+
+};
+
+#endif
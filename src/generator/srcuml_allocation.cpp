@@ -0,0 +1,247 @@
+/**
+ * @file srcuml_allocation.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <srcuml_allocation.hpp>
+
+#ifdef SRCUML_ALLOCATION_STATS
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+
+/*
+ * Every block is prefixed by a header recording its size and the phase it was
+ * allocated in, so freeing it is taken off the live bytes of that phase.
+ * Nothing here may allocate with operator new.
+ */
+namespace {
+
+enum : std::size_t { MAX_PHASES = 64, MAX_PHASE_NAME = 48 };
+
+struct phase_slot {
+
+    char name[MAX_PHASE_NAME];
+
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> bytes;
+    std::atomic<std::uint64_t> peak_live_bytes;
+    std::atomic<std::int64_t> live_bytes;
+
+};
+
+// zero initialized before any dynamic initialization, so usable by the first allocation
+phase_slot slots[MAX_PHASES];
+std::atomic<std::size_t> number_slots{ 1 };
+std::atomic<std::int64_t> total_live_bytes{ 0 };
+
+std::mutex slot_mutex;
+
+thread_local int current_phase = 0;
+
+union block_header {
+
+    struct {
+        std::size_t size;
+        int phase;
+    } block;
+
+    std::max_align_t alignment;
+
+};
+
+void * allocate(std::size_t size) noexcept {
+
+    block_header * header = static_cast<block_header *>(std::malloc(sizeof(block_header) + size));
+    if(!header)
+        return nullptr;
+
+    const int phase = current_phase;
+    header->block.size = size;
+    header->block.phase = phase;
+
+    phase_slot & slot = slots[phase];
+    slot.allocations.fetch_add(1, std::memory_order_relaxed);
+    slot.bytes.fetch_add(size, std::memory_order_relaxed);
+    slot.live_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    const std::int64_t live = total_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::uint64_t peak = slot.peak_live_bytes.load(std::memory_order_relaxed);
+    while(live > 0 && static_cast<std::uint64_t>(live) > peak
+          && !slot.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        ;
+
+    return header + 1;
+
+}
+
+void deallocate(void * pointer) noexcept {
+
+    if(!pointer)
+        return;
+
+    block_header * header = static_cast<block_header *>(pointer) - 1;
+    slots[header->block.phase].live_bytes.fetch_sub(header->block.size, std::memory_order_relaxed);
+    total_live_bytes.fetch_sub(header->block.size, std::memory_order_relaxed);
+
+    std::free(header);
+
+}
+
+void * allocate_or_throw(std::size_t size) {
+
+    if(size == 0)
+        size = 1;
+
+    while(true) {
+
+        if(void * pointer = allocate(size))
+            return pointer;
+
+        std::new_handler handler = std::get_new_handler();
+        if(!handler)
+            throw std::bad_alloc();
+        handler();
+
+    }
+
+}
+
+}
+
+int srcuml_allocation::get_phase() {
+
+    return current_phase;
+
+}
+
+void srcuml_allocation::set_phase(int phase) {
+
+    current_phase = phase;
+
+}
+
+int srcuml_allocation::find_phase(const char * phase) {
+
+    std::lock_guard<std::mutex> lock(slot_mutex);
+
+    const std::size_t size = number_slots.load(std::memory_order_relaxed);
+    for(std::size_t pos = 1; pos < size; ++pos)
+        if(std::strncmp(slots[pos].name, phase, MAX_PHASE_NAME - 1) == 0)
+            return pos;
+
+    if(size == MAX_PHASES)
+        return 0;
+
+    std::strncpy(slots[size].name, phase, MAX_PHASE_NAME - 1);
+    number_slots.store(size + 1, std::memory_order_relaxed);
+
+    return size;
+
+}
+
+std::vector<srcuml_allocation::phase_counts> srcuml_allocation::get_counts() {
+
+    const std::size_t size = number_slots.load(std::memory_order_relaxed);
+
+    std::vector<phase_counts> counts;
+    for(std::size_t pos = 0; pos < size; ++pos) {
+
+        const phase_slot & slot = slots[pos];
+        if(slot.allocations.load(std::memory_order_relaxed) == 0)
+            continue;
+
+        const std::int64_t live = slot.live_bytes.load(std::memory_order_relaxed);
+        counts.push_back(phase_counts{ pos ? slot.name : "other",
+                                       slot.allocations.load(std::memory_order_relaxed),
+                                       slot.bytes.load(std::memory_order_relaxed),
+                                       slot.peak_live_bytes.load(std::memory_order_relaxed),
+                                       live > 0 ? static_cast<std::uint64_t>(live) : 0 });
+
+    }
+
+    return counts;
+
+}
+
+void * operator new(std::size_t size) {
+
+    return allocate_or_throw(size);
+
+}
+
+void * operator new[](std::size_t size) {
+
+    return allocate_or_throw(size);
+
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept {
+
+    return allocate(size ? size : 1);
+
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+
+    return allocate(size ? size : 1);
+
+}
+
+void operator delete(void * pointer) noexcept {
+
+    deallocate(pointer);
+
+}
+
+void operator delete[](void * pointer) noexcept {
+
+    deallocate(pointer);
+
+}
+
+void operator delete(void * pointer, std::size_t) noexcept {
+
+    deallocate(pointer);
+
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept {
+
+    deallocate(pointer);
+
+}
+
+void operator delete(void * pointer, const std::nothrow_t &) noexcept {
+
+    deallocate(pointer);
+
+}
+
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept {
+
+    deallocate(pointer);
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file srcuml_allocation.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_ALLOCATION_HPP
+#define INCLUDED_SRCUML_ALLOCATION_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * srcuml_allocation
+ *
+ * Allocations of the process counted by the phase active on the allocating
+ * thread, the phases being those timed by srcuml_stats::timer.  Only built
+ * with SRCUML_ALLOCATION_STATS, which replaces the global operator new and
+ * delete, see srcuml_allocation.cpp.  Otherwise nothing is counted and the
+ * phase calls do nothing.
+ *
+ * Phase 0 is every allocation outside a timed phase.  The counts are for the
+ * whole process, across every run of a batch or server.
+ */
+class srcuml_allocation {
+
+public:
+
+    struct phase_counts {
+
+        std::string phase;
+
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        // most bytes live in the process while the phase allocated
+        std::uint64_t peak_live_bytes;
+        // bytes allocated in the phase not yet freed
+        std::uint64_t live_bytes;
+
+    };
+
+    /** makes phase the one allocations of this thread count for until a scope on it ends */
+    class phase_scope {
+
+    private:
+
+        int previous;
+
+    public:
+
+        phase_scope(int phase) : previous(get_phase()) {
+            set_phase(phase);
+        }
+
+        phase_scope(const char * phase) : phase_scope(find_phase(phase)) {}
+
+        phase_scope(const phase_scope &) = delete;
+        phase_scope & operator=(const phase_scope &) = delete;
+
+        ~phase_scope() {
+            set_phase(previous);
+        }
+
+    };
+
+#ifdef SRCUML_ALLOCATION_STATS
+
+    static bool is_enabled() { return true; }
+
+    /** phase of the allocations of this thread, pass to phase_scope on worker threads */
+    static int get_phase();
+    static void set_phase(int phase);
+
+    /** registers the phase on first use, 0 once there are too many phases */
+    static int find_phase(const char * phase);
+
+    /** phases that allocated, in the order first registered */
+    static std::vector<phase_counts> get_counts();
+
+#else
+
+    static bool is_enabled() { return false; }
+
+    static int get_phase() { return 0; }
+    static void set_phase(int) {}
+
+    static int find_phase(const char *) { return 0; }
+
+    static std::vector<phase_counts> get_counts() { return std::vector<phase_counts>(); }
+
+#endif
+
+};
+
+#endif
@@ -0,0 +1,352 @@
+/**
+ * @file srcuml_archive.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_ARCHIVE_HPP
+#define INCLUDED_SRCUML_ARCHIVE_HPP
+
+#include <srcuml_output.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <ostream>
+#include <fstream>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <zlib.h>
+
+/**
+ * srcuml_archive
+ *
+ * Many outputs written one after another into a single file, so a run with
+ * thousands of diagrams creates one file instead of thousands.  The format is
+ * chosen by the extension: a ustar archive for .tar, gzipped as a whole for
+ * .tar.gz and .tgz, or a zip archive of deflated entries for .zip.  Entries are
+ * added whole, as both formats want the size before the data, and the archive
+ * is written sequentially, so it may be a pipe.  Not thread safe, see
+ * srcuml_async_writer::use_archive.
+ */
+class srcuml_archive {
+
+public:
+
+    enum archive_format { TAR_ARCHIVE, ZIP_ARCHIVE };
+
+private:
+
+    // a zip entry, kept for the central directory
+    struct zip_entry {
+
+        std::string name;
+        std::uint32_t crc;
+        std::uint32_t compressed_size;
+        std::uint32_t size;
+        std::uint32_t offset;
+
+    };
+
+    std::string filename;
+    archive_format format;
+    std::unique_ptr<std::ostream> out;
+
+    // bytes written to out, before any compression of the whole
+    std::uint64_t offset;
+    std::vector<zip_entry> zip_entries;
+    bool is_closed;
+
+    // the time of every entry
+    std::time_t created;
+
+public:
+
+    /** throws if the extension is not an archive's or the file cannot be created */
+    srcuml_archive(const std::string & filename)
+        : filename(filename), format(TAR_ARCHIVE), out(), offset(0), zip_entries(), is_closed(false), created(std::time(nullptr)) {
+
+        if(has_extension(filename, ".zip")) {
+            format = ZIP_ARCHIVE;
+            out.reset(new std::ofstream(filename, std::ios::binary));
+        } else if(has_extension(filename, ".tar.gz") || has_extension(filename, ".tgz")) {
+            out.reset(new srcuml_compressed_stream(std::unique_ptr<std::ostream>(new std::ofstream(filename, std::ios::binary))));
+        } else if(has_extension(filename, ".tar")) {
+            out.reset(new std::ofstream(filename, std::ios::binary));
+        } else {
+            throw std::string("Error: Unknown archive ") + filename + ". Can be {.tar, .tar.gz, .tgz, .zip}";
+        }
+
+        if(!*out)
+            throw std::string("Error: Unable to create archive ") + filename;
+
+    }
+
+    ~srcuml_archive() {
+
+        try {
+            close();
+        } catch(const std::string &) {}
+
+    }
+
+    srcuml_archive(const srcuml_archive &) = delete;
+    srcuml_archive & operator=(const srcuml_archive &) = delete;
+
+    static bool is_archive(const std::string & filename) {
+
+        return has_extension(filename, ".zip") || has_extension(filename, ".tar")
+            || has_extension(filename, ".tar.gz") || has_extension(filename, ".tgz");
+
+    }
+
+    /** adds a file of the data named by its path, without a leading / or ./ */
+    void add(const std::string & path, const std::string & data) {
+
+        std::string name = path;
+        while(name.compare(0, 2, "./") == 0)
+            name.erase(0, 2);
+        while(!name.empty() && name.front() == '/')
+            name.erase(0, 1);
+
+        if(name.empty())
+            throw std::string("Error: An archive entry needs a name");
+
+        if(format == TAR_ARCHIVE)
+            add_tar(name, data);
+        else
+            add_zip(name, data);
+
+        if(!*out)
+            throw std::string("Error: Unable to write archive ") + filename;
+
+    }
+
+    /** ends the archive, throws if it could not be written */
+    void close() {
+
+        if(is_closed)
+            return;
+        is_closed = true;
+
+        if(format == TAR_ARCHIVE)
+            write_zeros(2 * BLOCK_SIZE);
+        else
+            end_zip();
+
+        if(srcuml_compressed_stream * compressed = dynamic_cast<srcuml_compressed_stream *>(out.get()))
+            compressed->close();
+        out->flush();
+
+        if(!*out)
+            throw std::string("Error: Unable to write archive ") + filename;
+
+    }
+
+private:
+
+    enum : std::size_t { BLOCK_SIZE = 512 };
+
+    static bool has_extension(const std::string & filename, const char * extension) {
+
+        const std::size_t length = std::strlen(extension);
+        return filename.size() > length && filename.compare(filename.size() - length, length, extension) == 0;
+
+    }
+
+    void write(const char * data, std::size_t size) {
+
+        out->write(data, size);
+        offset += size;
+
+    }
+
+    void write_zeros(std::size_t size) {
+
+        static const char zeros[BLOCK_SIZE] = {};
+        while(size) {
+
+            const std::size_t part = std::min<std::size_t>(size, BLOCK_SIZE);
+            write(zeros, part);
+            size -= part;
+
+        }
+
+    }
+
+    /** an octal field of a tar header, NUL terminated */
+    static void octal(char * field, std::size_t width, std::uint64_t value) {
+
+        std::snprintf(field, width, "%0*llo", static_cast<int>(width - 1), static_cast<unsigned long long>(value));
+
+    }
+
+    /** a ustar header block then the data padded to a block, a long name is split at a / into the prefix */
+    void add_tar(const std::string & name, const std::string & data) {
+
+        char header[BLOCK_SIZE] = {};
+
+        std::string prefix, base = name;
+        if(name.size() > 100) {
+
+            const std::string::size_type slash = name.rfind('/', 155);
+            if(slash == std::string::npos || name.size() - slash - 1 > 100 || slash == 0)
+                throw std::string("Error: Archive entry name too long ") + name;
+
+            prefix = name.substr(0, slash);
+            base = name.substr(slash + 1);
+
+        }
+
+        std::memcpy(header, base.data(), base.size());
+        octal(header + 100, 8, 0644);
+        octal(header + 108, 8, 0);
+        octal(header + 116, 8, 0);
+        octal(header + 124, 12, data.size());
+        octal(header + 136, 12, static_cast<std::uint64_t>(created));
+        std::memset(header + 148, ' ', 8);
+        header[156] = '0';
+        std::memcpy(header + 257, "ustar", 6);
+        std::memcpy(header + 263, "00", 2);
+        std::memcpy(header + 345, prefix.data(), prefix.size());
+
+        unsigned int checksum = 0;
+        for(char byte : header)
+            checksum += static_cast<unsigned char>(byte);
+        std::snprintf(header + 148, 8, "%06o", checksum);
+
+        write(header, BLOCK_SIZE);
+        write(data.data(), data.size());
+        write_zeros((BLOCK_SIZE - data.size() % BLOCK_SIZE) % BLOCK_SIZE);
+
+    }
+
+    static void little_endian(std::string & bytes, std::uint32_t value, std::size_t width) {
+
+        for(std::size_t pos = 0; pos < width; ++pos)
+            bytes += static_cast<char>((value >> (8 * pos)) & 0xff);
+
+    }
+
+    /** the DOS time and date of created, each 16 bits */
+    std::uint32_t dos_time() const {
+
+        std::tm local = *std::localtime(&created);
+        const std::uint32_t time = (local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2);
+        const std::uint32_t date = ((std::max(local.tm_year, 80) - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday;
+        return time | (date << 16);
+
+    }
+
+    /** a local header then the raw deflated data, zip64 is not written */
+    void add_zip(const std::string & name, const std::string & data) {
+
+        if(offset > 0xffffffffu || data.size() > 0xffffffffu || zip_entries.size() == 0xffff)
+            throw std::string("Error: Archive too large for zip ") + filename;
+
+        std::string compressed(deflateBound(nullptr, data.size()) + 64, '\0');
+        z_stream stream = z_stream();
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+        stream.avail_out = static_cast<uInt>(compressed.size());
+        const int result = deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        if(result != Z_STREAM_END)
+            throw std::string("Error: Unable to compress archive entry ") + name;
+
+        const zip_entry entry = { name, static_cast<std::uint32_t>(crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef *>(data.data()), data.size())),
+                                  static_cast<std::uint32_t>(compressed.size()), static_cast<std::uint32_t>(data.size()),
+                                  static_cast<std::uint32_t>(offset) };
+
+        std::string header;
+        little_endian(header, 0x04034b50, 4);
+        little_endian(header, 20, 2);
+        little_endian(header, 0, 2);
+        little_endian(header, Z_DEFLATED, 2);
+        little_endian(header, dos_time(), 4);
+        little_endian(header, entry.crc, 4);
+        little_endian(header, entry.compressed_size, 4);
+        little_endian(header, entry.size, 4);
+        little_endian(header, name.size(), 2);
+        little_endian(header, 0, 2);
+        header += name;
+
+        write(header.data(), header.size());
+        write(compressed.data(), compressed.size());
+        zip_entries.push_back(entry);
+
+    }
+
+    void end_zip() {
+
+        const std::uint64_t directory_offset = offset;
+        for(const zip_entry & entry : zip_entries) {
+
+            std::string header;
+            little_endian(header, 0x02014b50, 4);
+            little_endian(header, (3 << 8) | 20, 2);
+            little_endian(header, 20, 2);
+            little_endian(header, 0, 2);
+            little_endian(header, Z_DEFLATED, 2);
+            little_endian(header, dos_time(), 4);
+            little_endian(header, entry.crc, 4);
+            little_endian(header, entry.compressed_size, 4);
+            little_endian(header, entry.size, 4);
+            little_endian(header, entry.name.size(), 2);
+            little_endian(header, 0, 2);
+            little_endian(header, 0, 2);
+            little_endian(header, 0, 2);
+            little_endian(header, 0, 2);
+            // a regular file readable by all, in the high bits for unix
+            little_endian(header, 0100644u << 16, 4);
+            little_endian(header, entry.offset, 4);
+            header += entry.name;
+
+            write(header.data(), header.size());
+
+        }
+
+        if(offset > 0xffffffffu)
+            throw std::string("Error: Archive too large for zip ") + filename;
+
+        std::string end;
+        little_endian(end, 0x06054b50, 4);
+        little_endian(end, 0, 2);
+        little_endian(end, 0, 2);
+        little_endian(end, zip_entries.size(), 2);
+        little_endian(end, zip_entries.size(), 2);
+        little_endian(end, static_cast<std::uint32_t>(offset - directory_offset), 4);
+        little_endian(end, static_cast<std::uint32_t>(directory_offset), 4);
+        little_endian(end, 0, 2);
+
+        write(end.data(), end.size());
+
+    }
+
+};
+
+#endif
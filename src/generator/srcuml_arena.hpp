@@ -0,0 +1,132 @@
+/**
+ * @file srcuml_arena.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_ARENA_HPP
+#define INCLUDED_SRCUML_ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * srcuml_arena
+ *
+ * Bump allocator for the objects of one run.  Individual deallocations are
+ * ignored and every block is released at once when the arena is destroyed,
+ * so it must outlive everything allocated from it.  Not thread safe, use one
+ * per parsing thread.
+ */
+class srcuml_arena {
+
+private:
+
+    std::size_t block_size;
+    std::vector<std::unique_ptr<char[]>> blocks;
+
+    char * current;
+    std::size_t remaining;
+
+    // bytes of all blocks
+    std::size_t reserved;
+
+public:
+
+    srcuml_arena(std::size_t block_size = 1 << 16)
+        : block_size(block_size), blocks(), current(nullptr), remaining(0), reserved(0) {}
+
+    srcuml_arena(const srcuml_arena &) = delete;
+    srcuml_arena & operator=(const srcuml_arena &) = delete;
+
+    std::size_t get_reserved() const {
+        return reserved;
+    }
+
+    void * allocate(std::size_t size, std::size_t alignment) {
+
+        std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(current) % alignment) % alignment;
+        if(!current || padding + size > remaining) {
+
+            // oversized requests get a block of their own
+            std::size_t new_size = std::max(block_size, size + alignment);
+            blocks.emplace_back(new char[new_size]);
+            reserved += new_size;
+
+            current = blocks.back().get();
+            remaining = new_size;
+            padding = (alignment - reinterpret_cast<std::uintptr_t>(current) % alignment) % alignment;
+
+        }
+
+        char * allocation = current + padding;
+        current += padding + size;
+        remaining -= padding + size;
+
+        return allocation;
+
+    }
+
+};
+
+/**
+ * srcuml_arena_allocator
+ *
+ * Standard allocator drawing from a srcuml_arena, e.g. for std::allocate_shared.
+ */
+template<typename T>
+class srcuml_arena_allocator {
+
+private:
+
+    template<typename U>
+    friend class srcuml_arena_allocator;
+
+    srcuml_arena * arena;
+
+public:
+
+    typedef T value_type;
+
+    srcuml_arena_allocator(srcuml_arena & arena) : arena(&arena) {}
+
+    template<typename U>
+    srcuml_arena_allocator(const srcuml_arena_allocator<U> & allocator) : arena(allocator.arena) {}
+
+    T * allocate(std::size_t number) {
+        return static_cast<T *>(arena->allocate(number * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * pointer, std::size_t number) {}
+
+    template<typename U>
+    bool operator==(const srcuml_arena_allocator<U> & allocator) const {
+        return arena == allocator.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const srcuml_arena_allocator<U> & allocator) const {
+        return arena != allocator.arena;
+    }
+
+};
+
+#endif
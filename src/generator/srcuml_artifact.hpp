@@ -0,0 +1,262 @@
+/**
+ * @file srcuml_artifact.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_ARTIFACT_HPP
+#define INCLUDED_SRCUML_ARTIFACT_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_options.hpp>
+#include <srcuml_output.hpp>
+#include <srcuml_serialize.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+/**
+ * srcuml_artifact
+ *
+ * An output file written only when what it is rendered from changed.  The
+ * fingerprint of the classes, relationships and options an output is rendered
+ * from is stored next to the file, and while it matches the outputter is not
+ * run.  The file is written to a temporary file and renamed, so readers never
+ * see a partial output.  The classes and relationships are in the order they
+ * were parsed and analyzed, which does not depend on the number of threads.
+ */
+class srcuml_artifact {
+
+private:
+
+    // changes whenever the outputters draw the same model differently
+    enum : std::uint64_t { VERSION = 1 };
+
+    std::string filename;
+    output_compression compression;
+
+    boost::filesystem::path temp_path;
+    std::unique_ptr<std::ostream> stream;
+
+    static std::uint64_t hash_string(const std::string & str, std::uint64_t value) {
+
+        std::ostringstream out;
+        srcuml::write_string(out, str);
+        const std::string bytes = out.str();
+
+        return srcuml::hash(bytes.data(), bytes.size(), value);
+
+    }
+
+    static std::uint64_t hash_size(std::uint64_t size, std::uint64_t value) {
+
+        return srcuml::hash(reinterpret_cast<const char *>(&size), sizeof(size), value);
+
+    }
+
+    static std::uint64_t hash_labels(const std::vector<srcuml_member_label> & labels, std::uint64_t value) {
+
+        value = hash_size(labels.size(), value);
+        for(const srcuml_member_label & label : labels)
+            value = hash_size(label.is_static, hash_string(label.text, value));
+
+        return value;
+
+    }
+
+    static std::string format(std::uint64_t fingerprint) {
+
+        std::ostringstream out;
+        out << std::hex << std::setw(16) << std::setfill('0') << fingerprint;
+
+        return out.str();
+
+    }
+
+public:
+
+    srcuml_artifact(const std::string & filename, output_compression compression)
+        : filename(filename), compression(compression), temp_path(), stream() {}
+
+    srcuml_artifact(const std::string & filename) : srcuml_artifact(filename, compression_of(filename)) {}
+
+    ~srcuml_artifact() {
+
+        abandon();
+
+    }
+
+    const std::string & get_filename() const {
+
+        return filename;
+
+    }
+
+    /** file the fingerprint of filename is stored in */
+    static std::string fingerprint_filename(const std::string & filename) {
+
+        return filename + ".srcuml-hash";
+
+    }
+
+    /**
+     * Fingerprint of the output type, see srcuml_handler, rendered from classes and relationships with options.
+     * The member labels are hashed as displayed, so the member filter is part of it.
+     */
+    static std::uint64_t fingerprint(std::size_t type,
+                                     const std::vector<std::shared_ptr<srcuml_class>> & classes,
+                                     const std::vector<srcuml_relationship> & relationships,
+                                     const srcuml_options & options) {
+
+        std::uint64_t value = hash_size(VERSION, srcuml::hash(nullptr, 0));
+        value = hash_size(type, value);
+
+        value = hash_size(options.layout_budget, value);
+        value = hash_size(options.layout_components, value);
+        value = hash_size(options.crossmin_runs, value);
+        value = hash_size(options.three_bands, value);
+        value = hash_size(options.clusters, value);
+        value = hash_string(options.cluster_directory, value);
+        value = hash_string(options.tile_directory, value);
+        value = hash_string(std::to_string(options.tile_size), value);
+        value = hash_string(options.focus, value);
+        value = hash_size(options.focus_depth, value);
+        value = hash_size(options.edge_detail, value);
+        value = hash_size(options.max_classes, value);
+        value = hash_size(options.max_edges_per_class, value);
+        value = hash_size(options.max_label_lines, value);
+        value = hash_size(options.max_members, value);
+        value = hash_string(options.members_file, value);
+
+        value = hash_size(classes.size(), value);
+        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+            std::ostringstream out;
+            aclass->write(out);
+            const std::string summary = out.str();
+
+            value = srcuml::hash(summary.data(), summary.size(), value);
+            value = hash_labels(aclass->get_attribute_labels(), value);
+            value = hash_labels(aclass->get_operation_labels(), value);
+
+        }
+
+        std::ostringstream out;
+        srcuml::write_size(out, relationships.size());
+        for(const srcuml_relationship & relationship : relationships)
+            relationship.write(out);
+        const std::string edges = out.str();
+
+        return srcuml::hash(edges.data(), edges.size(), value);
+
+    }
+
+    /** whether the file exists and was last written from what has fingerprint */
+    bool is_current(std::uint64_t fingerprint) const {
+
+        if(!boost::filesystem::exists(filename))
+            return false;
+
+        std::ifstream in(fingerprint_filename(filename));
+        std::string stored;
+        if(!(in >> stored))
+            return false;
+
+        return stored == format(fingerprint);
+
+    }
+
+    /** stream to a temporary file next to filename, see commit */
+    std::ostream & open() {
+
+        abandon();
+
+        const boost::filesystem::path path(filename);
+        temp_path = path.parent_path() / boost::filesystem::unique_path(path.filename().string() + ".%%%%-%%%%.tmp");
+
+        stream.reset(open_output(temp_path.string(), compression));
+        if(!*stream)
+            throw std::string("Error: Unable to write ") + temp_path.string();
+
+        return *stream;
+
+    }
+
+    /**
+     * Renames the written temporary file to filename and stores fingerprint next to it.
+     * An incomplete output, e.g. cut short by a deadline, is kept without a fingerprint
+     * so the next run writes it again.
+     */
+    void commit(std::uint64_t fingerprint, bool is_complete = true) {
+
+        const bool written = bool(stream->flush());
+        if(srcuml_compressed_stream * compressed = dynamic_cast<srcuml_compressed_stream *>(stream.get()))
+            compressed->close();
+        stream.reset();
+        if(!written)
+            throw std::string("Error: Unable to write ") + temp_path.string();
+
+        // a stale fingerprint must never describe the new file
+        boost::filesystem::remove(fingerprint_filename(filename));
+        boost::filesystem::rename(temp_path, filename);
+        temp_path.clear();
+
+        if(!is_complete)
+            return;
+
+        const boost::filesystem::path fingerprint_path(fingerprint_filename(filename));
+        const boost::filesystem::path fingerprint_temp = fingerprint_path.parent_path()
+            / boost::filesystem::unique_path(fingerprint_path.filename().string() + ".%%%%-%%%%.tmp");
+
+        {
+            std::ofstream out(fingerprint_temp.string());
+            if(!out)
+                throw std::string("Error: Unable to write ") + fingerprint_temp.string();
+
+            out << format(fingerprint) << '\n';
+        }
+
+        boost::filesystem::rename(fingerprint_temp, fingerprint_path);
+
+    }
+
+    /** drops the temporary file of an output that failed, filename is left as it was */
+    void abandon() {
+
+        stream.reset();
+        if(temp_path.empty())
+            return;
+
+        boost::system::error_code error;
+        boost::filesystem::remove(temp_path, error);
+        temp_path.clear();
+
+    }
+
+};
+
+#endif
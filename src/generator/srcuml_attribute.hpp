@@ -25,37 +25,80 @@
 #include <DeclTypePolicySingleEvent.hpp>
 
 #include <srcuml_type.hpp>
+#include <srcuml_symbol.hpp>
 #include <string>
+#include <cstdint>
+
+/** multiplicity of an attribute, the bound is kept separately as a symbol */
+enum multiplicity_kind : std::uint8_t {
+    NO_MULTIPLICITY,        // nothing shown
+    BOUND_MULTIPLICITY,     // ［bound］
+    UP_TO_MULTIPLICITY,     // ［0..bound］, a pointer with an index
+    MANY_MULTIPLICITY,      // ［*］
+    OPTIONAL_MULTIPLICITY   // ［0..1］
+};
 
 class srcuml_attribute {
 
 private:
 
-    const DeclTypePolicy::DeclTypeData * data;
     const ClassPolicy::AccessSpecifier visibility;
 
     srcuml_type type;
     std::string name;
 
-    bool is_pointer;
-
     bool is_static;
 
     bool has_index;
-    std::string index;
+    // symbol 0 (the empty name) when there is no index
+    srcuml_symbol index;
+
+    // computed once the type and index are known, see append_multiplicity
+    multiplicity_kind multiplicity;
 
 public:
-    srcuml_attribute(const DeclTypePolicy::DeclTypeData * data, ClassPolicy::AccessSpecifier visibility)
-        : data(data),
-          visibility(visibility),
-          type(data->type),
+    srcuml_attribute(const DeclTypePolicy::DeclTypeData * data, ClassPolicy::AccessSpecifier visibility, srcuml_type_cache & types)
+        : visibility(visibility),
+          type(types.resolve(data->type)),
           name(data->name ? data->name->ToString() : ""),
-          is_pointer(type.get_is_pointer()),
           is_static(data->isStatic),
           has_index(false),
-          index() {
+          index(0),
+          multiplicity(NO_MULTIPLICITY) {
+
+            analyze_attribute(data);
+            analyze_multiplicity();
+
+    }
+
+    /** reads an attribute written by write */
+    srcuml_attribute(std::istream & in)
+        : visibility((ClassPolicy::AccessSpecifier)srcuml::read_size(in)),
+          type(in),
+          name(srcuml::read_string(in)),
+          is_static(srcuml::read_bool(in)),
+          has_index(srcuml::read_bool(in)),
+          index(srcuml::intern(srcuml::read_string(in))),
+          multiplicity(NO_MULTIPLICITY) {
+
+            analyze_multiplicity();
 
-            analyze_attribute();
+    }
+
+    ClassPolicy::AccessSpecifier get_visibility() const {
+
+        return visibility;
+
+    }
+
+    void write(std::ostream & out) const {
+
+        srcuml::write_size(out, visibility);
+        type.write(out);
+        srcuml::write_string(out, name);
+        srcuml::write_bool(out, is_static);
+        srcuml::write_bool(out, has_index);
+        srcuml::write_string(out, srcuml::symbol_name(index));
 
     }
 
@@ -71,36 +114,52 @@ public:
         return is_static;
     }
 
-    const std::string get_multiplicity() const {
+    multiplicity_kind get_multiplicity_kind() const {
+        return multiplicity;
+    }
 
-        if(!index.empty()) {
+    /** the bound of BOUND_MULTIPLICITY and UP_TO_MULTIPLICITY */
+    const std::string & get_multiplicity_bound() const {
+        return srcuml::symbol_name(index);
+    }
 
-            std::string multiplicity = "［";
-            if(is_pointer)
-                multiplicity += "0..";
-            multiplicity += index;
-            multiplicity += "］";
+    /** appends the multiplicity as drawn, e.g. ［0..1］, nothing for NO_MULTIPLICITY */
+    void append_multiplicity(std::string & out) const {
+
+        switch(multiplicity) {
+
+            case BOUND_MULTIPLICITY:
+                out += "［";
+                out += get_multiplicity_bound();
+                out += "］";
+                break;
+            case UP_TO_MULTIPLICITY:
+                out += "［0..";
+                out += get_multiplicity_bound();
+                out += "］";
+                break;
+            case MANY_MULTIPLICITY:
+                out += "［*］";
+                break;
+            case OPTIONAL_MULTIPLICITY:
+                out += "［0..1］";
+                break;
+            default:
+                break;
 
-            return multiplicity;
+        }
 
-        } 
+    }
 
-        if(is_pointer
-            || has_index
-            || type.get_is_container()) {
-            return "［*］";
-        }
+    std::string get_multiplicity() const {
 
-        if(type.get_is_smart_pointer()) {
-            return "［0..1］";
-        }
+        std::string multiplicity;
+        append_multiplicity(multiplicity);
 
-        return "";
+        return multiplicity;
 
     }
 
-    // ~srcuml_attribute() { if(data) delete data; }
-
     std::string get_string_attribute() const {
 
         std::string att = "";
@@ -114,9 +173,9 @@ public:
 
         att += ' ';
         att += name + ": " + type.get_string_type();
-        att += get_multiplicity();
+        append_multiplicity(att);
 
-        if(has_index || is_pointer || (type.get_is_container() && type.get_is_ordered())) {
+        if(has_index || type.get_is_pointer() || (type.get_is_container() && type.get_is_ordered())) {
             att += " ｛ordered｝";
         }
 
@@ -125,42 +184,38 @@ public:
 
     friend std::ostream & operator<<(std::ostream & out, const srcuml_attribute & attribute) {
 
-        if(attribute.visibility == ClassPolicy::PUBLIC)
-            out << '+';
-        else if(attribute.visibility == ClassPolicy::PRIVATE)
-            out << '-';
-        else if(attribute.visibility == ClassPolicy::PROTECTED)
-            out << '#';
-
-        out << ' ';
-
-        out << attribute.name << ": " << attribute.type;
-
-        out << attribute.get_multiplicity();
-
-        if(attribute.has_index || attribute.is_pointer || (attribute.type.get_is_container() && attribute.type.get_is_ordered())) {
-            out << " ｛ordered｝";
-        }
-
-        return out;
+        return out << attribute.get_string_attribute();
 
     }
 
 private:
-    void analyze_attribute() {
+    void analyze_attribute(const DeclTypePolicy::DeclTypeData * data) {
 
         if(!data->name) return;
 
         if(!data->name->arrayIndices.empty()) {
             has_index = true;
-            index = data->name->arrayIndices[0];
+            index = srcuml::intern(data->name->arrayIndices[0]);
         } else if(type.get_has_index()) {
             has_index = true;
-            index = type.get_index();
+            index = srcuml::intern(type.get_index());
         }
 
     }
 
+    void analyze_multiplicity() {
+
+        if(index)
+            multiplicity = type.get_is_pointer() ? UP_TO_MULTIPLICITY : BOUND_MULTIPLICITY;
+        else if(type.get_is_pointer() || has_index || type.get_is_container())
+            multiplicity = MANY_MULTIPLICITY;
+        else if(type.get_is_smart_pointer())
+            multiplicity = OPTIONAL_MULTIPLICITY;
+        else
+            multiplicity = NO_MULTIPLICITY;
+
+    }
+
 };
 
  #endif
@@ -0,0 +1,247 @@
+/**
+ * @file srcuml_cache.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_CACHE_HPP
+#define INCLUDED_SRCUML_CACHE_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_dispatcher.hpp>
+#include <srcuml_serialize.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * srcuml_cache
+ *
+ * Extracted class summaries keyed by a content hash of each srcML unit, kept in
+ * memory and, when given a directory, on disk.  Entries depend on the event
+ * profile and on classifying stereotypes, so each hashes differently.  Safe to
+ * share between threads.
+ *
+ * The entries in memory are bounded by their bytes, past the capacity the least
+ * recently used are evicted, so a server or watcher running for days does not
+ * keep every unit it ever saw.  Evicted entries are still read from disk.
+ */
+class srcuml_cache {
+
+private:
+
+    static const std::uint64_t VERSION = 6;
+
+    typedef std::list<std::pair<std::uint64_t, std::string>> entry_list;
+
+    boost::filesystem::path directory;
+    std::uint64_t seed;
+
+    mutable std::mutex mutex;
+    // most recently used first
+    mutable entry_list entries;
+    mutable std::unordered_map<std::uint64_t, entry_list::iterator> positions;
+    mutable std::size_t bytes;
+    std::size_t capacity;
+
+public:
+
+    /** memory only, capacity is in bytes, see srcuml_options::cache_memory */
+    srcuml_cache(event_profile profile, bool stereotypes = false, std::size_t capacity = static_cast<std::size_t>(-1))
+        : directory(), seed(srcuml::hash(nullptr, 0) + VERSION * 31 + profile + (stereotypes ? 7 : 0) + srcuml_container_registry::instance().get_fingerprint()),
+          mutex(), entries(), positions(), bytes(0), capacity(capacity) {}
+
+    srcuml_cache(const std::string & directory, event_profile profile, bool stereotypes = false,
+                 std::size_t capacity = static_cast<std::size_t>(-1))
+        : srcuml_cache(profile, stereotypes, capacity) {
+
+        this->directory = directory;
+        if(!directory.empty())
+            boost::filesystem::create_directories(this->directory);
+
+    }
+
+    /** entries kept in memory */
+    std::size_t size() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+
+    }
+
+    /** bytes of the entries kept in memory */
+    std::size_t get_bytes() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes;
+
+    }
+
+    /** false on a miss or an unreadable entry */
+    bool load(const char * unit, std::size_t size, std::vector<std::shared_ptr<srcuml_class>> & classes) const {
+
+        std::uint64_t key = srcuml::hash(unit, size, seed);
+
+        std::string entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::unordered_map<std::uint64_t, entry_list::iterator>::const_iterator itr = positions.find(key);
+            if(itr != positions.end()) {
+                entries.splice(entries.begin(), entries, itr->second);
+                entry = itr->second->second;
+            }
+        }
+
+        if(entry.empty() && !directory.empty()) {
+
+            std::ifstream in(entry_path(key).string(), std::ios::binary);
+            if(!in)
+                return false;
+
+            entry.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            if(!read_entry(entry, size, classes))
+                return false;
+
+            keep(key, std::move(entry));
+            return true;
+
+        }
+
+        return !entry.empty() && read_entry(entry, size, classes);
+
+    }
+
+    /** disk entries are written to a temporary file and renamed so readers never see a partial entry */
+    void store(const char * unit, std::size_t size, const std::vector<std::shared_ptr<srcuml_class>> & classes) const {
+
+        std::uint64_t key = srcuml::hash(unit, size, seed);
+
+        std::ostringstream out;
+        srcuml::write_size(out, VERSION);
+        srcuml::write_size(out, size);
+        srcuml::write_size(out, classes.size());
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            aclass->write(out);
+
+        std::string entry = out.str();
+
+        if(!directory.empty()) {
+
+            boost::filesystem::path temp_path = directory / boost::filesystem::unique_path("%%%%-%%%%-%%%%.tmp");
+
+            {
+                std::ofstream file(temp_path.string(), std::ios::binary);
+                if(!file)
+                    throw std::string("Error: Unable to write cache entry ") + temp_path.string();
+
+                file.write(entry.data(), entry.size());
+            }
+
+            boost::filesystem::rename(temp_path, entry_path(key));
+
+        }
+
+        keep(key, std::move(entry));
+
+    }
+
+private:
+
+    /** the entry becomes the most recently used, the least recently used are evicted past the capacity */
+    void keep(std::uint64_t key, std::string && entry) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::unordered_map<std::uint64_t, entry_list::iterator>::iterator itr = positions.find(key);
+        if(itr != positions.end()) {
+
+            bytes -= itr->second->second.size();
+            entries.erase(itr->second);
+            positions.erase(itr);
+
+        }
+
+        // an entry larger than the whole capacity is only kept on disk
+        if(entry.size() > capacity)
+            return;
+
+        bytes += entry.size();
+        entries.emplace_front(key, std::move(entry));
+        positions.emplace(key, entries.begin());
+
+        while(bytes > capacity) {
+
+            bytes -= entries.back().second.size();
+            positions.erase(entries.back().first);
+            entries.pop_back();
+
+        }
+
+    }
+
+    static bool read_entry(const std::string & entry, std::size_t size, std::vector<std::shared_ptr<srcuml_class>> & classes) {
+
+        srcuml::memory_streambuf buffer(entry.data(), entry.size());
+        std::istream in(&buffer);
+
+        try {
+
+            // guard against hash collisions with the unit size
+            if(srcuml::read_size(in) != VERSION || srcuml::read_size(in) != size)
+                return false;
+
+            std::vector<std::shared_ptr<srcuml_class>> entry_classes;
+            std::uint64_t number_classes = srcuml::read_size(in);
+            for(std::uint64_t pos = 0; pos < number_classes; ++pos)
+                entry_classes.emplace_back(std::make_shared<srcuml_class>(in));
+
+            classes.insert(classes.end(), entry_classes.begin(), entry_classes.end());
+
+        } catch(const std::string & error) {
+            return false;
+        }
+
+        return true;
+
+    }
+
+    boost::filesystem::path entry_path(std::uint64_t key) const {
+
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".unit";
+
+        return directory / name.str();
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file srcuml_cancel.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_CANCEL_HPP
+#define INCLUDED_SRCUML_CANCEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * srcuml_cancel
+ *
+ * Cancellation token of a run, cancelled explicitly or once its deadline
+ * passes.  The parse, the relationship passes, the layout and the drawing
+ * check it and cut their work short, so a run that hits its deadline still
+ * writes a complete, if degraded, output.  Checking is thread safe and cheap,
+ * though it reads the clock when there is a deadline.  Nothing is cancelled
+ * without a srcuml_cancel, see srcuml_options::cancel.
+ */
+class srcuml_cancel {
+
+private:
+
+    mutable std::atomic<bool> cancelled;
+
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline;
+
+public:
+
+    // remaining() without a deadline
+    enum : std::size_t { NO_DEADLINE = static_cast<std::size_t>(-1) };
+
+    /** a milliseconds of 0 has no deadline, the token is only cancelled by cancel */
+    explicit srcuml_cancel(std::size_t milliseconds = 0)
+        : cancelled(false), has_deadline(milliseconds != 0),
+          deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds)) {}
+
+    srcuml_cancel(const srcuml_cancel &) = delete;
+    srcuml_cancel & operator=(const srcuml_cancel &) = delete;
+
+    void cancel() {
+        cancelled = true;
+    }
+
+    bool is_cancelled() const {
+
+        if(cancelled.load(std::memory_order_relaxed))
+            return true;
+
+        if(has_deadline && std::chrono::steady_clock::now() >= deadline) {
+            cancelled = true;
+            return true;
+        }
+
+        return false;
+
+    }
+
+    /** milliseconds until the deadline, 0 once cancelled */
+    std::size_t remaining() const {
+
+        if(is_cancelled())
+            return 0;
+
+        if(!has_deadline)
+            return NO_DEADLINE;
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count() + 1;
+
+    }
+
+    /** for the optional token of a run */
+    static bool is_cancelled(const srcuml_cancel * cancel) {
+        return cancel && cancel->is_cancelled();
+    }
+
+    static std::size_t remaining(const srcuml_cancel * cancel) {
+        return cancel ? cancel->remaining() : static_cast<std::size_t>(NO_DEADLINE);
+    }
+
+};
+
+#endif
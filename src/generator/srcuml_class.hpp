@@ -26,10 +26,39 @@
 
 #include <srcuml_attribute.hpp>
 #include <srcuml_operation.hpp>
+#include <srcuml_member_filter.hpp>
 #include <static_outputter.hpp>
+#include <srcuml_utilities.hpp>
 
 #include <map>
 #include <set>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <mutex>
+
+/**
+ * srcuml_member_label
+ *
+ * A class member rendered for display.  Static members are underlined by the outputters that support it.
+ */
+struct srcuml_member_label {
+
+    std::string text;
+    bool is_static;
+
+};
+
+/**
+ * srcuml_category
+ *
+ * Entity, control or boundary role of a class by its first class stereotype, the
+ * bands of svg_three.  A class with another stereotype is OTHER_CATEGORY, one without
+ * any NO_CATEGORY.
+ */
+enum srcuml_category : std::uint8_t { ENTITY_CATEGORY, CONTROL_CATEGORY, BOUNDARY_CATEGORY, OTHER_CATEGORY, NO_CATEGORY };
 
 class srcuml_class {
 
@@ -37,6 +66,10 @@ private:
     const ClassPolicy::ClassData * data;
 
     std::string name;
+    // qualified name, the same as name unless the class was defined with a qualified name
+    srcuml_symbol name_symbol;
+    // filename of the srcML unit defining the class, empty when the archive has none
+    std::string filename;
 
     bool has_field;
     bool has_constructor;
@@ -58,16 +91,37 @@ private:
 
     bool is_finalized;
 
-    std::map<std::string, const FunctionPolicy::FunctionData *> implemented_functions_map;
-    std::map<std::string, const FunctionPolicy::FunctionData *> pure_virtual_functions_map;
+    // name with the prefix of its kind, see get_srcuml_name, kept in step with the flags
+    std::string srcuml_name;
+
+    std::vector<srcuml_symbol> parents;
+
+    // sorted signature hashes, see signature_hash
+    std::vector<std::uint64_t> implemented_functions;
+    std::vector<std::uint64_t> pure_virtual_functions;
 
     std::vector<srcuml_attribute> attributes;
+    std::vector<srcuml_operation> operations;
+
+    // qualified type names referenced by parameters, locals and returns of implemented functions
+    std::vector<srcuml_symbol> dependency_types;
 
     std::set<std::string> stereotypes;
+    // of stereotypes, kept in step with them
+    srcuml_category category = NO_CATEGORY;
+
+    // members shown by srcuml_member_filter, rendered once when first asked for, shared by every outputter,
+    // so outputs that draw no members never format them
+    mutable std::vector<srcuml_member_label> attribute_labels;
+    mutable std::vector<srcuml_member_label> operation_labels;
+    mutable std::once_flag members_rendered;
 
 public:
-    srcuml_class(const ClassPolicy::ClassData * data)
+    /** collect_dependencies = false skips gathering the types used by function bodies */
+    srcuml_class(const ClassPolicy::ClassData * data, bool collect_dependencies = true, const std::string & filename = "")
         : data(data),
+          name_symbol(0),
+          filename(filename),
           has_field(false),
           has_constructor(false),
           has_default_constructor(false),
@@ -84,18 +138,159 @@ public:
           is_datatype(false),
           is_finalized(false) {
 
-            analyze_data();
+            analyze_data(collect_dependencies);
+            update_srcuml_name();
+
+    }
+
+    /** reads a class summary written by write, the srcML data is not available */
+    srcuml_class(std::istream & in)
+        : data(nullptr),
+          assignment(nullptr) {
+
+            name = srcuml::read_string(in);
+            name_symbol = srcuml::intern(srcuml::read_string(in));
+            filename = srcuml::read_string(in);
+            has_field = srcuml::read_bool(in);
+            has_constructor = srcuml::read_bool(in);
+            has_default_constructor = srcuml::read_bool(in);
+            has_public_default_constructor = srcuml::read_bool(in);
+            has_copy_constructor = srcuml::read_bool(in);
+            has_public_copy_constructor = srcuml::read_bool(in);
+            has_destructor = srcuml::read_bool(in);
+            has_public_assignment = srcuml::read_bool(in);
+            has_operator = srcuml::read_bool(in);
+            has_method = srcuml::read_bool(in);
+            is_interface = srcuml::read_bool(in);
+            is_abstract = srcuml::read_bool(in);
+            is_datatype = srcuml::read_bool(in);
+            is_finalized = srcuml::read_bool(in);
+
+            read_symbols(in, parents);
+            read_signatures(in, implemented_functions);
+            read_signatures(in, pure_virtual_functions);
+
+            std::uint64_t number_attributes = srcuml::read_size(in);
+            for(std::uint64_t pos = 0; pos < number_attributes; ++pos)
+                attributes.emplace_back(in);
+
+            std::uint64_t number_operations = srcuml::read_size(in);
+            for(std::uint64_t pos = 0; pos < number_operations; ++pos)
+                operations.emplace_back(in);
+
+            read_symbols(in, dependency_types);
+            srcuml::read_strings(in, stereotypes);
+            category = categorize(stereotypes);
+
+            update_srcuml_name();
+
+    }
+
+    /**
+     * A class known only from how a diagram showed it, e.g. a yUML box: its name,
+     * kind and member labels.  It is finalized and has no srcML data.
+     */
+    srcuml_class(const std::string & name, bool is_interface, bool is_abstract, bool is_datatype,
+                 const std::vector<srcuml_member_label> & attribute_labels, const std::vector<srcuml_member_label> & operation_labels,
+                 bool has_field, bool has_method)
+        : data(nullptr),
+          name(name),
+          name_symbol(srcuml::intern(name)),
+          filename(),
+          has_field(has_field),
+          has_constructor(false),
+          has_default_constructor(false),
+          has_public_default_constructor(false),
+          has_copy_constructor(false),
+          has_public_copy_constructor(false),
+          has_destructor(false),
+          has_public_assignment(false),
+          assignment(nullptr),
+          has_operator(false),
+          has_method(has_method),
+          is_interface(is_interface),
+          is_abstract(is_abstract),
+          is_datatype(is_datatype),
+          is_finalized(true),
+          attribute_labels(attribute_labels),
+          operation_labels(operation_labels) {
+
+            // the labels are given, there is nothing to render them from
+            std::call_once(members_rendered, []() {});
+            update_srcuml_name();
 
     }
 
     ~srcuml_class() { if(data) delete data; }
 
+    /** the unqualified name of the class of data, class a::b::c is c with qualifier a::b:: */
+    static std::string simple_name(const ClassPolicy::ClassData * data, std::string & qualifier) {
+
+        const NamePolicy::NameData * class_name = data->name;
+        if(class_name->names.size() >= 2) {
+
+            for(std::size_t pos = 0; pos + 1 < class_name->names.size(); ++pos)
+                qualifier += class_name->names[pos]->SimpleName() + "::";
+            class_name = class_name->names.back();
+
+        }
+
+        return class_name->SimpleName();
+
+    }
+
+    /** the name get_name_symbol will have, without summarizing the class */
+    static std::string qualified_name(const ClassPolicy::ClassData * data) {
+
+        std::string qualifier;
+        const std::string name = simple_name(data, qualifier);
+        return qualifier + name;
+
+    }
+
+    /** writes everything analyze_data summarized */
+    void write(std::ostream & out) const {
+
+        write(out, true);
+
+    }
+
+    /** hash of the summary without the filename, equal for copies of the class in several units */
+    std::uint64_t get_structure_hash() const {
+
+        std::ostringstream summary;
+        write(summary, false);
+        const std::string & bytes = summary.str();
+
+        return srcuml::hash(bytes.data(), bytes.size());
+
+    }
+
+    /** only valid until release_data() is called */
     const ClassPolicy::ClassData & get_data() const {
 
         return *data;
 
     }
 
+    bool has_data() const {
+
+        return data != nullptr;
+
+    }
+
+    /**
+     * Frees the srcML policy data.  Everything the relationships
+     * and outputters need has been summarized by analyze_data.
+     */
+    void release_data() {
+
+        delete data;
+        data = nullptr;
+        assignment = nullptr;
+
+    }
+
 
     const std::string & get_name() const {
 
@@ -103,18 +298,23 @@ public:
 
     }
 
-    std::string get_srcuml_name() const { //shouldn't do any formatting
+    const std::string & get_filename() const {
 
-        if(is_interface)
-            return "«interface»" + name;
-        // not sure if should be gulliments or {}
-        if(is_abstract)
-            return "｛abstract｝" + name;
+        return filename;
 
-        if(is_datatype)
-            return "«datatype»" + name;
+    }
 
-        return name;
+    /** symbol of the qualified name, which identifies the class in relationships */
+    srcuml_symbol get_name_symbol() const {
+
+        return name_symbol;
+
+    }
+
+    /** computed when the kind changes, not on every call */
+    const std::string & get_srcuml_name() const { //shouldn't do any formatting
+
+        return srcuml_name;
 
     }
 
@@ -124,6 +324,7 @@ public:
 
     void set_is_interface(bool is_interface){
         this->is_interface = is_interface;
+        update_srcuml_name();
     }
 
     bool get_is_abstract() const {
@@ -132,6 +333,11 @@ public:
 
     void set_is_abstract(bool is_abstract){
         this->is_abstract = is_abstract;
+        update_srcuml_name();
+    }
+
+    bool get_is_datatype() const {
+        return is_datatype;
     }
 
     bool get_is_finalized() const {
@@ -150,27 +356,88 @@ public:
     	return has_field;
     }
 
-    const std::map<std::string, const FunctionPolicy::FunctionData *> & get_implemented_functions_map() const {
-        return implemented_functions_map;
+    const std::vector<srcuml_symbol> & get_parents() const {
+        return parents;
+    }
+
+    const std::vector<std::uint64_t> & get_implemented_functions() const {
+        return implemented_functions;
     }
 
-    std::map<std::string, const FunctionPolicy::FunctionData *> & get_pure_virtual_functions_map() {
-        return pure_virtual_functions_map;
+    /** declared by this class, inherited ones are only merged while resolving inheritence */
+    const std::vector<std::uint64_t> & get_pure_virtual_functions() const {
+        return pure_virtual_functions;
     }
 
     const std::vector<srcuml_attribute> & get_attributes() const {
         return attributes;
     } 
 
+    const std::vector<srcuml_operation> & get_operations() const {
+        return operations;
+    }
+
+    const std::vector<srcuml_symbol> & get_dependency_types() const {
+        return dependency_types;
+    }
+
     const std::set<std::string> & get_stereotypes() const {
         return stereotypes;
     }
 
+    srcuml_category get_category() const {
+        return category;
+    }
+
+    static srcuml_category categorize(const std::set<std::string> & stereotypes) {
+
+        if(stereotypes.empty())
+            return NO_CATEGORY;
+
+        const std::string & stereotype = *stereotypes.begin();
+        if(stereotype == "entity")
+            return ENTITY_CATEGORY;
+        if(stereotype == "control")
+            return CONTROL_CATEGORY;
+        if(stereotype == "boundary")
+            return BOUNDARY_CATEGORY;
+
+        return OTHER_CATEGORY;
+
+    }
+
+    const std::vector<srcuml_member_label> & get_attribute_labels() const {
+        std::call_once(members_rendered, &srcuml_class::render_members, this);
+        return attribute_labels;
+    }
+
+    /** get and set operations are not shown */
+    const std::vector<srcuml_member_label> & get_operation_labels() const {
+        std::call_once(members_rendered, &srcuml_class::render_members, this);
+        return operation_labels;
+    }
+
 private:
 
-    void analyze_data() {
+    void update_srcuml_name() {
 
-        name = data->name->SimpleName();
+        if(is_interface)
+            srcuml_name = "«interface»" + name;
+        // not sure if should be gulliments or {}
+        else if(is_abstract)
+            srcuml_name = "｛abstract｝" + name;
+        else if(is_datatype)
+            srcuml_name = "«datatype»" + name;
+        else
+            srcuml_name = name;
+
+    }
+
+    void analyze_data(bool collect_dependencies) {
+
+        std::string qualifier;
+        name = simple_name(data, qualifier);
+        name_symbol = srcuml::intern(qualifier + name);
         // if(data->isGeneric) name += "<>";
 
         has_field = data->fields[ClassPolicy::PUBLIC].size() || data->fields[ClassPolicy::PRIVATE].size() || data->fields[ClassPolicy::PROTECTED].size();
@@ -262,10 +529,13 @@ private:
 
         }
 
+        // operations and the dependency pass see the same parameter and return types
+        srcuml_type_cache types;
+
         for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
 
             for(const DeclTypePolicy::DeclTypeData * field : data->fields[access]) {
-                attributes.emplace_back(field, (ClassPolicy::AccessSpecifier)access);
+                attributes.emplace_back(field, (ClassPolicy::AccessSpecifier)access, types);
             }
 
         }
@@ -273,22 +543,176 @@ private:
         for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
 
             for(const FunctionPolicy::FunctionData * method : data->methods[access]) {
-                if(method->isPureVirtual)
-                    pure_virtual_functions_map[method->ToString()] = method;
-                else
-                    implemented_functions_map[method->ToString()] = method;
+                operations.emplace_back(method, (ClassPolicy::AccessSpecifier)access, types);
             }
 
-            for(const FunctionPolicy::FunctionData * op : data->operators[access]) {
-               if(op->isPureVirtual)
-                    pure_virtual_functions_map[op->ToString()] = op;
-                else
-                    implemented_functions_map[op->ToString()] = op;
-            }
+        }
 
+        // dependencies in declaration order, once per signature
+        std::unordered_set<std::uint64_t> signatures;
+        for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
+
+            for(const FunctionPolicy::FunctionData * method : data->methods[access])
+                add_function(method, collect_dependencies, types, signatures);
+
+            for(const FunctionPolicy::FunctionData * op : data->operators[access])
+                add_function(op, collect_dependencies, types, signatures);
+
+        }
+
+        std::sort(implemented_functions.begin(), implemented_functions.end());
+        std::sort(pure_virtual_functions.begin(), pure_virtual_functions.end());
+        pure_virtual_functions.erase(std::unique(pure_virtual_functions.begin(), pure_virtual_functions.end()), pure_virtual_functions.end());
+
+        for(const ClassPolicy::ParentData & parent_data : data->parents) {
+            parents.push_back(srcuml::intern(parent_data.name));
         }
 
         stereotypes = data->stereotypes;
+        category = categorize(stereotypes);
+
+    }
+
+    void write(std::ostream & out, bool with_filename) const {
+
+        srcuml::write_string(out, name);
+        srcuml::write_string(out, srcuml::symbol_name(name_symbol));
+        srcuml::write_string(out, with_filename ? filename : std::string());
+        srcuml::write_bool(out, has_field);
+        srcuml::write_bool(out, has_constructor);
+        srcuml::write_bool(out, has_default_constructor);
+        srcuml::write_bool(out, has_public_default_constructor);
+        srcuml::write_bool(out, has_copy_constructor);
+        srcuml::write_bool(out, has_public_copy_constructor);
+        srcuml::write_bool(out, has_destructor);
+        srcuml::write_bool(out, has_public_assignment);
+        srcuml::write_bool(out, has_operator);
+        srcuml::write_bool(out, has_method);
+        srcuml::write_bool(out, is_interface);
+        srcuml::write_bool(out, is_abstract);
+        srcuml::write_bool(out, is_datatype);
+        srcuml::write_bool(out, is_finalized);
+
+        write_symbols(out, parents);
+        write_signatures(out, implemented_functions);
+        write_signatures(out, pure_virtual_functions);
+
+        srcuml::write_size(out, attributes.size());
+        for(const srcuml_attribute & attribute : attributes)
+            attribute.write(out);
+
+        srcuml::write_size(out, operations.size());
+        for(const srcuml_operation & operation : operations)
+            operation.write(out);
+
+        write_symbols(out, dependency_types);
+        srcuml::write_strings(out, stereotypes);
+
+    }
+
+    void render_members() const {
+
+        const srcuml_member_filter & filter = srcuml_member_filter::instance();
+
+        for(const srcuml_attribute & attribute : attributes)
+            if(filter.is_shown(attribute.get_visibility()))
+                attribute_labels.push_back({ attribute.get_string_attribute(), attribute.get_is_static() });
+
+        for(const srcuml_operation & operation : operations)
+            if(filter.is_shown(operation.get_visibility(), operation.get_stereotype_mask()))
+                operation_labels.push_back({ operation.get_string_function(), operation.get_is_static() });
+
+    }
+
+    /** symbols are written by name, ids are only meaningful within a process */
+    static void write_symbols(std::ostream & out, const std::vector<srcuml_symbol> & symbols) {
+
+        srcuml::write_size(out, symbols.size());
+        for(srcuml_symbol symbol : symbols)
+            srcuml::write_string(out, srcuml::symbol_name(symbol));
+
+    }
+
+    static void read_symbols(std::istream & in, std::vector<srcuml_symbol> & symbols) {
+
+        std::uint64_t size = srcuml::read_size(in);
+        for(std::uint64_t pos = 0; pos < size; ++pos)
+            symbols.push_back(srcuml::intern(srcuml::read_string(in)));
+
+    }
+
+    /**
+     * Hash of what decides whether one function overrides another: the name,
+     * the parameter types and constness.
+     */
+    static std::uint64_t signature_hash(const FunctionPolicy::FunctionData * function, srcuml_type_cache & types) {
+
+        const std::string & function_name = function->name->ToString();
+        std::uint64_t signature = srcuml::hash(function_name.data(), function_name.size());
+
+        for(const ParamTypePolicy::ParamTypeData * param : function->parameters) {
+
+            const srcuml_type & type = types.resolve(param->type);
+            const std::string & type_name = srcuml::symbol_name(type.get_qualified_symbol());
+
+            std::uint64_t flags = type.get_flags();
+            signature = srcuml::hash(reinterpret_cast<const char *>(&flags), sizeof(flags), signature);
+            signature = srcuml::hash(type_name.data(), type_name.size(), signature);
+
+        }
+
+        char is_const = function->isConst;
+        return srcuml::hash(&is_const, 1, signature);
+
+    }
+
+    void add_function(const FunctionPolicy::FunctionData * function, bool collect_dependencies, srcuml_type_cache & types,
+                      std::unordered_set<std::uint64_t> & signatures) {
+
+        std::uint64_t signature = signature_hash(function, types);
+
+        if(function->isPureVirtual) {
+            pure_virtual_functions.push_back(signature);
+            return;
+        }
+
+        if(!signatures.insert(signature).second)
+            return;
+
+        implemented_functions.push_back(signature);
+        if(collect_dependencies)
+            analyze_dependencies(function, types);
+
+    }
+
+    static void write_signatures(std::ostream & out, const std::vector<std::uint64_t> & signatures) {
+
+        srcuml::write_size(out, signatures.size());
+        for(std::uint64_t signature : signatures)
+            srcuml::write_size(out, signature);
+
+    }
+
+    static void read_signatures(std::istream & in, std::vector<std::uint64_t> & signatures) {
+
+        std::uint64_t size = srcuml::read_size(in);
+        for(std::uint64_t pos = 0; pos < size; ++pos)
+            signatures.push_back(srcuml::read_size(in));
+
+    }
+
+    void analyze_dependencies(const FunctionPolicy::FunctionData * function, srcuml_type_cache & types) {
+
+        for(const ParamTypePolicy::ParamTypeData * param : function->parameters) {
+            dependency_types.push_back(types.resolve(param->type).get_qualified_symbol());
+        }
+
+        for(const DeclTypePolicy::DeclTypeData * relation : function->relations) {
+            dependency_types.push_back(types.resolve(relation->type).get_qualified_symbol());
+        }
+
+        if(function->returnType)
+            dependency_types.push_back(types.resolve(function->returnType).get_qualified_symbol());
 
     }
 
@@ -0,0 +1,324 @@
+/**
+ * @file srcuml_class_table.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_CLASS_TABLE_HPP
+#define INCLUDED_SRCUML_CLASS_TABLE_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_symbol.hpp>
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+/** contiguous run of class indices in a srcuml_class_table column */
+struct srcuml_index_range {
+
+    const std::size_t * first;
+    const std::size_t * last;
+
+    const std::size_t * begin() const { return first; }
+    const std::size_t * end() const { return last; }
+    bool empty() const { return first == last; }
+
+};
+
+/**
+ * srcuml_class_table
+ *
+ * Columnar copy of what the relationship passes read from the classes, built
+ * once after extraction.  Names are resolved to class indices up front, so the
+ * passes walk contiguous arrays instead of the class objects.
+ *
+ * A name is resolved like C++ would: in the scope of the class using it, then
+ * each enclosing scope out to the global one, through a trie of the scopes the
+ * classes were defined in.  A name no scope has falls back to the last class
+ * with the same simple name.
+ */
+class srcuml_class_table {
+
+public:
+
+    enum : std::size_t { NO_CLASS = static_cast<std::size_t>(-1) };
+
+    enum class_flag { CLASS_INTERFACE = 1 << 0, CLASS_ABSTRACT = 1 << 1, CLASS_FINALIZED = 1 << 2 };
+
+private:
+
+    enum : std::size_t { GLOBAL_SCOPE = 0 };
+
+    /** a scope and the symbol of a name within it */
+    typedef std::pair<std::size_t, srcuml_symbol> scope_key;
+
+    struct scope_key_hash {
+
+        std::size_t operator()(const scope_key & key) const {
+            return std::hash<std::size_t>()(key.first) * 31 + std::hash<srcuml_symbol>()(key.second);
+        }
+
+    };
+
+    /** a name split at the :: outside template arguments */
+    struct qualified_name {
+
+        std::vector<srcuml_symbol> qualifier;
+        srcuml_symbol name;
+
+    };
+
+    std::vector<srcuml_symbol> names;
+    std::vector<std::uint8_t> flags;
+
+    // parent of each scope of the trie, and child scopes and classes by scope and name
+    std::vector<std::size_t> scope_parents;
+    std::unordered_map<scope_key, std::size_t, scope_key_hash> child_scopes;
+    std::unordered_map<scope_key, std::size_t, scope_key_hash> scoped_classes;
+
+    // scope lookups from within each class start at, the class itself
+    std::vector<std::size_t> class_scopes;
+    // the class each class's qualified name resolves to (the last one with it)
+    std::vector<std::size_t> canonical;
+
+    // by simple name symbol, the last class with the simple name
+    std::unordered_map<srcuml_symbol, std::size_t> simple_classes;
+
+    std::unordered_map<srcuml_symbol, qualified_name> split_names;
+
+    // parents and dependencies that resolve to a class
+    std::vector<std::size_t> parent_offsets;
+    std::vector<std::size_t> parents;
+
+    std::vector<std::size_t> dependency_offsets;
+    std::vector<std::size_t> dependencies;
+
+    // one entry per attribute, NO_CLASS if its type is not a class
+    std::vector<std::size_t> attribute_offsets;
+    std::vector<std::size_t> attribute_classes;
+
+public:
+
+    srcuml_class_table(const std::vector<std::shared_ptr<srcuml_class>> & classes)
+        : names(), flags(),
+          scope_parents(1, GLOBAL_SCOPE), child_scopes(), scoped_classes(),
+          class_scopes(), canonical(), simple_classes(), split_names(),
+          parent_offsets(1, 0), parents(),
+          dependency_offsets(1, 0), dependencies(),
+          attribute_offsets(1, 0), attribute_classes() {
+
+        names.reserve(classes.size());
+        flags.reserve(classes.size());
+        class_scopes.reserve(classes.size());
+        for(std::size_t pos = 0; pos < classes.size(); ++pos) {
+
+            const srcuml_class & aclass = *classes[pos];
+
+            names.push_back(aclass.get_name_symbol());
+
+            const qualified_name & name = split(aclass.get_name_symbol());
+            std::size_t scope = GLOBAL_SCOPE;
+            for(srcuml_symbol component : name.qualifier)
+                scope = add_scope(scope, component);
+
+            scoped_classes[scope_key(scope, name.name)] = pos;
+            simple_classes[name.name] = pos;
+            class_scopes.push_back(add_scope(scope, name.name));
+
+            std::uint8_t class_flags = 0;
+            if(aclass.get_is_interface()) class_flags |= CLASS_INTERFACE;
+            if(aclass.get_is_abstract())  class_flags |= CLASS_ABSTRACT;
+            if(aclass.get_is_finalized()) class_flags |= CLASS_FINALIZED;
+            flags.push_back(class_flags);
+
+        }
+
+        canonical.reserve(classes.size());
+        for(std::size_t pos = 0; pos < classes.size(); ++pos)
+            canonical.push_back(scoped_classes[scope_key(scope_parents[class_scopes[pos]], split(names[pos]).name)]);
+
+        for(std::size_t pos = 0; pos < classes.size(); ++pos) {
+
+            const srcuml_class & aclass = *classes[pos];
+            std::size_t scope = class_scopes[pos];
+
+            for(srcuml_symbol parent : aclass.get_parents()) {
+                // a class is not its own scope for the names of its parents
+                std::size_t index = find(parent, scope_parents[scope]);
+                if(index != NO_CLASS)
+                    parents.push_back(index);
+            }
+            parent_offsets.push_back(parents.size());
+
+            for(srcuml_symbol dependency : aclass.get_dependency_types()) {
+                std::size_t index = find(dependency, scope);
+                if(index != NO_CLASS)
+                    dependencies.push_back(index);
+            }
+            dependency_offsets.push_back(dependencies.size());
+
+            for(const srcuml_attribute & attribute : aclass.get_attributes())
+                attribute_classes.push_back(find(attribute.get_type().get_qualified_symbol(), scope));
+            attribute_offsets.push_back(attribute_classes.size());
+
+        }
+
+    }
+
+    std::size_t size() const {
+        return names.size();
+    }
+
+    /** qualified name symbol */
+    srcuml_symbol get_name(std::size_t index) const {
+        return names[index];
+    }
+
+    /** the class the qualified name of a class resolves to */
+    std::size_t get_canonical(std::size_t index) const {
+        return canonical[index];
+    }
+
+    /** false for an earlier class with the same qualified name as a later one */
+    bool is_indexed(std::size_t index) const {
+        return canonical[index] == index;
+    }
+    bool has_flag(std::size_t index, class_flag flag) const {
+        return flags[index] & flag;
+    }
+
+    void set_flag(std::size_t index, class_flag flag, bool value) {
+
+        if(value)
+            flags[index] |= flag;
+        else
+            flags[index] &= ~flag;
+
+    }
+
+    srcuml_index_range get_parents(std::size_t index) const {
+        return range(parents, parent_offsets, index);
+    }
+
+    srcuml_index_range get_dependencies(std::size_t index) const {
+        return range(dependencies, dependency_offsets, index);
+    }
+
+    srcuml_index_range get_attribute_classes(std::size_t index) const {
+        return range(attribute_classes, attribute_offsets, index);
+    }
+
+private:
+
+    /** NO_CLASS if no class has the name */
+    std::size_t find(srcuml_symbol reference, std::size_t scope) {
+
+        const qualified_name & name = split(reference);
+
+        while(true) {
+
+            std::size_t target = scope;
+            for(srcuml_symbol component : name.qualifier) {
+
+                std::unordered_map<scope_key, std::size_t, scope_key_hash>::const_iterator itr = child_scopes.find(scope_key(target, component));
+                if(itr == child_scopes.end()) {
+                    target = NO_CLASS;
+                    break;
+                }
+
+                target = itr->second;
+
+            }
+
+            if(target != NO_CLASS) {
+
+                std::unordered_map<scope_key, std::size_t, scope_key_hash>::const_iterator itr = scoped_classes.find(scope_key(target, name.name));
+                if(itr != scoped_classes.end())
+                    return itr->second;
+
+            }
+
+            if(scope == GLOBAL_SCOPE)
+                break;
+
+            scope = scope_parents[scope];
+
+        }
+
+        std::unordered_map<srcuml_symbol, std::size_t>::const_iterator itr = simple_classes.find(name.name);
+        return itr == simple_classes.end() ? NO_CLASS : itr->second;
+
+    }
+
+    std::size_t add_scope(std::size_t parent, srcuml_symbol name) {
+
+        std::pair<std::unordered_map<scope_key, std::size_t, scope_key_hash>::iterator, bool> inserted
+            = child_scopes.emplace(scope_key(parent, name), scope_parents.size());
+        if(inserted.second)
+            scope_parents.push_back(parent);
+
+        return inserted.first->second;
+
+    }
+
+    const qualified_name & split(srcuml_symbol symbol) {
+
+        std::unordered_map<srcuml_symbol, qualified_name>::iterator itr = split_names.find(symbol);
+        if(itr != split_names.end())
+            return itr->second;
+
+        const std::string & str = srcuml::symbol_name(symbol);
+
+        qualified_name name;
+        std::size_t start = 0;
+        int depth = 0;
+        for(std::size_t pos = 0; pos < str.size(); ++pos) {
+
+            if(str[pos] == '<') ++depth;
+            else if(str[pos] == '>') --depth;
+            else if(depth == 0 && str[pos] == ':' && pos + 1 < str.size() && str[pos + 1] == ':') {
+
+                if(pos > start)
+                    name.qualifier.push_back(srcuml::intern(str.substr(start, pos - start)));
+                start = pos + 2;
+                ++pos;
+
+            }
+
+        }
+
+        name.name = start == 0 ? symbol : srcuml::intern(str.substr(start));
+        return split_names.emplace(symbol, std::move(name)).first->second;
+
+    }
+
+    static srcuml_index_range range(const std::vector<std::size_t> & column, const std::vector<std::size_t> & offsets, std::size_t index) {
+
+        const std::size_t * data = column.data();
+        return { data + offsets[index], data + offsets[index + 1] };
+
+    }
+
+};
+
+#endif
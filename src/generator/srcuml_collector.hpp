@@ -0,0 +1,131 @@
+/**
+ * @file srcuml_collector.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_COLLECTOR_HPP
+#define INCLUDED_SRCUML_COLLECTOR_HPP
+
+#include <srcSAXEventDispatchUtilities.hpp>
+#include <ClassPolicySingleEvent.hpp>
+
+#include <srcuml_class.hpp>
+#include <srcuml_arena.hpp>
+#include <srcuml_stereotyper.hpp>
+#include <srcuml_unit_filter.hpp>
+
+#include <memory>
+#include <vector>
+#include <typeinfo>
+
+/**
+ * srcuml_collector
+ *
+ * Listener that turns each class reported by the ClassPolicy
+ * into a srcuml_class.  One is used per parsing thread.
+ */
+class srcuml_collector : public srcSAXEventDispatch::PolicyListener {
+
+private:
+
+	std::vector<std::shared_ptr<srcuml_class>> classes;
+	bool streaming;
+	bool collect_dependencies;
+	srcuml_arena * arena;
+	srcuml_stereotyper stereotyper;
+	bool classify_stereotypes;
+	// classes it does not select are dropped before they are summarized, nullptr keeps every class
+	const srcuml_unit_filter * filter;
+
+public:
+
+	/** with an arena, classes are allocated from it and it must outlive them */
+	srcuml_collector(bool streaming = false, bool collect_dependencies = true, srcuml_arena * arena = nullptr, bool classify_stereotypes = false,
+					 const srcuml_unit_filter * filter = nullptr)
+		: classes(), streaming(streaming), collect_dependencies(collect_dependencies), arena(arena), stereotyper(), classify_stereotypes(classify_stereotypes),
+		  filter(filter) {}
+
+	std::vector<std::shared_ptr<srcuml_class>> & get_classes() {
+		return classes;
+	}
+
+	/** to give the dispatcher, nullptr unless classifying stereotypes */
+	srcuml_stereotyper * get_stereotyper() {
+		return classify_stereotypes ? &stereotyper : nullptr;
+	}
+
+	static void collect(const srcSAXEventDispatch::PolicyDispatcher * policy,
+						std::vector<std::shared_ptr<srcuml_class>> & classes,
+						bool streaming, bool collect_dependencies = true, srcuml_arena * arena = nullptr,
+						const std::string & filename = "", const srcuml_stereotyper * stereotyper = nullptr,
+						const srcuml_unit_filter * filter = nullptr) {
+
+		ClassPolicy::ClassData * class_data = class_data_of(policy);
+		if(!class_data)
+			return;
+
+		std::shared_ptr<srcuml_class> aclass = summarize(class_data, streaming, collect_dependencies, arena, filename, stereotyper, filter);
+		if(aclass)
+			classes.push_back(aclass);
+
+	}
+
+	/** the data of a named class reported by the ClassPolicy, nullptr for any other policy */
+	static ClassPolicy::ClassData * class_data_of(const srcSAXEventDispatch::PolicyDispatcher * policy) {
+
+		if(typeid(ClassPolicy) != typeid(*policy))
+			return nullptr;
+
+		ClassPolicy::ClassData * class_data = policy->Data<ClassPolicy::ClassData>();
+		return class_data && class_data->name ? class_data : nullptr;
+
+	}
+
+	/** the class of class_data, which it takes, nullptr if the filter drops it */
+	static std::shared_ptr<srcuml_class> summarize(ClassPolicy::ClassData * class_data, bool streaming, bool collect_dependencies,
+												   srcuml_arena * arena, const std::string & filename,
+												   const srcuml_stereotyper * stereotyper, const srcuml_unit_filter * filter) {
+
+		if(filter && filter->has_class_rules() && !filter->selects_class(srcuml_class::qualified_name(class_data))) {
+			delete class_data;
+			return nullptr;
+		}
+
+		if(stereotyper)
+			stereotyper->apply(class_data);
+
+		std::shared_ptr<srcuml_class> aclass = arena
+			? std::allocate_shared<srcuml_class>(srcuml_arena_allocator<srcuml_class>(*arena), class_data, collect_dependencies, filename)
+			: std::make_shared<srcuml_class>(class_data, collect_dependencies, filename);
+		if(streaming)
+			aclass->release_data();
+
+		return aclass;
+
+	}
+
+	virtual void Notify(const srcSAXEventDispatch::PolicyDispatcher * policy, const srcSAXEventDispatch::srcSAXEventContext & ctx) override {
+		collect(policy, classes, streaming, collect_dependencies, arena, ctx.currentFilePath, get_stereotyper(), filter);
+	}
+
+	virtual void NotifyWrite(const srcSAXEventDispatch::PolicyDispatcher * policy, srcSAXEventDispatch::srcSAXEventContext & ctx) override {}
+
+};
+
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file srcuml_container.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_CONTAINER_HPP
+#define INCLUDED_SRCUML_CONTAINER_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/** how a template base such as std::vector affects multiplicity and ownership */
+enum container_kind { NOT_CONTAINER,
+                      VECTOR, LIST, DEQUE, FORWARD_LIST, STACK, QUEUE, PRIORITY_QUEUE, ARRAY,
+                      SET, MAP, UNORDERED_SET, UNORDERED_MAP,
+                      AUTO_PTR, SHARED_PTR, UNIQUE_PTR, SCOPED_PTR };
+
+namespace srcuml {
+
+struct container_name {
+
+    const char * name;
+    container_kind kind;
+
+};
+
+/** standard containers and smart pointers, the config names them the same way */
+constexpr container_name builtin_containers[] = {
+
+    { "vector", VECTOR }, { "list", LIST }, { "deque", DEQUE }, { "forward_list", FORWARD_LIST },
+    { "stack", STACK }, { "queue", QUEUE }, { "priority_queue", PRIORITY_QUEUE }, { "array", ARRAY },
+    { "set", SET }, { "map", MAP }, { "unordered_set", UNORDERED_SET }, { "unordered_map", UNORDERED_MAP },
+    { "auto_ptr", AUTO_PTR }, { "shared_ptr", SHARED_PTR }, { "unique_ptr", UNIQUE_PTR }, { "scoped_ptr", SCOPED_PTR }
+
+};
+
+constexpr std::size_t number_builtin_containers = sizeof(builtin_containers) / sizeof(builtin_containers[0]);
+
+/** FNV-1a with an offset basis chosen so the built-in names do not collide, usable at compile time */
+constexpr std::uint32_t container_hash(const char * str, std::size_t size) {
+
+    std::uint32_t value = 2166136261u + 14;
+    for(std::size_t pos = 0; pos < size; ++pos) {
+        value ^= static_cast<unsigned char>(str[pos]);
+        value *= 16777619u;
+    }
+
+    return value;
+
+}
+
+constexpr std::size_t string_length(const char * str) {
+
+    std::size_t size = 0;
+    while(str[size])
+        ++size;
+
+    return size;
+
+}
+
+/**
+ * Perfect hash of the built-in names: each name owns its own slot, so a lookup
+ * is one hash, one slot and one string compare.
+ */
+struct container_table {
+
+    static constexpr std::size_t SLOTS = 64;
+
+    // index into builtin_containers + 1, 0 for an empty slot
+    std::size_t slots[SLOTS];
+
+    constexpr container_table() : slots() {
+
+        for(std::size_t pos = 0; pos < number_builtin_containers; ++pos) {
+
+            const char * name = builtin_containers[pos].name;
+            slots[container_hash(name, string_length(name)) % SLOTS] = pos + 1;
+
+        }
+
+    }
+
+    constexpr bool is_perfect() const {
+
+        std::size_t used = 0;
+        for(std::size_t pos = 0; pos < SLOTS; ++pos)
+            if(slots[pos])
+                ++used;
+
+        return used == number_builtin_containers;
+
+    }
+
+};
+
+constexpr container_table builtin_container_table;
+static_assert(builtin_container_table.is_perfect(), "built-in container names collide in the table");
+
+inline container_kind builtin_container_kind(const std::string & name) {
+
+    std::size_t slot = builtin_container_table.slots[container_hash(name.data(), name.size()) % container_table::SLOTS];
+    if(slot && name == builtin_containers[slot - 1].name)
+        return builtin_containers[slot - 1].kind;
+
+    return NOT_CONTAINER;
+
+}
+
+}
+
+/**
+ * srcuml_container_registry
+ *
+ * Template bases classified as containers or smart pointers: the built-in table
+ * plus user names, e.g. absl::flat_hash_map behaving like unordered_map.
+ * User names must be added before parsing starts; lookups are read-only.
+ */
+class srcuml_container_registry {
+
+private:
+
+    std::unordered_map<std::string, container_kind> names;
+    // names ending in '*' match by prefix, e.g. F14*
+    std::vector<std::pair<std::string, container_kind>> prefixes;
+
+    // changes with every user name, so cached extractions can tell configurations apart
+    std::uint64_t fingerprint;
+
+    srcuml_container_registry() : names(), prefixes(), fingerprint(0) {}
+
+public:
+
+    static srcuml_container_registry & instance() {
+
+        static srcuml_container_registry registry;
+        return registry;
+
+    }
+
+    container_kind lookup(const std::string & name) const {
+
+        container_kind kind = srcuml::builtin_container_kind(name);
+        if(kind != NOT_CONTAINER || (names.empty() && prefixes.empty()))
+            return kind;
+
+        std::unordered_map<std::string, container_kind>::const_iterator itr = names.find(name);
+        if(itr != names.end())
+            return itr->second;
+
+        for(const std::pair<std::string, container_kind> & prefix : prefixes)
+            if(name.compare(0, prefix.first.size(), prefix.first) == 0)
+                return prefix.second;
+
+        return NOT_CONTAINER;
+
+    }
+
+    std::uint64_t get_fingerprint() const {
+        return fingerprint;
+    }
+
+    /** like_name is the built-in the type behaves like, qualifiers are dropped from name */
+    void add(std::string name, const std::string & like_name) {
+
+        container_kind kind = srcuml::builtin_container_kind(like_name);
+        if(kind == NOT_CONTAINER)
+            throw std::string("Error: Unknown container kind ") + like_name + " for " + name;
+
+        fingerprint = fingerprint * 31 + srcuml::container_hash(name.data(), name.size()) + kind;
+
+        // types are matched by their last name
+        std::string::size_type scope = name.rfind("::");
+        if(scope != std::string::npos)
+            name = name.substr(scope + 2);
+
+        if(!name.empty() && name.back() == '*') {
+
+            name.pop_back();
+            prefixes.emplace_back(name, kind);
+
+        } else {
+
+            names[name] = kind;
+
+        }
+
+    }
+
+    /** one "name kind" pair per line, # starts a comment */
+    void load(const std::string & filename) {
+
+        std::ifstream in(filename);
+        if(!in)
+            throw std::string("Error: Unable to open ") + filename;
+
+        std::string line;
+        while(std::getline(in, line)) {
+
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream fields(line);
+            std::string name, like_name;
+            if(!(fields >> name))
+                continue;
+
+            if(!(fields >> like_name))
+                throw std::string("Error: Missing container kind for ") + name + " in " + filename;
+
+            add(name, like_name);
+
+        }
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,255 @@
+/**
+ * @file srcuml_diff.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_DIFF_HPP
+#define INCLUDED_SRCUML_DIFF_HPP
+
+#include <srcuml_model.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <cstdint>
+
+/**
+ * srcuml_diff
+ *
+ * What changed architecturally between two models, e.g. saved with
+ * --emit-model before and after a change.  Classes are matched by name and
+ * compared by a hash of what a diagram shows of them, relationships are
+ * matched as a whole.  The model of the diff has the changed classes and
+ * relationships, marked, and the classes and relationships one hop from a
+ * changed class, unmarked, so only they are laid out.
+ */
+class srcuml_diff {
+
+public:
+
+    enum change { UNCHANGED, ADDED, REMOVED, MODIFIED };
+
+private:
+
+    struct relationship_hash {
+
+        std::size_t operator()(const srcuml_relationship & relationship) const {
+            return ((relationship.source * 31 + relationship.destination) * 31 + relationship.label) * 31 + relationship.type;
+        }
+
+    };
+
+    typedef std::unordered_map<srcuml_symbol, std::shared_ptr<srcuml_class>> class_table;
+    typedef std::unordered_map<srcuml_symbol, std::vector<const srcuml_relationship *>> relationship_table;
+
+    // by change
+    std::size_t class_changes[4];
+    std::size_t relationship_changes[4];
+
+    std::vector<std::shared_ptr<srcuml_class>> classes;
+    std::vector<srcuml_relationship> relationships;
+
+    /** what a diagram shows of a class */
+    static std::uint64_t signature(const srcuml_class & aclass) {
+
+        std::string shown = aclass.get_srcuml_name();
+        for(const std::vector<srcuml_member_label> * labels : { &aclass.get_attribute_labels(), &aclass.get_operation_labels() }) {
+
+            shown += '|';
+            for(const srcuml_member_label & label : *labels) {
+                shown += label.is_static ? "$" : ";";
+                shown += label.text;
+            }
+
+        }
+
+        return srcuml::hash(shown.data(), shown.size());
+
+    }
+
+    static class_table index_classes(std::vector<std::shared_ptr<srcuml_class>> & classes) {
+
+        class_table table;
+        table.reserve(classes.size());
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            table.emplace(aclass->get_name_symbol(), aclass);
+
+        return table;
+
+    }
+
+    /** relationships by each of their ends */
+    static relationship_table index_relationships(const std::vector<srcuml_relationship> & relationships) {
+
+        relationship_table table;
+        for(const srcuml_relationship & relationship : relationships) {
+            table[relationship.source].push_back(&relationship);
+            if(relationship.destination != relationship.source)
+                table[relationship.destination].push_back(&relationship);
+        }
+
+        return table;
+
+    }
+
+    static const char * marker(change kind) {
+
+        switch(kind) {
+            case ADDED:    return " «added»";
+            case REMOVED:  return " «removed»";
+            case MODIFIED: return " «modified»";
+            default:       return "";
+        }
+
+    }
+
+public:
+
+    srcuml_diff(srcuml_model & base, srcuml_model & head)
+        : class_changes(), relationship_changes(), classes(), relationships() {
+
+        const class_table base_classes = index_classes(base.get_classes());
+        const class_table head_classes = index_classes(head.get_classes());
+
+        // changed classes in the order of head, then those removed in the order of base
+        std::vector<std::pair<srcuml_symbol, change>> changed;
+        for(const std::shared_ptr<srcuml_class> & aclass : head.get_classes()) {
+
+            class_table::const_iterator before = base_classes.find(aclass->get_name_symbol());
+            if(before == base_classes.end())
+                changed.emplace_back(aclass->get_name_symbol(), ADDED);
+            else if(signature(*before->second) != signature(*aclass))
+                changed.emplace_back(aclass->get_name_symbol(), MODIFIED);
+
+        }
+
+        for(const std::shared_ptr<srcuml_class> & aclass : base.get_classes())
+            if(!head_classes.count(aclass->get_name_symbol()))
+                changed.emplace_back(aclass->get_name_symbol(), REMOVED);
+
+        const std::unordered_set<srcuml_relationship, relationship_hash> base_set(base.get_relationships().begin(), base.get_relationships().end());
+        const std::unordered_set<srcuml_relationship, relationship_hash> head_set(head.get_relationships().begin(), head.get_relationships().end());
+
+        // kept relationships, then added ones, then removed ones
+        std::vector<std::pair<const srcuml_relationship *, change>> shown;
+        std::unordered_set<srcuml_symbol> touched;
+        for(const srcuml_relationship & relationship : head.get_relationships())
+            if(!base_set.count(relationship)) {
+                shown.emplace_back(&relationship, ADDED);
+                touched.insert(relationship.source);
+                touched.insert(relationship.destination);
+            }
+
+        for(const srcuml_relationship & relationship : base.get_relationships())
+            if(!head_set.count(relationship)) {
+                shown.emplace_back(&relationship, REMOVED);
+                touched.insert(relationship.source);
+                touched.insert(relationship.destination);
+            }
+
+        for(const std::pair<const srcuml_relationship *, change> & relationship : shown)
+            ++relationship_changes[relationship.second];
+
+        // unchanged relationships of changed classes are their context
+        const relationship_table head_ends = index_relationships(head.get_relationships());
+        std::unordered_set<const srcuml_relationship *> context;
+        for(const std::pair<srcuml_symbol, change> & aclass : changed) {
+
+            touched.insert(aclass.first);
+            if(aclass.second == REMOVED)
+                continue;
+
+            relationship_table::const_iterator ends = head_ends.find(aclass.first);
+            if(ends == head_ends.end())
+                continue;
+
+            for(const srcuml_relationship * relationship : ends->second)
+                if(base_set.count(*relationship) && context.insert(relationship).second) {
+                    shown.emplace_back(relationship, UNCHANGED);
+                    touched.insert(relationship->source);
+                    touched.insert(relationship->destination);
+                }
+
+        }
+
+        // every class shown, marked if it changed
+        std::unordered_map<srcuml_symbol, srcuml_symbol> names;
+        for(const std::pair<srcuml_symbol, change> & aclass : changed) {
+
+            ++class_changes[aclass.second];
+
+            const std::shared_ptr<srcuml_class> & shown_class = aclass.second == REMOVED ? base_classes.at(aclass.first) : head_classes.at(aclass.first);
+            classes.push_back(std::make_shared<srcuml_class>(shown_class->get_name() + marker(aclass.second),
+                                                             shown_class->get_is_interface(), shown_class->get_is_abstract(), shown_class->get_is_datatype(),
+                                                             shown_class->get_attribute_labels(), shown_class->get_operation_labels(),
+                                                             shown_class->get_has_field(), shown_class->get_has_method()));
+            names.emplace(aclass.first, classes.back()->get_name_symbol());
+
+        }
+
+        for(const std::shared_ptr<srcuml_class> & aclass : head.get_classes())
+            if(touched.count(aclass->get_name_symbol()) && names.emplace(aclass->get_name_symbol(), aclass->get_name_symbol()).second) {
+                classes.push_back(aclass);
+                ++class_changes[UNCHANGED];
+            }
+
+        for(const std::pair<const srcuml_relationship *, change> & relationship : shown) {
+
+            std::unordered_map<srcuml_symbol, srcuml_symbol>::const_iterator source = names.find(relationship.first->source);
+            std::unordered_map<srcuml_symbol, srcuml_symbol>::const_iterator destination = names.find(relationship.first->destination);
+            if(source == names.end() || destination == names.end())
+                continue;
+
+            srcuml_symbol label = relationship.first->label;
+            if(relationship.second != UNCHANGED)
+                label = srcuml::intern(std::string(marker(relationship.second) + 1) + (label ? " " + relationship.first->get_label() : ""));
+
+            relationships.emplace_back(source->second, destination->second, relationship.first->type, label);
+
+        }
+
+    }
+
+    /** the classes to lay out and their relationships, already analyzed */
+    srcuml_model get_model() const {
+        return srcuml_model(classes, relationships);
+    }
+
+    /** classes of a kind of change, UNCHANGED counts those shown as context */
+    std::size_t get_classes(change kind) const {
+        return class_changes[kind];
+    }
+
+    /** relationships of a kind of change, never MODIFIED */
+    std::size_t get_relationships(change kind) const {
+        return relationship_changes[kind];
+    }
+
+    bool is_empty() const {
+        return class_changes[ADDED] + class_changes[REMOVED] + class_changes[MODIFIED]
+             + relationship_changes[ADDED] + relationship_changes[REMOVED] == 0;
+    }
+
+};
+
+#endif
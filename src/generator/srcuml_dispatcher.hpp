@@ -23,6 +23,36 @@
 #define INCLUDED_SRCUML_DISPATCHER_HPP
 
 #include <srcSAXSingleEventDispatcher.hpp>
+#include <srcuml_cancel.hpp>
+#include <srcuml_stereotyper.hpp>
+#include <srcuml_unit_filter.hpp>
+#include <srcuml_trace.hpp>
+
+#include <string>
+#include <memory>
+#include <cstring>
+
+/**
+ * Which srcML events are dispatched to the policies.
+ *
+ * FULL_PROFILE keeps everything the relationships use.
+ * DEPENDENCIES_PROFILE also drops statement events inside bodies, keeping decl statements.
+ * STRUCTURE_ONLY_PROFILE prunes like DEPENDENCIES_PROFILE and skips the dependency pass.
+ */
+enum event_profile { FULL_PROFILE, DEPENDENCIES_PROFILE, STRUCTURE_ONLY_PROFILE };
+
+inline event_profile parse_event_profile(const std::string & profile) {
+
+    if(profile == "full")
+        return FULL_PROFILE;
+    if(profile == "dependencies")
+        return DEPENDENCIES_PROFILE;
+    if(profile == "structure-only")
+        return STRUCTURE_ONLY_PROFILE;
+
+    throw std::string("Error: Unknown profile ") + profile + ". Can be {full, dependencies, structure-only}";
+
+}
 
 template <typename ...policies>
 class srcuml_dispatcher : public srcSAXEventDispatch::srcSAXSingleEventDispatcher<policies...> {
@@ -30,11 +60,134 @@ class srcuml_dispatcher : public srcSAXEventDispatch::srcSAXSingleEventDispatche
 private:
     bool dispatched;
 
+    // the parser is stopped once it is cancelled, checked every CANCEL_INTERVAL elements
+    const srcuml_cancel * cancel;
+    std::size_t elements;
+
+    enum : std::size_t { CANCEL_INTERVAL = 1024 };
+
+    // classifies the method stereotypes from the raw events, whatever the profile, nullptr classifies none
+    srcuml_stereotyper * stereotyper;
+
+    // units whose filename it does not select are not dispatched, nullptr dispatches every unit
+    const srcuml_unit_filter * filter;
+    bool is_skipping_unit;
+
+    // the unit being dispatched, only while a srcuml_trace is started
+    std::unique_ptr<srcuml_trace::span> unit_span;
+
 public:
 
-   srcuml_dispatcher(srcSAXEventDispatch::PolicyListener * listener)
-        : srcSAXEventDispatch::srcSAXSingleEventDispatcher<policies...>(listener) {
+   srcuml_dispatcher(srcSAXEventDispatch::PolicyListener * listener, event_profile profile = FULL_PROFILE, const srcuml_cancel * cancel = nullptr,
+                     srcuml_stereotyper * stereotyper = nullptr, const srcuml_unit_filter * filter = nullptr)
+        : srcSAXEventDispatch::srcSAXSingleEventDispatcher<policies...>(listener), cancel(cancel), elements(0), stereotyper(stereotyper),
+          filter(filter && filter->has_path_rules() ? filter : nullptr), is_skipping_unit(false), unit_span() {
        srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::RemoveEvents({"if", "for", "while", "typedef", "call", "macro", "init", "expr_stmt", "member_list" });
+
+       if(profile != FULL_PROFILE) {
+           srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::RemoveEvents({"return", "switch", "case", "default", "do", "try", "catch", "throw",
+                                                                                  "break", "continue", "goto", "label", "lambda",
+                                                                                  "condition", "then", "else", "elseif", "control", "incr" });
+       }
+   }
+
+   /** true if the parse was stopped by the cancellation token */
+   bool is_stopped() const {
+       return srcuml_cancel::is_cancelled(cancel);
+   }
+
+   virtual void startUnit(const char * localname, const char * prefix, const char * URI,
+                          int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                          const struct srcsax_attribute * attributes) override {
+
+       if(srcuml_cancel::is_cancelled(cancel)) {
+           srcSAXHandler::stop_parser();
+           return;
+       }
+
+       if(filter && !filter->selects_path(unit_filename(num_attributes, attributes))) {
+           is_skipping_unit = true;
+           return;
+       }
+
+       if(stereotyper)
+           stereotyper->start_unit();
+
+       if(srcuml_trace::instance().is_started()) {
+           unit_span.reset(new srcuml_trace::span("unit", "parse"));
+           unit_span->set_detail(unit_filename(num_attributes, attributes));
+       }
+
+       srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::startUnit(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+   }
+
+   virtual void endUnit(const char * localname, const char * prefix, const char * URI) override {
+
+       if(is_skipping_unit) {
+           is_skipping_unit = false;
+           return;
+       }
+
+       srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::endUnit(localname, prefix, URI);
+       unit_span.reset();
+
+   }
+
+   virtual void startElement(const char * localname, const char * prefix, const char * URI,
+                             int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                             const struct srcsax_attribute * attributes) override {
+
+       if(cancel && ++elements % CANCEL_INTERVAL == 0 && cancel->is_cancelled()) {
+           srcSAXHandler::stop_parser();
+           return;
+       }
+
+       if(is_skipping_unit)
+           return;
+
+       if(stereotyper)
+           stereotyper->start_element(localname);
+
+       srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::startElement(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+   }
+
+   /** the stereotyper sees the end of a class before the policy reports the class */
+   virtual void endElement(const char * localname, const char * prefix, const char * URI) override {
+
+       if(is_skipping_unit)
+           return;
+
+       if(stereotyper)
+           stereotyper->end_element();
+
+       srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::endElement(localname, prefix, URI);
+
+   }
+
+   virtual void charactersUnit(const char * ch, int len) override {
+
+       if(is_skipping_unit)
+           return;
+
+       if(stereotyper)
+           stereotyper->characters(ch, len);
+
+       srcSAXEventDispatch::srcSAXEventDispatcher<policies...>::charactersUnit(ch, len);
+
+   }
+
+private:
+
+   static const char * unit_filename(int num_attributes, const struct srcsax_attribute * attributes) {
+
+       for(int pos = 0; pos < num_attributes; ++pos)
+           if(std::strcmp(attributes[pos].localname, "filename") == 0)
+               return attributes[pos].value;
+
+       return "";
+
    }
 
 };
@@ -0,0 +1,251 @@
+/**
+ * @file srcuml_edge_filter.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_EDGE_FILTER_HPP
+#define INCLUDED_SRCUML_EDGE_FILTER_HPP
+
+#include <srcuml_relationship.hpp>
+#include <srcuml_symbol.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <string>
+#include <vector>
+
+/** edge detail removed by a srcuml_edge_filter, bits */
+enum edge_detail { IMPLIED_DEPENDENCIES = 1 << 0, TRANSITIVE_DEPENDENCIES = 1 << 1, CLUSTER_BUNDLES = 1 << 2 };
+
+/** comma separated list, e.g. implied,transitive */
+inline unsigned parse_edge_detail(const std::string & detail) {
+
+    unsigned bits = 0;
+    for(const std::string & name : srcuml::split(detail, ',')) {
+
+        if(name == "implied")
+            bits |= IMPLIED_DEPENDENCIES;
+        else if(name == "transitive")
+            bits |= TRANSITIVE_DEPENDENCIES;
+        else if(name == "bundle")
+            bits |= CLUSTER_BUNDLES;
+        else if(!name.empty())
+            throw std::string("Error: Unknown edge aggregation ") + name + ". Can be {implied, transitive, bundle}";
+
+    }
+
+    return bits;
+
+}
+
+/**
+ * srcuml_edge_filter
+ *
+ * Level of detail applied to merged edges before they reach a layout:
+ *  - implied: a dependency between classes that also have a structural
+ *    relationship is drawn as that relationship,
+ *  - transitive: a dependency a -> c is dropped while edges a -> b -> c remain,
+ *  - bundle: edges between the same two namespaces become one edge weighted
+ *    by the number of edges it stands for.
+ * Edges keep their order.
+ */
+class srcuml_edge_filter {
+
+private:
+
+    unsigned detail;
+
+public:
+
+    srcuml_edge_filter(unsigned detail = 0) : detail(detail) {}
+
+    bool is_empty() const {
+        return detail == 0;
+    }
+
+    /** edges merged from relationships, directed as they were merged */
+    std::vector<srcuml_edge> apply(std::vector<srcuml_edge> edges, const std::vector<srcuml_relationship> & relationships, bool directed) const {
+
+        if(detail & IMPLIED_DEPENDENCIES)
+            drop_implied(edges, relationships, directed);
+
+        if(detail & TRANSITIVE_DEPENDENCIES)
+            drop_transitive(edges);
+
+        if(detail & CLUSTER_BUNDLES)
+            bundle(edges, directed);
+
+        return edges;
+
+    }
+
+private:
+
+    typedef std::pair<srcuml_symbol, srcuml_symbol> symbol_pair;
+    typedef srcuml_relationships::symbol_pair_hash symbol_pair_hash;
+
+    static symbol_pair key(srcuml_symbol source, srcuml_symbol destination, bool directed) {
+
+        if(!directed && destination < source)
+            return symbol_pair(destination, source);
+
+        return symbol_pair(source, destination);
+
+    }
+
+    static void drop_implied(std::vector<srcuml_edge> & edges, const std::vector<srcuml_relationship> & relationships, bool directed) {
+
+        // strongest structural relationship of each pair, the first unless a later association is stronger
+        std::unordered_map<symbol_pair, const srcuml_relationship *, symbol_pair_hash> structural;
+        for(const srcuml_relationship & relationship : relationships) {
+
+            if(relationship.get_type() == DEPENDENCY)
+                continue;
+
+            const srcuml_relationship *& strongest = structural[key(relationship.get_source_symbol(), relationship.get_destination_symbol(), directed)];
+            if(!strongest
+                || (srcuml_relationships::association_strength(strongest->get_type())
+                    && srcuml_relationships::association_strength(relationship.get_type()) > srcuml_relationships::association_strength(strongest->get_type())))
+                strongest = &relationship;
+
+        }
+
+        for(srcuml_edge & edge : edges) {
+
+            if(edge.type != DEPENDENCY)
+                continue;
+
+            std::unordered_map<symbol_pair, const srcuml_relationship *, symbol_pair_hash>::const_iterator itr
+                = structural.find(key(edge.source, edge.destination, directed));
+            if(itr == structural.end())
+                continue;
+
+            edge.source = itr->second->get_source_symbol();
+            edge.destination = itr->second->get_destination_symbol();
+            edge.type = itr->second->get_type();
+
+        }
+
+    }
+
+    /** in edge order against the edges still kept, so every dropped dependency stays reachable */
+    static void drop_transitive(std::vector<srcuml_edge> & edges) {
+
+        std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>> targets;
+        for(const srcuml_edge & edge : edges)
+            targets[edge.source].insert(edge.destination);
+
+        std::vector<srcuml_edge> kept;
+        kept.reserve(edges.size());
+        for(const srcuml_edge & edge : edges) {
+
+            if(edge.type != DEPENDENCY || edge.source == edge.destination || !has_path(targets, edge.source, edge.destination)) {
+                kept.push_back(edge);
+                continue;
+            }
+
+            targets[edge.source].erase(edge.destination);
+
+        }
+
+        edges.swap(kept);
+
+    }
+
+    /** path source -> between -> destination of two edges */
+    static bool has_path(const std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>> & targets,
+                         srcuml_symbol source, srcuml_symbol destination) {
+
+        for(srcuml_symbol between : targets.at(source)) {
+
+            if(between == source || between == destination)
+                continue;
+
+            std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>>::const_iterator itr = targets.find(between);
+            if(itr != targets.end() && itr->second.count(destination))
+                return true;
+
+        }
+
+        return false;
+
+    }
+
+    static void bundle(std::vector<srcuml_edge> & edges, bool directed) {
+
+        std::unordered_map<srcuml_symbol, srcuml_symbol> namespaces;
+        auto namespace_of = [&namespaces](srcuml_symbol symbol) {
+
+            std::unordered_map<srcuml_symbol, srcuml_symbol>::const_iterator itr = namespaces.find(symbol);
+            if(itr == namespaces.end())
+                itr = namespaces.emplace(symbol, srcuml::intern(qualifier(srcuml::symbol_name(symbol)))).first;
+
+            return itr->second;
+
+        };
+
+        std::unordered_map<symbol_pair, std::size_t, symbol_pair_hash> bundles;
+        std::vector<srcuml_edge> kept;
+        kept.reserve(edges.size());
+        for(const srcuml_edge & edge : edges) {
+
+            srcuml_symbol source_namespace = namespace_of(edge.source);
+            srcuml_symbol destination_namespace = namespace_of(edge.destination);
+            if(source_namespace == destination_namespace) {
+                kept.push_back(edge);
+                continue;
+            }
+
+            std::pair<std::unordered_map<symbol_pair, std::size_t, symbol_pair_hash>::iterator, bool> inserted
+                = bundles.emplace(key(source_namespace, destination_namespace, directed), kept.size());
+            if(inserted.second)
+                kept.push_back(edge);
+            else
+                kept[inserted.first->second].weight += edge.weight;
+
+        }
+
+        edges.swap(kept);
+
+    }
+
+    /** everything before the last :: outside template arguments, empty for the global namespace */
+    static std::string qualifier(const std::string & name) {
+
+        std::size_t depth = 0, last = std::string::npos;
+        for(std::size_t pos = 0; pos + 1 < name.size(); ++pos) {
+
+            if(name[pos] == '<')
+                ++depth;
+            else if(name[pos] == '>' && depth)
+                --depth;
+            else if(depth == 0 && name[pos] == ':' && name[pos + 1] == ':')
+                last = pos++;
+
+        }
+
+        return last == std::string::npos ? std::string() : name.substr(0, last);
+
+    }
+
+};
+
+#endif
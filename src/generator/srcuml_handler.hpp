@@ -28,21 +28,48 @@
 #include <srcuml_dispatcher.hpp>
 #include <ClassPolicySingleEvent.hpp>
 
+#include <libxml/parser.h>
+
+#include <srcuml_options.hpp>
+#include <srcuml_input.hpp>
+#include <srcuml_source.hpp>
+#include <srcuml_cache.hpp>
+#include <srcuml_model.hpp>
+#include <srcuml_collector.hpp>
+#include <srcuml_stereotyper.hpp>
+#include <srcuml_utilities.hpp>
 #include <srcuml_class.hpp>
 #include <srcuml_relationship.hpp>
+#include <srcuml_relationship_graph.hpp>
+#include <srcuml_adjacency.hpp>
+#include <srcuml_neighborhood.hpp>
+#include <srcuml_ranking.hpp>
+#include <srcuml_stats.hpp>
+#include <srcuml_allocation.hpp>
+#include <srcuml_pipeline.hpp>
 #include <dot_outputter.hpp>
 #include <yuml_outputter.hpp>
 #include <svg_sugiyama_outputter.hpp>
 #include <svg_multi_outputter.hpp>
 #include <svg_three_outputter.hpp>
+#include <svg_overview_outputter.hpp>
+#include <layout_outputter.hpp>
+#include <srcuml_output_registry.hpp>
+#include <srcuml_artifact.hpp>
 
 #include <iostream>
 #include <iomanip>
+#include <cstring>
 #include <algorithm>
 #include <memory>
 #include <map>
-
-enum output_type {dot, yuml, svg_sugiyama, svg_multi, svg_three};
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <exception>
 
 /**
  * srcuml_handler
@@ -53,44 +80,170 @@ class srcuml_handler : public srcSAXEventDispatch::PolicyListener {
 
 private:
 
+	// declared before classes so they are released after the classes allocated from them
+	std::vector<std::unique_ptr<srcuml_arena>> arenas;
+
 	std::vector<std::shared_ptr<srcuml_class>> classes;
-	output_type type;
+	std::vector<output_type> types;
+
+	srcuml_options options;
+	// from construction until output, declared after options
+	srcuml_stats::timer parse_timer{options.stats, "parse"};
+
+	bool is_analyzed;
+	std::vector<srcuml_relationship> relationships;
+
+	// method stereotypes of the serial parse, see srcuml_options::stereotypes
+	srcuml_stereotyper stereotyper;
+
+	// the phase options.cancel cut short was reported, see report_cancel
+	bool is_cancel_reported = false;
+
+	// options.memory_limit was reached while parsing, see apply_limits, read by the summarizing threads
+	std::atomic<bool> is_over_memory{false};
+	// attribute and operation lines of a class drawn before they are collapsed into counts
+	std::size_t member_lines = static_cast<std::size_t>(-1);
+
+	// classes parsed between checks of options.memory_limit
+	enum : std::size_t { MEMORY_CHECK_INTERVAL = 256 };
+
+	// a class reported by the parse on the calling thread, summarized on another, see parse(srcSAXController &)
+	// its data is freed with it if it is never summarized, e.g. once a summary failed
+	struct parsed_class {
+		std::size_t order;
+		std::unique_ptr<ClassPolicy::ClassData> data;
+		std::string filename;
+	};
+
+	// classes waiting to be summarized at most, per summarizing thread
+	enum : std::size_t { SUMMARY_QUEUE = 64 };
+
+	// where Notify hands the classes while summarizing on other threads, nullptr collects them as they are reported
+	srcuml_stage<parsed_class> * summarizer = nullptr;
+	// classes handed to summarizer so far, their document order
+	std::size_t number_handed = 0;
+
+	// text output whose classes are written while parsing, see srcuml_options::early_output
+	std::unique_ptr<srcuml_text_outputter> early_outputter;
+	std::unique_ptr<srcuml_text_sink> early_sink;
+	// classes already written to early_outputter
+	std::size_t early_classes = 0;
 
 public:
 
-	srcuml_handler(const std::string & input_str, std::ostream & out, std::string t = "svg_sugiyama") {
+	srcuml_handler(const std::string & input_str, std::ostream & out, std::string t = "svg_sugiyama", bool streaming = true)
+		: srcuml_handler(input_str, out, make_options(t, streaming)) {}
 
-		if(t == "svg_sugiyama"){
-			type = svg_sugiyama;
-		}else if(t == "dot"){
-			type = dot;
-		}else if(t == "yuml"){
-			type = yuml;
-		}else if(t == "svg_multi"){
-			type = svg_multi;
-		}else if(t == "svg_three"){
-			type = svg_three;
-		}
-		srcSAXController controller(input_str.c_str());
+	srcuml_handler(const char * input_filename, std::ostream & out, std::string t = "svg_sugiyama", bool streaming = true)
+		: srcuml_handler(input_filename, out, make_options(t, streaming)) {}
+
+	/** input_str is the srcML document itself, it is read in place */
+	srcuml_handler(const std::string & input_str, std::ostream & out, const srcuml_options & options)
+		: srcuml_handler(input_str.data(), input_str.size(), out, options) {}
+
+	/** parses an in-memory srcML document without copying it */
+	srcuml_handler(const char * buffer, std::size_t size, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {
+
+		start_early_output(out);
+		parse(buffer, size);
+		output(out);
+
+	}
+
+	/** the file is memory mapped and parsed from the mapped pages */
+	srcuml_handler(const char * input_filename, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {
+
+		srcuml_mapped_file input(input_filename);
+		start_early_output(out);
+		parse(input.get_data(), input.get_size());
+		output(out);
+
+	}
+
+	/** srcML read from a descriptor as it arrives, e.g. standard input, parsed on the calling thread */
+	srcuml_handler(srcuml_descriptor_reader & input, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {
+
+		srcSAXController controller(&input, srcuml_descriptor_reader::read, srcuml_descriptor_reader::close);
 		run(controller, out);
 
 	}
 
-	srcuml_handler(const char * input_filename, std::ostream & out, std::string t = "svg_sugiyama") {
+	/** a compressed srcML archive parsed on the calling thread as it is decompressed */
+	srcuml_handler(srcuml_compressed_reader & input, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {
+
+		srcSAXController controller(&input, srcuml_compressed_reader::read, srcuml_compressed_reader::close);
+		start_early_output(out);
+		parse(controller);
+		input.finish();
+		output(out);
+
+	}
+
+	/**
+	 * Source files and directories are converted with libsrcml and parsed from memory.
+	 * Several srcML archives, e.g. of the repositories of one system, are parsed into
+	 * one model, so relationships between their classes are found.
+	 */
+	srcuml_handler(const std::vector<std::string> & source_paths, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {
+
+		start_early_output(out);
+		add(source_paths);
+		output(out);
+
+	}
+
+	/**
+	 * Renders a model saved with options.emit_model, nothing is parsed, only a partial model is analyzed.
+	 * The classes are borrowed from the model, which outlives the handler, so their reference counts
+	 * are not written and a model shared by forked server workers stays shared.
+	 */
+	srcuml_handler(srcuml_model & model, std::ostream & out, const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options),
+		  is_analyzed(!model.get_is_partial()), relationships(model.get_relationships()) {
+
+		classes.reserve(model.get_classes().size());
+		for(const std::shared_ptr<srcuml_class> & aclass : model.get_classes())
+			classes.emplace_back(std::shared_ptr<srcuml_class>(), aclass.get());
+
+		output(out);
+
+	}
+
+	/** parses with add and renders nothing, the classes are taken with get_classes, see srcuml_session */
+	srcuml_handler(const srcuml_options & options)
+		: arenas(), classes(), types(parse_output_types(options.type)), options(options), is_analyzed(false), relationships() {}
+
+	/** an in-memory srcML document, read in place */
+	void add(const char * buffer, std::size_t size) {
+
+		parse(buffer, size);
+
+	}
+
+	/** source files and directories, converted with libsrcml, or srcML archives */
+	void add(const std::vector<std::string> & source_paths) {
+
+		if(srcuml_source::are_srcml_archives(source_paths)) {
+
+			parse_archives(source_paths);
+			return;
 
-		if(t == "svg_sugiyama"){
-			type = svg_sugiyama;
-		}else if(t == "dot"){
-			type = dot;
-		}else if(t == "yuml"){
-			type = yuml;
-		}else if(t == "svg_multi"){
-			type = svg_multi;
-		}else if(t == "svg_three"){
-			type = svg_three;
 		}
-		srcSAXController controller(input_filename);
-		run(controller, out);
+
+		srcuml_source source(source_paths, options.shard, options.filter);
+		parse(source);
+
+	}
+
+	/** the classes parsed so far, they live as long as the handler */
+	const std::vector<std::shared_ptr<srcuml_class>> & get_classes() const {
+
+		return classes;
 
 	}
 
@@ -98,80 +251,1132 @@ public:
 
 	void run(srcSAXController & controller, std::ostream & out) {
 
-		srcuml_dispatcher<ClassPolicy> dispatcher(this);
-		controller.parse(&dispatcher);
+		start_early_output(out);
+		parse(controller);
+		output(out);
+
+	}
+
+	virtual void Notify(const srcSAXEventDispatch::PolicyDispatcher * policy, const srcSAXEventDispatch::srcSAXEventContext & ctx) override {
+
+		if(summarizer) {
+
+			hand_over(policy, ctx);
+			return;
+
+		}
+
+		srcuml_collector::collect(policy, classes, options.streaming, options.profile != STRUCTURE_ONLY_PROFILE, &run_arena(), ctx.currentFilePath,
+								  options.stereotypes ? &stereotyper : nullptr, &options.filter);
+		write_early_classes();
+
+		if(classes.size() % MEMORY_CHECK_INTERVAL == 0)
+			check_memory();
+
+	}
+
+    virtual void NotifyWrite(const srcSAXEventDispatch::PolicyDispatcher * policy, srcSAXEventDispatch::srcSAXEventContext & ctx) override {
+    }
+
+
+private:
+
+	/** arenas must be created before parsing threads start */
+	srcuml_arena & new_arena() {
+
+		arenas.emplace_back(new srcuml_arena());
+		return *arenas.back();
+
+	}
+
+	/** arena for classes extracted on the calling thread */
+	srcuml_arena & run_arena() {
+
+		if(arenas.empty())
+			return new_arena();
+
+		return *arenas.front();
+
+	}
+
+	/** with options.early_output, a lone dot or yuml output has its classes written as they are parsed */
+	void start_early_output(std::ostream & out) {
+
+		if(!options.early_output || types.size() != 1 || !options.outputs.empty() || !options.focus.empty())
+			return;
+
+		if(types.front() == dot)
+			early_outputter.reset(new dot_outputter());
+		else if(types.front() == yuml)
+			early_outputter.reset(new yuml_outputter());
+		else
+			return;
+
+		early_sink.reset(new srcuml_text_sink(out));
+		early_outputter->write_header(*early_sink);
+
+	}
+
+	void write_early_classes() {
+
+		if(!early_outputter)
+			return;
+
+		for(; early_classes < classes.size(); ++early_classes)
+			early_outputter->write_class(*early_sink, *classes[early_classes]);
+
+	}
+
+	/** classes parsed on other threads or loaded from a cache are written now, then the relationships */
+	void finish_early_output() {
+
+		write_early_classes();
+		analyze();
+
+		early_outputter->use_relationships(relationships);
+		early_outputter->write_relationships(*early_sink, classes, early_outputter->analyze_relationships(classes));
+
+		early_sink.reset();
+		early_outputter.reset();
+
+	}
+
+	static srcuml_options make_options(const std::string & t, bool streaming) {
+
+		srcuml_options options;
+		options.type = t;
+		options.streaming = streaming;
+
+		return options;
+
+	}
+
+	/** a type of srcuml_output_registry by name */
+	static output_type parse_output_type(const std::string & t) {
+
+		std::size_t type;
+		if(srcuml_output_registry::instance().find(t, type))
+			return static_cast<output_type>(type);
+
+		std::cout << "Error: Output type not recognized, running svg_sugiyama\n";
+		return svg_sugiyama;
+
+	}
+
+	/** comma separated list, e.g. dot,yuml,svg_sugiyama */
+	static std::vector<output_type> parse_output_types(const std::string & t) {
+
+		std::vector<output_type> types;
+		for(const std::string & name : srcuml::split(t, ','))
+			types.push_back(parse_output_type(name));
+
+		return types;
+
+	}
+
+	void parse(const char * buffer, std::size_t size) {
+
+		if(options.cache || !options.cache_directory.empty()) {
+
+			parse_cached(buffer, size);
+			return;
+
+		}
+
+		if(is_selecting_units()) {
+
+			parse_selected(buffer, size);
+			return;
+
+		}
 
-		switch(type){
-			case svg_sugiyama:
-				{
-					std::cout << "SVG SUGIYAMA Called\n";
-					svg_sugiyama_outputter outputter;
-					outputter.output(out, classes);
+		if(options.threads > 1) {
+
+			parse_units(buffer, size);
+			return;
+
+		}
+
+		srcuml_input_reader reader(buffer, size);
+		srcSAXController controller(&reader, srcuml_input_reader::read, srcuml_input_reader::close);
+		parse(controller);
+
+	}
+
+	/**
+	 * With options.threads > 1, the classes reported are summarized and their members
+	 * rendered on the other threads while the parse goes on, through a bounded queue
+	 * so the parser cannot run ahead of memory.  Classes are merged in document order.
+	 */
+	void parse(srcSAXController & controller) {
+
+		srcuml_dispatcher<ClassPolicy> dispatcher(this, options.profile, options.cancel, options.stereotypes ? &stereotyper : nullptr, &options.filter);
+
+		// early output writes each class as it is reported
+		const std::size_t number_workers = early_outputter || options.threads < 2 ? 0 : options.threads - 1;
+		if(number_workers == 0) {
+
+			controller.parse(&dispatcher);
+			return;
+
+		}
+
+		std::vector<srcuml_arena *> worker_arenas;
+		for(std::size_t worker = 0; worker < number_workers; ++worker)
+			worker_arenas.push_back(&new_arena());
+
+		std::vector<std::vector<std::pair<std::size_t, std::shared_ptr<srcuml_class>>>> summarized(number_workers);
+		const bool streaming = options.streaming;
+		const bool collect_dependencies = options.profile != STRUCTURE_ONLY_PROFILE;
+		srcuml_stage<parsed_class> stage(number_workers, number_workers * SUMMARY_QUEUE, [&, this](parsed_class & parsed, std::size_t worker) {
+
+			std::shared_ptr<srcuml_class> aclass = srcuml_collector::summarize(parsed.data.release(), streaming || is_over_memory, collect_dependencies,
+																				worker_arenas[worker], parsed.filename, nullptr, &options.filter);
+			if(!aclass)
+				return;
+
+			aclass->get_attribute_labels();
+			summarized[worker].emplace_back(parsed.order, aclass);
+
+		});
+
+		summarizer = &stage;
+		number_handed = 0;
+		try {
+			controller.parse(&dispatcher);
+		} catch(...) {
+			summarizer = nullptr;
+			throw;
+		}
+		summarizer = nullptr;
+		stage.finish();
+
+		std::vector<std::pair<std::size_t, std::shared_ptr<srcuml_class>>> ordered;
+		for(std::vector<std::pair<std::size_t, std::shared_ptr<srcuml_class>>> & worker_classes : summarized)
+			ordered.insert(ordered.end(), worker_classes.begin(), worker_classes.end());
+
+		std::sort(ordered.begin(), ordered.end(), [](const std::pair<std::size_t, std::shared_ptr<srcuml_class>> & one,
+													 const std::pair<std::size_t, std::shared_ptr<srcuml_class>> & two) {
+			return one.first < two.first;
+		});
+
+		for(std::pair<std::size_t, std::shared_ptr<srcuml_class>> & summary : ordered)
+			classes.push_back(std::move(summary.second));
+
+	}
+
+	/** a class reported while summarizer is set, its stereotypes come from the parse so they are applied here */
+	void hand_over(const srcSAXEventDispatch::PolicyDispatcher * policy, const srcSAXEventDispatch::srcSAXEventContext & ctx) {
+
+		ClassPolicy::ClassData * class_data = srcuml_collector::class_data_of(policy);
+		if(!class_data)
+			return;
+
+		if(options.stereotypes)
+			stereotyper.apply(class_data);
+
+		summarizer->push(parsed_class{ number_handed++, std::unique_ptr<ClassPolicy::ClassData>(class_data), ctx.currentFilePath });
+
+		if(number_handed % MEMORY_CHECK_INTERVAL == 0)
+			check_memory();
+
+	}
+
+	/**
+	 * Parses the units of an archive on options.threads threads, each with its own
+	 * dispatcher.  Classes are merged in document order so the result matches a serial parse.
+	 * Each chunk is read directly out of the input buffer.
+	 */
+	void parse_units(const char * buffer, std::size_t size) {
+
+		std::vector<std::pair<std::size_t, std::size_t>> chunks;
+		std::size_t header_size = srcuml::split_unit_ranges(buffer, size, options.threads, chunks);
+		if(header_size == 0) {
+
+			srcuml_input_reader reader(buffer, size);
+			srcSAXController controller(&reader, srcuml_input_reader::read, srcuml_input_reader::close);
+			parse(controller);
+			return;
+
+		}
+
+		// libxml2 must be initialized before parsers are created on other threads
+		xmlInitParser();
+
+		std::vector<std::vector<std::shared_ptr<srcuml_class>>> chunk_classes(chunks.size());
+		std::vector<std::exception_ptr> errors(chunks.size());
+
+		std::vector<srcuml_arena *> chunk_arenas;
+		for(std::size_t pos = 0; pos < chunks.size(); ++pos)
+			chunk_arenas.push_back(&new_arena());
+
+		const int phase = srcuml_allocation::get_phase();
+
+		std::vector<std::thread> workers;
+		for(std::size_t pos = 0; pos < chunks.size(); ++pos) {
+
+			workers.emplace_back([this, pos, phase, buffer, header_size, &chunks, &chunk_classes, &chunk_arenas, &errors]() {
+
+				srcuml_allocation::phase_scope scope(phase);
+
+				try {
+
+					srcuml_input_reader reader = make_chunk_reader(buffer, header_size, chunks[pos]);
+					chunk_classes[pos] = collect_classes(reader, *chunk_arenas[pos]);
+
+				} catch(...) {
+					errors[pos] = std::current_exception();
 				}
-				break;
 
-			case svg_multi:
-				{
-					std::cout << "SVG MULTI Called\n";
-					svg_multi_outputter outputter;
-					outputter.output(out, classes);
+			});
+
+		}
+
+		for(std::thread & worker : workers)
+			worker.join();
+
+		for(std::size_t pos = 0; pos < chunks.size(); ++pos) {
+
+			if(errors[pos])
+				std::rethrow_exception(errors[pos]);
+
+			classes.insert(classes.end(), chunk_classes[pos].begin(), chunk_classes[pos].end());
+
+		}
+
+	}
+
+	/** whether only some units are parsed, by options.shard or options.filter */
+	bool is_selecting_units() const {
+
+		return options.shard.is_sharded() || options.filter.has_path_rules();
+
+	}
+
+	/** whether the unit of filename is in options.shard and selected by options.filter */
+	bool selects_unit(const std::string & filename) const {
+
+		return options.shard.contains(filename) && options.filter.selects_path(filename);
+
+	}
+
+	/**
+	 * Parses only the units selects_unit keeps, found by their filename attribute before any
+	 * is parsed, on at most options.threads threads each taking a contiguous run of them.
+	 * Classes are merged in document order.
+	 */
+	void parse_selected(const char * buffer, std::size_t size) {
+
+		std::vector<std::pair<std::size_t, std::size_t>> units;
+		std::size_t header_size = srcuml::find_unit_ranges(buffer, size, units);
+		if(units.empty()) {
+
+			// a single unit, or no srcML at all, is parsed as a whole
+			if(header_size == 0 || selects_unit(srcuml::unit_attribute(buffer, size, "filename"))) {
+
+				srcuml_input_reader reader(buffer, size);
+				srcSAXController controller(&reader, srcuml_input_reader::read, srcuml_input_reader::close);
+				parse(controller);
+
+			}
+			return;
+
+		}
+
+		std::vector<std::pair<std::size_t, std::size_t>> shard_units;
+		for(const std::pair<std::size_t, std::size_t> & unit : units)
+			if(selects_unit(srcuml::unit_attribute(buffer + unit.first, unit.second - unit.first, "filename")))
+				shard_units.push_back(unit);
+
+		const std::size_t number_runs = std::max<std::size_t>(1, std::min(options.threads, shard_units.size()));
+		if(number_runs > 1)
+			xmlInitParser();
+
+		std::vector<srcuml_arena *> run_arenas;
+		for(std::size_t run = 0; run < number_runs; ++run)
+			run_arenas.push_back(&new_arena());
+
+		std::vector<std::vector<std::shared_ptr<srcuml_class>>> run_classes(number_runs);
+		srcuml::parallel_ranges(number_runs, number_runs, [&](std::size_t first, std::size_t last) {
+
+			for(std::size_t run = first; run < last; ++run) {
+
+				const std::size_t begin = (shard_units.size() * run) / number_runs;
+				const std::size_t end = (shard_units.size() * (run + 1)) / number_runs;
+				for(std::size_t pos = begin; pos < end && !srcuml_cancel::is_cancelled(options.cancel); ++pos) {
+
+					srcuml_input_reader reader = make_chunk_reader(buffer, header_size, shard_units[pos]);
+					std::vector<std::shared_ptr<srcuml_class>> unit_classes = collect_classes(reader, *run_arenas[run]);
+					run_classes[run].insert(run_classes[run].end(), unit_classes.begin(), unit_classes.end());
+
 				}
+
+			}
+
+		});
+
+		for(const std::vector<std::shared_ptr<srcuml_class>> & shard_classes : run_classes)
+			classes.insert(classes.end(), shard_classes.begin(), shard_classes.end());
+
+	}
+
+	/**
+	 * Loads the classes of unchanged units from the cache and only dispatches the rest.
+	 * A document that is a single unit is cached as a whole.  Every class of a unit is
+	 * cached, those options.filter drops are dropped once loaded.
+	 */
+	void parse_cached(const char * buffer, std::size_t size) {
+
+		std::unique_ptr<srcuml_cache> run_cache;
+		if(!options.cache)
+			run_cache.reset(new srcuml_cache(options.cache_directory, options.profile, options.stereotypes, options.cache_memory));
+
+		srcuml_cache & cache = options.cache ? *options.cache : *run_cache;
+
+		std::vector<std::pair<std::size_t, std::size_t>> units;
+		std::size_t header_size = srcuml::find_unit_ranges(buffer, size, units);
+		if(units.empty()) {
+
+			if(is_selecting_units() && !selects_unit(srcuml::unit_attribute(buffer, size, "filename")))
+				return;
+
+			std::vector<std::shared_ptr<srcuml_class>> unit_classes;
+			const bool is_hit = cache.load(buffer, size, unit_classes);
+			count_cache_lookups(is_hit ? 1 : 0, is_hit ? 0 : 1);
+			if(!is_hit) {
+
+				srcuml_input_reader reader(buffer, size);
+				unit_classes = collect_classes(reader, run_arena(), false);
+				// a parse cut short is not cached
+				if(!srcuml_cancel::is_cancelled(options.cancel))
+					cache.store(buffer, size, unit_classes);
+
+			}
+
+			add_selected_classes(unit_classes);
+			return;
+
+		}
+
+		std::size_t hits = 0, misses = 0;
+		for(const std::pair<std::size_t, std::size_t> & unit : units) {
+
+			if(srcuml_cancel::is_cancelled(options.cancel))
 				break;
+			check_memory();
+
+			const char * unit_buffer = buffer + unit.first;
+			std::size_t unit_size = unit.second - unit.first;
+			if(is_selecting_units() && !selects_unit(srcuml::unit_attribute(unit_buffer, unit_size, "filename")))
+				continue;
+
+			std::vector<std::shared_ptr<srcuml_class>> unit_classes;
+			if(cache.load(unit_buffer, unit_size, unit_classes)) {
+				++hits;
+			} else {
+
+				++misses;
+				srcuml_input_reader reader = make_chunk_reader(buffer, header_size, unit);
+				unit_classes = collect_classes(reader, run_arena(), false);
+				if(!srcuml_cancel::is_cancelled(options.cancel))
+					cache.store(unit_buffer, unit_size, unit_classes);
+
+			}
+
+			add_selected_classes(unit_classes);
+
+		}
+
+		count_cache_lookups(hits, misses);
+
+	}
+
+	void count_cache_lookups(std::size_t hits, std::size_t misses) {
+
+		if(!options.stats)
+			return;
+
+		options.stats->add_count("unit cache hits", hits);
+		options.stats->add_count("unit cache misses", misses);
+
+	}
+
+	/** appends the classes options.filter keeps */
+	void add_selected_classes(const std::vector<std::shared_ptr<srcuml_class>> & unit_classes) {
+
+		for(const std::shared_ptr<srcuml_class> & aclass : unit_classes)
+			if(!options.filter.has_class_rules() || options.filter.selects_class(srcuml::symbol_name(aclass->get_name_symbol())))
+				classes.push_back(aclass);
+
+	}
+
+	/** reader for header + "\n\n" + range + unit_chunk_footer, see srcuml::split_unit_ranges */
+	static srcuml_input_reader make_chunk_reader(const char * buffer, std::size_t header_size,
+												 const std::pair<std::size_t, std::size_t> & range) {
+
+		srcuml_input_reader reader(buffer, header_size);
+		reader.append("\n\n", 2);
+		reader.append(buffer + range.first, range.second - range.first);
+		reader.append(srcuml::unit_chunk_footer, std::strlen(srcuml::unit_chunk_footer));
 
-			case svg_three:
-				{
-					std::cout << "SVG THREE Called\n";
-					svg_three_outputter outputter;
-					outputter.output(out, classes);
+		return reader;
+
+	}
+
+	/**
+	 * Parses with its own dispatcher, so it can run on any thread with its own arena.
+	 * Units options.filter drops are skipped, and unless filter_classes is false so are its classes.
+	 */
+	std::vector<std::shared_ptr<srcuml_class>> collect_classes(srcuml_input_reader & reader, srcuml_arena & arena, bool filter_classes = true) const {
+
+		srcuml_collector collector(options.streaming, options.profile != STRUCTURE_ONLY_PROFILE, &arena, options.stereotypes,
+								   filter_classes ? &options.filter : nullptr);
+		srcuml_dispatcher<ClassPolicy> dispatcher(&collector, options.profile, options.cancel, collector.get_stereotyper(), &options.filter);
+		srcSAXController controller(&reader, srcuml_input_reader::read, srcuml_input_reader::close);
+		controller.parse(&dispatcher);
+
+		return std::move(collector.get_classes());
+
+	}
+
+	/**
+	 * Parses srcML archives in turn into the same classes, each on options.threads
+	 * threads as a single archive is.  Compressed ones are decompressed as they are parsed.
+	 */
+	void parse_archives(const std::vector<std::string> & filenames) {
+
+		for(std::size_t pos = 0; pos < filenames.size() && !srcuml_cancel::is_cancelled(options.cancel); ++pos) {
+
+			if(srcuml_compressed_reader::compression_of(filenames[pos]) != NO_INPUT_COMPRESSION) {
+
+				srcuml_compressed_reader input(filenames[pos]);
+				srcSAXController controller(&input, srcuml_compressed_reader::read, srcuml_compressed_reader::close);
+				parse(controller);
+				input.finish();
+				continue;
+
+			}
+
+			srcuml_mapped_file input(filenames[pos].c_str());
+			parse(input.get_data(), input.get_size());
+
+		}
+
+	}
+
+	/**
+	 * Converts and parses one source file at a time, so only one srcML document per thread
+	 * is alive.  With options.threads > 1 the files are split into contiguous ranges and
+	 * merged in order.
+	 */
+	void parse(const srcuml_source & source) {
+
+		std::size_t number_threads = std::min(options.threads, source.size());
+		if(number_threads <= 1 || options.cache || !options.cache_directory.empty()) {
+
+			srcuml_source::parser parser(source);
+			for(std::size_t pos = 0; pos < source.size() && !srcuml_cancel::is_cancelled(options.cancel); ++pos) {
+
+				const std::pair<const char *, std::size_t> unit = parser.parse(pos);
+				parse(unit.first, unit.second);
+
+			}
+
+			return;
+
+		}
+
+		xmlInitParser();
+
+		std::vector<std::vector<std::shared_ptr<srcuml_class>>> thread_classes(number_threads);
+		std::vector<std::exception_ptr> errors(number_threads);
+
+		std::vector<srcuml_arena *> thread_arenas;
+		for(std::size_t thread_pos = 0; thread_pos < number_threads; ++thread_pos)
+			thread_arenas.push_back(&new_arena());
+
+		const int phase = srcuml_allocation::get_phase();
+
+		std::vector<std::thread> workers;
+		for(std::size_t thread_pos = 0; thread_pos < number_threads; ++thread_pos) {
+
+			workers.emplace_back([this, thread_pos, phase, number_threads, &source, &thread_classes, &thread_arenas, &errors]() {
+
+				srcuml_allocation::phase_scope scope(phase);
+
+				try {
+
+					std::size_t begin = (source.size() * thread_pos) / number_threads;
+					std::size_t end = (source.size() * (thread_pos + 1)) / number_threads;
+					srcuml_source::parser parser(source);
+					for(std::size_t pos = begin; pos < end && !srcuml_cancel::is_cancelled(options.cancel); ++pos) {
+
+						const std::pair<const char *, std::size_t> unit = parser.parse(pos);
+
+						srcuml_input_reader reader(unit.first, unit.second);
+						std::vector<std::shared_ptr<srcuml_class>> file_classes = collect_classes(reader, *thread_arenas[thread_pos]);
+						thread_classes[thread_pos].insert(thread_classes[thread_pos].end(), file_classes.begin(), file_classes.end());
+
+					}
+
+				} catch(...) {
+					errors[thread_pos] = std::current_exception();
 				}
-				break;
 
-			case dot:
-				{
-					std::cout << "DOT Called\n";
-					dot_outputter outputter;
-					outputter.output(out, classes);
+			});
+
+		}
+
+		for(std::thread & worker : workers)
+			worker.join();
+
+		for(std::size_t thread_pos = 0; thread_pos < number_threads; ++thread_pos) {
+
+			if(errors[thread_pos])
+				std::rethrow_exception(errors[thread_pos]);
+
+			classes.insert(classes.end(), thread_classes[thread_pos].begin(), thread_classes[thread_pos].end());
+
+		}
+
+	}
+
+	/** past options.memory_limit, the srcML data of the classes parsed from now on is freed, see apply_limits */
+	void check_memory() {
+
+		if(is_over_memory || options.memory_limit == 0 || srcuml_stats::resident_rss() <= options.memory_limit)
+			return;
+
+		is_over_memory = true;
+		options.streaming = true;
+		report_degraded("memory", "resident memory over " + std::to_string(options.memory_limit) + " bytes after "
+							   + std::to_string(classes.size()) + " classes, freeing srcML data while parsing");
+
+	}
+
+	/**
+	 * Degrades the output of inputs past the limits of options, mildest first:
+	 * a class with more than max_edges_per_class relationships loses its dependencies,
+	 * then the rest beyond the limit, a class with more than max_label_lines members
+	 * shows how many there are.  Past max_classes or memory_limit every dependency is
+	 * dropped, every class shows counts and the SVG outputs are drawn as svg_overview.
+	 */
+	void apply_limits() {
+
+		check_memory();
+
+		const bool is_over_classes = options.max_classes != 0 && classes.size() > options.max_classes;
+		if(!is_over_classes && !is_over_memory && options.max_edges_per_class == 0 && options.max_label_lines == 0)
+			return;
+
+		analyze();
+
+		if(is_over_classes || is_over_memory) {
+
+			const std::string reason = is_over_classes ? std::to_string(classes.size()) + " classes over --max-classes " + std::to_string(options.max_classes)
+													   : std::string("resident memory over --memory-limit");
+
+			std::size_t number_relationships = relationships.size();
+			relationships.erase(std::remove_if(relationships.begin(), relationships.end(), [](const srcuml_relationship & relationship) {
+				return relationship.get_type() == DEPENDENCY;
+			}), relationships.end());
+
+			member_lines = 0;
+
+			bool is_overview = false;
+			for(output_type & type : types) {
+				if(type == svg_sugiyama || type == svg_multi || type == svg_three) {
+					type = svg_overview;
+					is_overview = true;
 				}
-				break;
+			}
+
+			report_degraded("classes", reason + ": dropped " + std::to_string(number_relationships - relationships.size())
+									   + " dependencies, members shown as counts" + (is_overview ? ", drawn as svg_overview" : ""));
+			return;
+
+		}
+
+		if(options.max_edges_per_class != 0)
+			limit_edges();
+
+		if(options.max_label_lines != 0) {
+
+			member_lines = options.max_label_lines;
+
+			std::size_t collapsed = 0;
+			for(const std::shared_ptr<srcuml_class> & aclass : classes)
+				if(aclass->get_attribute_labels().size() + aclass->get_operation_labels().size() > member_lines)
+					++collapsed;
+
+			if(collapsed)
+				report_degraded("members", std::to_string(collapsed) + " classes with more than " + std::to_string(member_lines)
+										   + " members shown as counts");
+
+		}
 
-			case yuml:
-				{
-					std::cout << "YUML Called\n";
-					yuml_outputter outputter;
-					outputter.output(out, classes);
+	}
+
+	/** every member of the classes options.max_members cuts short, as yUML boxes */
+	void write_members_file() const {
+
+		if(options.members_file.empty() || options.max_members == 0)
+			return;
+
+		std::ofstream file(options.members_file);
+		if(!file)
+			throw std::string("Error: Unable to write ") + options.members_file;
+
+		yuml_outputter outputter;
+		srcuml_text_sink sink(file);
+		outputter.write_header(sink);
+		for(const std::shared_ptr<srcuml_class> & aclass : classes)
+			if(aclass->get_attribute_labels().size() > options.max_members || aclass->get_operation_labels().size() > options.max_members)
+				outputter.write_class(sink, *aclass);
+
+	}
+
+	/** keeps at most options.max_edges_per_class relationships from each class, dependencies dropped first */
+	void limit_edges() {
+
+		std::unordered_map<srcuml_symbol, std::size_t> edges;
+		for(const srcuml_relationship & relationship : relationships)
+			++edges[relationship.get_source_symbol()];
+
+		const std::size_t limit = options.max_edges_per_class;
+
+		// a class over the limit keeps its other relationships first, then dependencies while there is room
+		std::unordered_map<srcuml_symbol, std::size_t> kept;
+		std::size_t number_relationships = relationships.size();
+		std::vector<bool> is_kept(number_relationships, false);
+		for(bool is_dependency_pass : { false, true }) {
+
+			for(std::size_t pos = 0; pos < number_relationships; ++pos) {
+
+				const srcuml_relationship & relationship = relationships[pos];
+				const srcuml_symbol source = relationship.get_source_symbol();
+				if(edges[source] <= limit) {
+					if(!is_dependency_pass)
+						is_kept[pos] = true;
+					continue;
 				}
-				break; 
 
-			default:
-				{
-					std::cout << "Error: Output type not recognized, running svg_sugiyama\n";
-					svg_sugiyama_outputter outputter;
-					outputter.output(out, classes);
+				if((relationship.get_type() == DEPENDENCY) != is_dependency_pass || kept[source] == limit)
+					continue;
+
+				++kept[source];
+				is_kept[pos] = true;
+
+			}
+
+		}
+
+		// those kept stay in the order they were, e.g. sorted
+		std::vector<srcuml_relationship> limited;
+		for(std::size_t pos = 0; pos < number_relationships; ++pos)
+			if(is_kept[pos])
+				limited.push_back(relationships[pos]);
+
+		if(limited.size() == number_relationships)
+			return;
+
+		std::size_t classes_over = 0;
+		for(const std::pair<const srcuml_symbol, std::size_t> & count : edges)
+			if(count.second > limit)
+				++classes_over;
+
+		relationships.swap(limited);
+		report_degraded("edges", std::to_string(classes_over) + " classes with more than " + std::to_string(limit) + " relationships, dropped "
+								 + std::to_string(number_relationships - relationships.size()));
+
+	}
+
+	/** what apply_limits did, on stderr and as a note and progress event of options.stats */
+	void report_degraded(const char * limit, const std::string & action) {
+
+		std::cerr << "srcuml: degraded output, " << action << '\n';
+		if(options.stats)
+			options.stats->set_note(std::string("limit ") + limit, action);
+
+	}
+
+	/** a progress event for the first phase cut short by options.cancel, the phases after it are degraded too */
+	void report_cancel(const char * phase) {
+
+		if(is_cancel_reported || !srcuml_cancel::is_cancelled(options.cancel))
+			return;
+
+		is_cancel_reported = true;
+		if(options.stats)
+			options.stats->event("cancelled", phase, std::to_string(classes.size()) + " classes parsed, " + std::to_string(relationships.size()) + " relationships");
+
+	}
+
+	/** sizes of the parsed input, see srcuml_options::stats */
+	void count_parsed() const {
+
+		if(!options.stats)
+			return;
+
+		std::size_t attributes = 0, operations = 0, arena_bytes = 0;
+		std::unordered_set<std::string> units;
+		for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+			attributes += aclass->get_attributes().size();
+			operations += aclass->get_operations().size();
+			units.insert(aclass->get_filename());
+
+		}
+
+		for(const std::unique_ptr<srcuml_arena> & arena : arenas)
+			arena_bytes += arena->get_reserved();
+
+		options.stats->add_count("classes", classes.size());
+		options.stats->add_count("attributes", attributes);
+		options.stats->add_count("operations", operations);
+		options.stats->add_count("units", units.size());
+		options.stats->add_count("arena bytes", arena_bytes);
+
+	}
+
+	/** finalizes the classes and analyzes the relationships once for every outputter */
+	void analyze() {
+
+		if(is_analyzed)
+			return;
+
+		srcuml_stats::timer timer(options.stats, "analyze");
+		if(options.graph) {
+			options.graph->update(classes, options.threads);
+			relationships = options.graph->get_relationships();
+		} else {
+			relationships = srcuml_relationships(classes, options.threads, options.stats, options.cancel).get_relationships();
+		}
+		is_analyzed = true;
+		sort_relationships();
+
+		if(options.stats)
+			options.stats->add_count("relationships", relationships.size());
+		report_cancel("analyze");
+
+	}
+
+	/**
+	 * Drops copies of classes parsed from several units, e.g. a header vendored twice, as
+	 * options.duplicates asks: copies with the same structure hash after the first, or every
+	 * class but the last parsed of a name.  The classes keep their order.
+	 */
+	void deduplicate() {
+
+		if(options.duplicates == KEEP_DUPLICATES || is_analyzed)
+			return;
+
+		std::vector<char> is_kept(classes.size(), 1);
+		if(options.duplicates == MERGE_DUPLICATES) {
+
+			std::vector<std::uint64_t> hashes(classes.size());
+			srcuml::parallel_ranges(classes.size(), options.threads, [&](std::size_t first, std::size_t last) {
+				for(std::size_t pos = first; pos < last; ++pos)
+					hashes[pos] = classes[pos]->get_structure_hash();
+			});
+
+			// the summary hashed includes the name
+			std::unordered_set<std::uint64_t> seen;
+			for(std::size_t pos = 0; pos < classes.size(); ++pos)
+				is_kept[pos] = seen.insert(hashes[pos]).second;
+
+		} else {
+
+			std::unordered_set<srcuml_symbol> seen;
+			for(std::size_t pos = classes.size(); pos-- > 0; )
+				is_kept[pos] = seen.insert(classes[pos]->get_name_symbol()).second;
+
+		}
+
+		std::size_t kept = 0;
+		for(std::size_t pos = 0; pos < classes.size(); ++pos)
+			if(is_kept[pos])
+				classes[kept++] = classes[pos];
+
+		const std::size_t dropped = classes.size() - kept;
+		classes.resize(kept);
+
+		if(options.stats)
+			options.stats->add_count("duplicate classes", dropped);
+
+	}
+
+	/** ranks of the symbols named by the classes and relationships, in order of their names */
+	std::unordered_map<srcuml_symbol, std::size_t> rank_symbols() const {
+
+		std::vector<std::pair<std::string, srcuml_symbol>> names;
+		std::unordered_set<srcuml_symbol> seen;
+		const auto add = [&names, &seen](srcuml_symbol symbol) {
+			if(seen.insert(symbol).second)
+				names.emplace_back(srcuml::symbol_name(symbol), symbol);
+		};
+
+		for(const std::shared_ptr<srcuml_class> & aclass : classes)
+			add(aclass->get_name_symbol());
+
+		for(const srcuml_relationship & relationship : relationships) {
+			add(relationship.get_source_symbol());
+			add(relationship.get_destination_symbol());
+		}
+
+		std::sort(names.begin(), names.end());
+
+		std::unordered_map<srcuml_symbol, std::size_t> ranks;
+		for(std::size_t pos = 0; pos < names.size(); ++pos)
+			ranks.emplace(names[pos].second, pos);
+
+		return ranks;
+
+	}
+
+	/**
+	 * With options.sorted, orders the classes by qualified name, copies of a name in the order
+	 * parsed, so every outputter, the model and the fingerprints of the artifacts see the same
+	 * order whatever the order of the units, the threads parsing them or the cache. Classes
+	 * written early are left in the order parsed, only their relationships are sorted.
+	 */
+	void sort_classes() {
+
+		if(!options.sorted)
+			return;
+
+		if(!early_outputter) {
+
+			srcuml_stats::timer timer(options.stats, "sort");
+			const std::unordered_map<srcuml_symbol, std::size_t> ranks = rank_symbols();
+			std::stable_sort(classes.begin(), classes.end(),
+				[&ranks](const std::shared_ptr<srcuml_class> & one, const std::shared_ptr<srcuml_class> & two) {
+					return ranks.at(one->get_name_symbol()) < ranks.at(two->get_name_symbol());
+				});
+
+		}
+
+		// a loaded model is already analyzed
+		sort_relationships();
+
+	}
+
+	/** with options.sorted, orders the relationships by source, destination then type */
+	void sort_relationships() {
+
+		if(!options.sorted || !is_analyzed)
+			return;
+
+		const std::unordered_map<srcuml_symbol, std::size_t> ranks = rank_symbols();
+		std::stable_sort(relationships.begin(), relationships.end(),
+			[&ranks](const srcuml_relationship & one, const srcuml_relationship & two) {
+				return std::make_tuple(ranks.at(one.get_source_symbol()), ranks.at(one.get_destination_symbol()), one.get_type())
+					< std::make_tuple(ranks.at(two.get_source_symbol()), ranks.at(two.get_destination_symbol()), two.get_type());
+			});
+
+	}
+
+	/** neighbors of the classes through the relationships analyzed, shared by the graph passes that follow */
+	srcuml_adjacency index_relationships() const {
+
+		srcuml_stats::timer timer(options.stats, "adjacency");
+		return srcuml_adjacency(classes, relationships);
+
+	}
+
+	/** keeps only the neighborhood of options.focus, the outputters never see the rest */
+	void focus() {
+
+		analyze();
+
+		const srcuml_adjacency adjacency = index_relationships();
+		srcuml_neighborhood neighborhood(classes, adjacency, options.focus, options.focus_depth);
+		classes = neighborhood.select_classes(classes);
+		relationships = neighborhood.select_relationships(relationships);
+
+	}
+
+	/** keeps only the options.top_classes classes of the highest rank, before any of the limits applies */
+	void sample() {
+
+		analyze();
+
+		const srcuml_adjacency adjacency = index_relationships();
+		srcuml_ranking ranking(adjacency, options.top_classes, options.threads);
+		const std::size_t number_classes = classes.size();
+		relationships = ranking.select_relationships(relationships);
+		classes = ranking.select_classes(classes);
+
+		if(options.stats)
+			options.stats->add_count("omitted classes", number_classes - classes.size());
+
+	}
+
+	void render(srcuml_outputter & outputter, std::ostream & out) {
+
+		if(is_analyzed)
+			outputter.use_relationships(relationships);
+		outputter.use_edge_filter(srcuml_edge_filter(options.edge_detail));
+		outputter.use_stats(options.stats);
+		outputter.use_cancel(options.cancel);
+
+		outputter.output(out, classes);
+
+	}
+
+	/**
+	 * Writes every requested output type.  The classes are parsed and the relationships
+	 * analyzed once and shared read-only by the outputters, which run concurrently
+	 * when options.threads > 1.
+	 */
+	void output(std::ostream & out) {
+
+		parse_timer.stop();
+		count_parsed();
+		report_cancel("parse");
+		deduplicate();
+		sort_classes();
+
+		if(options.shard.is_sharded()) {
+
+			if(options.emit_model.empty())
+				throw std::string("Error: A shard is only saved as a partial model, it needs a model file");
+
+			// the relationships are analyzed once the shards are merged, see srcuml_model::merge
+			srcuml_model(classes, std::vector<srcuml_relationship>(), true).save(options.emit_model);
+			return;
+
+		}
+
+		if(!options.emit_model.empty()) {
+
+			analyze();
+			srcuml_model(classes, relationships).save(options.emit_model);
+
+		}
+
+		if(early_outputter) {
+
+			finish_early_output();
+			return;
+
+		}
+
+		if(!options.focus.empty())
+			focus();
+
+		if(options.top_classes != 0)
+			sample();
+
+		apply_limits();
+		write_members_file();
+
+		if(!options.artifacts.empty()) {
+
+			output_artifacts();
+			return;
+
+		}
+
+		if(types.size() == 1 && options.outputs.empty()) {
+
+			// analyzed here too, so the outputter gets the sorted relationships rather than analyzing its own
+			analyze();
+			output(types.front(), out);
+			return;
+
+		}
+
+		if(!options.outputs.empty() && options.outputs.size() != types.size())
+			throw std::string("Error: Need one output per output type");
+
+		analyze();
+
+		std::vector<std::ostream *> streams(types.size(), &out);
+		if(!options.outputs.empty())
+			streams = options.outputs;
+
+		if(options.threads <= 1) {
+
+			for(std::size_t pos = 0; pos < types.size(); ++pos)
+				output(types[pos], *streams[pos]);
+
+			return;
+
+		}
+
+		std::vector<std::exception_ptr> errors(types.size());
+
+		std::vector<std::thread> workers;
+		for(std::size_t pos = 0; pos < types.size(); ++pos) {
+
+			workers.emplace_back([this, pos, &streams, &errors]() {
+
+				try {
+					output(types[pos], *streams[pos]);
+				} catch(...) {
+					errors[pos] = std::current_exception();
 				}
-				break;
+
+			});
 
 		}
 
-		//delete outputter;
+		for(std::thread & worker : workers)
+			worker.join();
+
+		for(const std::exception_ptr & error : errors)
+			if(error)
+				std::rethrow_exception(error);
+
 	}
 
-	virtual void Notify(const srcSAXEventDispatch::PolicyDispatcher * policy, const srcSAXEventDispatch::srcSAXEventContext & ctx) override {
+	/** renders the output types whose artifact is not current, see srcuml_artifact */
+	void output_artifacts() {
+
+		if(options.artifacts.size() != types.size())
+			throw std::string("Error: Need one output per output type");
 
-		if(typeid(ClassPolicy) == typeid(*policy)) {
+		analyze();
 
-			ClassPolicy::ClassData * class_data = policy->Data<ClassPolicy::ClassData>();
-			if(class_data && class_data->name)
-				classes.emplace_back(std::make_shared<srcuml_class>(class_data));
+		std::vector<std::size_t> stale;
+		std::vector<std::uint64_t> fingerprints(types.size());
+		for(std::size_t pos = 0; pos < types.size(); ++pos) {
+
+			fingerprints[pos] = srcuml_artifact::fingerprint(types[pos], classes, relationships, options);
+			if(!options.artifacts[pos]->is_current(fingerprints[pos]))
+				stale.push_back(pos);
 
 		}
 
+		if(options.stats)
+			options.stats->add_count("outputs unchanged", types.size() - stale.size());
+
+		srcuml::parallel_ranges(stale.size(), options.threads, [this, &stale, &fingerprints](std::size_t first, std::size_t last) {
+
+			for(std::size_t pos = first; pos < last; ++pos) {
+
+				srcuml_artifact & artifact = *options.artifacts[stale[pos]];
+				try {
+					output(types[stale[pos]], artifact.open());
+					artifact.commit(fingerprints[stale[pos]], !srcuml_cancel::is_cancelled(options.cancel));
+				} catch(...) {
+					artifact.abandon();
+					throw;
+				}
+
+			}
+
+		});
+
 	}
 
-    virtual void NotifyWrite(const srcSAXEventDispatch::PolicyDispatcher * policy, srcSAXEventDispatch::srcSAXEventContext & ctx) override {
-    }
+	void output(output_type type, std::ostream & out) {
 
+		std::unique_ptr<srcuml_outputter> outputter = srcuml_output_registry::instance().make(type, srcuml_output_context{ options, member_lines });
+		render(*outputter, out);
 
-private:
+	}
 
 };
 
@@ -0,0 +1,685 @@
+/**
+ * @file srcuml_input.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_INPUT_HPP
+#define INCLUDED_SRCUML_INPUT_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include <zlib.h>
+#ifdef SRCUML_ZSTD
+#include <zstd.h>
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+/**
+ * srcuml_mapped_file
+ *
+ * Read-only memory mapping of an input file.
+ */
+class srcuml_mapped_file {
+
+private:
+
+	const char * data;
+	std::size_t size;
+
+public:
+
+	srcuml_mapped_file(const char * filename) : data(nullptr), size(0) {
+
+		int fd = open(filename, O_RDONLY);
+		if(fd < 0)
+			throw std::string("Error: Unable to open ") + filename;
+
+		struct stat info;
+		if(fstat(fd, &info) != 0) {
+			close(fd);
+			throw std::string("Error: Unable to stat ") + filename;
+		}
+
+		size = info.st_size;
+		if(size) {
+
+			void * mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapping == MAP_FAILED) {
+				close(fd);
+				throw std::string("Error: Unable to map ") + filename;
+			}
+
+			madvise(mapping, size, MADV_SEQUENTIAL);
+			data = static_cast<const char *>(mapping);
+
+		}
+
+		// the mapping stays valid after the descriptor is closed
+		close(fd);
+
+	}
+
+	srcuml_mapped_file(const srcuml_mapped_file &) = delete;
+	srcuml_mapped_file & operator=(const srcuml_mapped_file &) = delete;
+
+	~srcuml_mapped_file() {
+
+		if(data)
+			munmap(const_cast<char *>(data), size);
+
+	}
+
+	const char * get_data() const {
+		return data;
+	}
+
+	std::size_t get_size() const {
+		return size;
+	}
+
+};
+
+/**
+ * srcuml_input_reader
+ *
+ * Feeds srcSAX from a sequence of borrowed buffers through its read callback,
+ * so a document never has to be copied into a single string.
+ */
+class srcuml_input_reader {
+
+private:
+
+	std::vector<std::pair<const char *, std::size_t>> segments;
+	std::size_t segment;
+	std::size_t pos;
+
+public:
+
+	srcuml_input_reader() : segments(), segment(0), pos(0) {}
+
+	srcuml_input_reader(const char * data, std::size_t size) : srcuml_input_reader() {
+		append(data, size);
+	}
+
+	void append(const char * data, std::size_t size) {
+
+		if(size)
+			segments.emplace_back(data, size);
+
+	}
+
+	static int read(void * context, char * buffer, int len) {
+
+		srcuml_input_reader * reader = static_cast<srcuml_input_reader *>(context);
+
+		int total = 0;
+		while(total < len && reader->segment < reader->segments.size()) {
+
+			const std::pair<const char *, std::size_t> & current = reader->segments[reader->segment];
+			std::size_t count = std::min<std::size_t>(len - total, current.second - reader->pos);
+
+			std::memcpy(buffer + total, current.first + reader->pos, count);
+			total += count;
+			reader->pos += count;
+
+			if(reader->pos == current.second) {
+				++reader->segment;
+				reader->pos = 0;
+			}
+
+		}
+
+		return total;
+
+	}
+
+	static int close(void * context) {
+		return 0;
+	}
+
+};
+
+/**
+ * srcuml_descriptor_reader
+ *
+ * Feeds srcSAX from a file descriptor as the data arrives, e.g. from srcml
+ * writing to a pipe, so parsing overlaps with producing the document and it
+ * is never stored in full.
+ */
+class srcuml_descriptor_reader {
+
+private:
+
+	int fd;
+	bool is_owner;
+
+public:
+
+	/** reads fd, which is closed with the reader if it is the owner */
+	explicit srcuml_descriptor_reader(int fd, bool is_owner = false) : fd(fd), is_owner(is_owner) {}
+
+	/** opens a file that cannot be mapped, e.g. a named pipe, "-" is the standard input */
+	explicit srcuml_descriptor_reader(const std::string & filename) : fd(0), is_owner(false) {
+
+		if(filename == "-")
+			return;
+
+		fd = open(filename.c_str(), O_RDONLY);
+		if(fd < 0)
+			throw std::string("Error: Unable to open ") + filename;
+
+		is_owner = true;
+
+	}
+
+	srcuml_descriptor_reader(const srcuml_descriptor_reader &) = delete;
+	srcuml_descriptor_reader & operator=(const srcuml_descriptor_reader &) = delete;
+
+	~srcuml_descriptor_reader() {
+
+		if(is_owner)
+			::close(fd);
+
+	}
+
+	/** "-" or a pipe, socket or device, which are read as a stream instead of mapped */
+	static bool is_stream(const std::string & path) {
+
+		if(path == "-")
+			return true;
+
+		struct stat info;
+		if(stat(path.c_str(), &info) != 0)
+			return false;
+
+		return S_ISFIFO(info.st_mode) || S_ISSOCK(info.st_mode) || S_ISCHR(info.st_mode);
+
+	}
+
+	static int read(void * context, char * buffer, int len) {
+
+		srcuml_descriptor_reader * reader = static_cast<srcuml_descriptor_reader *>(context);
+
+		ssize_t count;
+		do {
+			count = ::read(reader->fd, buffer, len);
+		} while(count < 0 && errno == EINTR);
+
+		return count < 0 ? -1 : static_cast<int>(count);
+
+	}
+
+	static int close(void * context) {
+		return 0;
+	}
+
+};
+
+/** compressions of srcML archives detected from their first bytes */
+enum input_compression { NO_INPUT_COMPRESSION, GZIP_INPUT, ZSTD_INPUT, ZIP_INPUT };
+
+/**
+ * srcuml_compressed_reader
+ *
+ * Feeds srcSAX the srcML archive in a gzip, zstd or zip file, decompressed on
+ * a background thread as it is parsed, so nothing is written to disk and
+ * parsing overlaps with decompression.  At most MAX_PENDING chunks wait to be
+ * parsed.  A zip file holds a single srcML archive.  zstd needs srcUML built
+ * with SRCUML_ZSTD.
+ */
+class srcuml_compressed_reader {
+
+private:
+
+	enum : std::size_t { CHUNK_SIZE = 1 << 18, MAX_PENDING = 4 };
+
+	srcuml_mapped_file input;
+	input_compression compression;
+
+	// the compressed data of a zip entry and whether it is deflated instead of stored
+	const char * entry_data;
+	std::size_t entry_size;
+	bool is_deflated;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<std::vector<char>> pending;
+	bool is_finished;
+	bool is_stopped;
+	std::string error;
+
+	// chunk being read by the parser
+	std::vector<char> current;
+	std::size_t pos;
+
+	std::thread decompressor;
+
+public:
+
+	/** the compression of a file by its first bytes, NO_INPUT_COMPRESSION if it cannot be read */
+	static input_compression compression_of(const std::string & filename) {
+
+		unsigned char magic[4] = { 0, 0, 0, 0 };
+		int fd = open(filename.c_str(), O_RDONLY);
+		if(fd < 0)
+			return NO_INPUT_COMPRESSION;
+
+		const ssize_t count = ::read(fd, magic, sizeof(magic));
+		::close(fd);
+
+		return compression_of(magic, count < 0 ? 0 : count);
+
+	}
+
+	static input_compression compression_of(const unsigned char * magic, std::size_t size) {
+
+		if(size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+			return GZIP_INPUT;
+		if(size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+			return ZSTD_INPUT;
+		if(size >= 4 && magic[0] == 'P' && magic[1] == 'K' && magic[2] == 3 && magic[3] == 4)
+			return ZIP_INPUT;
+
+		return NO_INPUT_COMPRESSION;
+
+	}
+
+	explicit srcuml_compressed_reader(const std::string & filename)
+		: input(filename.c_str()), compression(compression_of(reinterpret_cast<const unsigned char *>(input.get_data()), input.get_size())),
+		  entry_data(nullptr), entry_size(0), is_deflated(false), mutex(), changed(), pending(), is_finished(false), is_stopped(false),
+		  error(), current(), pos(0), decompressor() {
+
+		if(compression == NO_INPUT_COMPRESSION)
+			throw std::string("Error: ") + filename + " is not gzip, zstd or zip compressed";
+
+#ifndef SRCUML_ZSTD
+		if(compression == ZSTD_INPUT)
+			throw std::string("Error: ") + filename + " is zstd compressed, srcUML was built without zstd";
+#endif
+
+		if(compression == ZIP_INPUT)
+			find_zip_entry(filename);
+
+		decompressor = std::thread([this]() { decompress(); });
+
+	}
+
+	srcuml_compressed_reader(const srcuml_compressed_reader &) = delete;
+	srcuml_compressed_reader & operator=(const srcuml_compressed_reader &) = delete;
+
+	~srcuml_compressed_reader() {
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopped = true;
+		}
+		changed.notify_all();
+
+		if(decompressor.joinable())
+			decompressor.join();
+
+	}
+
+	/** waits for the decompression, throws if it failed, so a truncated archive is not taken for a whole one */
+	void finish() {
+
+		if(decompressor.joinable())
+			decompressor.join();
+
+		if(!error.empty())
+			throw error;
+
+	}
+
+	static int read(void * context, char * buffer, int len) {
+
+		srcuml_compressed_reader * reader = static_cast<srcuml_compressed_reader *>(context);
+
+		int total = 0;
+		while(total < len) {
+
+			if(reader->pos == reader->current.size() && !reader->next_chunk())
+				break;
+
+			std::size_t count = std::min<std::size_t>(len - total, reader->current.size() - reader->pos);
+			std::memcpy(buffer + total, reader->current.data() + reader->pos, count);
+			total += count;
+			reader->pos += count;
+
+		}
+
+		if(total == 0 && reader->has_failed())
+			return -1;
+
+		return total;
+
+	}
+
+	static int close(void * context) {
+		return 0;
+	}
+
+private:
+
+	/** waits for the next decompressed chunk, false at the end of the data */
+	bool next_chunk() {
+
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return !pending.empty() || is_finished; });
+		if(pending.empty())
+			return false;
+
+		current.swap(pending.front());
+		pending.pop_front();
+		pos = 0;
+
+		lock.unlock();
+		changed.notify_all();
+
+		return true;
+
+	}
+
+	bool has_failed() {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return !error.empty();
+
+	}
+
+	/** hands a decompressed chunk to the parser, false once the reader is destroyed */
+	bool hand_over(std::vector<char> & chunk) {
+
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return pending.size() < MAX_PENDING || is_stopped; });
+		if(is_stopped)
+			return false;
+
+		pending.push_back(std::vector<char>());
+		pending.back().swap(chunk);
+
+		lock.unlock();
+		changed.notify_all();
+
+		chunk.resize(CHUNK_SIZE);
+		return true;
+
+	}
+
+	void fail(const std::string & message) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(error.empty())
+			error = message;
+
+	}
+
+	void decompress() {
+
+		switch(compression) {
+
+			case GZIP_INPUT:
+				inflate_data(input.get_data(), input.get_size(), 15 + 32);
+				break;
+
+			case ZIP_INPUT:
+				if(is_deflated)
+					inflate_data(entry_data, entry_size, -15);
+				else
+					copy_data(entry_data, entry_size);
+				break;
+
+			case ZSTD_INPUT:
+				decompress_zstd();
+				break;
+
+			default:
+				break;
+
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_finished = true;
+		}
+		changed.notify_all();
+
+	}
+
+	void copy_data(const char * data, std::size_t size) {
+
+		std::vector<char> chunk;
+		for(std::size_t start = 0; start < size; start += CHUNK_SIZE) {
+
+			chunk.assign(data + start, data + std::min(size, start + CHUNK_SIZE));
+			if(!hand_over(chunk))
+				return;
+
+		}
+
+	}
+
+	/** zlib with window_bits, 15 + 32 detects gzip, which may be several concatenated members, -15 is raw deflate */
+	void inflate_data(const char * data, std::size_t size, int window_bits) {
+
+		z_stream stream;
+		std::memset(&stream, 0, sizeof(stream));
+		if(inflateInit2(&stream, window_bits) != Z_OK) {
+			fail("Error: Unable to start decompression");
+			return;
+		}
+
+		std::vector<char> chunk(CHUNK_SIZE);
+		std::size_t consumed = 0;
+		int status = Z_OK;
+		while(true) {
+
+			if(stream.avail_in == 0 && consumed < size) {
+
+				// avail_in is 32 bits
+				const std::size_t count = std::min<std::size_t>(size - consumed, std::size_t(1) << 30);
+				stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data + consumed));
+				stream.avail_in = static_cast<uInt>(count);
+				consumed += count;
+
+			}
+
+			stream.next_out = reinterpret_cast<Bytef *>(chunk.data());
+			stream.avail_out = static_cast<uInt>(chunk.size());
+			status = inflate(&stream, Z_NO_FLUSH);
+
+			// with all of the output free, no progress means the input ended early
+			if(status == Z_BUF_ERROR) {
+				fail("Error: Truncated compressed srcML archive");
+				break;
+			}
+
+			if(status != Z_OK && status != Z_STREAM_END) {
+				fail("Error: Corrupt compressed srcML archive");
+				break;
+			}
+
+			chunk.resize(chunk.size() - stream.avail_out);
+			if(!chunk.empty() && !hand_over(chunk))
+				break;
+			chunk.resize(CHUNK_SIZE);
+
+			if(status == Z_STREAM_END) {
+
+				if(stream.avail_in == 0 && consumed == size)
+					break;
+
+				if(window_bits < 0) {
+					// data after the deflate stream of a zip entry is not part of it
+					break;
+				}
+
+				inflateReset(&stream);
+
+			} else if(stream.avail_in == 0 && consumed == size && stream.avail_out != 0) {
+				fail("Error: Truncated compressed srcML archive");
+				break;
+			}
+
+		}
+
+		inflateEnd(&stream);
+
+	}
+
+	void decompress_zstd() {
+
+#ifdef SRCUML_ZSTD
+		ZSTD_DStream * stream = ZSTD_createDStream();
+		if(!stream || ZSTD_isError(ZSTD_initDStream(stream))) {
+			fail("Error: Unable to start decompression");
+			if(stream) ZSTD_freeDStream(stream);
+			return;
+		}
+
+		ZSTD_inBuffer in = { input.get_data(), input.get_size(), 0 };
+		std::vector<char> chunk(CHUNK_SIZE);
+		std::size_t remaining = 0;
+		while(in.pos < in.size || remaining != 0) {
+
+			ZSTD_outBuffer out = { chunk.data(), chunk.size(), 0 };
+			remaining = ZSTD_decompressStream(stream, &out, &in);
+			if(ZSTD_isError(remaining)) {
+				fail("Error: Corrupt compressed srcML archive");
+				break;
+			}
+
+			chunk.resize(out.pos);
+			if(!chunk.empty() && !hand_over(chunk))
+				break;
+			chunk.resize(CHUNK_SIZE);
+
+			if(in.pos == in.size && remaining != 0 && out.pos < out.size) {
+				fail("Error: Truncated compressed srcML archive");
+				break;
+			}
+
+		}
+
+		ZSTD_freeDStream(stream);
+#endif
+
+	}
+
+	static std::uint32_t little_endian(const char * data, std::size_t size) {
+
+		std::uint32_t value = 0;
+		for(std::size_t pos = size; pos > 0; --pos)
+			value = (value << 8) | static_cast<unsigned char>(data[pos - 1]);
+
+		return value;
+
+	}
+
+	/** the only file of a zip archive, found from its central directory */
+	void find_zip_entry(const std::string & filename) {
+
+		const char * data = input.get_data();
+		const std::size_t size = input.get_size();
+		const std::string corrupt = std::string("Error: ") + filename + " is not a zip archive srcUML can read";
+
+		// the end of central directory record is followed by at most a 64 KB comment
+		enum : std::size_t { END_SIZE = 22, CENTRAL_SIZE = 46, LOCAL_SIZE = 30 };
+		if(size < END_SIZE)
+			throw corrupt;
+
+		std::size_t end = size - END_SIZE + 1;
+		const std::size_t lowest = size > END_SIZE + 0xffff ? size - END_SIZE - 0xffff : 0;
+		do {
+			--end;
+		} while(end > lowest && little_endian(data + end, 4) != 0x06054b50);
+
+		if(little_endian(data + end, 4) != 0x06054b50)
+			throw corrupt;
+
+		const std::size_t number_entries = little_endian(data + end + 10, 2);
+		std::size_t central = little_endian(data + end + 16, 4);
+
+		std::size_t number_files = 0;
+		for(std::size_t entry = 0; entry < number_entries; ++entry) {
+
+			if(central + CENTRAL_SIZE > size || little_endian(data + central, 4) != 0x02014b50)
+				throw corrupt;
+
+			const std::uint32_t method = little_endian(data + central + 10, 2);
+			const std::uint32_t compressed_size = little_endian(data + central + 20, 4);
+			const std::size_t name_size = little_endian(data + central + 28, 2);
+			const std::size_t extra_size = little_endian(data + central + 30, 2);
+			const std::size_t comment_size = little_endian(data + central + 32, 2);
+			const std::size_t local = little_endian(data + central + 42, 4);
+
+			// the name, extra field and comment are within the file
+			if(central + CENTRAL_SIZE + name_size + extra_size + comment_size > size)
+				throw corrupt;
+
+			// directories are skipped
+			if(name_size && data[central + CENTRAL_SIZE + name_size - 1] != '/') {
+
+				if(++number_files > 1)
+					throw std::string("Error: ") + filename + " holds more than one file, a zip input is a single srcML archive";
+
+				if((method != 0 && method != 8) || compressed_size == 0xffffffff)
+					throw std::string("Error: ") + filename + " is compressed with a zip method srcUML cannot read";
+
+				if(local + LOCAL_SIZE > size || little_endian(data + local, 4) != 0x04034b50)
+					throw corrupt;
+
+				const std::size_t start = local + LOCAL_SIZE + little_endian(data + local + 26, 2) + little_endian(data + local + 28, 2);
+				if(start + compressed_size > size)
+					throw corrupt;
+
+				entry_data = data + start;
+				entry_size = compressed_size;
+				is_deflated = method == 8;
+
+			}
+
+			central += CENTRAL_SIZE + name_size + extra_size + comment_size;
+
+		}
+
+		if(!number_files)
+			throw std::string("Error: ") + filename + " is an empty zip archive";
+
+	}
+
+};
+
+#endif
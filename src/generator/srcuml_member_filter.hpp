@@ -0,0 +1,137 @@
+/**
+ * @file srcuml_member_filter.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_MEMBER_FILTER_HPP
+#define INCLUDED_SRCUML_MEMBER_FILTER_HPP
+
+#include <ClassPolicySingleEvent.hpp>
+
+#include <srcuml_utilities.hpp>
+
+#include <string>
+#include <set>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * srcuml_member_filter
+ *
+ * Which attributes and operations the diagrams leave out, by method stereotype
+ * or by visibility.  By default the get and set methods, which the attributes
+ * already show.  A member's stereotypes are turned into a mask of bits once,
+ * see stereotype_mask, so each class renders its members, see
+ * srcuml_class::render_members, without looking up strings.
+ *
+ * Configured once before parsing, like srcuml_container_registry.
+ */
+class srcuml_member_filter {
+
+private:
+
+    // stereotypes of stereotype_attr.xsl, a bit each, any other is OTHER_STEREOTYPE
+    static const char * const * stereotype_names() {
+
+        static const char * const names[] = { "get", "nonconstget", "predicate", "property", "void-accessor", "set", "command",
+                                              "non-void-command", "controller", "collaborator", "factory", "stateless",
+                                              "incidental", "empty", "constructor", "copy-constructor", "unclassified", nullptr };
+        return names;
+
+    }
+
+    enum : std::uint32_t { OTHER_STEREOTYPE = 1u << 31 };
+
+    std::uint32_t hidden_stereotypes;
+    // bit per ClassPolicy::AccessSpecifier
+    unsigned hidden_visibilities;
+
+    srcuml_member_filter() : hidden_stereotypes(stereotype_mask({ "get", "set" })), hidden_visibilities(0) {}
+
+public:
+
+    static srcuml_member_filter & instance() {
+
+        static srcuml_member_filter filter;
+        return filter;
+
+    }
+
+    static std::uint32_t stereotype_mask(const std::set<std::string> & stereotypes) {
+
+        std::uint32_t mask = 0;
+        for(const std::string & stereotype : stereotypes) {
+
+            std::uint32_t bit = OTHER_STEREOTYPE;
+            for(std::size_t pos = 0; stereotype_names()[pos]; ++pos)
+                if(stereotype == stereotype_names()[pos])
+                    bit = 1u << pos;
+
+            mask |= bit;
+
+        }
+
+        return mask;
+
+    }
+
+    /**
+     * Comma separated stereotypes and visibilities (public, protected, private)
+     * to leave out, replacing the default.  "none" leaves nothing out.
+     */
+    void set_rules(const std::string & rules) {
+
+        hidden_stereotypes = 0;
+        hidden_visibilities = 0;
+
+        for(const std::string & rule : srcuml::split(rules, ',')) {
+
+            if(rule.empty() || rule == "none")
+                continue;
+
+            if(rule == "public")
+                hidden_visibilities |= 1u << ClassPolicy::PUBLIC;
+            else if(rule == "private")
+                hidden_visibilities |= 1u << ClassPolicy::PRIVATE;
+            else if(rule == "protected")
+                hidden_visibilities |= 1u << ClassPolicy::PROTECTED;
+            else if(stereotype_mask({ rule }) != OTHER_STEREOTYPE)
+                hidden_stereotypes |= stereotype_mask({ rule });
+            else
+                throw std::string("Error: Unknown member filter ") + rule + ". Can be a visibility or a method stereotype";
+
+        }
+
+    }
+
+    bool is_shown(ClassPolicy::AccessSpecifier visibility) const {
+
+        return !(hidden_visibilities & (1u << visibility));
+
+    }
+
+    bool is_shown(ClassPolicy::AccessSpecifier visibility, std::uint32_t stereotypes) const {
+
+        return is_shown(visibility) && !(stereotypes & hidden_stereotypes);
+
+    }
+
+};
+
+#endif
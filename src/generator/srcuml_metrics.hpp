@@ -0,0 +1,226 @@
+/**
+ * @file srcuml_metrics.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_METRICS_HPP
+#define INCLUDED_SRCUML_METRICS_HPP
+
+#include <srcuml_stats.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <ostream>
+#include <mutex>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * srcuml_metrics
+ *
+ * Totals of the requests a long running srcuml served, in the OpenMetrics text
+ * format Prometheus scrapes.  Each request is recorded from its own
+ * srcuml_stats, so the metrics are the --stats instrumentation summed over
+ * requests: a latency histogram of every request and of every phase by the
+ * output types requested (the layout and render phases of an engine or
+ * format), the counts, hit ratios of the unit and layout caches and gauges of
+ * the memory and the server's own state.  Recording is thread safe.
+ */
+class srcuml_metrics {
+
+private:
+
+    /** cumulative buckets, in seconds, above them is +Inf */
+    static const std::vector<double> & bounds() {
+
+        static const std::vector<double> seconds = { .005, .01, .025, .05, .1, .25, .5, 1, 2.5, 5, 10, 30, 60 };
+        return seconds;
+
+    }
+
+    struct histogram {
+
+        std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(bounds().size(), 0);
+        std::uint64_t count = 0;
+        double sum = 0;
+
+        void observe(double seconds) {
+
+            for(std::size_t pos = 0; pos < bounds().size(); ++pos)
+                if(seconds <= bounds()[pos])
+                    ++buckets[pos];
+
+            ++count;
+            sum += seconds;
+
+        }
+
+    };
+
+    mutable std::mutex mutex;
+
+    // by output types, and by phase then output types
+    std::map<std::string, histogram> requests;
+    std::map<std::pair<std::string, std::string>, histogram> phases;
+
+    // by output types then outcome, "ok" or "error"
+    std::map<std::pair<std::string, std::string>, std::uint64_t> outcomes;
+
+    std::map<std::string, std::uint64_t> counts;
+
+    // set by the server, e.g. the entries of the unit cache
+    std::map<std::string, double> gauges;
+
+public:
+
+    /** a request for the output types, its phases and counts from stats */
+    void record(const std::string & type, const srcuml_stats & stats, double seconds, bool is_error) {
+
+        const std::vector<std::pair<std::string, double>> times = stats.get_times();
+        const std::vector<std::pair<std::string, std::uint64_t>> request_counts = stats.get_counts();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        requests[type].observe(seconds);
+        ++outcomes[std::make_pair(type, is_error ? "error" : "ok")];
+
+        for(const std::pair<std::string, double> & time : times)
+            phases[std::make_pair(time.first, type)].observe(time.second / 1000);
+
+        for(const std::pair<std::string, std::uint64_t> & count : request_counts)
+            counts[count.first] += count.second;
+
+    }
+
+    /** replaces the gauge of the same name, written as srcuml_<name> */
+    void set_gauge(const std::string & name, double value) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        gauges[name] = value;
+
+    }
+
+    /** content type of write_openmetrics */
+    static const char * content_type() {
+        return "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    }
+
+    void write_openmetrics(std::ostream & out) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        out << "# TYPE srcuml_requests counter\n"
+            << "# HELP srcuml_requests Requests served by output types and outcome.\n";
+        for(const std::pair<const std::pair<std::string, std::string>, std::uint64_t> & outcome : outcomes)
+            out << "srcuml_requests_total{type=\"" << escape(outcome.first.first) << "\",outcome=\"" << outcome.first.second << "\"} "
+                << outcome.second << '\n';
+
+        out << "# TYPE srcuml_request_duration_seconds histogram\n"
+            << "# HELP srcuml_request_duration_seconds Time to serve a request by output types.\n";
+        for(const std::pair<const std::string, histogram> & request : requests)
+            write_histogram(out, "srcuml_request_duration_seconds", "type=\"" + escape(request.first) + "\"", request.second);
+
+        out << "# TYPE srcuml_phase_duration_seconds histogram\n"
+            << "# HELP srcuml_phase_duration_seconds Time of each phase of a request, as --stats times it, by output types.\n";
+        for(const std::pair<const std::pair<std::string, std::string>, histogram> & phase : phases)
+            write_histogram(out, "srcuml_phase_duration_seconds",
+                            "phase=\"" + escape(phase.first.first) + "\",type=\"" + escape(phase.first.second) + "\"", phase.second);
+
+        out << "# TYPE srcuml_stats_counts counter\n"
+            << "# HELP srcuml_stats_counts Counts of --stats summed over requests.\n";
+        for(const std::pair<const std::string, std::uint64_t> & count : counts)
+            out << "srcuml_stats_counts_total{count=\"" << escape(count.first) << "\"} " << count.second << '\n';
+
+        write_ratio(out, "srcuml_unit_cache_hit_ratio", "Units loaded from the unit cache instead of parsed.", "unit cache");
+        write_ratio(out, "srcuml_layout_cache_hit_ratio", "Drawings restored from the layout cache instead of laid out.", "layout cache");
+
+        out << "# TYPE srcuml_resident_memory_bytes gauge\n"
+            << "srcuml_resident_memory_bytes " << srcuml_stats::resident_rss() << '\n'
+            << "# TYPE srcuml_peak_resident_memory_bytes gauge\n"
+            << "srcuml_peak_resident_memory_bytes " << srcuml_stats::peak_rss() << '\n';
+
+        for(const std::pair<const std::string, double> & gauge : gauges)
+            out << "# TYPE srcuml_" << gauge.first << " gauge\n"
+                << "srcuml_" << gauge.first << ' ' << number(gauge.second) << '\n';
+
+        out << "# EOF\n";
+
+    }
+
+private:
+
+    static void write_histogram(std::ostream & out, const std::string & name, const std::string & labels, const histogram & values) {
+
+        for(std::size_t pos = 0; pos < bounds().size(); ++pos)
+            out << name << "_bucket{" << labels << ",le=\"" << number(bounds()[pos]) << "\"} " << values.buckets[pos] << '\n';
+
+        out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << values.count << '\n'
+            << name << "_count{" << labels << "} " << values.count << '\n'
+            << name << "_sum{" << labels << "} " << number(values.sum) << '\n';
+
+    }
+
+    /** hits over lookups of the counts "<cache> hits" and "<cache> misses", none before a lookup */
+    void write_ratio(std::ostream & out, const char * name, const char * help, const std::string & cache) const {
+
+        std::map<std::string, std::uint64_t>::const_iterator hits = counts.find(cache + " hits");
+        std::map<std::string, std::uint64_t>::const_iterator misses = counts.find(cache + " misses");
+        const std::uint64_t number_hits = hits == counts.end() ? 0 : hits->second;
+        const std::uint64_t lookups = number_hits + (misses == counts.end() ? 0 : misses->second);
+
+        out << "# TYPE " << name << " gauge\n"
+            << "# HELP " << name << ' ' << help << '\n';
+        if(lookups)
+            out << name << ' ' << number(double(number_hits) / lookups) << '\n';
+
+    }
+
+    static std::string number(double value) {
+
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.6g", value);
+        return text;
+
+    }
+
+    static std::string escape(const std::string & text) {
+
+        std::string escaped;
+        for(char character : text) {
+
+            if(character == '"' || character == '\\')
+                escaped += '\\';
+
+            if(character == '\n')
+                escaped += "\\n";
+            else
+                escaped += character;
+
+        }
+
+        return escaped;
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file srcuml_model.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_MODEL_HPP
+#define INCLUDED_SRCUML_MODEL_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_serialize.hpp>
+#include <srcuml_input.hpp>
+
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_set>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+/**
+ * srcuml_model
+ *
+ * Finalized classes and their relationships, saved after extraction so
+ * they can be rendered later without parsing srcML again.  A partial model,
+ * e.g. of one srcuml_shard, has classes that are not analyzed yet and no
+ * relationships, it is analyzed once merged with the rest.
+ */
+class srcuml_model {
+
+private:
+
+    static const std::uint64_t VERSION = 9;
+
+    static const char * magic() {
+        return "srcUML model\n";
+    }
+
+    std::vector<std::shared_ptr<srcuml_class>> classes;
+    std::vector<srcuml_relationship> relationships;
+    bool is_partial;
+
+public:
+
+    srcuml_model() : classes(), relationships(), is_partial(false) {}
+
+    srcuml_model(const std::vector<std::shared_ptr<srcuml_class>> & classes,
+                 const std::vector<srcuml_relationship> & relationships,
+                 bool is_partial = false)
+        : classes(classes), relationships(relationships), is_partial(is_partial) {}
+
+    /** reads a model from a memory mapped file */
+    static srcuml_model load(const std::string & filename) {
+
+        srcuml_mapped_file input(filename.c_str());
+        srcuml::memory_streambuf buffer(input.get_data(), input.get_size());
+        std::istream in(&buffer);
+
+        srcuml_model model;
+        model.read(in);
+
+        return model;
+
+    }
+
+    /**
+     * The classes of the models in filenames, e.g. of every shard, as a partial model
+     * to be analyzed.  A class saved by more than one of them is kept once.
+     */
+    static srcuml_model merge(const std::vector<std::string> & filenames) {
+
+        srcuml_model merged;
+        merged.is_partial = true;
+
+        std::unordered_set<std::string> summaries;
+        for(const std::string & filename : filenames) {
+
+            srcuml_model part = load(filename);
+            for(const std::shared_ptr<srcuml_class> & aclass : part.classes) {
+
+                std::ostringstream summary;
+                aclass->write(summary);
+                if(summaries.insert(summary.str()).second)
+                    merged.classes.push_back(aclass);
+
+            }
+
+        }
+
+        return merged;
+
+    }
+
+    void save(const std::string & filename) const {
+
+        std::ofstream out(filename, std::ios::binary);
+        if(!out)
+            throw std::string("Error: Unable to open ") + filename;
+
+        write(out);
+
+    }
+
+    void write(std::ostream & out) const {
+
+        out.write(magic(), std::strlen(magic()));
+        srcuml::write_size(out, VERSION);
+        srcuml::write_bool(out, is_partial);
+
+        srcuml::write_size(out, classes.size());
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            aclass->write(out);
+
+        srcuml::write_size(out, relationships.size());
+        for(const srcuml_relationship & relationship : relationships)
+            relationship.write(out);
+
+    }
+
+    void read(std::istream & in) {
+
+        std::string header(std::strlen(magic()), '\0');
+        if(!in.read(&header[0], header.size()) || header != magic())
+            throw std::string("Error: Not a srcUML model");
+
+        std::uint64_t version = srcuml::read_size(in);
+        if(version != VERSION)
+            throw std::string("Error: Unsupported srcUML model version ") + std::to_string(version);
+
+        is_partial = srcuml::read_bool(in);
+
+        std::uint64_t number_classes = srcuml::read_size(in);
+        for(std::uint64_t pos = 0; pos < number_classes; ++pos)
+            // not make_shared, the reference count is allocated apart so counting does not write the class's page
+            classes.emplace_back(new srcuml_class(in));
+
+        std::uint64_t number_relationships = srcuml::read_size(in);
+        for(std::uint64_t pos = 0; pos < number_relationships; ++pos)
+            relationships.emplace_back(in);
+
+    }
+
+    std::vector<std::shared_ptr<srcuml_class>> & get_classes() {
+        return classes;
+    }
+
+    const std::vector<srcuml_relationship> & get_relationships() const {
+        return relationships;
+    }
+
+    bool get_is_partial() const {
+        return is_partial;
+    }
+
+};
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file srcuml_neighborhood.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_NEIGHBORHOOD_HPP
+#define INCLUDED_SRCUML_NEIGHBORHOOD_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_adjacency.hpp>
+#include <srcuml_symbol.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * srcuml_neighborhood
+ *
+ * Classes within a number of relationships of a focus class, in either
+ * direction, so a focused diagram is laid out without the rest of the system.
+ */
+class srcuml_neighborhood {
+
+private:
+
+    const srcuml_adjacency & adjacency;
+
+    // by vertex of the adjacency
+    std::vector<char> reached;
+
+public:
+
+    /**
+     * focus is a qualified class name, or an unqualified one matching every class
+     * of that name.  A depth of 0 is only the focus.
+     */
+    srcuml_neighborhood(const std::vector<std::shared_ptr<srcuml_class>> & classes,
+                        const srcuml_adjacency & adjacency,
+                        const std::string & focus, std::size_t depth) : adjacency(adjacency), reached(adjacency.size(), 0) {
+
+        std::vector<std::size_t> frontier;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(srcuml::symbol_name(aclass->get_name_symbol()) == focus || aclass->get_name() == focus) {
+
+                const std::size_t vertex = adjacency.vertex(aclass->get_name_symbol());
+                if(vertex != adjacency.size() && !reached[vertex]) {
+                    reached[vertex] = true;
+                    frontier.push_back(vertex);
+                }
+
+            }
+
+        if(frontier.empty())
+            throw std::string("Error: No class named ") + focus;
+
+        for(std::size_t hop = 0; hop < depth && !frontier.empty(); ++hop) {
+
+            std::vector<std::size_t> next;
+            for(std::size_t vertex : frontier) {
+
+                for(const srcuml_adjacency::arc & arc : adjacency.outgoing(vertex))
+                    if(!reached[arc.vertex]) {
+                        reached[arc.vertex] = true;
+                        next.push_back(arc.vertex);
+                    }
+
+                for(const srcuml_adjacency::arc & arc : adjacency.incoming(vertex))
+                    if(!reached[arc.vertex]) {
+                        reached[arc.vertex] = true;
+                        next.push_back(arc.vertex);
+                    }
+
+            }
+
+            frontier.swap(next);
+
+        }
+
+    }
+
+    bool contains(srcuml_symbol symbol) const {
+
+        const std::size_t vertex = adjacency.vertex(symbol);
+        return vertex != adjacency.size() && reached[vertex];
+
+    }
+
+    /** the classes reached, in their original order */
+    std::vector<std::shared_ptr<srcuml_class>> select_classes(const std::vector<std::shared_ptr<srcuml_class>> & classes) const {
+
+        std::vector<std::shared_ptr<srcuml_class>> selected;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(contains(aclass->get_name_symbol()))
+                selected.push_back(aclass);
+
+        return selected;
+
+    }
+
+    /** the relationships between classes reached, in their original order */
+    std::vector<srcuml_relationship> select_relationships(const std::vector<srcuml_relationship> & relationships) const {
+
+        std::vector<srcuml_relationship> selected;
+        for(const srcuml_relationship & relationship : relationships)
+            if(contains(relationship.get_source_symbol()) && contains(relationship.get_destination_symbol()))
+                selected.push_back(relationship);
+
+        return selected;
+
+    }
+
+};
+
+#endif
@@ -28,36 +28,136 @@
 #include <srcuml_parameter.hpp>
 
 #include <srcuml_utilities.hpp>
+#include <srcuml_member_filter.hpp>
 
 #include <sstream>
 #include <iterator>
 #include <string>
+#include <vector>
 #include <set>
+#include <cstdint>
 
 class srcuml_operation {
 
 private:
-    const FunctionPolicy::FunctionData * data;
     const ClassPolicy::AccessSpecifier visibility;
 
+    std::string name;
+    std::string signature;
+
+    std::vector<srcuml_parameter> parameters;
+
+    bool has_return_type;
+    srcuml_type return_type;
+
+    bool is_static;
+    bool is_pure_virtual;
+
+    std::set<std::string> stereotypes;
+    // stereotypes as bits, see srcuml_member_filter
+    std::uint32_t stereotype_mask;
+
 public:
-    srcuml_operation(const FunctionPolicy::FunctionData * data, ClassPolicy::AccessSpecifier visibility)
+    srcuml_operation(const FunctionPolicy::FunctionData * data, ClassPolicy::AccessSpecifier visibility, srcuml_type_cache & types)
+
+        : visibility(visibility),
+          name(data->name->SimpleName()),
+          signature(data->ToString()),
+          parameters(),
+          has_return_type(data->returnType != nullptr),
+          return_type(types.resolve(data->returnType)),
+          is_static(data->isStatic),
+          is_pure_virtual(data->isPureVirtual),
+          stereotypes(data->stereotypes),
+          stereotype_mask(srcuml_member_filter::stereotype_mask(stereotypes)) {
+            analyze_operation(data, types);
+    }
+
+    /** reads an operation written by write */
+    srcuml_operation(std::istream & in)
+        : visibility((ClassPolicy::AccessSpecifier)srcuml::read_size(in)),
+          name(srcuml::read_string(in)),
+          signature(srcuml::read_string(in)),
+          parameters(),
+          has_return_type(srcuml::read_bool(in)),
+          return_type(in),
+          is_static(srcuml::read_bool(in)),
+          is_pure_virtual(srcuml::read_bool(in)),
+          stereotypes(),
+          stereotype_mask(0) {
+
+        srcuml::read_strings(in, stereotypes);
+        stereotype_mask = srcuml_member_filter::stereotype_mask(stereotypes);
+
+        std::uint64_t number_parameters = srcuml::read_size(in);
+        for(std::uint64_t pos = 0; pos < number_parameters; ++pos)
+            parameters.emplace_back(in);
+
+    }
+
+    void write(std::ostream & out) const {
+
+        srcuml::write_size(out, visibility);
+        srcuml::write_string(out, name);
+        srcuml::write_string(out, signature);
+        srcuml::write_bool(out, has_return_type);
+        return_type.write(out);
+        srcuml::write_bool(out, is_static);
+        srcuml::write_bool(out, is_pure_virtual);
+        srcuml::write_strings(out, stereotypes);
+
+        srcuml::write_size(out, parameters.size());
+        for(const srcuml_parameter & parameter : parameters)
+            parameter.write(out);
+
+    }
+
+    const std::string & get_name() const {
+
+        return name;
+
+    }
+
+    /** the full srcML signature, used to match overrides */
+    const std::string & get_signature() const {
+
+        return signature;
+
+    }
+
+    const std::vector<srcuml_parameter> & get_parameters() const {
+
+        return parameters;
+
+    }
+
+    ClassPolicy::AccessSpecifier get_visibility() const {
+
+        return visibility;
 
-        : data(data), visibility(visibility) {
-            analyze_operation();
     }
 
-    // ~srcuml_operation() { if(data) delete data; }
+    bool get_is_static() const {
 
-    const FunctionPolicy::FunctionData & get_data() const {
+        return is_static;
 
-        return *data;
+    }
+
+    bool get_is_pure_virtual() const {
+
+        return is_pure_virtual;
 
     }
 
     const std::set<std::string> & get_stereotypes() const {
 
-        return data->stereotypes;
+        return stereotypes;
+
+    }
+
+    std::uint32_t get_stereotype_mask() const {
+
+        return stereotype_mask;
 
     }
 
@@ -90,36 +190,33 @@ public:
 
         func += ' ';
 
-        func += data->name->SimpleName();
+        func += name;
 
         func += '(';
 
 
-        for(std::size_t pos = 0; pos < data->parameters.size(); ++pos) {
+        for(std::size_t pos = 0; pos < parameters.size(); ++pos) {
 
             if(pos != 0)
                 func += ", ";
 
-            srcuml_parameter the_parameter(data->parameters[pos]);
-
-            func += the_parameter.get_string_parameter();
+            func += parameters[pos].get_string_parameter();
 
         }
         func += ')';
 
 
-        if(data->returnType) {
+        if(has_return_type) {
 
-            srcuml_type the_type(data->returnType);
-            if(the_type.get_type_name() != "void") {
+            if(return_type.get_type_name() != "void") {
                 func += ": ";
-                func += the_type.get_string_type();
+                func += return_type.get_string_type();
             }            
 
         }
 
 
-        if(!data->stereotypes.empty()) {
+        if(!stereotypes.empty()) {
 
             func += " ｛";
             func += get_stereotypes_string();
@@ -132,55 +229,19 @@ public:
 
     friend std::ostream & operator<<(std::ostream & out, const srcuml_operation & operation) {
 
-        if(operation.visibility == ClassPolicy::PUBLIC)
-            out << '+';
-        else if(operation.visibility == ClassPolicy::PRIVATE)
-            out << '-';
-        else if(operation.visibility == ClassPolicy::PROTECTED)
-            out << '#';
-
-        out << ' ';
-
-        out << operation.data->name->SimpleName();
-
-        out << '(';
-        for(std::size_t pos = 0; pos < operation.data->parameters.size(); ++pos) {
-
-            if(pos != 0)
-                out << ", ";
-
-            srcuml_parameter the_parameter(operation.data->parameters[pos]);
-            out << the_parameter;
-
-        }
-        out << ')';
-
-        if(operation.data->returnType) {
-
-            srcuml_type the_type(operation.data->returnType);
-            if(the_type.get_type_name() != "void") {
-                out << ": ";
-                out << the_type;
-            }            
-
-        }
+        return out << operation.get_string_function();
 
-        if(!operation.get_stereotypes().empty()) {
+    }
 
-            out << " ｛";
-            out << operation.get_stereotypes_string();
-            out << "｝";
+private:
 
-        }
+    void analyze_operation(const FunctionPolicy::FunctionData * data, srcuml_type_cache & types) {
 
-        return out;
+        for(const ParamTypePolicy::ParamTypeData * parameter : data->parameters)
+            parameters.emplace_back(parameter, types);
 
     }
 
-private:
-
-    void analyze_operation() {}
-
 };
 
  #endif
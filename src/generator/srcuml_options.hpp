@@ -0,0 +1,192 @@
+/**
+ * @file srcuml_options.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_OPTIONS_HPP
+#define INCLUDED_SRCUML_OPTIONS_HPP
+
+#include <srcuml_dispatcher.hpp>
+#include <srcuml_shard.hpp>
+#include <srcuml_unit_filter.hpp>
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+class srcuml_cache;
+class srcuml_relationship_graph;
+class srcuml_stats;
+class srcuml_cancel;
+class srcuml_artifact;
+
+/** what groups classes into the clusters of svg_multi */
+enum cluster_source { NAMESPACE_CLUSTERS, DIRECTORY_CLUSTERS };
+
+inline cluster_source parse_cluster_source(const std::string & source) {
+
+	if(source == "namespace")
+		return NAMESPACE_CLUSTERS;
+	if(source == "directory")
+		return DIRECTORY_CLUSTERS;
+
+	throw std::string("Error: Unknown cluster source ") + source + ". Can be {namespace, directory}";
+
+}
+
+/** what is done with classes of the same qualified name parsed from several units */
+enum duplicate_policy { KEEP_DUPLICATES, MERGE_DUPLICATES, NEWEST_DUPLICATES };
+
+inline duplicate_policy parse_duplicate_policy(const std::string & policy) {
+
+	if(policy == "keep")
+		return KEEP_DUPLICATES;
+	if(policy == "merge")
+		return MERGE_DUPLICATES;
+	if(policy == "newest")
+		return NEWEST_DUPLICATES;
+
+	throw std::string("Error: Unknown duplicate policy ") + policy + ". Can be {keep, merge, newest}";
+
+}
+
+/**
+ * srcuml_options
+ *
+ * Settings for a single srcuml_handler run.
+ */
+struct srcuml_options {
+
+	// comma separated output types, see srcuml_handler
+	std::string type = "svg_sugiyama";
+
+	// release the srcML data of each class as soon as it is summarized, nothing reads it
+	// afterwards so the SAX trees do not pile up, the input and every summary are still kept
+	bool streaming = true;
+
+	// a lone dot or yuml output has each class written as soon as it is parsed, the relationships at the end
+	bool early_output = false;
+
+	// classes and relationships are output by qualified name instead of in the order parsed, so the
+	// output does not depend on the order of the units, the threads or the cache. Classes written
+	// early stay in the order parsed
+	bool sorted = true;
+
+	// number of threads used to parse the units of an archive and to run the outputters
+	std::size_t threads = 1;
+
+	// milliseconds the optimal svg_sugiyama layout may take before the fast one is used, 0 for no limit
+	std::size_t layout_budget = 0;
+	// largest graphs, in classes, given the optimal layout, larger ones use a fast layout
+	std::size_t optimal_limit = 300;
+	// lay out each connected component of the svg_sugiyama graph on its own, in parallel
+	bool layout_components = false;
+	// file of svg_sugiyama drawings reused for unchanged components, and with .three appended of svg_three bands, empty disables it
+	std::string layout_cache;
+	// file the changes to the svg_sugiyama drawing since the last run are written to, see svg_patch, empty writes none
+	std::string svg_patch;
+	// SVG edges passing over other classes are drawn over them instead of beneath them
+	bool raise_edges = false;
+	// svg_sugiyama crossing minimization runs made in parallel, the fewest crossings are kept
+	std::size_t crossmin_runs = 1;
+
+	// svg_three lays out each stereotype as a band instead of using ClusterPlanarizationLayout
+	bool three_bands = false;
+
+	// groups laid out separately by svg_multi
+	cluster_source clusters = NAMESPACE_CLUSTERS;
+	// directory svg_multi writes one SVG per cluster to, empty only writes the summary
+	std::string cluster_directory;
+
+	// directory the SVG outputs are also written to as tiles with a JSON manifest, empty writes no tiles
+	std::string tile_directory;
+	// width and height of a tile in layout units
+	double tile_size = 2000;
+
+	// class whose neighborhood is drawn instead of the whole system, empty draws every class
+	std::string focus;
+	// relationships followed from the focus class
+	std::size_t focus_depth = 1;
+
+	// classes of the highest rank drawn as an overview of the system, the paths through the others collapsed into dependencies, 0 draws every class, see srcuml_ranking
+	std::size_t top_classes = 0;
+
+	// level of detail of the drawn edges, edge_detail bits, see srcuml_edge_filter
+	unsigned edge_detail = 0;
+
+	// limits degrading the output of pathological inputs, 0 for no limit, see srcuml_handler::apply_limits
+	// classes beyond which the SVG outputs are drawn as svg_overview, without dependencies or members
+	std::size_t max_classes = 0;
+	// relationships from a class beyond which its dependencies are dropped, then its other relationships
+	std::size_t max_edges_per_class = 0;
+	// attribute and operation lines of a class beyond which they are drawn as counts
+	std::size_t max_label_lines = 0;
+	// attributes, and operations, of a class drawn before the rest is drawn as "… k more", see svg_outputter::add_members
+	std::size_t max_members = 0;
+	// file every member of the classes cut short by max_members is written to, as yUML, empty writes none
+	std::string members_file;
+	// soft cap in bytes of the resident memory, beyond it srcML data is freed while parsing and the output degrades as with max_classes
+	std::size_t memory_limit = 0;
+
+	// srcML events dispatched to the policies
+	event_profile profile = FULL_PROFILE;
+
+	// classify method and class stereotypes while parsing, see srcuml_stereotyper, instead of relying on stereotype.xsl
+	bool stereotypes = false;
+
+	// directory of per-unit class summaries, empty disables the cache
+	std::string cache_directory;
+
+	// bytes of unit summaries a cache keeps in memory, past it the least recently used are only kept in cache_directory
+	std::size_t cache_memory = 256 * 1024 * 1024;
+
+	// cache shared between runs, e.g. kept warm by a server, used instead of cache_directory
+	srcuml_cache * cache = nullptr;
+
+	// relationships kept between runs and only regenerated where classes changed, nullptr analyzes from scratch
+	srcuml_relationship_graph * graph = nullptr;
+
+	// phase times and counts of the run are added to it, nullptr records nothing
+	srcuml_stats * stats = nullptr;
+
+	// once cancelled, e.g. by its deadline, the run cuts each phase short and writes degraded output, nullptr never cancels
+	srcuml_cancel * cancel = nullptr;
+
+	// stream for each output type, empty writes every type to the handler's stream
+	std::vector<std::ostream *> outputs;
+
+	// file for each output type, only rendered when what it is drawn from changed, used instead of outputs
+	std::vector<srcuml_artifact *> artifacts;
+
+	// file the analyzed model is saved to, empty does not save it
+	std::string emit_model;
+
+	// only the units of the shard are parsed and saved to emit_model as a partial model, nothing is rendered
+	srcuml_shard shard;
+
+	// units and classes extracted, the rest is skipped before it is parsed or summarized
+	srcuml_unit_filter filter;
+
+	// copies of a class are kept, merged when their structure is the same, or only the last parsed is kept
+	duplicate_policy duplicates = KEEP_DUPLICATES;
+
+};
+
+#endif
@@ -0,0 +1,648 @@
+/**
+ * @file srcuml_output.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_OUTPUT_HPP
+#define INCLUDED_SRCUML_OUTPUT_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <streambuf>
+#include <ostream>
+#include <sstream>
+#include <fstream>
+#include <cstddef>
+#include <cstdio>
+
+#include <zlib.h>
+
+/** how an output is written */
+enum output_compression { NO_COMPRESSION, GZIP_COMPRESSION };
+
+inline output_compression parse_output_compression(const std::string & compression) {
+
+	if(compression == "none")
+		return NO_COMPRESSION;
+	if(compression == "gzip")
+		return GZIP_COMPRESSION;
+
+	throw std::string("Error: Unknown compression ") + compression + ". Can be {none, gzip}";
+
+}
+
+/** gzip for .svgz and .gz files */
+inline output_compression compression_of(const std::string & filename) {
+
+	for(const char * extension : { ".svgz", ".gz" }) {
+
+		const std::size_t length = std::char_traits<char>::length(extension);
+		if(filename.size() >= length && filename.compare(filename.size() - length, length, extension) == 0)
+			return GZIP_COMPRESSION;
+
+	}
+
+	return NO_COMPRESSION;
+
+}
+
+/**
+ * srcuml_gzip_buffer
+ *
+ * Stream buffer that gzips what is written to it on a background thread, so
+ * compression overlaps with rendering.  Written data is handed over in chunks;
+ * at most MAX_PENDING chunks wait for the thread before writing blocks.
+ */
+class srcuml_gzip_buffer : public std::streambuf {
+
+private:
+
+	enum : std::size_t { CHUNK_SIZE = 1 << 18, MAX_PENDING = 4 };
+
+	std::ostream & sink;
+
+	std::vector<char> chunk;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<std::vector<char>> pending;
+	bool is_finished;
+	std::string error;
+
+	std::thread compressor;
+
+public:
+
+	srcuml_gzip_buffer(std::ostream & sink)
+		: sink(sink), chunk(CHUNK_SIZE), mutex(), changed(), pending(), is_finished(false), error(), compressor() {
+
+		setp(chunk.data(), chunk.data() + chunk.size());
+		compressor = std::thread([this]() { compress(); });
+
+	}
+
+	~srcuml_gzip_buffer() {
+
+		try {
+			close();
+		} catch(...) {}
+
+	}
+
+	/** compresses the rest and waits for the thread, throws if writing failed */
+	void close() {
+
+		if(!compressor.joinable())
+			return;
+
+		hand_over();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_finished = true;
+		}
+		changed.notify_all();
+		compressor.join();
+
+		sink.flush();
+		if(!error.empty())
+			throw error;
+
+	}
+
+protected:
+
+	int_type overflow(int_type character) override {
+
+		if(!hand_over())
+			return traits_type::eof();
+
+		if(!traits_type::eq_int_type(character, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(character);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(character);
+
+	}
+
+	/** data already written stays pending, only the thread writes the sink */
+	int sync() override {
+		return hand_over() ? 0 : -1;
+	}
+
+private:
+
+	bool hand_over() {
+
+		std::size_t size = pptr() - pbase();
+		if(size) {
+
+			std::vector<char> full(CHUNK_SIZE);
+			full.swap(chunk);
+			full.resize(size);
+
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [this]() { return pending.size() < MAX_PENDING || !error.empty(); });
+			pending.push_back(std::move(full));
+			lock.unlock();
+			changed.notify_all();
+
+			setp(chunk.data(), chunk.data() + chunk.size());
+
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return error.empty();
+
+	}
+
+	void compress() {
+
+		z_stream stream = z_stream();
+		// 16 asks zlib for a gzip header and trailer
+		if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			fail("Error: Unable to start gzip compression");
+			return;
+		}
+
+		std::vector<char> compressed(CHUNK_SIZE);
+		while(true) {
+
+			std::vector<char> input;
+			bool is_last = false;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [this]() { return !pending.empty() || is_finished; });
+				if(!pending.empty()) {
+					input = std::move(pending.front());
+					pending.pop_front();
+				}
+				is_last = pending.empty() && is_finished;
+			}
+			changed.notify_all();
+
+			stream.next_in = reinterpret_cast<Bytef *>(input.data());
+			stream.avail_in = static_cast<uInt>(input.size());
+			const int flush = is_last ? Z_FINISH : Z_NO_FLUSH;
+			do {
+
+				stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+				stream.avail_out = static_cast<uInt>(compressed.size());
+				deflate(&stream, flush);
+
+				sink.write(compressed.data(), compressed.size() - stream.avail_out);
+
+			} while(stream.avail_out == 0);
+
+			if(!sink) {
+				fail("Error: Unable to write compressed output");
+				break;
+			}
+
+			if(is_last)
+				break;
+
+		}
+
+		deflateEnd(&stream);
+
+	}
+
+	void fail(const std::string & message) {
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			error = message;
+		}
+		changed.notify_all();
+
+	}
+
+};
+
+/**
+ * srcuml_compressed_stream
+ *
+ * Output stream gzipping into a sink, which it owns if given one.
+ */
+class srcuml_compressed_stream : public std::ostream {
+
+private:
+
+	std::unique_ptr<std::ostream> owned_sink;
+	srcuml_gzip_buffer buffer;
+
+public:
+
+	srcuml_compressed_stream(std::ostream & sink) : std::ostream(nullptr), owned_sink(), buffer(sink) {
+		rdbuf(&buffer);
+	}
+
+	srcuml_compressed_stream(std::unique_ptr<std::ostream> sink)
+		: std::ostream(nullptr), owned_sink(std::move(sink)), buffer(*owned_sink) {
+		rdbuf(&buffer);
+	}
+
+	/** finishes the compressed data, throws if it could not be written */
+	void close() {
+		buffer.close();
+	}
+
+};
+
+/** the stream for an output file, written with compression as given or by its extension */
+inline std::ostream * open_output(const std::string & filename, output_compression compression) {
+
+	if(compression == NO_COMPRESSION)
+		return new std::ofstream(filename);
+
+	return new srcuml_compressed_stream(std::unique_ptr<std::ostream>(new std::ofstream(filename, std::ios::binary)));
+
+}
+
+inline std::ostream * open_output(const std::string & filename) {
+	return open_output(filename, compression_of(filename));
+}
+
+/**
+ * srcuml_async_writer
+ *
+ * Writes output files on a thread of its own, e.g. for every job of a batch,
+ * so the next job is laid out and rendered while the last one is written.
+ * Streams from open hand their data over in chunks as it is rendered; once
+ * max_pending bytes wait for the thread, writing to a stream blocks.  Files
+ * are opened by the thread and their failures are collected for finish.
+ * With use_archive, files are gathered whole instead and each is handed to
+ * the archive once complete, one at a time, see srcuml_archive.  A file
+ * whose stream is abandoned, e.g. by a failed job, is neither archived nor
+ * kept on disk.
+ */
+class srcuml_async_writer {
+
+public:
+
+	enum : std::size_t { CHUNK_SIZE = 1 << 18, MAX_PENDING_BYTES = 1 << 26 };
+
+	/** a file being written, shared by its stream and the chunks waiting for it */
+	struct target {
+
+		std::string filename;
+		output_compression compression;
+		std::unique_ptr<std::ostream> stream;
+		bool has_failed;
+
+		// the data so far of a file bound for the archive
+		std::string archived;
+
+	};
+
+private:
+
+	struct chunk {
+
+		std::shared_ptr<target> file;
+		std::vector<char> data;
+		bool is_last;
+		bool is_abandoned;
+
+	};
+
+	std::size_t max_pending;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<chunk> pending;
+	std::size_t pending_bytes;
+	bool is_finished;
+	std::vector<std::string> errors;
+
+	// adds a complete file to the archive on the thread, empty writes files
+	std::function<void(const std::string &, const std::string &)> archive;
+
+	std::thread writer;
+
+public:
+
+	srcuml_async_writer(std::size_t max_pending = MAX_PENDING_BYTES)
+		: max_pending(max_pending), mutex(), changed(), pending(), pending_bytes(0), is_finished(false), errors(), archive(), writer() {
+
+		writer = std::thread([this]() { write(); });
+
+	}
+
+	~srcuml_async_writer() {
+
+		finish();
+
+	}
+
+	/** stream written to filename by the thread, it must be destroyed before finish */
+	std::unique_ptr<std::ostream> open(const std::string & filename, output_compression compression);
+
+	std::unique_ptr<std::ostream> open(const std::string & filename) {
+		return open(filename, compression_of(filename));
+	}
+
+	/**
+	 * Files are added to an archive instead of written, add is called on the
+	 * thread with each complete file's name and data, compressed as the file
+	 * would be, and throws a std::string on failure.  Called before any open.
+	 */
+	void use_archive(const std::function<void(const std::string &, const std::string &)> & add) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		archive = add;
+
+	}
+
+	/** queues data for file, blocks while max_pending bytes are queued, an abandoned file is dropped */
+	void submit(const std::shared_ptr<target> & file, std::vector<char> && data, bool is_last, bool is_abandoned = false) {
+
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return pending_bytes < max_pending; });
+		pending_bytes += data.size();
+		pending.push_back(chunk{ file, std::move(data), is_last, is_abandoned });
+		lock.unlock();
+		changed.notify_all();
+
+	}
+
+	/** writes what is queued and stops the thread, returns a "filename: error" for each failed file */
+	std::vector<std::string> finish() {
+
+		if(writer.joinable()) {
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				is_finished = true;
+			}
+			changed.notify_all();
+			writer.join();
+
+		}
+
+		return errors;
+
+	}
+
+private:
+
+	void write() {
+
+		while(true) {
+
+			chunk next;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [this]() { return !pending.empty() || is_finished; });
+				if(pending.empty())
+					return;
+
+				next = std::move(pending.front());
+				pending.pop_front();
+				pending_bytes -= next.data.size();
+			}
+			changed.notify_all();
+
+			target & file = *next.file;
+			if(file.has_failed)
+				continue;
+
+			if(next.is_abandoned) {
+				drop(file);
+				continue;
+			}
+
+			try {
+
+				if(archive) {
+					archive_chunk(file, next);
+					continue;
+				}
+
+				if(!file.stream)
+					file.stream.reset(open_output(file.filename, file.compression));
+
+				file.stream->write(next.data.data(), next.data.size());
+				if(next.is_last) {
+
+					if(srcuml_compressed_stream * compressed = dynamic_cast<srcuml_compressed_stream *>(file.stream.get()))
+						compressed->close();
+					file.stream->flush();
+
+				}
+
+				if(!*file.stream)
+					throw std::string("Error: Unable to write ") + file.filename;
+
+			} catch(const std::string & error) {
+				fail(file, error);
+			}
+
+			if(next.is_last || file.has_failed)
+				file.stream.reset();
+
+		}
+
+	}
+
+	/** gathers the file, compressed as a whole once complete, and adds it to the archive */
+	void archive_chunk(target & file, const chunk & next) {
+
+		file.archived.append(next.data.data(), next.data.size());
+		if(!next.is_last)
+			return;
+
+		if(file.compression != NO_COMPRESSION) {
+
+			std::ostringstream compressed;
+			srcuml_compressed_stream stream(compressed);
+			stream.write(file.archived.data(), file.archived.size());
+			stream.close();
+			file.archived = compressed.str();
+
+		}
+
+		archive(file.filename, file.archived);
+		std::string().swap(file.archived);
+
+	}
+
+	/** what was gathered of an abandoned file is discarded, what was written of it removed */
+	void drop(target & file) {
+
+		std::string().swap(file.archived);
+		if(!file.stream)
+			return;
+
+		file.stream.reset();
+		std::remove(file.filename.c_str());
+
+	}
+
+	void fail(target & file, const std::string & error) {
+
+		file.has_failed = true;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		errors.push_back(file.filename + ": " + error);
+
+	}
+
+};
+
+/**
+ * srcuml_async_buffer
+ *
+ * Stream buffer handing what is written to it to a srcuml_async_writer in
+ * chunks.  Only the writer's thread touches the file.
+ */
+class srcuml_async_buffer : public std::streambuf {
+
+private:
+
+	srcuml_async_writer & writer;
+	std::shared_ptr<srcuml_async_writer::target> file;
+
+	std::vector<char> chunk;
+	bool is_closed;
+
+public:
+
+	srcuml_async_buffer(srcuml_async_writer & writer, const std::string & filename, output_compression compression)
+		: writer(writer),
+		  file(new srcuml_async_writer::target{ filename, compression, nullptr, false }),
+		  chunk(srcuml_async_writer::CHUNK_SIZE),
+		  is_closed(false) {
+
+		setp(chunk.data(), chunk.data() + chunk.size());
+
+	}
+
+	~srcuml_async_buffer() {
+
+		close();
+
+	}
+
+	/** hands over the rest, the writer then finishes the file */
+	void close() {
+
+		if(is_closed)
+			return;
+
+		hand_over(true);
+		is_closed = true;
+
+	}
+
+	/** drops what is not handed over yet, the writer then drops the file, see srcuml_async_writer */
+	void abandon() {
+
+		if(is_closed)
+			return;
+
+		setp(chunk.data(), chunk.data() + chunk.size());
+		writer.submit(file, std::vector<char>(), true, true);
+		is_closed = true;
+
+	}
+
+protected:
+
+	int_type overflow(int_type character) override {
+
+		hand_over(false);
+
+		if(!traits_type::eq_int_type(character, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(character);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(character);
+
+	}
+
+	/** the file is only written by the writer's thread, syncing waits for nothing */
+	int sync() override {
+		return 0;
+	}
+
+private:
+
+	void hand_over(bool is_last) {
+
+		std::size_t size = pptr() - pbase();
+		if(!size && !is_last)
+			return;
+
+		std::vector<char> full(is_last ? 0 : srcuml_async_writer::CHUNK_SIZE);
+		full.swap(chunk);
+		full.resize(size);
+		writer.submit(file, std::move(full), is_last);
+
+		setp(chunk.data(), chunk.data() + chunk.size());
+
+	}
+
+};
+
+/**
+ * srcuml_async_stream
+ *
+ * Output stream written by a srcuml_async_writer, see srcuml_async_writer::open.
+ */
+class srcuml_async_stream : public std::ostream {
+
+private:
+
+	srcuml_async_buffer buffer;
+
+public:
+
+	srcuml_async_stream(srcuml_async_writer & writer, const std::string & filename, output_compression compression)
+		: std::ostream(nullptr), buffer(writer, filename, compression) {
+		rdbuf(&buffer);
+	}
+
+	/** the rest is handed to the writer, which then finishes the file */
+	void close() {
+		buffer.close();
+	}
+
+	/** the file is incomplete, e.g. its rendering failed, it is neither archived nor kept */
+	void abandon() {
+		buffer.abandon();
+	}
+
+};
+
+inline std::unique_ptr<std::ostream> srcuml_async_writer::open(const std::string & filename, output_compression compression) {
+
+	return std::unique_ptr<std::ostream>(new srcuml_async_stream(*this, filename, compression));
+
+}
+
+#endif
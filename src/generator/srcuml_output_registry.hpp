@@ -0,0 +1,200 @@
+/**
+ * @file srcuml_output_registry.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_OUTPUT_REGISTRY_HPP
+#define INCLUDED_SRCUML_OUTPUT_REGISTRY_HPP
+
+#include <srcuml_options.hpp>
+#include <srcuml_outputter.hpp>
+#include <dot_outputter.hpp>
+#include <yuml_outputter.hpp>
+#include <svg_sugiyama_outputter.hpp>
+#include <svg_multi_outputter.hpp>
+#include <svg_three_outputter.hpp>
+#include <svg_overview_outputter.hpp>
+#include <svg_hierarchy_outputter.hpp>
+#include <layout_outputter.hpp>
+#include <svg_tiles.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <cstddef>
+
+// output types built in, in the order srcuml_output_registry adds them, formats added later follow
+enum output_type : std::size_t {dot, yuml, svg_sugiyama, svg_multi, svg_three, svg_overview, layout_json, layout_binary, svg_hierarchy};
+
+/** what an outputter is made from, see srcuml_output_registry */
+struct srcuml_output_context {
+
+	const srcuml_options & options;
+	// attribute and operation lines of a class drawn before they are collapsed into counts
+	std::size_t member_lines;
+
+	/** tiles of the SVG output type name, if options.tile_directory asks for them */
+	svg_tiles tiles(const char * name) const {
+		return svg_tiles(options.tile_directory, name, options.tile_size, options.threads);
+	}
+
+};
+
+/**
+ * srcuml_output_registry
+ *
+ * The output formats by name, each with the factory of its outputter, so a
+ * format is added without changing srcuml_handler.  Formats are added before
+ * any handler runs, the registry is only read once handlers do.
+ */
+class srcuml_output_registry {
+
+public:
+
+	typedef std::function<std::unique_ptr<srcuml_outputter>(const srcuml_output_context &)> factory;
+
+private:
+
+	std::vector<std::pair<std::string, factory>> formats;
+
+	srcuml_output_registry() : formats() {
+
+		add("dot", [](const srcuml_output_context &) {
+			return std::unique_ptr<srcuml_outputter>(new dot_outputter());
+		});
+
+		add("yuml", [](const srcuml_output_context &) {
+			return std::unique_ptr<srcuml_outputter>(new yuml_outputter());
+		});
+
+		add("svg_sugiyama", [](const srcuml_output_context & context) {
+			const srcuml_options & options = context.options;
+			std::unique_ptr<svg_sugiyama_outputter> outputter(new svg_sugiyama_outputter(options.layout_budget, options.layout_components, options.threads,
+																						 options.layout_cache, options.crossmin_runs));
+			use_svg_options(*outputter, context, "svg_sugiyama");
+			outputter->use_optimal_limit(options.optimal_limit);
+			if(!options.svg_patch.empty())
+				outputter->use_patch(options.svg_patch, options.layout_cache + ".patch");
+			return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+		});
+
+		add("svg_multi", [](const srcuml_output_context & context) {
+			const srcuml_options & options = context.options;
+			std::unique_ptr<svg_multi_outputter> outputter(new svg_multi_outputter(options.clusters, options.cluster_directory, options.threads, options.layout_budget));
+			use_svg_options(*outputter, context, "svg_multi");
+			outputter->use_optimal_limit(options.optimal_limit);
+			return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+		});
+
+		add("svg_three", [](const srcuml_output_context & context) {
+			const srcuml_options & options = context.options;
+			std::unique_ptr<svg_three_outputter> outputter(new svg_three_outputter(options.three_bands, options.threads, options.layout_budget,
+																				   options.layout_cache.empty() ? "" : options.layout_cache + ".three"));
+			use_svg_options(*outputter, context, "svg_three");
+			outputter->use_optimal_limit(options.optimal_limit);
+			return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+		});
+
+		add("svg_overview", [](const srcuml_output_context & context) {
+			std::unique_ptr<svg_outputter> outputter(new svg_overview_outputter());
+			use_svg_options(*outputter, context, "svg_overview");
+			return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+		});
+
+		add("layout_json", [](const srcuml_output_context & context) {
+			return make_layout(JSON_LAYOUT, context.options);
+		});
+
+		add("layout_binary", [](const srcuml_output_context & context) {
+			return make_layout(BINARY_LAYOUT, context.options);
+		});
+
+		add("svg_hierarchy", [](const srcuml_output_context & context) {
+			std::unique_ptr<svg_outputter> outputter(new svg_hierarchy_outputter());
+			use_svg_options(*outputter, context, "svg_hierarchy");
+			return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+		});
+
+	}
+
+	static void use_svg_options(svg_outputter & outputter, const srcuml_output_context & context, const char * name) {
+
+		outputter.use_tiles(context.tiles(name));
+		outputter.use_draw_threads(context.options.threads);
+		outputter.use_member_lines(context.member_lines);
+		outputter.use_max_members(context.options.max_members);
+		outputter.use_raise_edges(context.options.raise_edges);
+
+	}
+
+	static std::unique_ptr<srcuml_outputter> make_layout(layout_format format, const srcuml_options & options) {
+
+		std::unique_ptr<layout_outputter> outputter(new layout_outputter(format, options.layout_budget, options.layout_components,
+																		 options.threads, options.layout_cache, options.crossmin_runs));
+		outputter->use_optimal_limit(options.optimal_limit);
+		return std::unique_ptr<srcuml_outputter>(std::move(outputter));
+
+	}
+
+public:
+
+	static srcuml_output_registry & instance() {
+
+		static srcuml_output_registry registry;
+		return registry;
+
+	}
+
+	/** adds a format, returns its output type */
+	std::size_t add(const std::string & name, factory make) {
+
+		std::size_t type;
+		if(find(name, type))
+			throw std::string("Error: Output type ") + name + " is already registered";
+
+		formats.emplace_back(name, make);
+		return formats.size() - 1;
+
+	}
+
+	bool find(const std::string & name, std::size_t & type) const {
+
+		for(std::size_t pos = 0; pos < formats.size(); ++pos)
+			if(formats[pos].first == name) {
+				type = pos;
+				return true;
+			}
+
+		return false;
+
+	}
+
+	const std::string & get_name(std::size_t type) const {
+		return formats.at(type).first;
+	}
+
+	std::unique_ptr<srcuml_outputter> make(std::size_t type, const srcuml_output_context & context) const {
+		return formats.at(type).second(context);
+	}
+
+};
+
+#endif
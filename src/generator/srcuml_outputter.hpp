@@ -24,17 +24,86 @@
 
 #include <srcuml_class.hpp>
 #include <srcuml_relationship.hpp>
+#include <srcuml_edge_filter.hpp>
+#include <srcuml_stats.hpp>
+#include <srcuml_cancel.hpp>
+
+#include <unordered_map>
 
 
 class srcuml_outputter {
 
+private:
+
+	const std::vector<srcuml_relationship> * analyzed_relationships = nullptr;
+
+	srcuml_edge_filter edge_filter;
+
+	srcuml_stats * stats = nullptr;
+
+	const srcuml_cancel * cancel = nullptr;
+
 public:
 
+	virtual ~srcuml_outputter() {}
+
 	virtual bool output(std::ostream & out, std::vector<std::shared_ptr<srcuml_class>> & classes) = 0;
 
+	/** relationships analyzed beforehand are used instead of analyzing again, they must outlive output */
+	void use_relationships(const std::vector<srcuml_relationship> & relationships) {
+
+		analyzed_relationships = &relationships;
+
+	}
+
+	/** level of detail applied by merge_edges, see srcuml_edge_filter */
+	void use_edge_filter(const srcuml_edge_filter & filter) {
+
+		edge_filter = filter;
+
+	}
+
+	/** phase times and counts are added to stats, nullptr records nothing */
+	void use_stats(srcuml_stats * stats) {
+
+		this->stats = stats;
+
+	}
+
+	srcuml_stats * get_stats() const {
+
+		return stats;
+
+	}
+
+	/** once cancelled the layout and drawing are cut short for a degraded output, nullptr never cancels */
+	void use_cancel(const srcuml_cancel * cancel) {
+
+		this->cancel = cancel;
+
+	}
+
+	const srcuml_cancel * get_cancel() const {
+
+		return cancel;
+
+	}
+
+	std::vector<srcuml_edge> merge_edges(const srcuml_relationships & relationships, bool directed) const {
+
+		if(edge_filter.is_empty())
+			return relationships.merge_edges(directed);
+
+		return edge_filter.apply(relationships.merge_edges(directed), relationships.get_relationships(), directed);
+
+	}
+
 	virtual srcuml_relationships analyze_relationships(std::vector<std::shared_ptr<srcuml_class>> & classes) {
 
-	return srcuml_relationships(classes);
+	if(analyzed_relationships)
+		return srcuml_relationships(classes, *analyzed_relationships);
+
+	return srcuml_relationships(classes, 1, stats, cancel);
 
 	}
 
@@ -31,26 +31,36 @@ class srcuml_parameter {
 
 private:
 
-    const ParamTypePolicy::ParamTypeData * data;
-
     srcuml_type type;
     std::string name;
 
-    bool is_pointer;
-
     bool has_index;
     std::string index;
 
 public:
-    srcuml_parameter(const ParamTypePolicy::ParamTypeData * data)
-        : data(data),
-          type(data->type),
+    srcuml_parameter(const ParamTypePolicy::ParamTypeData * data, srcuml_type_cache & types)
+        : type(types.resolve(data->type)),
           name(data->name ? data->name->ToString() : ""),
-          is_pointer(type.get_is_pointer()),
           has_index(false),
           index() {
 
-            analyze_parameter();
+            analyze_parameter(data);
+
+    }
+
+    /** reads a parameter written by write */
+    srcuml_parameter(std::istream & in)
+        : type(in),
+          name(srcuml::read_string(in)),
+          has_index(srcuml::read_bool(in)),
+          index(srcuml::read_string(in)) {}
+
+    void write(std::ostream & out) const {
+
+        type.write(out);
+        srcuml::write_string(out, name);
+        srcuml::write_bool(out, has_index);
+        srcuml::write_string(out, index);
 
     }
 
@@ -67,7 +77,7 @@ public:
         if(!index.empty()) {
 
             std::string multiplicity = "［";
-            if(is_pointer)
+            if(type.get_is_pointer())
                 multiplicity += "0..";
             multiplicity += index;
             multiplicity += "］";
@@ -76,7 +86,7 @@ public:
 
         } 
 
-        if(is_pointer
+        if(type.get_is_pointer()
             || has_index
             || type.get_is_container()) {
             return "［*］";
@@ -90,8 +100,6 @@ public:
 
     }
 
-    // ~srcuml_parameter() { if(data) delete data; }
-
     std::string get_string_parameter() const {
 
         std::string para = "";
@@ -108,19 +116,12 @@ public:
 
     friend std::ostream & operator<<(std::ostream & out, const srcuml_parameter & parameter) {
 
-        if(!parameter.type.get_is_const() && (parameter.type.get_is_pointer() || parameter.type.get_is_reference()))
-            out << "inout ";
-
-        out << parameter.name << ": " << parameter.type;
-
-        // out << parameter.get_multiplicity();
-
-        return out;
+        return out << parameter.get_string_parameter();
 
     }
 
 private:
-    void analyze_parameter() {
+    void analyze_parameter(const ParamTypePolicy::ParamTypeData * data) {
 
         if(!data->name) return;
 
@@ -0,0 +1,156 @@
+/**
+ * @file srcuml_pipeline.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_PIPELINE_HPP
+#define INCLUDED_SRCUML_PIPELINE_HPP
+
+#include <srcuml_allocation.hpp>
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <cstddef>
+
+/**
+ * srcuml_stage
+ *
+ * A stage of a pipeline: items pushed by one thread are processed by worker
+ * threads while the pusher keeps going.  At most capacity items wait, beyond
+ * that push blocks, so a fast producer cannot outgrow memory.  process(item,
+ * worker) is given the number of the worker so it can keep per-worker state.
+ * Items are processed in no particular order.  Once a worker fails no further
+ * item is processed: those pushed later and those still waiting are destroyed,
+ * so an item owning its data, e.g. through a std::unique_ptr, frees it.
+ */
+template<typename item>
+class srcuml_stage {
+
+private:
+
+    std::function<void(item &, std::size_t)> process;
+    std::size_t capacity;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<item> pending;
+    bool is_closed;
+    std::exception_ptr error;
+
+    std::vector<std::thread> workers;
+
+public:
+
+    srcuml_stage(std::size_t number_workers, std::size_t capacity, std::function<void(item &, std::size_t)> process)
+        : process(process), capacity(capacity ? capacity : 1), mutex(), changed(), pending(), is_closed(false), error(), workers() {
+
+        const int phase = srcuml_allocation::get_phase();
+        for(std::size_t worker = 0; worker < number_workers; ++worker)
+            workers.emplace_back([this, worker, phase]() {
+                srcuml_allocation::phase_scope scope(phase);
+                work(worker);
+            });
+
+    }
+
+    srcuml_stage(const srcuml_stage &) = delete;
+    srcuml_stage & operator=(const srcuml_stage &) = delete;
+
+    ~srcuml_stage() {
+
+        close();
+
+    }
+
+    /** waits while the stage is full, destroyed unprocessed once a worker has failed */
+    void push(item value) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return pending.size() < capacity || error; });
+        if(error)
+            return;
+
+        pending.push_back(std::move(value));
+        lock.unlock();
+        changed.notify_all();
+
+    }
+
+    /** processes what is left, waits for the workers and rethrows the first exception a worker threw */
+    void finish() {
+
+        close();
+        if(error)
+            std::rethrow_exception(error);
+
+    }
+
+private:
+
+    void close() {
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_closed = true;
+        }
+        changed.notify_all();
+
+        for(std::thread & worker : workers)
+            if(worker.joinable())
+                worker.join();
+
+    }
+
+    void work(std::size_t worker) {
+
+        while(true) {
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return !pending.empty() || is_closed || error; });
+            if(pending.empty() || error)
+                return;
+
+            item value = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            changed.notify_all();
+
+            try {
+                process(value, worker);
+            } catch(...) {
+                std::lock_guard<std::mutex> error_lock(mutex);
+                if(!error)
+                    error = std::current_exception();
+                // nothing else is processed, so what waits is released now rather than with the stage
+                pending.clear();
+                changed.notify_all();
+            }
+
+        }
+
+    }
+
+};
+
+#endif
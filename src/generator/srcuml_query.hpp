@@ -0,0 +1,236 @@
+/**
+ * @file srcuml_query.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_QUERY_HPP
+#define INCLUDED_SRCUML_QUERY_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_model.hpp>
+#include <srcuml_adjacency.hpp>
+#include <srcuml_symbol.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+
+/**
+ * srcuml_query
+ *
+ * Answers questions about the classes of an analyzed model without laying it
+ * out: who depends on a class, what inherits from it, what implements an
+ * interface, which classes are interfaces and which own an attribute of a
+ * type.  The relationships are indexed once in a srcuml_adjacency, each
+ * answer only walks what it reaches.  Classes are named qualified or not, as for
+ * srcuml_neighborhood, and answered in the order of the model.
+ */
+class srcuml_query {
+
+private:
+
+    const std::vector<std::shared_ptr<srcuml_class>> & classes;
+
+    const srcuml_adjacency adjacency;
+
+    /** vertices of the classes named, each once */
+    std::vector<std::size_t> find(const std::string & name) const {
+
+        std::vector<std::size_t> found;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(srcuml::symbol_name(aclass->get_name_symbol()) == name || aclass->get_name() == name)
+                if(std::find(found.begin(), found.end(), adjacency.vertex(aclass->get_name_symbol())) == found.end())
+                    found.push_back(adjacency.vertex(aclass->get_name_symbol()));
+
+        if(found.empty())
+            throw std::string("Error: No class named ") + name;
+
+        return found;
+
+    }
+
+    /** the classes reached, in the order of the model */
+    std::vector<std::shared_ptr<srcuml_class>> select(const std::vector<char> & reached) const {
+
+        std::vector<std::shared_ptr<srcuml_class>> selected;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(reached[adjacency.vertex(aclass->get_name_symbol())])
+                selected.push_back(aclass);
+
+        return selected;
+
+    }
+
+    /** every class reaching name through relationships of the types, not name itself */
+    std::vector<char> descendants(const std::string & name, bool generalizations, bool realizations) const {
+
+        const std::vector<std::size_t> roots = find(name);
+        std::vector<char> reached(adjacency.size(), 0);
+        for(std::size_t root : roots)
+            reached[root] = true;
+
+        std::vector<std::size_t> frontier = roots;
+        while(!frontier.empty()) {
+
+            const std::size_t vertex = frontier.back();
+            frontier.pop_back();
+
+            for(relationship_type type : { GENERALIZATION, REALIZATION }) {
+
+                if(type == GENERALIZATION ? !generalizations : !realizations)
+                    continue;
+
+                for(const srcuml_adjacency::arc & arc : adjacency.incoming(vertex, type))
+                    if(!reached[arc.vertex]) {
+                        reached[arc.vertex] = true;
+                        frontier.push_back(arc.vertex);
+                    }
+
+            }
+
+        }
+
+        for(std::size_t root : roots)
+            reached[root] = false;
+
+        return reached;
+
+    }
+
+    static bool is_of_type(const srcuml_type & attribute_type, const std::string & type) {
+
+        if(attribute_type.get_type_name() == type || srcuml::symbol_name(attribute_type.get_qualified_symbol()) == type)
+            return true;
+
+        for(srcuml_symbol argument : attribute_type.get_template_arguments()) {
+
+            const std::string & name = srcuml::symbol_name(argument);
+            if(name == type || (name.size() >= type.size() + 2 && name.compare(name.size() - type.size() - 2, std::string::npos, "::" + type) == 0))
+                return true;
+
+        }
+
+        return false;
+
+    }
+
+public:
+
+    srcuml_query(const std::vector<std::shared_ptr<srcuml_class>> & classes, const std::vector<srcuml_relationship> & relationships)
+        : classes(classes), adjacency(classes, relationships) {}
+
+    /** classes with a relationship of any type to name */
+    std::vector<std::shared_ptr<srcuml_class>> dependents(const std::string & name) const {
+
+        std::vector<char> reached(adjacency.size(), 0);
+        for(std::size_t vertex : find(name)) {
+
+            for(const srcuml_adjacency::arc & arc : adjacency.incoming(vertex))
+                if(arc.vertex != vertex)
+                    reached[arc.vertex] = true;
+
+        }
+
+        return select(reached);
+
+    }
+
+    /** classes generalizing name, directly or through other subclasses */
+    std::vector<std::shared_ptr<srcuml_class>> subclasses(const std::string & name) const {
+        return select(descendants(name, true, false));
+    }
+
+    /** classes that are not interfaces realizing name, directly, through an interface or a parent */
+    std::vector<std::shared_ptr<srcuml_class>> implementers(const std::string & name) const {
+
+        std::vector<std::shared_ptr<srcuml_class>> implementers;
+        for(const std::shared_ptr<srcuml_class> & aclass : select(descendants(name, true, true)))
+            if(!aclass->get_is_interface())
+                implementers.push_back(aclass);
+
+        return implementers;
+
+    }
+
+    std::vector<std::shared_ptr<srcuml_class>> interfaces() const {
+
+        std::vector<std::shared_ptr<srcuml_class>> interfaces;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(aclass->get_is_interface())
+                interfaces.push_back(aclass);
+
+        return interfaces;
+
+    }
+
+    /** classes with an attribute of the type, named as written or qualified, or of a template of it, e.g. a map keyed by it */
+    std::vector<std::shared_ptr<srcuml_class>> owners(const std::string & type) const {
+
+        std::vector<std::shared_ptr<srcuml_class>> owners;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            for(const srcuml_attribute & attribute : aclass->get_attributes())
+                if(is_of_type(attribute.get_type(), type)) {
+                    owners.push_back(aclass);
+                    break;
+                }
+
+        return owners;
+
+    }
+
+    /**
+     * Answers a question of the form "dependents name", "subclasses name",
+     * "implementers name", "owners type" or "interfaces", qualified class names one per line.
+     */
+    void answer(const std::string & question, std::ostream & out) const {
+
+        const std::string::size_type space = question.find(' ');
+        const std::string kind = question.substr(0, space);
+        std::string name = space == std::string::npos ? std::string() : question.substr(space + 1);
+        srcuml::trim(name);
+
+        if(kind != "interfaces" && name.empty())
+            throw std::string("Error: Query ") + kind + " needs a class name";
+
+        std::vector<std::shared_ptr<srcuml_class>> answer;
+        if(kind == "dependents")
+            answer = dependents(name);
+        else if(kind == "subclasses")
+            answer = subclasses(name);
+        else if(kind == "implementers")
+            answer = implementers(name);
+        else if(kind == "owners")
+            answer = owners(name);
+        else if(kind == "interfaces")
+            answer = interfaces();
+        else
+            throw std::string("Error: Unknown query ") + kind;
+
+        for(const std::shared_ptr<srcuml_class> & aclass : answer)
+            out << srcuml::symbol_name(aclass->get_name_symbol()) << '\n';
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * @file srcuml_ranking.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_RANKING_HPP
+#define INCLUDED_SRCUML_RANKING_HPP
+
+#include <srcuml_class.hpp>
+#include <srcuml_relationship.hpp>
+#include <srcuml_adjacency.hpp>
+#include <srcuml_symbol.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * srcuml_ranking
+ *
+ * The most important classes of a system, so an overview of a giant codebase
+ * is laid out as a few hundred classes instead of all of them.  Classes are
+ * ranked by PageRank over the relationships, importance flowing from source
+ * to destination, with generalizations and realizations weighted most so the
+ * roots of the hierarchies rank high.  A path between two kept classes through
+ * omitted ones is collapsed into a dependency between them.
+ */
+class srcuml_ranking {
+
+private:
+
+    enum : std::size_t { ITERATIONS = 50 };
+
+    const srcuml_adjacency & adjacency;
+
+    // of each vertex, the inverse of the weight of its relationships to others, 0 without any
+    std::vector<double> shares;
+
+    std::vector<double> scores;
+    std::vector<char> kept;
+
+    std::size_t threads;
+
+    static double weight(relationship_type type) {
+
+        switch(type) {
+
+            case GENERALIZATION:
+            case REALIZATION:
+                return 3;
+
+            case COMPOSITION:
+            case AGGREGATION:
+                return 2;
+
+            default:
+                return 1;
+
+        }
+
+    }
+
+    void index() {
+
+        shares.assign(adjacency.size(), 0);
+        for(std::size_t vertex = 0; vertex < adjacency.size(); ++vertex) {
+
+            double out_weight = 0;
+            for(std::size_t type = 0; type < srcuml_adjacency::NUMBER_TYPES; ++type)
+                for(const srcuml_adjacency::arc & arc : adjacency.outgoing(vertex, relationship_type(type)))
+                    if(arc.vertex != vertex)
+                        out_weight += weight(relationship_type(type));
+
+            if(out_weight != 0)
+                shares[vertex] = 1 / out_weight;
+
+        }
+
+    }
+
+    /** power iterations, the score of classes without outgoing edges is shared by every class */
+    void rank() {
+
+        const std::size_t count = adjacency.size();
+        const double damping = 0.85;
+
+        scores.assign(count, 1.0 / count);
+        std::vector<double> next(count);
+        for(std::size_t iteration = 0; iteration < ITERATIONS; ++iteration) {
+
+            double dangling = 0;
+            for(std::size_t pos = 0; pos < count; ++pos)
+                if(shares[pos] == 0)
+                    dangling += scores[pos];
+
+            const double base = (1 - damping + damping * dangling) / count;
+            srcuml::parallel_ranges(count, threads, [&](std::size_t first, std::size_t last) {
+
+                for(std::size_t pos = first; pos < last; ++pos) {
+
+                    double score = base;
+                    for(std::size_t type = 0; type < srcuml_adjacency::NUMBER_TYPES; ++type)
+                        for(const srcuml_adjacency::arc & arc : adjacency.incoming(pos, relationship_type(type)))
+                            if(arc.vertex != pos)
+                                score += damping * weight(relationship_type(type)) * shares[arc.vertex] * scores[arc.vertex];
+
+                    next[pos] = score;
+
+                }
+
+            });
+
+            double change = 0;
+            for(std::size_t pos = 0; pos < count; ++pos)
+                change += std::fabs(next[pos] - scores[pos]);
+
+            scores.swap(next);
+            if(change < 1e-9)
+                break;
+
+        }
+
+    }
+
+    void keep(std::size_t number_kept) {
+
+        const std::size_t count = adjacency.size();
+        kept.assign(count, number_kept >= count);
+        if(number_kept >= count)
+            return;
+
+        std::vector<std::size_t> order(count);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::nth_element(order.begin(), order.begin() + number_kept, order.end(), [this](std::size_t one, std::size_t two) {
+            return scores[one] != scores[two] ? scores[one] > scores[two] : one < two;
+        });
+
+        for(std::size_t pos = 0; pos < number_kept; ++pos)
+            kept[order[pos]] = true;
+
+    }
+
+public:
+
+    /** ranks the classes and keeps the number_kept highest, all of them if there are no more */
+    srcuml_ranking(const srcuml_adjacency & adjacency, std::size_t number_kept, std::size_t threads)
+        : adjacency(adjacency), shares(), scores(), kept(), threads(threads) {
+
+        if(adjacency.size() == 0)
+            return;
+
+        index();
+        rank();
+        keep(number_kept);
+
+    }
+
+    bool contains(srcuml_symbol symbol) const {
+
+        const std::size_t pos = adjacency.vertex(symbol);
+        return pos != adjacency.size() && kept[pos];
+
+    }
+
+    double get_score(srcuml_symbol symbol) const {
+
+        const std::size_t pos = adjacency.vertex(symbol);
+        return pos == adjacency.size() ? 0 : scores[pos];
+
+    }
+
+    /** the classes kept, in their original order */
+    std::vector<std::shared_ptr<srcuml_class>> select_classes(const std::vector<std::shared_ptr<srcuml_class>> & classes) const {
+
+        std::vector<std::shared_ptr<srcuml_class>> selected;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes)
+            if(contains(aclass->get_name_symbol()))
+                selected.push_back(aclass);
+
+        return selected;
+
+    }
+
+    /**
+     * The relationships between classes kept, in their original order, then a
+     * dependency for each pair of kept classes joined only through omitted ones.
+     */
+    std::vector<srcuml_relationship> select_relationships(const std::vector<srcuml_relationship> & relationships) const {
+
+        std::vector<srcuml_relationship> selected;
+        std::unordered_set<std::uint64_t> joined;
+        for(const srcuml_relationship & relationship : relationships) {
+
+            if(!contains(relationship.get_source_symbol()) || !contains(relationship.get_destination_symbol()))
+                continue;
+
+            selected.push_back(relationship);
+            joined.insert(pair_key(adjacency.vertex(relationship.get_source_symbol()), adjacency.vertex(relationship.get_destination_symbol())));
+
+        }
+
+        std::vector<std::size_t> kept_positions;
+        for(std::size_t pos = 0; pos < kept.size(); ++pos)
+            if(kept[pos])
+                kept_positions.push_back(pos);
+
+        std::vector<std::vector<std::pair<std::size_t, std::size_t>>> collapsed(kept_positions.size());
+        srcuml::parallel_ranges(kept_positions.size(), threads, [&](std::size_t first, std::size_t last) {
+
+            std::vector<std::size_t> visited(kept.size(), kept.size());
+            std::vector<std::size_t> frontier;
+            for(std::size_t kept_pos = first; kept_pos < last; ++kept_pos)
+                collapse(kept_positions[kept_pos], visited, frontier, collapsed[kept_pos]);
+
+        });
+
+        for(const std::vector<std::pair<std::size_t, std::size_t>> & paths : collapsed)
+            for(const std::pair<std::size_t, std::size_t> & path : paths)
+                if(joined.insert(pair_key(path.first, path.second)).second)
+                    selected.emplace_back(adjacency.symbol(path.first), adjacency.symbol(path.second), DEPENDENCY);
+
+        return selected;
+
+    }
+
+private:
+
+    static std::uint64_t pair_key(std::size_t source, std::size_t destination) {
+
+        return (std::uint64_t(source) << 32) ^ std::uint64_t(destination);
+
+    }
+
+    /** the kept classes reached from source through omitted classes only, visited is stamped with source */
+    void collapse(std::size_t source, std::vector<std::size_t> & visited, std::vector<std::size_t> & frontier,
+                  std::vector<std::pair<std::size_t, std::size_t>> & paths) const {
+
+        frontier.clear();
+        for(const srcuml_adjacency::arc & arc : adjacency.outgoing(source)) {
+
+            const std::size_t next = arc.vertex;
+            if(!kept[next] && visited[next] != source) {
+                visited[next] = source;
+                frontier.push_back(next);
+            }
+
+        }
+
+        while(!frontier.empty()) {
+
+            const std::size_t pos = frontier.back();
+            frontier.pop_back();
+            for(const srcuml_adjacency::arc & arc : adjacency.outgoing(pos)) {
+
+                const std::size_t next = arc.vertex;
+                if(visited[next] == source)
+                    continue;
+
+                visited[next] = source;
+                if(kept[next]) {
+                    if(next != source)
+                        paths.emplace_back(source, next);
+                } else {
+                    frontier.push_back(next);
+                }
+
+            }
+
+        }
+
+    }
+
+};
+
+#endif
@@ -23,53 +23,100 @@
 #define INCLUDED_SRCUML_RELATIONSHIP_HPP
 
 #include <srcuml_class.hpp>
+#include <srcuml_symbol.hpp>
+#include <srcuml_class_table.hpp>
+#include <srcuml_utilities.hpp>
+#include <srcuml_stats.hpp>
+#include <srcuml_cancel.hpp>
+#include <srcuml_trace.hpp>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
 
 enum relationship_type { DEPENDENCY, ASSOCIATION, BIDIRECTIONAL, AGGREGATION, COMPOSITION, GENERALIZATION, REALIZATION, NONE_TYPE };
+
+/**
+ * srcuml_relationship
+ *
+ * Edge between two classes by name symbol.  Only attribute relationships have
+ * a label, which is shown at the destination end.
+ */
 struct srcuml_relationship {
 
-    srcuml_relationship(const std::string & source,
-                         const std::string & source_label,
-                         const std::string & destination,
-                         const std::string & destination_label,
-                         relationship_type type)
+    srcuml_relationship(srcuml_symbol source,
+                        srcuml_symbol destination,
+                        relationship_type type,
+                        srcuml_symbol label = 0)
         : source(source),
-          source_label(source_label),
           destination(destination),
-          destination_label(destination_label),
+          label(label),
           type(type) {}
 
-    srcuml_relationship(const std::string & source,
-                         const std::string & destination,
-                         relationship_type type)
-        : srcuml_relationship(source, "", destination, "", type) {}
+    /** reads a relationship written by write */
+    srcuml_relationship(std::istream & in)
+        : source(srcuml::intern(srcuml::read_string(in))),
+          destination(srcuml::intern(srcuml::read_string(in))),
+          label(srcuml::intern(srcuml::read_string(in))),
+          type((relationship_type)srcuml::read_size(in)) {}
+
+    void write(std::ostream & out) const {
 
-    std::string source;
-    std::string source_label;
-    std::string destination;
-    std::string destination_label;
+        srcuml::write_string(out, srcuml::symbol_name(source));
+        srcuml::write_string(out, srcuml::symbol_name(destination));
+        srcuml::write_string(out, srcuml::symbol_name(label));
+        srcuml::write_size(out, type);
+
+    }
+
+    // class name symbols of the source and destination
+    srcuml_symbol source;
+    srcuml_symbol destination;
+
+    srcuml_symbol label;
 
     relationship_type type;
 
-    std::string get_source() const{
+    srcuml_symbol get_source_symbol() const {
         return source;
     }
 
-    std::string get_destination() const{
+    srcuml_symbol get_destination_symbol() const {
         return destination;
     }
 
-    std::string get_source_label() const{
-        return source_label;
-    }
-
-    std::string get_destination_label() const{
-        return destination_label;
+    const std::string & get_label() const {
+        return srcuml::symbol_name(label);
     }
 
     relationship_type get_type() const{
         return type;
     }
 
+    bool operator==(const srcuml_relationship & relationship) const {
+        return source == relationship.source && destination == relationship.destination
+            && label == relationship.label && type == relationship.type;
+    }
+
+    bool operator!=(const srcuml_relationship & relationship) const {
+        return !(*this == relationship);
+    }
+
+};
+
+/** relationship between a pair of classes after merging, see srcuml_relationships::merge_edges */
+struct srcuml_edge {
+
+    srcuml_symbol source;
+    srcuml_symbol destination;
+    relationship_type type;
+    // relationships bundled into the edge, see srcuml_edge_filter
+    std::size_t weight = 1;
+
 };
 
 class srcuml_relationships {
@@ -78,113 +125,388 @@ private:
 
     std::vector<std::shared_ptr<srcuml_class>> & classes;
 
-    std::map<std::string, std::shared_ptr<srcuml_class>> class_map;
+    // classes resolved at once before threads are used
+    static const std::size_t PARALLEL_GRAIN = 256;
+
+    std::size_t threads;
 
-    std::vector<srcuml_relationship> relationships;
+    // classes whose edges are generated, nullptr for every class
+    const std::vector<char> * selected;
+
+    // times of the passes are added to it, if any
+    srcuml_stats * stats;
+
+    // once cancelled the attribute and dependency passes stop, leaving the edges generated so far
+    const srcuml_cancel * cancel;
+
+    // owned when analyzed here, otherwise a view of relationships analyzed elsewhere
+    std::shared_ptr<const std::vector<srcuml_relationship>> relationships;
 
 public:
-    srcuml_relationships(std::vector<std::shared_ptr<srcuml_class>> & classes)
-        : classes(classes) {
+    srcuml_relationships(std::vector<std::shared_ptr<srcuml_class>> & classes, std::size_t threads = 1, srcuml_stats * stats = nullptr,
+                         const srcuml_cancel * cancel = nullptr)
+        : classes(classes), threads(threads), selected(nullptr), stats(stats), cancel(cancel), relationships() {
+            analyze_classes();
+    }
+
+    /**
+     * Resolves inheritence for every class but only generates the edges owned by
+     * the classes with non-zero selected entries: the child of a generalization
+     * and the source of any other edge.
+     */
+    srcuml_relationships(std::vector<std::shared_ptr<srcuml_class>> & classes,
+                         const std::vector<char> & selected,
+                         std::size_t threads = 1, srcuml_stats * stats = nullptr, const srcuml_cancel * cancel = nullptr)
+        : classes(classes), threads(threads), selected(&selected), stats(stats), cancel(cancel), relationships() {
             analyze_classes();
     }
 
+    /** relationships that were already analyzed, e.g. read from a model */
+    srcuml_relationships(std::vector<std::shared_ptr<srcuml_class>> & classes,
+                         const std::vector<srcuml_relationship> & relationships)
+        : classes(classes), threads(1), selected(nullptr), stats(nullptr), cancel(nullptr), relationships(std::shared_ptr<void>(), &relationships) {}
+
     ~srcuml_relationships() {}
 
-    std::vector<srcuml_relationship> get_relationships(){
-        return relationships;
+    const std::vector<srcuml_relationship> & get_relationships() const {
+        return *relationships;
+    }
+
+    /**
+     * One edge per pair of classes, in order of the pair's first relationship.
+     * Unless directed, a pair is unordered and the first relationship's direction
+     * wins.  A later relationship only strengthens an association:
+     * association < bidirectional < aggregation < composition.
+     */
+    std::vector<srcuml_edge> merge_edges(bool directed) const {
+
+        static const std::size_t REVERSE_EDGE = static_cast<std::size_t>(-1);
+
+        std::vector<srcuml_edge> edges;
+        edges.reserve(relationships->size());
+
+        // pair to position in edges, REVERSE_EDGE for the reverse of an unordered pair
+        std::unordered_map<std::pair<srcuml_symbol, srcuml_symbol>, std::size_t, symbol_pair_hash> edge_table;
+        edge_table.reserve(relationships->size() * (directed ? 1 : 2));
+
+        for(const srcuml_relationship & relationship : *relationships) {
+
+            std::pair<std::unordered_map<std::pair<srcuml_symbol, srcuml_symbol>, std::size_t, symbol_pair_hash>::iterator, bool> inserted
+                = edge_table.emplace(std::make_pair(relationship.get_source_symbol(), relationship.get_destination_symbol()), edges.size());
+
+            if(inserted.second) {
+
+                edges.push_back(srcuml_edge{ relationship.get_source_symbol(), relationship.get_destination_symbol(), relationship.get_type() });
+                if(!directed)
+                    edge_table.emplace(std::make_pair(relationship.get_destination_symbol(), relationship.get_source_symbol()), REVERSE_EDGE);
+                continue;
+
+            }
+
+            if(inserted.first->second == REVERSE_EDGE)
+                continue;
+
+            srcuml_edge & edge = edges[inserted.first->second];
+            if(association_strength(edge.type) && association_strength(relationship.get_type()) > association_strength(edge.type))
+                edge.type = relationship.get_type();
+
+        }
+
+        return edges;
+
+    }
+
+    struct symbol_pair_hash {
+
+        std::size_t operator()(const std::pair<srcuml_symbol, srcuml_symbol> & pair) const {
+            return std::hash<srcuml_symbol>()(pair.first) * 31 + std::hash<srcuml_symbol>()(pair.second);
+        }
+
+    };
+
+    /** 0 for relationships that are not associations */
+    static int association_strength(relationship_type type) {
+
+        switch(type) {
+
+            case ASSOCIATION:   return 1;
+            case BIDIRECTIONAL: return 2;
+            case AGGREGATION:   return 3;
+            case COMPOSITION:   return 4;
+            default:            return 0;
+
+        }
+
     }
 
 private:
 
+    bool is_selected(std::size_t index) const {
+        return !selected || (*selected)[index];
+    }
+
+    /** checked at every PARALLEL_GRAIN-th class, so a pass reads the clock rarely */
+    bool is_cancelled(std::size_t index) const {
+        return cancel && index % PARALLEL_GRAIN == 0 && cancel->is_cancelled();
+    }
+
     void analyze_classes() {
 
-        generate_class_map();
-        resolve_inheritence();
-        generate_attribute_relationships();
-        generate_dependency_relationships();
+        std::shared_ptr<std::vector<srcuml_relationship>> analyzed = std::make_shared<std::vector<srcuml_relationship>>();
 
-    }
+        srcuml_stats::timer table_timer(stats, "relationships.table");
+        srcuml_class_table table(classes);
+        table_timer.stop();
+
+        srcuml_stats::timer inheritence_timer(stats, "relationships.inheritence");
+        resolve_inheritence(table, *analyzed);
+        inheritence_timer.stop();
+
+        // one per buffer, reused by both passes
+        std::vector<class_marks> marks(count_buffers(table.size()), class_marks(table.size()));
+
+        srcuml_stats::timer attribute_timer(stats, "relationships.attributes");
+        generate_in_parallel(table, &srcuml_relationships::generate_attribute_relationships, marks, *analyzed);
+        attribute_timer.stop();
+
+        srcuml_stats::timer dependency_timer(stats, "relationships.dependencies");
+        generate_in_parallel(table, &srcuml_relationships::generate_dependency_relationships, marks, *analyzed);
+        dependency_timer.stop();
+
+        relationships = analyzed;
 
-    void add_relationship(const srcuml_relationship & relationship) {
-        relationships.emplace_back(relationship);
     }
 
-    void generate_class_map() {
+    /** sorted signature hashes, shared between a class and the descendants that inherit it unchanged */
+    typedef std::vector<std::uint64_t> function_set;
 
-        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
-            class_map[aclass->get_name()] = aclass;
-        } 
+    static bool intersects(const function_set & first, const function_set & second) {
+
+        function_set::const_iterator first_itr = first.begin(), second_itr = second.begin();
+        while(first_itr != first.end() && second_itr != second.end()) {
+
+            if(*first_itr < *second_itr)
+                ++first_itr;
+            else if(*second_itr < *first_itr)
+                ++second_itr;
+            else
+                return true;
+
+        }
+
+        return false;
 
     }
 
-    void resolve_inheritence_inner(std::shared_ptr<srcuml_class> & aclass) {
+    /** every resolved parent is finalized, unresolved ones are the members of a broken cycle */
+    void resolve_inheritence_inner(srcuml_class_table & table, std::size_t index,
+                                   std::vector<std::shared_ptr<const function_set>> & pure_virtuals,
+                                   const std::vector<const std::string *> & span_names) const {
 
-        bool has_found_parents = false;
-        for(const ClassPolicy::ParentData & parent_data : aclass->get_data().parents) {
+        srcuml_class & aclass = *classes[index];
 
-            std::map<std::string, std::shared_ptr<srcuml_class>>::iterator parent = class_map.find(parent_data.name);
+        srcuml_trace::span span("finalize", "class");
+        if(span && index < span_names.size())
+            span.set_detail(*span_names[index]);
 
-            if(parent != class_map.end()) {
+        const function_set & implemented = aclass.get_implemented_functions();
+        function_set functions = aclass.get_pure_virtual_functions();
+        bool is_merged = !functions.empty();
 
-                has_found_parents = true;
+        // a single parent's set none of whose functions are implemented here is inherited as is
+        std::shared_ptr<const function_set> inherited;
 
-                if(!parent->second->get_is_finalized())
-                    resolve_inheritence_inner(parent->second);
+        bool has_found_parents = false;
+        for(std::size_t parent : table.get_parents(index)) {
 
-                if(!parent->second->get_is_interface()) {
-                    aclass->set_is_interface(false);
-                }
+            if(!table.has_flag(parent, srcuml_class_table::CLASS_FINALIZED))
+                continue;
 
-                // add pure virtual from parents
-                for(const std::pair<std::string, const FunctionPolicy::FunctionData *> & function_pair
-                        : parent->second->get_pure_virtual_functions_map()) {
+            has_found_parents = true;
 
-                    std::map<std::string, const FunctionPolicy::FunctionData *>::const_iterator implemented_function
-                        = aclass->get_implemented_functions_map().find(function_pair.first);
-                    if(implemented_function == aclass->get_implemented_functions_map().end())
-                        aclass->get_pure_virtual_functions_map()[function_pair.first] = function_pair.second;
+            if(!table.has_flag(parent, srcuml_class_table::CLASS_INTERFACE)) {
+                table.set_flag(index, srcuml_class_table::CLASS_INTERFACE, false);
+            }
 
-                }
+            // add pure virtual from parents
+            const std::shared_ptr<const function_set> & parent_functions = pure_virtuals[parent];
+            if(!parent_functions || parent_functions == inherited)
+                continue;
 
-            } else {
-                /** @todo not sure what default shold be */
+            if(!is_merged && !inherited && !intersects(*parent_functions, implemented)) {
+                inherited = parent_functions;
+                continue;
             }
+
+            if(inherited) {
+                functions.insert(functions.end(), inherited->begin(), inherited->end());
+                inherited.reset();
+            }
+
+            is_merged = true;
+            std::set_difference(parent_functions->begin(), parent_functions->end(),
+                                implemented.begin(), implemented.end(), std::back_inserter(functions));
                 
         }
 
-        aclass->set_is_abstract(!aclass->get_pure_virtual_functions_map().empty());
+        if(is_merged) {
+
+            std::sort(functions.begin(), functions.end());
+            functions.erase(std::unique(functions.begin(), functions.end()), functions.end());
+            if(!functions.empty())
+                inherited = std::make_shared<const function_set>(std::move(functions));
+
+        }
+
+        pure_virtuals[index] = inherited;
+
+        table.set_flag(index, srcuml_class_table::CLASS_ABSTRACT, bool(inherited));
         if(!has_found_parents
-            && aclass->get_implemented_functions_map().empty()
-            && aclass->get_pure_virtual_functions_map().empty())
-            aclass->set_is_interface(false);
+            && implemented.empty()
+            && !inherited)
+            table.set_flag(index, srcuml_class_table::CLASS_INTERFACE, false);
 
         // check if pure virtual are overriden
-        aclass->set_is_finalized(true);
+        table.set_flag(index, srcuml_class_table::CLASS_FINALIZED, true);
+
+        aclass.set_is_interface(table.has_flag(index, srcuml_class_table::CLASS_INTERFACE));
+        aclass.set_is_abstract(table.has_flag(index, srcuml_class_table::CLASS_ABSTRACT));
+        aclass.set_is_finalized(true);
 
     }
 
-    void resolve_inheritence() {
+    /**
+     * Resolves parents before children, a wave of classes whose parents are all
+     * resolved at a time.  When only cycles and the classes waiting on them are
+     * left, a class on a cycle, found by walking unresolved parents until one
+     * repeats, is resolved without its unresolved parents.
+     */
+    void resolve_inheritence(srcuml_class_table & table, std::vector<srcuml_relationship> & relationships) {
+
+        const std::size_t number_classes = table.size();
+
+        // children of each class and the number of its parents not yet resolved
+        std::vector<std::size_t> child_offsets(number_classes + 1, 0);
+        std::vector<std::size_t> waiting(number_classes, 0);
+        std::size_t remaining = 0;
+        for(std::size_t index = 0; index < number_classes; ++index) {
+
+            table.set_flag(index, srcuml_class_table::CLASS_FINALIZED, false);
+            if(!table.is_indexed(index)) continue;
+
+            ++remaining;
+            for(std::size_t parent : table.get_parents(index)) {
+                ++child_offsets[parent + 1];
+                ++waiting[index];
+            }
 
-        for(std::pair<const std::string, std::shared_ptr<srcuml_class>> & map_pair : class_map) {
-            resolve_inheritence_inner(map_pair.second);
         }
 
-        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+        for(std::size_t index = 0; index < number_classes; ++index)
+            child_offsets[index + 1] += child_offsets[index];
+
+        std::vector<std::size_t> children(child_offsets.back());
+        std::vector<std::size_t> child_ends(child_offsets.begin(), child_offsets.end() - 1);
+        for(std::size_t index = 0; index < number_classes; ++index) {
+
+            if(!table.is_indexed(index)) continue;
+
+            for(std::size_t parent : table.get_parents(index))
+                children[child_ends[parent]++] = index;
+
+        }
+
+        std::vector<std::shared_ptr<const function_set>> pure_virtuals(number_classes);
+
+        // names of the spans, looked up before the waves so their threads never wait on the symbol table,
+        // whose names stay where they are as it grows
+        std::vector<const std::string *> span_names;
+        if(srcuml_trace::instance().is_started()) {
+
+            span_names.reserve(number_classes);
+            for(std::size_t index = 0; index < number_classes; ++index)
+                span_names.push_back(&srcuml::symbol_name(classes[index]->get_name_symbol()));
+
+        }
+
+        std::vector<std::size_t> wave;
+        for(std::size_t index = 0; index < number_classes; ++index)
+            if(table.is_indexed(index) && waiting[index] == 0)
+                wave.push_back(index);
+
+        std::size_t cycle_pos = 0;
+        std::vector<std::size_t> walked(number_classes, 0);
+        std::size_t walk = 0;
+        std::vector<std::size_t> next_wave;
+        while(remaining) {
+
+            if(wave.empty()) {
+
+                while(!table.is_indexed(cycle_pos) || table.has_flag(cycle_pos, srcuml_class_table::CLASS_FINALIZED))
+                    ++cycle_pos;
+
+                // the class left may only wait on a cycle, its unresolved parents lead to one
+                ++walk;
+                std::size_t blocked = cycle_pos;
+                while(walked[blocked] != walk) {
+
+                    walked[blocked] = walk;
+                    for(std::size_t parent : table.get_parents(blocked)) {
+
+                        if(table.is_indexed(parent) && !table.has_flag(parent, srcuml_class_table::CLASS_FINALIZED)) {
+                            blocked = parent;
+                            break;
+                        }
+
+                    }
+
+                }
+
+                waiting[blocked] = 0;
+                wave.push_back(blocked);
+
+            }
+
+            // a class only reads its resolved parents, so a wave resolves in any order
+            std::size_t wave_threads = wave.size() < PARALLEL_GRAIN ? 1 : threads;
+            srcuml::parallel_ranges(wave.size(), wave_threads, [&](std::size_t first, std::size_t last) {
+                for(std::size_t pos = first; pos < last; ++pos)
+                    resolve_inheritence_inner(table, wave[pos], pure_virtuals, span_names);
+            });
+
+            remaining -= wave.size();
 
-            for(const ClassPolicy::ParentData & parent_data : aclass->get_data().parents) {
+            next_wave.clear();
+            for(std::size_t index : wave) {
 
-                std::map<std::string, std::shared_ptr<srcuml_class>>::iterator parent = class_map.find(parent_data.name);
+                for(std::size_t pos = child_offsets[index]; pos < child_offsets[index + 1]; ++pos) {
+
+                    std::size_t child = children[pos];
+                    if(waiting[child] && --waiting[child] == 0)
+                        next_wave.push_back(child);
+
+                }
+
+            }
 
-                /** @todo should I show these? */
-                if(parent == class_map.end()) continue;
+            wave.swap(next_wave);
+
+        }
+
+        for(std::size_t index = 0; index < table.size(); ++index) {
+
+            if(!is_selected(index)) continue;
+
+            /** @todo should I show unresolved parents? */
+            for(std::size_t parent : table.get_parents(index)) {
 
                 relationship_type type = GENERALIZATION;
-                if(!aclass->get_is_abstract() && parent->second->get_is_abstract()) {
+                if(!table.has_flag(index, srcuml_class_table::CLASS_ABSTRACT)
+                    && table.has_flag(parent, srcuml_class_table::CLASS_ABSTRACT)) {
                     type = REALIZATION;
                 }
 
-                srcuml_relationship relationship(parent->second->get_srcuml_name(), aclass->get_srcuml_name(), type);
-                add_relationship(relationship);
+                relationships.emplace_back(table.get_name(parent), table.get_name(index), type);
 
             }
 
@@ -192,19 +514,125 @@ private:
  
     }
 
-    void generate_attribute_relationships() {
+    /**
+     * The classes a class has related to by class index, stamped with an epoch of
+     * the class so nothing is cleared or allocated between classes or passes.
+     */
+    class class_marks {
+
+    private:
+
+        std::vector<std::uint32_t> epochs;
+        std::uint32_t epoch;
+
+    public:
+
+        class_marks(std::size_t number_classes) : epochs(number_classes, 0), epoch(0) {}
+
+        /** unmarks every class, for the next class */
+        void clear() {
+
+            if(++epoch != 0)
+                return;
+
+            std::fill(epochs.begin(), epochs.end(), 0);
+            epoch = 1;
+
+        }
+
+        /** false if the class was already marked */
+        bool mark(std::size_t index) {
+
+            if(epochs[index] == epoch)
+                return false;
+
+            epochs[index] = epoch;
+            return true;
+
+        }
+
+    };
+
+    /**
+     * A pass over the classes from first to last.  The label of each relationship generated is left
+     * for generate_in_parallel to intern, its text is appended to labels, none when no relationship
+     * of the pass has one.
+     */
+    typedef void (srcuml_relationships::*generate_pass)(const srcuml_class_table &, std::size_t, std::size_t, class_marks &,
+                                                        std::vector<srcuml_relationship> &, std::vector<std::string> &) const;
+
+    std::size_t count_buffers(std::size_t number_classes) const {
+        return number_classes < PARALLEL_GRAIN ? 1 : std::min(threads, number_classes);
+    }
+
+    /**
+     * Runs a pass over contiguous ranges of classes, each into its own buffer.
+     * The buffers are appended in class order, so the relationships come out
+     * as they would serially.  The labels are interned once they are joined,
+     * so the threads never wait on the symbol table.
+     */
+    void generate_in_parallel(const srcuml_class_table & table, generate_pass pass, std::vector<class_marks> & marks,
+                              std::vector<srcuml_relationship> & relationships) const {
+
+        const std::size_t number_classes = table.size();
+        const std::size_t number_buffers = marks.size();
+        const std::size_t start = relationships.size();
+
+        std::vector<std::string> labels;
+        if(number_buffers < 2) {
+
+            (this->*pass)(table, 0, number_classes, marks.front(), relationships, labels);
+
+        } else {
+
+            std::vector<std::vector<srcuml_relationship>> buffers(number_buffers);
+            std::vector<std::vector<std::string>> buffer_labels(number_buffers);
+            srcuml::parallel_ranges(number_buffers, number_buffers, [&](std::size_t first, std::size_t last) {
+
+                for(std::size_t buffer = first; buffer < last; ++buffer)
+                    (this->*pass)(table, buffer * number_classes / number_buffers, (buffer + 1) * number_classes / number_buffers,
+                                  marks[buffer], buffers[buffer], buffer_labels[buffer]);
+
+            });
+
+            for(std::size_t buffer = 0; buffer < number_buffers; ++buffer) {
+
+                relationships.insert(relationships.end(), buffers[buffer].begin(), buffers[buffer].end());
+                labels.insert(labels.end(), std::make_move_iterator(buffer_labels[buffer].begin()),
+                              std::make_move_iterator(buffer_labels[buffer].end()));
+
+            }
+
+        }
+
+        if(labels.empty())
+            return;
+
+        const std::vector<srcuml_symbol> symbols = srcuml::intern(labels);
+        for(std::size_t pos = 0; pos < symbols.size(); ++pos)
+            relationships[start + pos].label = symbols[pos];
+
+    }
+
+    void generate_attribute_relationships(const srcuml_class_table & table, std::size_t first, std::size_t last,
+                                          class_marks & catalogued_attributes, std::vector<srcuml_relationship> & relationships,
+                                          std::vector<std::string> & labels) const {
 
-        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+        for(std::size_t index = first; index < last && !is_cancelled(index); ++index) {
 
-            /** @todo may want set so same type not added twice */
-            //WIP
+            if(!is_selected(index)) continue;
 
-            std::set<std::string> catalogued_attributes; 
+            const std::vector<srcuml_attribute> & attributes = classes[index]->get_attributes();
+            catalogued_attributes.clear();
 
-            for(const srcuml_attribute & attribute : aclass->get_attributes()) {
+            std::size_t position = 0;
+            for(std::size_t parent : table.get_attribute_classes(index)) {
 
-                std::map<std::string, std::shared_ptr<srcuml_class>>::iterator parent = class_map.find(attribute.get_type().get_type_name());
-                if(parent == class_map.end()) continue;
+                const srcuml_attribute & attribute = attributes[position++];
+                if(parent == srcuml_class_table::NO_CLASS) continue;
+
+                if(!catalogued_attributes.mark(parent))
+                    continue;
 
                 relationship_type type = ASSOCIATION;
                 if(attribute.get_type().get_is_composite())
@@ -212,90 +640,38 @@ private:
                 else if(attribute.get_type().get_is_aggregate())
                     type = AGGREGATION;
 
-                std::string relationship_label = attribute.get_name() + attribute.get_multiplicity();
+                // nothing is built for the attributes skipped
+                labels.push_back(attribute.get_name());
+                attribute.append_multiplicity(labels.back());
 
-                std::set<std::string>::iterator catalogued_class = catalogued_attributes.find(parent->second->get_srcuml_name());
-                if(catalogued_class != catalogued_attributes.end())
-                    continue;
-
-                srcuml_relationship relationship(aclass->get_srcuml_name(), "", parent->second->get_srcuml_name(), relationship_label, type);
-                add_relationship(relationship);
-                catalogued_attributes.insert(parent->second->get_srcuml_name());
+                relationships.emplace_back(table.get_name(index), table.get_name(parent), type);
             }
 
         }
 
     }
 
-    void generate_dependency_relationships(){//dependency is local variables or parameters
-        for(const std::shared_ptr<srcuml_class>& aclass : classes){
-            //create set of already add dependecies so no repeats
-            std::set<std::string> catalogued_dependencies;
-            //obtain current class type
-            std::string current_class_type = aclass->get_srcuml_name();
-            catalogued_dependencies.insert(current_class_type);
-
-            for(const std::pair<std::string, const FunctionPolicy::FunctionData *> func : aclass->get_implemented_functions_map()){
-
-                //Parameter dependencies
-                for(const ParamTypePolicy::ParamTypeData* aparam : func.second->parameters){
-                    //iterate over parameters
-                    //obtain param_type which is a nice string form of the type
-                    //==================================================
-                    srcuml_type* temp = new srcuml_type(aparam->type);
-                    std::string param_type = temp->get_type_name();
-                    //==================================================
-
-                    std::map<std::string, std::shared_ptr<srcuml_class>>::iterator related_class = class_map.find(param_type);
-                    if(related_class == class_map.end()) continue;
-                    std::string working_dep = related_class->second->get_srcuml_name();
-                    std::set<std::string>::iterator catalogued_class = catalogued_dependencies.find(working_dep);
-                    
-                    //remove last condition to re-add multi dependencies
-                    if(related_class == class_map.end() || current_class_type == working_dep || catalogued_class != catalogued_dependencies.end())
-                        continue;
-
-                    srcuml_relationship relationship(current_class_type, working_dep, DEPENDENCY);
-                    catalogued_dependencies.insert(working_dep); //add param_type is std::string 
-                    add_relationship(relationship);                   
-                }
-
-                //decleration dependencies   
-                for(const DeclTypePolicy::DeclTypeData* arelation : func.second->relations){
-                    srcuml_type* temp = new srcuml_type(arelation->type);
-                    std::string relate_type = temp->get_type_name();
-
-                    std::map<std::string, std::shared_ptr<srcuml_class>>::iterator related_class = class_map.find(relate_type);
-                    if(related_class == class_map.end()) continue;
-                    std::string working_dep = related_class->second->get_srcuml_name();//get heuristic version of dependency name
-                    std::set<std::string>::iterator catalogued_class = catalogued_dependencies.find(working_dep);
+    void generate_dependency_relationships(const srcuml_class_table & table, std::size_t first, std::size_t last,
+                                           class_marks & catalogued_dependencies, std::vector<srcuml_relationship> & relationships,
+                                           std::vector<std::string> &) const {//dependency is local variables or parameters
 
-                    //remove last condition to re-add multi dependencies
-                    if(related_class == class_map.end() || current_class_type == working_dep || catalogued_class != catalogued_dependencies.end())
-                        continue;
+        for(std::size_t index = first; index < last && !is_cancelled(index); ++index){
+            if(!is_selected(index)) continue;
 
-                    srcuml_relationship relationship(current_class_type, working_dep, DEPENDENCY);
-                    catalogued_dependencies.insert(working_dep);
-                    add_relationship(relationship);
-                }
+            //the current class type
+            std::size_t current_class = table.get_canonical(index);
+            catalogued_dependencies.clear();
+            catalogued_dependencies.mark(current_class);
 
-                //Return type dependency
-                srcuml_type* temp = new srcuml_type(func.second->returnType);
-                std::string return_type = temp->get_type_name();
+            //parameter, decleration and return type dependencies in function order
+            for(std::size_t related_class : table.get_dependencies(index)){
 
-                std::map<std::string, std::shared_ptr<srcuml_class>>::iterator related_class = class_map.find(return_type);
-                if(related_class == class_map.end()) continue;
-                std::string working_dep = related_class->second->get_srcuml_name();
-                std::set<std::string>::iterator catalogued_class = catalogued_dependencies.find(working_dep);
-
-                //remove last condition to re-add multi dependencies
-                if(related_class == class_map.end() || current_class_type == working_dep || catalogued_class != catalogued_dependencies.end())
+                //remove condition to re-add multi dependencies
+                if(!catalogued_dependencies.mark(related_class))
                     continue;
 
-                srcuml_relationship relationship(current_class_type, working_dep, DEPENDENCY);
-                catalogued_dependencies.insert(working_dep);
-                add_relationship(relationship);
-            } 
+                relationships.emplace_back(table.get_name(index), table.get_name(related_class), DEPENDENCY);
+            }
         }
     }
 
@@ -0,0 +1,297 @@
+/**
+ * @file srcuml_relationship_graph.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_RELATIONSHIP_GRAPH_HPP
+#define INCLUDED_SRCUML_RELATIONSHIP_GRAPH_HPP
+
+#include <srcuml_relationship.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <sstream>
+#include <cstdint>
+
+/** edges an update of a srcuml_relationship_graph added and removed */
+struct srcuml_relationship_delta {
+
+    std::vector<srcuml_relationship> added;
+    std::vector<srcuml_relationship> removed;
+
+};
+
+/**
+ * srcuml_relationship_graph
+ *
+ * Relationships kept between runs, e.g. by the watcher.  Each update only
+ * regenerates the edges owned by classes that changed, by classes that
+ * reference a class that appeared or disappeared and by the descendants of a
+ * changed class.  Inheritence is still resolved for every class, as every
+ * class object needs its flags.
+ */
+class srcuml_relationship_graph {
+
+private:
+
+    // generalizations, attribute relationships and dependencies, in analysis order
+    static const std::size_t NUMBER_PASSES = 3;
+
+    struct class_entry {
+
+        std::uint64_t fingerprint;
+
+        // sorted names referenced by parents, attributes and dependencies
+        std::vector<srcuml_symbol> references;
+        std::vector<srcuml_symbol> parents;
+
+        // the child of a generalization and the source of any other edge owns it
+        std::vector<srcuml_relationship> edges[NUMBER_PASSES];
+
+    };
+
+    // by class name, classes with the same name share an entry
+    std::unordered_map<srcuml_symbol, class_entry> entries;
+
+    // names that reference a name, and children of a name
+    std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>> referrers;
+    std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>> children;
+
+    std::vector<srcuml_relationship> relationships;
+    srcuml_relationship_delta delta;
+
+public:
+
+    srcuml_relationship_graph() : entries(), referrers(), children(), relationships(), delta() {}
+
+    /** brings the relationships up to date with classes, finalizing every class */
+    void update(std::vector<std::shared_ptr<srcuml_class>> & classes, std::size_t threads = 1) {
+
+        delta = srcuml_relationship_delta();
+
+        std::unordered_map<srcuml_symbol, class_entry> current;
+        for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+            std::unordered_map<srcuml_symbol, class_entry>::iterator itr = current.find(aclass->get_name_symbol());
+            if(itr == current.end())
+                itr = current.emplace(aclass->get_name_symbol(), class_entry{ srcuml::hash(nullptr, 0) }).first;
+
+            std::ostringstream summary;
+            aclass->write(summary);
+            const std::string & data = summary.str();
+            itr->second.fingerprint = srcuml::hash(data.data(), data.size(), itr->second.fingerprint);
+
+            std::vector<srcuml_symbol> & references = itr->second.references;
+            references.insert(references.end(), aclass->get_parents().begin(), aclass->get_parents().end());
+            references.insert(references.end(), aclass->get_dependency_types().begin(), aclass->get_dependency_types().end());
+            for(const srcuml_attribute & attribute : aclass->get_attributes())
+                references.push_back(attribute.get_type().get_type_symbol());
+
+            std::vector<srcuml_symbol> & parents = itr->second.parents;
+            parents.insert(parents.end(), aclass->get_parents().begin(), aclass->get_parents().end());
+
+        }
+
+        // names whose classes changed, and names that appeared or disappeared
+        std::vector<srcuml_symbol> changed;
+        std::vector<srcuml_symbol> appeared;
+
+        for(std::pair<const srcuml_symbol, class_entry> & entry : current) {
+
+            sort_unique(entry.second.references);
+            sort_unique(entry.second.parents);
+
+            std::unordered_map<srcuml_symbol, class_entry>::iterator itr = entries.find(entry.first);
+            if(itr == entries.end()) {
+
+                changed.push_back(entry.first);
+                appeared.push_back(entry.first);
+                index(entry.first, entry.second);
+                entries.emplace(entry.first, std::move(entry.second));
+
+            } else if(itr->second.fingerprint != entry.second.fingerprint) {
+
+                changed.push_back(entry.first);
+                unindex(entry.first, itr->second);
+                index(entry.first, entry.second);
+                itr->second.fingerprint = entry.second.fingerprint;
+                itr->second.references.swap(entry.second.references);
+                itr->second.parents.swap(entry.second.parents);
+
+            }
+
+        }
+
+        for(std::unordered_map<srcuml_symbol, class_entry>::iterator itr = entries.begin(); itr != entries.end();) {
+
+            if(current.count(itr->first)) {
+                ++itr;
+                continue;
+            }
+
+            changed.push_back(itr->first);
+            appeared.push_back(itr->first);
+            unindex(itr->first, itr->second);
+            for(const std::vector<srcuml_relationship> & edges : itr->second.edges)
+                delta.removed.insert(delta.removed.end(), edges.begin(), edges.end());
+            itr = entries.erase(itr);
+
+        }
+
+        std::unordered_set<srcuml_symbol> dirty(changed.begin(), changed.end());
+
+        // edges to a class that appeared or disappeared now resolve differently
+        for(srcuml_symbol name : appeared) {
+
+            std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>>::const_iterator itr = referrers.find(name);
+            if(itr != referrers.end())
+                dirty.insert(itr->second.begin(), itr->second.end());
+
+        }
+
+        // a change is inherited, and a generalization's type depends on both ends
+        std::vector<srcuml_symbol> ancestors(changed);
+        while(!ancestors.empty()) {
+
+            srcuml_symbol name = ancestors.back();
+            ancestors.pop_back();
+
+            std::unordered_map<srcuml_symbol, std::unordered_set<srcuml_symbol>>::const_iterator itr = children.find(name);
+            if(itr == children.end()) continue;
+
+            for(srcuml_symbol child : itr->second)
+                if(dirty.insert(child).second)
+                    ancestors.push_back(child);
+
+        }
+
+        std::vector<char> selected(classes.size(), 0);
+        for(std::size_t pos = 0; pos < classes.size(); ++pos)
+            selected[pos] = dirty.count(classes[pos]->get_name_symbol());
+
+        std::unordered_map<srcuml_symbol, class_entry> regenerated;
+        for(srcuml_symbol name : dirty)
+            if(entries.count(name))
+                regenerated[name];
+
+        srcuml_relationships analyzed(classes, selected, threads);
+        for(const srcuml_relationship & relationship : analyzed.get_relationships()) {
+
+            std::size_t pass = get_pass(relationship);
+            srcuml_symbol owner = pass == 0 ? relationship.get_destination_symbol() : relationship.get_source_symbol();
+            regenerated[owner].edges[pass].push_back(relationship);
+
+        }
+
+        for(std::pair<const srcuml_symbol, class_entry> & entry : regenerated) {
+
+            class_entry & existing = entries[entry.first];
+            for(std::size_t pass = 0; pass < NUMBER_PASSES; ++pass) {
+
+                difference(entry.second.edges[pass], existing.edges[pass], delta.added);
+                difference(existing.edges[pass], entry.second.edges[pass], delta.removed);
+                existing.edges[pass].swap(entry.second.edges[pass]);
+
+            }
+
+        }
+
+        // same order as a full analysis, apart from classes that share a name
+        relationships.clear();
+        for(std::size_t pass = 0; pass < NUMBER_PASSES; ++pass) {
+
+            std::unordered_set<srcuml_symbol> emitted;
+            for(const std::shared_ptr<srcuml_class> & aclass : classes) {
+
+                if(!emitted.insert(aclass->get_name_symbol()).second) continue;
+
+                const std::vector<srcuml_relationship> & edges = entries[aclass->get_name_symbol()].edges[pass];
+                relationships.insert(relationships.end(), edges.begin(), edges.end());
+
+            }
+
+        }
+
+    }
+
+    const std::vector<srcuml_relationship> & get_relationships() const {
+        return relationships;
+    }
+
+    /** edges the last update added and removed */
+    const srcuml_relationship_delta & get_delta() const {
+        return delta;
+    }
+
+private:
+
+    static void sort_unique(std::vector<srcuml_symbol> & symbols) {
+
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+    }
+
+    static std::size_t get_pass(const srcuml_relationship & relationship) {
+
+        if(relationship.get_type() == GENERALIZATION || relationship.get_type() == REALIZATION)
+            return 0;
+
+        if(relationship.get_type() == DEPENDENCY)
+            return 2;
+
+        return 1;
+
+    }
+
+    /** appends the edges of first that are not in second */
+    static void difference(const std::vector<srcuml_relationship> & first, const std::vector<srcuml_relationship> & second,
+                           std::vector<srcuml_relationship> & result) {
+
+        for(const srcuml_relationship & relationship : first)
+            if(std::find(second.begin(), second.end(), relationship) == second.end())
+                result.push_back(relationship);
+
+    }
+
+    void index(srcuml_symbol name, const class_entry & entry) {
+
+        for(srcuml_symbol reference : entry.references)
+            referrers[reference].insert(name);
+
+        for(srcuml_symbol parent : entry.parents)
+            children[parent].insert(name);
+
+    }
+
+    void unindex(srcuml_symbol name, const class_entry & entry) {
+
+        for(srcuml_symbol reference : entry.references)
+            referrers[reference].erase(name);
+
+        for(srcuml_symbol parent : entry.parents)
+            children[parent].erase(name);
+
+    }
+
+};
+
+#endif
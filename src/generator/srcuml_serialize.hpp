@@ -0,0 +1,163 @@
+/**
+ * @file srcuml_serialize.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SERIALIZE_HPP
+#define INCLUDED_SRCUML_SERIALIZE_HPP
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Binary encoding of the extracted model.  Sizes are fixed width little endian,
+ * so files can be shared between machines.  Readers throw on truncated input.
+ */
+namespace srcuml {
+
+inline void write_size(std::ostream & out, std::uint64_t value) {
+
+    char bytes[8];
+    for(std::size_t pos = 0; pos < 8; ++pos)
+        bytes[pos] = static_cast<char>((value >> (8 * pos)) & 0xff);
+
+    out.write(bytes, 8);
+
+}
+
+inline std::uint64_t read_size(std::istream & in) {
+
+    char bytes[8];
+    if(!in.read(bytes, 8))
+        throw std::string("Error: Truncated model data");
+
+    std::uint64_t value = 0;
+    for(std::size_t pos = 0; pos < 8; ++pos)
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[pos])) << (8 * pos);
+
+    return value;
+
+}
+
+/** the IEEE 754 bits of value, in the byte order of sizes */
+inline void write_double(std::ostream & out, double value) {
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_size(out, bits);
+
+}
+
+inline double read_double(std::istream & in) {
+
+    std::uint64_t bits = read_size(in);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+
+}
+
+inline void write_bool(std::ostream & out, bool value) {
+    out.put(value ? 1 : 0);
+}
+
+inline bool read_bool(std::istream & in) {
+
+    char value;
+    if(!in.get(value))
+        throw std::string("Error: Truncated model data");
+
+    return value != 0;
+
+}
+
+inline void write_string(std::ostream & out, const std::string & str) {
+
+    write_size(out, str.size());
+    out.write(str.data(), str.size());
+
+}
+
+inline std::string read_string(std::istream & in) {
+
+    std::uint64_t size = read_size(in);
+
+    std::string str;
+    str.resize(size);
+    if(size && !in.read(&str[0], size))
+        throw std::string("Error: Truncated model data");
+
+    return str;
+
+}
+
+template<typename container>
+void write_strings(std::ostream & out, const container & strs) {
+
+    write_size(out, strs.size());
+    for(const std::string & str : strs)
+        write_string(out, str);
+
+}
+
+inline void read_strings(std::istream & in, std::vector<std::string> & strs) {
+
+    std::uint64_t size = read_size(in);
+    for(std::uint64_t pos = 0; pos < size; ++pos)
+        strs.push_back(read_string(in));
+
+}
+
+inline void read_strings(std::istream & in, std::set<std::string> & strs) {
+
+    std::uint64_t size = read_size(in);
+    for(std::uint64_t pos = 0; pos < size; ++pos)
+        strs.insert(read_string(in));
+
+}
+
+/**
+ * memory_streambuf
+ *
+ * Read-only stream buffer over borrowed memory, e.g. a mapped file.
+ */
+class memory_streambuf : public std::streambuf {
+
+public:
+
+    memory_streambuf(const char * data, std::size_t size) {
+
+        char * begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+
+    }
+
+};
+
+}
+
+#endif
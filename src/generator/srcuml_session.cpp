@@ -0,0 +1,178 @@
+/**
+ * @file srcuml_session.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <srcuml_session.hpp>
+#include <srcuml_handler.hpp>
+
+#include <sstream>
+#include <algorithm>
+
+srcuml_session::srcuml_session(const srcuml_options & options)
+    : options(options), cache(options.cache_directory, options.profile, options.stereotypes, options.cache_memory), graph(),
+      summaries(), classes(), is_analyzed(false), mutex() {
+
+    this->options.cache = &cache;
+    this->options.early_output = false;
+    this->options.outputs.clear();
+    this->options.artifacts.clear();
+    this->options.emit_model.clear();
+
+}
+
+srcuml_session::~srcuml_session() {}
+
+void srcuml_session::add_buffer(const char * buffer, std::size_t size) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    srcuml_handler handler(options);
+    handler.add(buffer, size);
+    add_classes(handler.get_classes());
+
+}
+
+void srcuml_session::add_archive(const std::string & filename) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    srcuml_mapped_file input(filename.c_str());
+    srcuml_handler handler(options);
+    handler.add(input.get_data(), input.get_size());
+    add_classes(handler.get_classes());
+
+}
+
+void srcuml_session::add_sources(const std::vector<std::string> & source_paths) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    srcuml_handler handler(options);
+    handler.add(source_paths);
+    add_classes(handler.get_classes());
+
+}
+
+std::size_t srcuml_session::remove(const std::string & filename) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const std::size_t number_summaries = summaries.size();
+    summaries.erase(std::remove_if(summaries.begin(), summaries.end(), [&filename](const class_summary & summary) {
+        return summary.filename == filename;
+    }), summaries.end());
+
+    if(summaries.size() != number_summaries)
+        is_analyzed = false;
+
+    return number_summaries - summaries.size();
+
+}
+
+void srcuml_session::clear() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    summaries.clear();
+    is_analyzed = false;
+
+}
+
+std::size_t srcuml_session::size() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return summaries.size();
+
+}
+
+void srcuml_session::render(const std::string & type, std::ostream & out) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    srcuml_options render_options = options;
+    render_options.type = type;
+    render(render_options, out);
+
+}
+
+void srcuml_session::render(const std::string & types, const std::vector<std::ostream *> & outputs) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    srcuml_options render_options = options;
+    render_options.type = types;
+    render_options.outputs = outputs;
+
+    std::ostringstream unused;
+    render(render_options, unused);
+
+}
+
+/** the classes are summarized right away, the handler and its srcML data are gone after the add */
+void srcuml_session::add_classes(const std::vector<std::shared_ptr<srcuml_class>> & parsed) {
+
+    for(const std::shared_ptr<srcuml_class> & aclass : parsed) {
+
+        std::ostringstream out;
+        aclass->write(out);
+        summaries.push_back(class_summary{ aclass->get_filename(), out.str() });
+
+    }
+
+    if(!parsed.empty())
+        is_analyzed = false;
+
+}
+
+/**
+ * Classes are finalized by the analysis, so they are read again from their
+ * summaries whenever classes were added or removed.  graph only regenerates
+ * the relationships of what changed.
+ */
+void srcuml_session::analyze() {
+
+    if(is_analyzed)
+        return;
+
+    srcuml_stats::timer timer(options.stats, "analyze");
+
+    classes.clear();
+    for(const class_summary & summary : summaries) {
+
+        srcuml::memory_streambuf buffer(summary.data.data(), summary.data.size());
+        std::istream in(&buffer);
+        classes.emplace_back(std::make_shared<srcuml_class>(in));
+
+    }
+
+    graph.update(classes, options.threads);
+    is_analyzed = true;
+
+}
+
+void srcuml_session::render(const srcuml_options & render_options, std::ostream & out) {
+
+    analyze();
+
+    srcuml_model model(classes, graph.get_relationships());
+    srcuml_handler handler(model, out, render_options);
+
+}
@@ -0,0 +1,115 @@
+/**
+ * @file srcuml_session.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SESSION_HPP
+#define INCLUDED_SRCUML_SESSION_HPP
+
+#include <srcuml_options.hpp>
+#include <srcuml_cache.hpp>
+#include <srcuml_relationship_graph.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+class srcuml_class;
+
+/**
+ * srcuml_session
+ *
+ * srcUML embedded in another program, the entry point of libsrcuml.  Inputs
+ * are added one at a time and any output type of the classes added so far can
+ * be rendered to caller-provided streams, as often as needed.  The unit cache
+ * and the relationships stay warm between calls, so only what was added or
+ * removed since the last render is analyzed again.  Each call runs alone.
+ *
+ *   srcuml_session session(options);
+ *   session.add_archive("project.xml");
+ *   session.render("svg_sugiyama", out);
+ */
+class srcuml_session {
+
+private:
+
+    /** a parsed class, kept as its summary so no srcML data outlives add */
+    struct class_summary {
+
+        std::string filename;
+        std::string data;
+
+    };
+
+    srcuml_options options;
+    srcuml_cache cache;
+    srcuml_relationship_graph graph;
+
+    std::vector<class_summary> summaries;
+
+    // classes of summaries analyzed by graph, they are read again once summaries change
+    std::vector<std::shared_ptr<srcuml_class>> classes;
+    bool is_analyzed;
+
+    std::mutex mutex;
+
+public:
+
+    /** options of every add and render, except the type and outputs given to render */
+    srcuml_session(const srcuml_options & options = srcuml_options());
+    ~srcuml_session();
+
+    srcuml_session(const srcuml_session &) = delete;
+    srcuml_session & operator=(const srcuml_session &) = delete;
+
+    /** an in-memory srcML archive or unit, it is not used after the call */
+    void add_buffer(const char * buffer, std::size_t size);
+
+    /** a srcML archive or unit file */
+    void add_archive(const std::string & filename);
+
+    /** source files and directories, converted with libsrcml */
+    void add_sources(const std::vector<std::string> & source_paths);
+
+    /** drops the classes of the unit filename, e.g. before adding its new version, returns how many */
+    std::size_t remove(const std::string & filename);
+
+    /** drops every class, the caches stay warm */
+    void clear();
+
+    /** number of classes added */
+    std::size_t size();
+
+    /** renders the output type, see srcuml_options::type, of the classes added to out */
+    void render(const std::string & type, std::ostream & out);
+
+    /** renders each of the comma separated output types to its stream */
+    void render(const std::string & types, const std::vector<std::ostream *> & outputs);
+
+private:
+
+    void add_classes(const std::vector<std::shared_ptr<srcuml_class>> & parsed);
+    void analyze();
+    void render(const srcuml_options & render_options, std::ostream & out);
+
+};
+
+#endif
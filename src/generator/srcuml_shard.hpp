@@ -0,0 +1,86 @@
+/**
+ * @file srcuml_shard.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SHARD_HPP
+#define INCLUDED_SRCUML_SHARD_HPP
+
+#include <srcuml_utilities.hpp>
+
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+
+/**
+ * srcuml_shard
+ *
+ * The units one of several processes extracts, by a hash of their filename,
+ * e.g. shard 2/8.  Each shard writes a partial model and srcuml_model::merge
+ * joins them before the relationships are analyzed.
+ */
+struct srcuml_shard {
+
+    std::size_t index = 0;
+    std::size_t count = 1;
+
+    /** index/count, e.g. 2/8, index counts from 0 */
+    static srcuml_shard parse(const std::string & spec) {
+
+        srcuml_shard shard;
+
+        const std::size_t slash = spec.find('/');
+        try {
+
+            if(slash == std::string::npos)
+                throw std::invalid_argument(spec);
+
+            std::size_t index_end = 0, count_end = 0;
+            shard.index = std::stoul(spec.substr(0, slash), &index_end);
+            shard.count = std::stoul(spec.substr(slash + 1), &count_end);
+            if(index_end != slash || count_end != spec.size() - slash - 1)
+                throw std::invalid_argument(spec);
+
+        } catch(const std::logic_error &) {
+            throw std::string("Error: A shard is index/count, e.g. 0/4, not ") + spec;
+        }
+
+        if(shard.count == 0 || shard.index >= shard.count)
+            throw std::string("Error: Shard ") + spec + " needs an index below its count";
+
+        return shard;
+
+    }
+
+    bool is_sharded() const {
+
+        return count > 1;
+
+    }
+
+    /** whether the unit of filename belongs to this shard */
+    bool contains(const std::string & filename) const {
+
+        return !is_sharded() || srcuml::hash(filename.data(), filename.size()) % count == index;
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,218 @@
+/**
+ * @file srcuml_source.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SOURCE_HPP
+#define INCLUDED_SRCUML_SOURCE_HPP
+
+#include <srcml.h>
+#include <srcuml_shard.hpp>
+#include <srcuml_unit_filter.hpp>
+#include <srcuml_input.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+/**
+ * srcuml_source
+ *
+ * Source files (or directories of them) converted to srcML in-process by libsrcml.
+ * Each file becomes its own in-memory srcML unit, see parser, so no archive is written.
+ */
+class srcuml_source {
+
+private:
+
+	std::vector<std::pair<std::string, std::string>> files;
+
+public:
+
+	/**
+	 * Directories are searched recursively for files with a language libsrcml recognizes,
+	 * only the files of shard that filter selects are kept.
+	 */
+	srcuml_source(const std::vector<std::string> & paths, const srcuml_shard & shard = srcuml_shard(),
+				  const srcuml_unit_filter & filter = srcuml_unit_filter()) : files() {
+
+		srcml_archive * archive = srcml_archive_create();
+
+		for(const std::string & path : paths) {
+
+			if(boost::filesystem::is_directory(path)) {
+
+				std::vector<std::string> directory_files;
+				for(boost::filesystem::recursive_directory_iterator itr(path), end; itr != end; ++itr) {
+
+					if(boost::filesystem::is_regular_file(itr->status()))
+						directory_files.push_back(itr->path().string());
+
+				}
+
+				// directory order is not stable across file systems
+				std::sort(directory_files.begin(), directory_files.end());
+				for(const std::string & file : directory_files)
+					add_file(archive, file, false, shard, filter);
+
+			} else {
+
+				add_file(archive, path, true, shard, filter);
+
+			}
+
+		}
+
+		srcml_archive_free(archive);
+
+	}
+
+	/** a single .xml argument is an existing srcML archive, anything else is source code */
+	static bool is_srcml_file(const std::vector<std::string> & paths) {
+
+		if(paths.size() != 1)
+			return false;
+
+		const std::string & path = paths.front();
+		return path.size() >= 4 && path.compare(path.size() - 4, 4, ".xml") == 0;
+
+	}
+
+	/** a .xml file or a compressed one, see srcuml_compressed_reader */
+	static bool is_srcml_archive(const std::string & path) {
+
+		return (path.size() >= 4 && path.compare(path.size() - 4, 4, ".xml") == 0)
+			|| srcuml_compressed_reader::compression_of(path) != NO_INPUT_COMPRESSION;
+
+	}
+
+	/** whether every path is a srcML archive, throws if only some are */
+	static bool are_srcml_archives(const std::vector<std::string> & paths) {
+
+		const std::size_t number_archives = std::count_if(paths.begin(), paths.end(), is_srcml_archive);
+		if(number_archives != 0 && number_archives != paths.size())
+			throw std::string("Error: The inputs are either srcML archives or source files, not both");
+
+		return !paths.empty() && number_archives == paths.size();
+
+	}
+
+	std::size_t size() const {
+		return files.size();
+	}
+
+	const std::string & get_filename(std::size_t pos) const {
+		return files[pos].first;
+	}
+
+	/**
+	 * Converts the files of a source one at a time, on one thread.  Each file is parsed into
+	 * a unit of one archive kept open for the parser's life, and its srcML is read straight
+	 * from the unit: no archive is serialized around the unit and copied into a buffer, and
+	 * libsrcml's archive is not set up again for every file.
+	 */
+	class parser {
+
+	private:
+
+		const srcuml_source & source;
+
+		srcml_archive * archive;
+		// the archive is opened for writing so units can be parsed, nothing is written to it
+		char * archive_data;
+		std::size_t archive_size;
+
+		srcml_unit * unit;
+
+	public:
+
+		parser(const srcuml_source & source) : source(source), archive(srcml_archive_create()), archive_data(nullptr), archive_size(0), unit(nullptr) {
+
+			if(srcml_archive_write_open_memory(archive, &archive_data, &archive_size) != SRCML_STATUS_OK) {
+				srcml_archive_free(archive);
+				throw std::string("Error: Unable to start libsrcml");
+			}
+
+		}
+
+		parser(const parser &) = delete;
+		parser & operator=(const parser &) = delete;
+
+		~parser() {
+
+			if(unit)
+				srcml_unit_free(unit);
+
+			srcml_archive_close(archive);
+			srcml_archive_free(archive);
+			if(archive_data)
+				srcml_memory_free(archive_data);
+
+		}
+
+		/** the srcML unit of the file and its size, valid until the next parse, throws on failure */
+		std::pair<const char *, std::size_t> parse(std::size_t pos) {
+
+			const std::string & filename = source.get_filename(pos);
+
+			if(unit)
+				srcml_unit_free(unit);
+			unit = srcml_unit_create(archive);
+			srcml_unit_set_language(unit, source.files[pos].second.c_str());
+			srcml_unit_set_filename(unit, filename.c_str());
+
+			const char * srcml = nullptr;
+			if(srcml_unit_parse_filename(unit, filename.c_str()) == SRCML_STATUS_OK)
+				srcml = srcml_unit_get_srcml(unit);
+
+			if(!srcml)
+				throw std::string("Error: Unable to parse ") + filename;
+
+			return std::make_pair(srcml, std::strlen(srcml));
+
+		}
+
+	};
+
+private:
+
+	void add_file(srcml_archive * archive, const std::string & filename, bool required, const srcuml_shard & shard, const srcuml_unit_filter & filter) {
+
+		const char * language = srcml_archive_check_extension(archive, filename.c_str());
+		if(language) {
+
+			if(shard.contains(filename) && filter.selects_path(filename))
+				files.emplace_back(filename, language);
+			return;
+
+		}
+
+		if(required)
+			throw std::string("Error: Unknown source language for ") + filename;
+
+	}
+
+};
+
+#endif
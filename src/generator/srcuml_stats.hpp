@@ -0,0 +1,325 @@
+/**
+ * @file srcuml_stats.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_STATS_HPP
+#define INCLUDED_SRCUML_STATS_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <chrono>
+#include <mutex>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+#include <srcuml_allocation.hpp>
+#include <srcuml_trace.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+/**
+ * srcuml_stats
+ *
+ * Time spent in each phase of a run, counts of what it processed and notes,
+ * e.g. the layout used.  Phases and counts are summed when recorded again and
+ * listed in the order first recorded.  Recording is thread safe.  Nothing is
+ * recorded, or timed, without a srcuml_stats, see srcuml_options::stats.
+ * Built with SRCUML_ALLOCATION_STATS, the allocations of each timed phase are
+ * reported as well, see srcuml_allocation.  Timed phases are also spans of a
+ * started srcuml_trace, with or without stats.
+ *
+ * Given a progress stream, the start and end of every phase, notes and other
+ * events are also written to it as they happen, a JSON object per line:
+ *
+ *   {"event": "end", "phase": "layout", "elapsed_ms": 1520.125, "detail": "1520.010 ms"}
+ */
+class srcuml_stats {
+
+private:
+
+    mutable std::mutex mutex;
+
+    std::vector<std::pair<std::string, double>> times;
+    std::vector<std::pair<std::string, std::uint64_t>> counts;
+    std::vector<std::pair<std::string, std::string>> notes;
+
+    // events are written to it as they happen, nullptr writes none
+    std::ostream * progress = nullptr;
+    std::chrono::steady_clock::time_point created = std::chrono::steady_clock::now();
+
+public:
+
+    /**
+     * Times a phase from construction until stop or destruction on a monotonic clock,
+     * the allocations of the thread meanwhile count for it.  A timer for no stats does nothing.
+     */
+    class timer {
+
+    private:
+
+        srcuml_stats * stats;
+        const char * phase;
+        std::chrono::steady_clock::time_point start;
+        int previous_phase = 0;
+        srcuml_trace::span span;
+
+    public:
+
+        timer(srcuml_stats * stats, const char * phase)
+            : stats(stats), phase(phase), start(stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()),
+              span(phase, "phase") {
+
+            if(!stats)
+                return;
+
+            previous_phase = srcuml_allocation::get_phase();
+            srcuml_allocation::set_phase(srcuml_allocation::find_phase(phase));
+            stats->event("start", phase);
+
+        }
+
+        timer(const timer &) = delete;
+        timer & operator=(const timer &) = delete;
+
+        ~timer() {
+            stop();
+        }
+
+        void stop() {
+
+            span.end();
+            if(!stats)
+                return;
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            stats->add_time(phase, elapsed.count());
+
+            char detail[32];
+            std::snprintf(detail, sizeof(detail), "%.3f ms", elapsed.count());
+            stats->event("end", phase, detail);
+            stats = nullptr;
+
+            srcuml_allocation::set_phase(previous_phase);
+
+        }
+
+    };
+
+    void add_time(const std::string & phase, double milliseconds) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entry(times, phase) += milliseconds;
+
+    }
+
+    void add_count(const std::string & name, std::uint64_t number) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entry(counts, name) += number;
+
+    }
+
+    /** replaces an earlier note of the same name */
+    void set_note(const std::string & name, const std::string & text) {
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entry(notes, name) = text;
+        }
+
+        event("note", name, text);
+
+    }
+
+    /** events are written to out as they happen, see the class comment */
+    void report_progress(std::ostream * out) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        progress = out;
+
+    }
+
+    /** writes an event about subject, e.g. a phase, to the progress stream if any */
+    void event(const char * name, const std::string & subject, const std::string & detail = "") {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!progress)
+            return;
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - created;
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.3f", elapsed.count());
+
+        *progress << "{\"event\": \"" << name << "\", \"phase\": \"" << srcuml::json_escape(subject) << "\", \"elapsed_ms\": " << number;
+        if(!detail.empty())
+            *progress << ", \"detail\": \"" << srcuml::json_escape(detail) << '"';
+        *progress << "}" << std::endl;
+
+    }
+
+    /** peak resident set size of the process in bytes */
+    static std::uint64_t peak_rss() {
+
+        struct rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+
+        // kilobytes on Linux
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+
+    }
+
+    /** milliseconds recorded for phase, 0 if none */
+    double get_time(const std::string & phase) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const std::pair<std::string, double> & time : times)
+            if(time.first == phase)
+                return time.second;
+
+        return 0;
+
+    }
+
+    /** milliseconds of every phase, in the order first recorded */
+    std::vector<std::pair<std::string, double>> get_times() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return times;
+
+    }
+
+    /** every count, in the order first recorded */
+    std::vector<std::pair<std::string, std::uint64_t>> get_counts() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return counts;
+
+    }
+
+    /** resident set size of the process in bytes, 0 if unknown */
+    static std::uint64_t resident_rss() {
+
+        std::FILE * statm = std::fopen("/proc/self/statm", "r");
+        if(!statm)
+            return 0;
+
+        unsigned long long size = 0, resident = 0;
+        const bool is_read = std::fscanf(statm, "%llu %llu", &size, &resident) == 2;
+        std::fclose(statm);
+
+        return is_read ? static_cast<std::uint64_t>(resident) * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+
+    }
+
+    void write_text(std::ostream & out) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        char line[160];
+        for(const std::pair<std::string, double> & time : times) {
+            std::snprintf(line, sizeof(line), "%-28s %12.3f ms\n", time.first.c_str(), time.second);
+            out << line;
+        }
+
+        for(const std::pair<std::string, std::uint64_t> & count : counts) {
+            std::snprintf(line, sizeof(line), "%-28s %12llu\n", count.first.c_str(), static_cast<unsigned long long>(count.second));
+            out << line;
+        }
+
+        std::snprintf(line, sizeof(line), "%-28s %12.1f MiB\n", "peak rss", peak_rss() / (1024.0 * 1024.0));
+        out << line;
+
+        for(const srcuml_allocation::phase_counts & phase : srcuml_allocation::get_counts()) {
+            std::snprintf(line, sizeof(line), "%-28s %12llu allocations %10.1f MiB %10.1f MiB peak live %10.1f MiB live\n",
+                          ("allocations " + phase.phase).c_str(), static_cast<unsigned long long>(phase.allocations),
+                          phase.bytes / (1024.0 * 1024.0), phase.peak_live_bytes / (1024.0 * 1024.0), phase.live_bytes / (1024.0 * 1024.0));
+            out << line;
+        }
+
+        for(const std::pair<std::string, std::string> & note : notes)
+            out << note.first << ": " << note.second << '\n';
+
+    }
+
+    /**
+     * {"times_ms": {...}, "counts": {...}, "peak_rss": bytes, "notes": {...}}, and when counted
+     * "allocations": {phase: {"count": n, "bytes": n, "peak_live_bytes": n, "live_bytes": n}, ...}
+     */
+    void write_json(std::ostream & out) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        out << "{\"times_ms\": {";
+        for(std::size_t pos = 0; pos < times.size(); ++pos) {
+
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.3f", times[pos].second);
+            out << (pos ? ", " : "") << '"' << srcuml::json_escape(times[pos].first) << "\": " << number;
+
+        }
+
+        out << "}, \"counts\": {";
+        for(std::size_t pos = 0; pos < counts.size(); ++pos)
+            out << (pos ? ", " : "") << '"' << srcuml::json_escape(counts[pos].first) << "\": " << counts[pos].second;
+
+        out << "}, \"peak_rss\": " << peak_rss() << ", \"notes\": {";
+        for(std::size_t pos = 0; pos < notes.size(); ++pos)
+            out << (pos ? ", " : "") << '"' << srcuml::json_escape(notes[pos].first) << "\": \"" << srcuml::json_escape(notes[pos].second) << '"';
+        out << '}';
+
+        if(srcuml_allocation::is_enabled()) {
+
+            const std::vector<srcuml_allocation::phase_counts> allocations = srcuml_allocation::get_counts();
+            out << ", \"allocations\": {";
+            for(std::size_t pos = 0; pos < allocations.size(); ++pos)
+                out << (pos ? ", " : "") << '"' << srcuml::json_escape(allocations[pos].phase) << "\": {\"count\": " << allocations[pos].allocations
+                    << ", \"bytes\": " << allocations[pos].bytes << ", \"peak_live_bytes\": " << allocations[pos].peak_live_bytes
+                    << ", \"live_bytes\": " << allocations[pos].live_bytes << '}';
+            out << '}';
+
+        }
+
+        out << "}\n";
+
+    }
+
+private:
+
+    template<typename value_type>
+    static value_type & entry(std::vector<std::pair<std::string, value_type>> & entries, const std::string & name) {
+
+        for(std::pair<std::string, value_type> & existing : entries)
+            if(existing.first == name)
+                return existing.second;
+
+        entries.emplace_back(name, value_type());
+        return entries.back().second;
+
+    }
+
+};
+
+#endif
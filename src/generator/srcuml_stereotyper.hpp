@@ -0,0 +1,742 @@
+/**
+ * @file srcuml_stereotyper.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_STEREOTYPER_HPP
+#define INCLUDED_SRCUML_STEREOTYPER_HPP
+
+#include <ClassPolicySingleEvent.hpp>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+/**
+ * srcuml_stereotyper
+ *
+ * Classifies method stereotypes, get, set, command and so on, from the srcML
+ * events of the function bodies during the SAX pass, as stereotype.xsl did
+ * over the whole archive beforehand, see orig_files/stereotype_base.xsl.  The
+ * class stereotypes svg_three clusters by, entity, control and boundary, are
+ * derived from those of its methods.
+ *
+ * Fed the events by srcuml_dispatcher.  Fills in a class with apply when the
+ * ClassPolicy reports it, which is when its end tag is seen.  Only functions
+ * defined inside a class are classified, as with the XSLT, and stereotypes
+ * already in the srcML, e.g. of an archive the XSLT was run over, are kept.
+ */
+class srcuml_stereotyper {
+
+private:
+
+    enum element_kind { OTHER, CLASS, FUNCTION, CONSTRUCTOR, BLOCK, NAME, TYPE, SPECIFIER, MODIFIER, OPERATOR, LITERAL,
+                        CALL, EXPR, DECL, DECL_STMT, PARAMETER_LIST, RETURN, STATEMENT };
+
+    struct element {
+
+        element_kind kind;
+        // non-whitespace text of NAME, TYPE, SPECIFIER, MODIFIER, OPERATOR and LITERAL, and the name of a CALL
+        std::string text;
+
+    };
+
+    struct token {
+
+        element_kind kind;
+        std::string text;
+
+    };
+
+    struct return_facts {
+
+        // return n; or return *n;
+        bool is_variable;
+        std::string variable;
+        // return *this;
+        bool is_this;
+        bool has_new;
+
+    };
+
+    struct function_facts {
+
+        bool is_constructor = false;
+        std::string name;
+        bool is_const = false;
+        std::string return_type;
+
+        std::vector<std::string> parameter_names;
+        std::vector<std::string> parameter_types;
+        std::vector<std::string> local_names;
+        std::vector<std::string> local_types;
+
+        std::size_t statements = 0;
+        // variables, without this->, read or written, written and called on, in any order
+        std::vector<std::string> used;
+        std::vector<std::string> written;
+        std::vector<std::string> calls;
+        std::size_t news = 0;
+        std::vector<return_facts> returns;
+
+        // depth of the function element, of its body, 0 until entered, and classes open at the start
+        std::size_t depth = 0;
+        std::size_t body_depth = 0;
+        std::size_t class_level = 0;
+        bool in_parameters = false;
+        bool after_parameters = false;
+
+    };
+
+    struct class_facts {
+
+        std::string name;
+        std::size_t depth;
+        std::unordered_set<std::string> fields;
+        std::vector<function_facts> functions;
+
+    };
+
+    struct expr_facts {
+
+        std::size_t depth;
+        std::vector<token> tokens;
+
+    };
+
+    std::vector<element> elements;
+    std::size_t depth = 0;
+
+    std::vector<class_facts> classes;
+    std::vector<function_facts> functions;
+    std::vector<expr_facts> exprs;
+
+    // stereotypes of the defined functions of each class of the unit ended so far, by name and number of parameters
+    std::unordered_map<std::string, std::map<std::pair<std::string, std::size_t>, std::deque<std::set<std::string>>>> completed;
+
+public:
+
+    void start_unit() {
+
+        depth = 0;
+        classes.clear();
+        functions.clear();
+        exprs.clear();
+        completed.clear();
+
+    }
+
+    void start_element(const char * localname) {
+
+        if(depth == elements.size())
+            elements.emplace_back();
+
+        element & current = elements[depth++];
+        current.kind = kind_of(localname);
+        current.text.clear();
+
+        switch(current.kind) {
+
+        case CLASS:
+            classes.push_back(class_facts{ std::string(), depth, {}, {} });
+            return;
+
+        case FUNCTION:
+        case CONSTRUCTOR:
+            if(!classes.empty() && (functions.empty() || functions.back().class_level < classes.size())) {
+                functions.emplace_back();
+                functions.back().is_constructor = current.kind == CONSTRUCTOR;
+                functions.back().depth = depth;
+                functions.back().class_level = classes.size();
+            }
+            return;
+
+        case BLOCK:
+            if(is_function_child())
+                functions.back().body_depth = depth;
+            return;
+
+        case PARAMETER_LIST:
+            if(is_function_child())
+                functions.back().in_parameters = true;
+            return;
+
+        default:
+            break;
+
+        }
+
+        if(!in_body())
+            return;
+
+        function_facts & function = functions.back();
+        if(current.kind == STATEMENT || current.kind == DECL_STMT || current.kind == RETURN)
+            ++function.statements;
+        else if(current.kind == EXPR)
+            exprs.push_back(expr_facts{ depth, {} });
+
+    }
+
+    void characters(const char * ch, int len) {
+
+        if(depth == 0 || !is_text(elements[depth - 1].kind))
+            return;
+
+        std::string & text = elements[depth - 1].text;
+        for(int pos = 0; pos < len; ++pos)
+            if(!std::isspace(static_cast<unsigned char>(ch[pos])))
+                text += ch[pos];
+
+    }
+
+    void end_element() {
+
+        if(depth == 0)
+            return;
+
+        element & current = elements[depth - 1];
+        element * parent = depth > 1 ? &elements[depth - 2] : nullptr;
+        element * grandparent = depth > 2 ? &elements[depth - 3] : nullptr;
+
+        if(parent && is_text(current.kind) && is_text(parent->kind) && !(parent->kind == TYPE && current.kind == SPECIFIER)) {
+            if(parent->kind == TYPE && !parent->text.empty())
+                parent->text += ' ';
+            parent->text += current.text;
+        }
+
+        switch(current.kind) {
+
+        case NAME:
+            end_name(current, parent, grandparent);
+            break;
+
+        case TYPE:
+            end_type(current, parent, grandparent);
+            break;
+
+        case SPECIFIER:
+            if(is_function_child() && functions.back().after_parameters && current.text == "const")
+                functions.back().is_const = true;
+            break;
+
+        case PARAMETER_LIST:
+            if(is_function_child()) {
+                functions.back().in_parameters = false;
+                functions.back().after_parameters = true;
+            }
+            break;
+
+        case OPERATOR:
+        case LITERAL:
+            if(parent && parent->kind == EXPR && in_expr()) {
+                exprs.back().tokens.push_back(token{ current.kind, current.text });
+                if(current.text == "new")
+                    ++functions.back().news;
+            }
+            break;
+
+        case CALL:
+            if(in_body()) {
+                // new foo() constructs, it is not a real call
+                const bool is_new = in_expr() && !exprs.back().tokens.empty() && exprs.back().tokens.back().text == "new";
+                if(!is_new)
+                    functions.back().calls.push_back(current.text);
+                if(parent && parent->kind == EXPR && in_expr())
+                    exprs.back().tokens.push_back(token{ CALL, current.text });
+            }
+            break;
+
+        case EXPR:
+            if(in_expr() && exprs.back().depth == depth) {
+                end_expr(parent && parent->kind == RETURN);
+                exprs.pop_back();
+            }
+            break;
+
+        case FUNCTION:
+        case CONSTRUCTOR:
+            if(!functions.empty() && functions.back().depth == depth) {
+                classes[functions.back().class_level - 1].functions.push_back(std::move(functions.back()));
+                functions.pop_back();
+            }
+            break;
+
+        case CLASS:
+            if(!classes.empty() && classes.back().depth == depth) {
+                end_class(classes.back());
+                classes.pop_back();
+            }
+            break;
+
+        default:
+            break;
+
+        }
+
+        --depth;
+
+    }
+
+    /** fills in the stereotypes of the class and its inner classes, keeping any already there */
+    void apply(ClassPolicy::ClassData * data) const {
+
+        if(!data)
+            return;
+
+        for(std::size_t access = 0; access < 3; ++access)
+            for(ClassPolicy::ClassData * inner : data->innerClasses[access])
+                apply(inner);
+
+        if(!data->name)
+            return;
+
+        std::unordered_map<std::string, std::map<std::pair<std::string, std::size_t>, std::deque<std::set<std::string>>>>::const_iterator found
+            = completed.find(data->name->ToString());
+        if(found == completed.end())
+            return;
+
+        std::map<std::pair<std::string, std::size_t>, std::deque<std::set<std::string>>> remaining = found->second;
+        std::map<std::string, std::size_t> counts;
+        std::size_t classified = 0;
+        for(std::size_t access = 0; access < 3; ++access) {
+
+            for(const std::vector<FunctionPolicy::FunctionData *> * functions : { &data->constructors[access], &data->methods[access], &data->operators[access] }) {
+
+                for(FunctionPolicy::FunctionData * function : *functions) {
+
+                    if(!function || !function->name)
+                        continue;
+
+                    std::deque<std::set<std::string>> & defined = remaining[std::make_pair(function->name->ToString(), function->parameters.size())];
+                    if(defined.empty())
+                        continue;
+
+                    if(function->stereotypes.empty())
+                        function->stereotypes = defined.front();
+                    defined.pop_front();
+
+                    ++classified;
+                    for(const std::string & stereotype : function->stereotypes)
+                        ++counts[stereotype];
+
+                }
+
+            }
+
+        }
+
+        if(data->stereotypes.empty() && classified != 0) {
+            const std::string stereotype = class_stereotype(counts, classified);
+            if(!stereotype.empty())
+                data->stereotypes.insert(stereotype);
+        }
+
+    }
+
+private:
+
+    static element_kind kind_of(const char * localname) {
+
+        static const std::pair<const char *, element_kind> kinds[] = {
+            { "name", NAME }, { "operator", OPERATOR }, { "expr", EXPR }, { "call", CALL }, { "type", TYPE },
+            { "literal", LITERAL }, { "decl", DECL }, { "decl_stmt", DECL_STMT }, { "expr_stmt", STATEMENT },
+            { "block", BLOCK }, { "specifier", SPECIFIER }, { "modifier", MODIFIER }, { "return", RETURN },
+            { "function", FUNCTION }, { "constructor", CONSTRUCTOR }, { "parameter_list", PARAMETER_LIST },
+            { "class", CLASS }, { "struct", CLASS }, { "if", STATEMENT }, { "for", STATEMENT }, { "while", STATEMENT },
+            { "do", STATEMENT }, { "switch", STATEMENT }, { "throw", STATEMENT }, { "try", STATEMENT },
+            { "break", STATEMENT }, { "continue", STATEMENT }, { "goto", STATEMENT }, { "foreach", STATEMENT }
+        };
+
+        for(const std::pair<const char *, element_kind> & kind : kinds)
+            if(std::strcmp(localname, kind.first) == 0)
+                return kind.second;
+
+        return OTHER;
+
+    }
+
+    static bool is_text(element_kind kind) {
+
+        return kind == NAME || kind == TYPE || kind == SPECIFIER || kind == MODIFIER || kind == OPERATOR || kind == LITERAL;
+
+    }
+
+    /** the current element is a child of the innermost function element */
+    bool is_function_child() const {
+
+        return !functions.empty() && functions.back().class_level == classes.size() && functions.back().depth + 1 == depth;
+
+    }
+
+    /** inside the body of a function of the innermost class */
+    bool in_body() const {
+
+        return !functions.empty() && functions.back().class_level == classes.size()
+            && functions.back().body_depth != 0 && depth > functions.back().body_depth;
+
+    }
+
+    bool in_expr() const {
+
+        return in_body() && !exprs.empty() && exprs.back().depth > functions.back().body_depth;
+
+    }
+
+    void end_name(element & current, element * parent, element * grandparent) {
+
+        if(!parent)
+            return;
+
+        if(parent->kind == CLASS) {
+            if(!classes.empty() && classes.back().depth + 1 == depth && classes.back().name.empty())
+                classes.back().name = current.text;
+            return;
+        }
+
+        if(parent->kind == CALL) {
+            if(parent->text.empty())
+                parent->text = current.text;
+            return;
+        }
+
+        if(parent->kind == EXPR) {
+            if(in_expr())
+                exprs.back().tokens.push_back(token{ NAME, current.text });
+            return;
+        }
+
+        if((parent->kind == FUNCTION || parent->kind == CONSTRUCTOR) && is_function_child()) {
+            if(functions.back().name.empty())
+                functions.back().name = current.text;
+            return;
+        }
+
+        if(parent->kind != DECL || !grandparent)
+            return;
+
+        if(in_body()) {
+            if(grandparent->kind == DECL_STMT)
+                functions.back().local_names.push_back(current.text);
+        } else if(!functions.empty() && functions.back().class_level == classes.size() && functions.back().in_parameters) {
+            functions.back().parameter_names.push_back(current.text);
+        } else if(grandparent->kind == DECL_STMT && !classes.empty()
+                  && (functions.empty() || functions.back().class_level < classes.size())) {
+            classes.back().fields.insert(primary_name(current.text));
+        }
+
+    }
+
+    void end_type(element & current, element * parent, element * grandparent) {
+
+        if(!parent)
+            return;
+
+        if((parent->kind == FUNCTION || parent->kind == CONSTRUCTOR) && is_function_child()) {
+            functions.back().return_type = current.text;
+            return;
+        }
+
+        if(parent->kind != DECL || !grandparent)
+            return;
+
+        if(in_body()) {
+            if(grandparent->kind == DECL_STMT)
+                functions.back().local_types.push_back(current.text);
+        } else if(!functions.empty() && functions.back().class_level == classes.size() && functions.back().in_parameters) {
+            functions.back().parameter_types.push_back(current.text);
+        }
+
+    }
+
+    /** variables read, written and, for a return, what is returned */
+    void end_expr(bool is_return) {
+
+        function_facts & function = functions.back();
+        const std::vector<token> & tokens = exprs.back().tokens;
+
+        for(std::size_t pos = 0; pos < tokens.size(); ++pos) {
+
+            if(tokens[pos].kind != NAME)
+                continue;
+
+            const std::string variable = primary_name(tokens[pos].text);
+            function.used.push_back(variable);
+
+            const bool is_assigned = pos + 1 < tokens.size() && tokens[pos + 1].kind == OPERATOR && is_assignment(tokens[pos + 1].text);
+            const bool is_incremented = pos > 0 && tokens[pos - 1].kind == OPERATOR && (tokens[pos - 1].text == "++" || tokens[pos - 1].text == "--");
+            if(is_assigned || is_incremented)
+                function.written.push_back(variable);
+
+        }
+
+        if(!is_return)
+            return;
+
+        return_facts facts{ false, std::string(), false, false };
+        if(tokens.size() == 1 && tokens[0].kind == NAME) {
+            facts.is_variable = true;
+            facts.variable = primary_name(tokens[0].text);
+        } else if(tokens.size() == 2 && tokens[0].kind == OPERATOR && tokens[0].text == "*" && tokens[1].kind == NAME) {
+            facts.is_this = tokens[1].text == "this";
+            facts.is_variable = !facts.is_this;
+            facts.variable = primary_name(tokens[1].text);
+        }
+
+        for(const token & returned : tokens)
+            if(returned.kind == OPERATOR && returned.text == "new")
+                facts.has_new = true;
+
+        function.returns.push_back(facts);
+
+    }
+
+    static bool is_assignment(const std::string & op) {
+
+        return op == "=" || op == "+=" || op == "-=" || op == "*=" || op == "/=" || op == "%=" || op == "&=" || op == "|="
+            || op == "^=" || op == "<<=" || op == ">>=" || op == "++" || op == "--";
+
+    }
+
+    /** the variable a name starts with, e.g. a of this->a.b[0] */
+    static std::string primary_name(const std::string & name) {
+
+        std::string variable = name;
+        for(const char * self : { "this->", "this." })
+            if(variable.compare(0, std::strlen(self), self) == 0)
+                variable.erase(0, std::strlen(self));
+
+        std::size_t end = std::min({ variable.find('.'), variable.find("->"), variable.find('[') });
+        return variable.substr(0, end);
+
+    }
+
+    void end_class(const class_facts & current) {
+
+        std::map<std::pair<std::string, std::size_t>, std::deque<std::set<std::string>>> & defined = completed[current.name];
+        defined.clear();
+
+        for(const function_facts & function : current.functions)
+            defined[std::make_pair(function.name, function.parameter_names.size())].push_back(classify(function, current));
+
+    }
+
+    static bool contains(const std::vector<std::string> & names, const std::string & name) {
+
+        return std::find(names.begin(), names.end(), name) != names.end();
+
+    }
+
+    static bool has_word(const std::string & type, const char * word) {
+
+        const std::size_t length = std::strlen(word);
+        for(std::size_t pos = type.find(word); pos != std::string::npos; pos = type.find(word, pos + 1)) {
+
+            const bool starts = pos == 0 || !(std::isalnum(static_cast<unsigned char>(type[pos - 1])) || type[pos - 1] == '_');
+            const bool ends = pos + length == type.size() || !(std::isalnum(static_cast<unsigned char>(type[pos + length])) || type[pos + length] == '_');
+            if(starts && ends)
+                return true;
+
+        }
+
+        return false;
+
+    }
+
+    /** a type naming an object of another class than class_name */
+    static bool is_collaborator(const std::string & type, const std::string & class_name) {
+
+        static const std::set<std::string> primitives = { "void", "bool", "char", "wchar_t", "char16_t", "char32_t", "short", "int",
+                                                          "long", "float", "double", "signed", "unsigned", "auto", "size_t",
+                                                          "std::size_t", "const", "volatile", "*", "&", "&&", "boolean", "byte",
+                                                          "String", "Object", "T" };
+
+        std::size_t start = 0;
+        while(start < type.size()) {
+
+            std::size_t end = type.find(' ', start);
+            if(end == std::string::npos)
+                end = type.size();
+
+            const std::string word = type.substr(start, end - start);
+            if(!word.empty() && !primitives.count(word) && word != class_name && word.compare(0, 5, "std::") != 0)
+                return true;
+
+            start = end + 1;
+
+        }
+
+        return false;
+
+    }
+
+    /** stereotypes of a function, following the criteria of orig_files/stereotype_base.xsl */
+    static std::set<std::string> classify(const function_facts & function, const class_facts & current) {
+
+        if(function.is_constructor) {
+
+            if(function.parameter_types.size() == 1 && has_word(function.parameter_types.front(), current.name.c_str()))
+                return { "copy-constructor" };
+
+            return { "constructor" };
+
+        }
+
+        if(function.statements == 0)
+            return { "empty" };
+
+        auto is_data_member = [&](const std::string & variable) {
+            return current.fields.count(variable) && !contains(function.parameter_names, variable) && !contains(function.local_names, variable);
+        };
+
+        std::set<std::string> members_written;
+        for(const std::string & variable : function.written)
+            if(is_data_member(variable))
+                members_written.insert(variable);
+
+        bool uses_members = !members_written.empty();
+        for(const std::string & variable : function.used)
+            uses_members = uses_members || is_data_member(variable);
+
+        bool locals_written = false;
+        for(const std::string & variable : function.written)
+            locals_written = locals_written || contains(function.parameter_names, variable) || contains(function.local_names, variable);
+
+        std::size_t pure_calls = 0, member_calls = 0;
+        for(const std::string & call : function.calls) {
+
+            const std::string callee = primary_name(call);
+            if(callee == call || call.compare(0, 4, "this") == 0)
+                ++pure_calls;
+            else if(is_data_member(callee))
+                ++member_calls;
+
+        }
+
+        const bool is_void = function.return_type == "void";
+        const bool is_bool = has_word(function.return_type, "bool") || has_word(function.return_type, "boolean");
+
+        bool returns_member = false, returns_other = false, returns_this = false, returns_created = false;
+        for(const return_facts & returned : function.returns) {
+
+            const bool is_member = returned.is_variable && is_data_member(returned.variable);
+            returns_member = returns_member || is_member;
+            returns_other = returns_other || !is_member;
+            returns_this = returns_this || returned.is_this;
+            returns_created = returns_created || returned.has_new
+                || (returned.is_variable && (contains(function.parameter_names, returned.variable) || contains(function.local_names, returned.variable)));
+
+        }
+
+        const bool uses_state = uses_members || pure_calls != 0 || member_calls != 0;
+
+        std::set<std::string> stereotypes;
+        if(function.is_const) {
+
+            if(!is_void && returns_member)
+                stereotypes.insert("get");
+            if(is_bool && returns_other && uses_state)
+                stereotypes.insert("predicate");
+            if(!is_void && !is_bool && returns_other && uses_state)
+                stereotypes.insert("property");
+            if(is_void && uses_members)
+                stereotypes.insert("void-accessor");
+            if(!uses_state && (is_void || returns_other))
+                stereotypes.insert("controller");
+
+        } else {
+
+            const std::size_t calls = function.calls.size();
+            const bool is_command = members_written.size() > 1 || (members_written.size() == 1 && calls >= 2)
+                                 || (members_written.empty() && (pure_calls != 0 || member_calls != 0));
+
+            if(!is_void && returns_member && members_written.empty())
+                stereotypes.insert("nonconstget");
+            if((is_void || is_bool || returns_this) && calls <= 1 && members_written.size() == 1)
+                stereotypes.insert("set");
+            else if((is_void || is_bool) && is_command)
+                stereotypes.insert("command");
+            else if(!is_void && !is_bool && is_command)
+                stereotypes.insert("non-void-command");
+            if(members_written.empty() && pure_calls == 0 && member_calls == 0 && (calls != 0 || locals_written))
+                stereotypes.insert("controller");
+
+        }
+
+        if(function.return_type.find('*') != std::string::npos && returns_created)
+            stereotypes.insert("factory");
+
+        if(stereotypes.empty() && !uses_members)
+            stereotypes.insert(function.calls.size() + function.news != 0 ? "stateless" : "incidental");
+
+        bool collaborates = is_collaborator(function.return_type, current.name);
+        for(const std::string & type : function.parameter_types)
+            collaborates = collaborates || is_collaborator(type, current.name);
+        for(const std::string & type : function.local_types)
+            collaborates = collaborates || is_collaborator(type, current.name);
+        if(collaborates)
+            stereotypes.insert("collaborator");
+
+        if(stereotypes.empty())
+            stereotypes.insert("unclassified");
+
+        return stereotypes;
+
+    }
+
+    /** control, boundary or entity from how many of the classified methods have each stereotype */
+    static std::string class_stereotype(const std::map<std::string, std::size_t> & counts, std::size_t methods) {
+
+        auto count = [&](std::initializer_list<const char *> names) {
+            std::size_t total = 0;
+            for(const char * name : names) {
+                std::map<std::string, std::size_t>::const_iterator found = counts.find(name);
+                if(found != counts.end())
+                    total += found->second;
+            }
+            return total;
+        };
+
+        const std::size_t accessors = count({ "get", "nonconstget", "predicate", "property", "void-accessor" });
+        const std::size_t mutators = count({ "set", "command", "non-void-command" });
+        const std::size_t controllers = count({ "controller" });
+        const std::size_t factories = count({ "factory" });
+        const std::size_t collaborators = count({ "collaborator" });
+
+        if(3 * (controllers + factories) > 2 * methods)
+            return "control";
+        if(2 * collaborators > methods && 2 * factories < methods && 3 * controllers < methods)
+            return "boundary";
+        if(accessors + mutators > controllers + factories)
+            return "entity";
+
+        return "";
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file srcuml_symbol.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_SYMBOL_HPP
+#define INCLUDED_SRCUML_SYMBOL_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <algorithm>
+#include <cstddef>
+
+/** dense id of an interned class or type name */
+typedef std::size_t srcuml_symbol;
+
+/**
+ * srcuml_symbol_table
+ *
+ * Process wide table interning class and type names, so the relationships and
+ * outputters compare and look up names by id.  Ids are dense, and only reused
+ * once the names interned after a size are dropped by truncate, e.g. at the
+ * end of a srcuml_symbol_scope.  Safe to use from the parsing threads.
+ */
+class srcuml_symbol_table {
+
+private:
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, srcuml_symbol> symbols;
+    // deque so references to names stay valid as the table grows
+    std::deque<std::string> names;
+
+    srcuml_symbol_table() : mutex(), symbols(), names() {
+
+        // the empty name is symbol 0
+        intern(std::string());
+
+    }
+
+public:
+
+    static srcuml_symbol_table & instance() {
+
+        static srcuml_symbol_table table;
+        return table;
+
+    }
+
+    srcuml_symbol intern(const std::string & name) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::unordered_map<std::string, srcuml_symbol>::const_iterator itr = symbols.find(name);
+        if(itr != symbols.end())
+            return itr->second;
+
+        srcuml_symbol symbol = names.size();
+        names.push_back(name);
+        symbols.emplace(name, symbol);
+
+        return symbol;
+
+    }
+
+    /** the names interned under one lock, e.g. those generated by several threads, in order */
+    std::vector<srcuml_symbol> intern(const std::vector<std::string> & names) {
+
+        std::vector<srcuml_symbol> interned;
+        interned.reserve(names.size());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const std::string & name : names) {
+
+            std::unordered_map<std::string, srcuml_symbol>::const_iterator itr = symbols.find(name);
+            if(itr == symbols.end()) {
+
+                itr = symbols.emplace(name, this->names.size()).first;
+                this->names.push_back(name);
+
+            }
+
+            interned.push_back(itr->second);
+
+        }
+
+        return interned;
+
+    }
+
+    const std::string & get_name(srcuml_symbol symbol) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return names[symbol];
+
+    }
+
+    std::size_t size() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.size();
+
+    }
+
+    /** drops the names interned since the table had size names, nothing may hold their symbols */
+    void truncate(std::size_t size) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        while(names.size() > std::max<std::size_t>(size, 1)) {
+
+            symbols.erase(names.back());
+            names.pop_back();
+
+        }
+
+    }
+
+};
+
+namespace srcuml {
+
+inline srcuml_symbol intern(const std::string & name) {
+    return srcuml_symbol_table::instance().intern(name);
+}
+
+inline std::vector<srcuml_symbol> intern(const std::vector<std::string> & names) {
+    return srcuml_symbol_table::instance().intern(names);
+}
+
+inline const std::string & symbol_name(srcuml_symbol symbol) {
+    return srcuml_symbol_table::instance().get_name(symbol);
+}
+
+}
+
+#endif
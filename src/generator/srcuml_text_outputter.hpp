@@ -0,0 +1,67 @@
+/**
+ * @file srcuml_text_outputter.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_TEXT_OUTPUTTER_HPP
+#define INCLUDED_SRCUML_TEXT_OUTPUTTER_HPP
+
+#include <srcuml_outputter.hpp>
+#include <srcuml_text_sink.hpp>
+
+/**
+ * srcuml_text_outputter
+ *
+ * A text format written in two phases: each class body on its own, then the
+ * relationships once the whole model is known.  The class bodies can be
+ * written while the archive is still being parsed, see srcuml_options::early_output.
+ */
+class srcuml_text_outputter : public srcuml_outputter {
+
+public:
+
+	bool output(std::ostream & stream, std::vector<std::shared_ptr<srcuml_class>> & classes) override {
+
+		srcuml_relationships relationships = analyze_relationships(classes);
+
+		// written to the stream in large blocks
+		srcuml_text_sink out(stream);
+
+		write_header(out);
+		for(const std::shared_ptr<srcuml_class> & aclass : classes)
+			write_class(out, *aclass);
+		write_relationships(out, classes, relationships);
+
+		return true;
+
+	}
+
+	/** written before any class */
+	virtual void write_header(srcuml_text_sink & out) = 0;
+
+	/** a class body, in the order the classes are given */
+	virtual void write_class(srcuml_text_sink & out, const srcuml_class & aclass) = 0;
+
+	/** once every class is written, the classes are those written, finalized by the analysis */
+	virtual void write_relationships(srcuml_text_sink & out, const std::vector<std::shared_ptr<srcuml_class>> & classes,
+									 const srcuml_relationships & relationships) = 0;
+
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file srcuml_text_sink.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_TEXT_SINK_HPP
+#define INCLUDED_SRCUML_TEXT_SINK_HPP
+
+#include <string>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+
+/**
+ * srcuml_text_sink
+ *
+ * Collects the text of an outputter in one growing buffer and writes it to
+ * the stream in large blocks, so a model is not written to the stream one
+ * small piece, or one character, at a time.  Whatever is left is written
+ * when the sink is flushed or destroyed.
+ */
+class srcuml_text_sink {
+
+private:
+
+    std::ostream & out;
+    std::string buffer;
+
+public:
+
+    enum : std::size_t { BUFFER_SIZE = 1 << 16 };
+
+    explicit srcuml_text_sink(std::ostream & out) : out(out), buffer() {
+        buffer.reserve(BUFFER_SIZE);
+    }
+
+    ~srcuml_text_sink() {
+        flush();
+    }
+
+    srcuml_text_sink(const srcuml_text_sink &) = delete;
+    srcuml_text_sink & operator=(const srcuml_text_sink &) = delete;
+
+    void append(const char * text, std::size_t size) {
+
+        buffer.append(text, size);
+        if(buffer.size() >= BUFFER_SIZE)
+            flush();
+
+    }
+
+    /** room for size more characters at the end of the text, to be written before shrink */
+    char * extend(std::size_t size) {
+
+        std::size_t end = buffer.size();
+        buffer.resize(end + size);
+        return &buffer[end];
+
+    }
+
+    /** gives back the end of the room of extend that was not written */
+    void shrink(std::size_t unused) {
+
+        buffer.resize(buffer.size() - unused);
+        if(buffer.size() >= BUFFER_SIZE)
+            flush();
+
+    }
+
+    srcuml_text_sink & operator<<(const std::string & text) {
+
+        append(text.data(), text.size());
+        return *this;
+
+    }
+
+    srcuml_text_sink & operator<<(const char * text) {
+
+        append(text, std::strlen(text));
+        return *this;
+
+    }
+
+    srcuml_text_sink & operator<<(char character) {
+
+        buffer += character;
+        if(buffer.size() >= BUFFER_SIZE)
+            flush();
+
+        return *this;
+
+    }
+
+    void flush() {
+
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+
+    }
+
+};
+
+#endif
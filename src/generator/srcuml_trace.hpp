@@ -0,0 +1,219 @@
+/**
+ * @file srcuml_trace.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_TRACE_HPP
+#define INCLUDED_SRCUML_TRACE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+#include <srcuml_utilities.hpp>
+
+/**
+ * srcuml_trace
+ *
+ * Spans of a run in the Chrome trace event format, for chrome://tracing and
+ * Perfetto, so a single slow unit, class or layout shows where the totals of
+ * --stats cannot.  Once started, a span records its name, category, thread
+ * and time from construction until end or destruction.  Each thread records
+ * into a buffer of its own, and the buffers are written together as complete
+ * ("X") events.  Until started, a span is a load of one atomic flag.
+ *
+ *   {"traceEvents": [{"name": "layout", "cat": "phase", "ph": "X", "ts": 1520.125, "dur": 88.5, "pid": 1, "tid": 2}, ...]}
+ */
+class srcuml_trace {
+
+private:
+
+    struct event {
+
+        const char * name;
+        const char * category;
+        std::string detail;
+        double start;
+        double duration;
+
+    };
+
+    struct thread_buffer {
+
+        std::uint32_t thread;
+
+        // only contended by write_json, e.g. with a layout abandoned at the deadline
+        std::mutex mutex;
+        std::vector<event> events;
+
+    };
+
+    std::atomic<bool> is_recording{false};
+    std::chrono::steady_clock::time_point started;
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+    std::atomic<std::uint32_t> number_threads{0};
+
+    srcuml_trace() : started(std::chrono::steady_clock::now()), mutex(), buffers() {}
+
+    /** the calling thread's buffer, registered on its first span */
+    thread_buffer & local_buffer() {
+
+        static thread_local std::shared_ptr<thread_buffer> local;
+        if(!local) {
+
+            local = std::make_shared<thread_buffer>();
+            local->thread = ++number_threads;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(local);
+
+        }
+
+        return *local;
+
+    }
+
+    double now() const {
+
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+
+    }
+
+public:
+
+    static srcuml_trace & instance() {
+
+        static srcuml_trace trace;
+        return trace;
+
+    }
+
+    /** spans are recorded from now on */
+    void start() {
+
+        started = std::chrono::steady_clock::now();
+        is_recording.store(true, std::memory_order_release);
+
+    }
+
+    bool is_started() const {
+        return is_recording.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * A span of the calling thread, recorded when it ends if the trace was started
+     * when it began.  name and category must outlive the trace, e.g. literals.
+     */
+    class span {
+
+    private:
+
+        const char * name;
+        const char * category;
+        std::string detail;
+        double start;
+        bool is_active;
+
+    public:
+
+        span(const char * name, const char * category)
+            : name(name), category(category), detail(), start(0), is_active(instance().is_started()) {
+
+            if(is_active)
+                start = instance().now();
+
+        }
+
+        span(const span &) = delete;
+        span & operator=(const span &) = delete;
+
+        ~span() {
+            end();
+        }
+
+        /** whether the span is recorded, so a detail is only built when it is */
+        explicit operator bool() const {
+            return is_active;
+        }
+
+        /** shown as the span's args, e.g. the class finalized */
+        void set_detail(const std::string & text) {
+            detail = text;
+        }
+
+        void end() {
+
+            if(!is_active)
+                return;
+            is_active = false;
+
+            srcuml_trace & trace = instance();
+            const double finish = trace.now();
+            thread_buffer & buffer = trace.local_buffer();
+
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.events.push_back(event{ name, category, std::move(detail), start, finish - start });
+
+        }
+
+    };
+
+    /** writes every span ended so far */
+    void write_json(std::ostream & out) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        out << "{\"traceEvents\": [";
+        bool is_first = true;
+        for(const std::shared_ptr<thread_buffer> & buffer : buffers) {
+
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+            for(const event & recorded : buffer->events) {
+
+                char times[64];
+                std::snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", recorded.start, recorded.duration);
+
+                out << (is_first ? "\n" : ",\n") << "{\"name\": \"" << srcuml::json_escape(recorded.name) << "\", \"cat\": \"" << recorded.category
+                    << "\", \"ph\": \"X\", " << times << ", \"pid\": 1, \"tid\": " << buffer->thread;
+                if(!recorded.detail.empty())
+                    out << ", \"args\": {\"detail\": \"" << srcuml::json_escape(recorded.detail) << "\"}";
+                out << '}';
+                is_first = false;
+
+            }
+
+        }
+
+        out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+
+    }
+
+};
+
+#endif
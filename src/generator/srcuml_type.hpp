@@ -24,167 +24,307 @@
 
 #include <TypePolicySingleEvent.hpp>
 
-class srcuml_type {
+#include <srcuml_serialize.hpp>
+#include <srcuml_symbol.hpp>
+#include <srcuml_container.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+/** flag bits of a srcuml_type */
+enum type_flag { TYPE_NUMERIC = 1 << 0,
+                 TYPE_POINTER = 1 << 1, TYPE_REFERENCE = 1 << 2, TYPE_RVALUE = 1 << 3,
+                 TYPE_CONST = 1 << 4,
+                 TYPE_HAS_INDEX = 1 << 5 };
+
+/**
+ * srcuml_argument_table
+ *
+ * Process wide table interning the template argument lists of types, so a
+ * srcuml_type keeps an id instead of a vector.  Id 0 is the empty list.
+ * Safe to use from the parsing threads.
+ */
+class srcuml_argument_table {
 
 private:
 
-    std::shared_ptr<TypePolicy::TypeData> data;
+    mutable std::mutex mutex;
+    // the symbols of a list as bytes
+    std::unordered_map<std::string, std::size_t> ids;
+    // deque so references to lists stay valid as the table grows
+    std::deque<std::vector<srcuml_symbol>> lists;
+
+    srcuml_argument_table() : mutex(), ids(), lists() {
+
+        intern(std::vector<srcuml_symbol>());
+
+    }
+
+public:
+
+    static srcuml_argument_table & instance() {
+
+        static srcuml_argument_table table;
+        return table;
+
+    }
+
+    std::size_t intern(const std::vector<srcuml_symbol> & arguments) {
+
+        const std::string key(reinterpret_cast<const char *>(arguments.data()), arguments.size() * sizeof(srcuml_symbol));
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::unordered_map<std::string, std::size_t>::const_iterator itr = ids.find(key);
+        if(itr != ids.end())
+            return itr->second;
+
+        std::size_t id = lists.size();
+        lists.push_back(arguments);
+        ids.emplace(key, id);
+
+        return id;
+
+    }
+
+    const std::vector<srcuml_symbol> & get_arguments(std::size_t id) const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return lists[id];
+
+    }
+
+    std::size_t size() const {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return lists.size();
+
+    }
+
+    /** drops the lists interned since the table had size lists, nothing may hold their ids */
+    void truncate(std::size_t size) {
 
-    std::string name;
-    bool is_numeric;
+        std::lock_guard<std::mutex> lock(mutex);
+        while(lists.size() > std::max<std::size_t>(size, 1)) {
 
-    bool is_pointer;
-    bool is_reference;
-    bool is_rvalue;
+            const std::vector<srcuml_symbol> & arguments = lists.back();
+            ids.erase(std::string(reinterpret_cast<const char *>(arguments.data()), arguments.size() * sizeof(srcuml_symbol)));
+            lists.pop_back();
 
-    bool is_const;
+        }
+
+    }
 
-    bool is_vector;
-    bool is_list;
-    bool is_deque;
-    bool is_forward_list;
-    bool is_stack;
-    bool is_queue;
-    bool is_priority_queue;
-    bool is_array;
+};
 
-    bool is_set;
-    bool is_map;
-    bool is_unordered_set;
-    bool is_unordered_map;
+/**
+ * srcuml_symbol_scope
+ *
+ * The names and template argument lists interned while a scope is alive are
+ * dropped when it ends, so a long running process, e.g. a server rendering each
+ * request from scratch, does not keep the names of every request.  Everything
+ * holding their symbols, classes, relationships and outputs, must be gone by
+ * then, and no other thread may be interning.
+ */
+class srcuml_symbol_scope {
 
-    bool is_auto_ptr;
-    bool is_shared_ptr;
-    bool is_unique_ptr;
-    bool is_scoped_ptr;
+private:
 
-    bool has_index;
-    std::string index;
+    std::size_t number_symbols;
+    std::size_t number_argument_lists;
 
 public:
 
-    srcuml_type(TypePolicy::TypeData * data) : srcuml_type(std::shared_ptr<TypePolicy::TypeData>(data)) {}
+    srcuml_symbol_scope()
+        : number_symbols(srcuml_symbol_table::instance().size()), number_argument_lists(srcuml_argument_table::instance().size()) {}
 
-    srcuml_type(std::shared_ptr<TypePolicy::TypeData> data)
-        : data(data),
-        name(),
-        is_numeric(false),
+    ~srcuml_symbol_scope() {
+
+        srcuml_argument_table::instance().truncate(number_argument_lists);
+        srcuml_symbol_table::instance().truncate(number_symbols);
+
+    }
+
+    srcuml_symbol_scope(const srcuml_symbol_scope &) = delete;
+    srcuml_symbol_scope & operator=(const srcuml_symbol_scope &) = delete;
+
+};
+
+/**
+ * srcuml_type
+ *
+ * Resolved type: interned name and index, a flag word and the container kind
+ * of its template base.  Small enough to copy into every attribute and parameter.
+ */
+class srcuml_type {
 
-        is_pointer(false),
-        is_reference(false),
-        is_rvalue(false),
+private:
 
-        is_const(false),
+    srcuml_symbol name;
+    // name with the qualifier it was written with, e.g. a::b::c, used to find its class
+    srcuml_symbol qualified;
+    // symbol 0 (the empty name) when there is no index
+    srcuml_symbol index;
 
-        is_vector(false),
-        is_list(false),
-        is_deque(false),
-        is_forward_list(false),
-        is_stack(false),
-        is_queue(false),
-        is_priority_queue(false),
-        is_array(false),
+    std::uint8_t flags;
+    std::uint8_t container;
 
-        is_set(false),
-        is_map(false),
-        is_unordered_set(false),
-        is_unordered_map(false),
+    // of a template, each of its arguments resolved as the type is, see srcuml_argument_table
+    std::size_t arguments;
 
-        is_auto_ptr(false),
-        is_shared_ptr(false),
-        is_unique_ptr(false),
-        is_scoped_ptr(false),
+public:
 
-        has_index(false),
-        index() {
+    /** does not take ownership, type data is only read during construction */
+    srcuml_type(const TypePolicy::TypeData * data)
+        : name(0),
+          qualified(0),
+          index(0),
+          flags(0),
+          container(NOT_CONTAINER),
+          arguments(0) {
 
-            resolve_type();
+            resolve_type(data);
             check_is_numeric();
 
     }
 
-    //~srcuml_type() { delete data; }
+    /** reads a type written by write */
+    srcuml_type(std::istream & in) : srcuml_type(nullptr) {
+
+        name = srcuml::intern(srcuml::read_string(in));
+        flags = srcuml::read_size(in);
+        container = srcuml::read_size(in);
+        index = srcuml::intern(srcuml::read_string(in));
+        qualified = srcuml::intern(srcuml::read_string(in));
+
+        std::vector<srcuml_symbol> argument_symbols(srcuml::read_size(in));
+        for(srcuml_symbol & argument : argument_symbols)
+            argument = srcuml::intern(srcuml::read_string(in));
+        arguments = srcuml_argument_table::instance().intern(argument_symbols);
+
+    }
+
+    void write(std::ostream & out) const {
+
+        srcuml::write_string(out, get_type_name());
+        srcuml::write_size(out, flags);
+        srcuml::write_size(out, container);
+        srcuml::write_string(out, get_index());
+        srcuml::write_string(out, srcuml::symbol_name(qualified));
+
+        const std::vector<srcuml_symbol> & argument_symbols = get_template_arguments();
+        srcuml::write_size(out, argument_symbols.size());
+        for(srcuml_symbol argument : argument_symbols)
+            srcuml::write_string(out, srcuml::symbol_name(argument));
+
+    }
 
     const std::string & get_type_name() const {
-        return name;        
+        return srcuml::symbol_name(name);
+    }
+
+    srcuml_symbol get_type_symbol() const {
+        return name;
+    }
+
+    srcuml_symbol get_qualified_symbol() const {
+        return qualified;
+    }
+
+    /** type_flag bits */
+    std::uint8_t get_flags() const {
+        return flags;
+    }
+
+    container_kind get_container_kind() const {
+        return (container_kind)container;
     }
 
     bool get_is_pointer() const {
-        return is_pointer;       
+        return flags & TYPE_POINTER;
     }    
 
     bool get_is_reference() const {
-        return is_reference;       
+        return flags & TYPE_REFERENCE;
     }
 
     bool get_is_rvalue() const {
-        return is_rvalue;       
+        return flags & TYPE_RVALUE;
     }
 
     bool get_is_const() const {
-        return is_const;       
+        return flags & TYPE_CONST;
     }
 
     bool get_is_container() const {
-        return is_vector || is_list || is_deque || is_forward_list
-            || is_stack || is_queue || is_priority_queue || is_array
-            || is_set || is_map || is_unordered_set || is_unordered_map;
+        return container >= VECTOR && container <= UNORDERED_MAP;
     }
 
     bool get_is_ordered() const {
-        return is_vector || is_list || is_deque || is_forward_list
-            || is_stack || is_queue || is_priority_queue || is_array;
+        return container >= VECTOR && container <= ARRAY;
     }
 
     bool get_is_smart_pointer() const {
-        return is_auto_ptr || is_shared_ptr || is_unique_ptr || is_scoped_ptr;       
+        return container >= AUTO_PTR && container <= SCOPED_PTR;
     }
 
     bool get_is_composite() const {
-        return (!is_pointer && !is_reference && !is_rvalue)
-            || is_shared_ptr;
+        return (!get_is_pointer() && !get_is_reference() && !get_is_rvalue())
+            || container == SHARED_PTR;
             /** @todo unique_ptr? */
     }
 
     bool get_is_aggregate() const {
-        return is_pointer || is_reference || is_rvalue
-            || is_auto_ptr
-            || is_scoped_ptr;
+        return get_is_pointer() || get_is_reference() || get_is_rvalue()
+            || container == AUTO_PTR
+            || container == SCOPED_PTR;
     }
 
     bool get_has_index() const {
-        return has_index;       
+        return flags & TYPE_HAS_INDEX;
+    }
+
+    /**
+     * Of a template, the name of each argument as written with its qualifier, resolved
+     * through nested templates, e.g. K and Foo for std::map<K, std::vector<Foo *>>.
+     */
+    const std::vector<srcuml_symbol> & get_template_arguments() const {
+        return srcuml_argument_table::instance().get_arguments(arguments);
     }
 
-    const std::string get_index() const {
-        return index;       
+    const std::string & get_index() const {
+        return srcuml::symbol_name(index);
     }
 
-    std::string get_string_type() const {
-        
-        std::string t = "";
+    const std::string & get_string_type() const {
 
-        if(is_numeric)
-            t += "number";
-        else
-            t += name;
+        static const std::string number = "number";
 
-        return t;
+        if(flags & TYPE_NUMERIC)
+            return number;
+
+        return get_type_name();
     }
 
     friend std::ostream & operator<<(std::ostream & out, const srcuml_type & type) {
 
-        if(type.is_numeric)
-            out << "number";
-        else
-            out << type.name;
-
-        return out;
+        return out << type.get_string_type();
 
     }
 
 private:
+    void set_flag(type_flag flag) {
+        flags |= flag;
+    }
+
     void check_is_numeric() {
+
+        const std::string & name = get_type_name();
         if(    name == "int"
             || name == "double"
             || name == "long"
@@ -194,62 +334,29 @@ private:
             || name == "signed"
             || name == "unsigned"
           )
-            is_numeric = true;
+            set_flag(TYPE_NUMERIC);
 
     }
 
     void check_template_base(const std::string & name) {
+        container = srcuml_container_registry::instance().lookup(name);
+    }
 
-        if(name == "vector")
-            is_vector = true;
-        else if(name == "list")
-            is_list = true;
-        else if(name == "deque")
-            is_deque = true;
-        else if(name == "forward_list")
-            is_forward_list = true;
-        else if(name == "stack")
-            is_stack = true;
-        else if(name == "queue")
-            is_queue = true;
-        else if(name == "priority_queue")
-            is_priority_queue = true;
-        else if(name == "array")
-            is_array = true;
-
-        else if(name == "set")
-            is_set = true;
-        else if(name == "map")
-            is_map = true;
-        else if(name == "unordered_set")
-            is_unordered_set = true;
-        else if(name == "unordered_map")
-            is_unordered_map = true;
-
-        else if(name == "auto_ptr")
-            is_auto_ptr = true;
-        else if(name == "shared_ptr")
-            is_shared_ptr = true;
-        else if(name == "unique_ptr")
-            is_unique_ptr = true;
-        else if(name == "scoped_ptr")
-            is_scoped_ptr = true;
-
-    }
-
-    void resolve_type() {
+    void resolve_type(const TypePolicy::TypeData * data) {
+
+        if(!data) return;
 
         std::vector<std::pair<void *, TypePolicy::TypeType>>::const_reverse_iterator citr;
         for(citr = data->types.rbegin(); citr != data->types.rend(); ++citr) {
 
             if(citr->second == TypePolicy::POINTER)
-                is_pointer = true;
+                set_flag(TYPE_POINTER);
 
             if(citr->second == TypePolicy::REFERENCE)
-                is_reference = true;
+                set_flag(TYPE_REFERENCE);
 
             if(citr->second == TypePolicy::RVALUE)
-                is_rvalue = true;
+                set_flag(TYPE_RVALUE);
 
             if(citr->second != TypePolicy::NAME)
                 continue;
@@ -257,9 +364,15 @@ private:
             /** @todo need to look and see if using only last is valid */
             /** @todo issue in srcML to simplify markup, should make this simpler possibly eliminate if condition */
             const NamePolicy::NameData * type_name = static_cast<const NamePolicy::NameData *>(citr->first);
-            if(type_name->names.size() >= 2)
+            std::string qualifier;
+            if(type_name->names.size() >= 2) {
+
+                for(std::size_t pos = 0; pos + 1 < type_name->names.size(); ++pos)
+                    qualifier += type_name->names[pos]->SimpleName() + "::";
                 type_name = type_name->names.back();
 
+            }
+
             std::string type_str;
 
             /** @todo what if template argument is pointer? */
@@ -270,11 +383,13 @@ private:
                 type_str = resolve_template_type(type_name);
             }
 
-            has_index = !type_name->arrayIndices.empty();
-            if(has_index)
-                index = type_name->arrayIndices[0];
+            if(!type_name->arrayIndices.empty()) {
+                set_flag(TYPE_HAS_INDEX);
+                index = srcuml::intern(type_name->arrayIndices[0]);
+            }
 
-            name = type_str;
+            name = srcuml::intern(type_str);
+            qualified = qualifier.empty() ? name : srcuml::intern(qualifier + type_str);
             break;
 
         }
@@ -288,7 +403,7 @@ private:
 
             if(specifier == "const") {
 
-                is_const = true;
+                set_flag(TYPE_CONST);
                 break;
 
             }
@@ -298,39 +413,115 @@ private:
 
     }
 
-    std::string resolve_template_type(const NamePolicy::NameData * type_name) {
+    /** the name of type_name with the qualifier it was written with */
+    static std::string qualified_name(const NamePolicy::NameData * type_name) {
 
-        if(type_name->templateArguments.empty())
+        if(type_name->names.size() < 2)
             return type_name->SimpleName();
 
-        /** @todo need to look and see if using only last is valid */
-        for(std::vector<std::pair<void *, TemplateArgumentPolicy::TemplateArgumentType>>::const_reverse_iterator citr = type_name->templateArguments.back()->data.rbegin();
-            citr != type_name->templateArguments.back()->data.rend();
+        std::string qualified;
+        for(std::size_t pos = 0; pos + 1 < type_name->names.size(); ++pos)
+            qualified += type_name->names[pos]->SimpleName() + "::";
+
+        return qualified + type_name->names.back()->SimpleName();
+
+    }
+
+    /** the name of a template argument, the flags of what it is written with are set if set_flags */
+    const NamePolicy::NameData * argument_name(const TemplateArgumentPolicy::TemplateArgumentData * argument, bool set_flags) {
+
+        for(std::vector<std::pair<void *, TemplateArgumentPolicy::TemplateArgumentType>>::const_reverse_iterator citr = argument->data.rbegin();
+            citr != argument->data.rend();
             ++citr) {
 
-            if(citr->second == TemplateArgumentPolicy::POINTER)
-                is_pointer = true;
+            if(set_flags) {
 
-            if(citr->second == TemplateArgumentPolicy::OPERATOR && (*static_cast<std::string *>(citr->first)) == "*")
-                is_pointer = true;
+                if(citr->second == TemplateArgumentPolicy::POINTER)
+                    set_flag(TYPE_POINTER);
 
-            if(citr->second == TemplateArgumentPolicy::REFERENCE)
-                is_reference = true;
+                if(citr->second == TemplateArgumentPolicy::OPERATOR && (*static_cast<std::string *>(citr->first)) == "*")
+                    set_flag(TYPE_POINTER);
 
-            if(citr->second == TemplateArgumentPolicy::RVALUE)
-                is_rvalue = true;
+                if(citr->second == TemplateArgumentPolicy::REFERENCE)
+                    set_flag(TYPE_REFERENCE);
 
-            if(citr->second != TemplateArgumentPolicy::NAME)
-                continue;
+                if(citr->second == TemplateArgumentPolicy::RVALUE)
+                    set_flag(TYPE_RVALUE);
+
+            }
 
-            return resolve_template_type(static_cast<NamePolicy::NameData *>(citr->first));
+            if(citr->second == TemplateArgumentPolicy::NAME)
+                return static_cast<const NamePolicy::NameData *>(citr->first);
 
         }
 
-        return std::string();
+        return nullptr;
+
+    }
+
+    /** follows the last template argument of each level down to a name that is not a template, nullptr if there is none */
+    const NamePolicy::NameData * innermost_name(const NamePolicy::NameData * type_name, bool set_flags) {
+
+        /** @todo need to look and see if using only last is valid */
+        while(type_name && !type_name->templateArguments.empty())
+            type_name = argument_name(type_name->templateArguments.back(), set_flags);
+
+        return type_name;
+
+    }
+
+    /**
+     * The innermost name of the last argument, iteratively so nesting costs no stack, with
+     * the flags of that chain.  Every argument of the outer template is recorded as well.
+     */
+    std::string resolve_template_type(const NamePolicy::NameData * type_name) {
+
+        std::vector<srcuml_symbol> argument_symbols;
+        for(std::size_t pos = 0; pos + 1 < type_name->templateArguments.size(); ++pos) {
+
+            const NamePolicy::NameData * argument = innermost_name(argument_name(type_name->templateArguments[pos], false), false);
+            argument_symbols.push_back(argument ? srcuml::intern(qualified_name(argument)) : 0);
+
+        }
+
+        const NamePolicy::NameData * last = innermost_name(type_name, true);
+        argument_symbols.push_back(last ? srcuml::intern(qualified_name(last)) : 0);
+
+        arguments = srcuml_argument_table::instance().intern(argument_symbols);
+
+        return last ? last->SimpleName() : std::string();
+
+    }
+
+};
+
+/**
+ * srcuml_type_cache
+ *
+ * Resolved types keyed by TypeData identity, so a type shared by an operation
+ * and the dependency pass is only resolved once.  Only valid while the
+ * TypeData it was filled from is alive.
+ */
+class srcuml_type_cache {
+
+private:
+
+    std::unordered_map<const TypePolicy::TypeData *, srcuml_type> types;
+
+public:
+
+    srcuml_type_cache() : types() {}
+
+    const srcuml_type & resolve(const TypePolicy::TypeData * data) {
+
+        std::unordered_map<const TypePolicy::TypeData *, srcuml_type>::iterator itr = types.find(data);
+        if(itr == types.end())
+            itr = types.emplace(data, srcuml_type(data)).first;
+
+        return itr->second;
 
     }
 
 };
 
- #endif
+#endif
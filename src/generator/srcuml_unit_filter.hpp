@@ -0,0 +1,157 @@
+/**
+ * @file srcuml_unit_filter.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_UNIT_FILTER_HPP
+#define INCLUDED_SRCUML_UNIT_FILTER_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+/**
+ * srcuml_unit_filter
+ *
+ * Which units, by filename, and which classes, by qualified name, are
+ * extracted.  Units are tested before they are parsed and classes before
+ * they are summarized, so what is filtered out costs little more than
+ * reading it.  Something is kept if no include pattern is given or one
+ * matches, and no exclude pattern matches.
+ *
+ * Path patterns are globs: * and ? match within a directory, ** across
+ * directories.  One that does not start with / may match from any directory
+ * of the filename, e.g. src/net/** matches /home/me/repo/src/net/socket.cpp.
+ * Class patterns are globs over the qualified name, one ending in :: matches
+ * everything in that namespace, e.g. net:: or net::*Socket.
+ */
+struct srcuml_unit_filter {
+
+    std::vector<std::string> include_paths;
+    std::vector<std::string> exclude_paths;
+    std::vector<std::string> include_classes;
+    std::vector<std::string> exclude_classes;
+
+    bool has_path_rules() const {
+        return !include_paths.empty() || !exclude_paths.empty();
+    }
+
+    bool has_class_rules() const {
+        return !include_classes.empty() || !exclude_classes.empty();
+    }
+
+    bool selects_path(const std::string & filename) const {
+        return selects(include_paths, exclude_paths, filename, match_path);
+    }
+
+    bool selects_class(const std::string & qualified_name) const {
+        return selects(include_classes, exclude_classes, qualified_name, match_class);
+    }
+
+    /** glob match of the whole text, * and ? stop at / unless across_directories */
+    static bool match(const char * pattern, const char * text, bool across_directories) {
+
+        for(; *pattern; ++pattern, ++text) {
+
+            if(*pattern == '*') {
+
+                const bool is_double = pattern[1] == '*';
+                pattern += is_double ? 2 : 1;
+                const bool crosses = is_double || across_directories;
+
+                // ** followed by / also matches no directory at all
+                if(is_double && *pattern == '/' && match(pattern + 1, text, across_directories))
+                    return true;
+
+                for(;; ++text) {
+
+                    if(match(pattern, text, across_directories))
+                        return true;
+                    if(!*text || (!crosses && *text == '/'))
+                        return false;
+
+                }
+
+            }
+
+            if(!*text || (*pattern == '?' ? !across_directories && *text == '/' : *pattern != *text))
+                return false;
+
+        }
+
+        return !*text;
+
+    }
+
+private:
+
+    static bool selects(const std::vector<std::string> & includes, const std::vector<std::string> & excludes,
+                        const std::string & text, bool (*matcher)(const std::string &, const std::string &)) {
+
+        for(const std::string & pattern : excludes)
+            if(matcher(pattern, text))
+                return false;
+
+        if(includes.empty())
+            return true;
+
+        for(const std::string & pattern : includes)
+            if(matcher(pattern, text))
+                return true;
+
+        return false;
+
+    }
+
+    static bool match_path(const std::string & pattern, const std::string & filename) {
+
+        const char * path = filename.c_str();
+        if(std::strncmp(path, "./", 2) == 0)
+            path += 2;
+
+        if(!pattern.empty() && pattern.front() == '/')
+            return match(pattern.c_str(), path, false);
+
+        for(const char * start = path; start; ) {
+
+            if(match(pattern.c_str(), start, false))
+                return true;
+
+            start = std::strchr(start, '/');
+            if(start)
+                ++start;
+
+        }
+
+        return false;
+
+    }
+
+    static bool match_class(const std::string & pattern, const std::string & qualified_name) {
+
+        if(pattern.size() >= 2 && pattern.compare(pattern.size() - 2, 2, "::") == 0)
+            return match((pattern + "*").c_str(), qualified_name.c_str(), true);
+
+        return match(pattern.c_str(), qualified_name.c_str(), true);
+
+    }
+
+};
+
+#endif
@@ -22,6 +22,8 @@
 #include <srcuml_utilities.hpp>
 
 #include <algorithm>
+#include <utility>
+#include <cstdio>
 
 namespace srcuml {
 
@@ -35,4 +37,243 @@ std::string & trim(std::string & str) {
 
 }
 
+std::vector<std::string> split(const std::string & str, char delimiter) {
+
+    std::vector<std::string> pieces;
+
+    std::string::size_type start = 0;
+    while(true) {
+
+        std::string::size_type end = str.find(delimiter, start);
+        std::string piece = str.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        pieces.push_back(trim(piece));
+
+        if(end == std::string::npos)
+            break;
+
+        start = end + 1;
+
+    }
+
+    return pieces;
+
+}
+
+const char * const unit_chunk_footer = "\n\n</unit>\n";
+
+static std::size_t find(const char * archive, std::size_t size, const std::string & str, std::size_t pos) {
+
+    if(pos >= size) return std::string::npos;
+
+    const char * found = std::search(archive + pos, archive + size, str.begin(), str.end());
+    return found == archive + size ? std::string::npos : found - archive;
+
+}
+
+static std::size_t find_unit_start(const char * archive, std::size_t size, std::size_t pos) {
+
+    static const std::string unit_start = "<unit";
+    while((pos = find(archive, size, unit_start, pos)) != std::string::npos) {
+
+        char next = pos + 5 < size ? archive[pos + 5] : '\0';
+        if(next == '>' || next == '/' || isspace(next))
+            return pos;
+
+        pos += 5;
+
+    }
+
+    return std::string::npos;
+
+}
+
+std::size_t find_unit_ranges(const char * archive, std::size_t size,
+                             std::vector<std::pair<std::size_t, std::size_t>> & units) {
+
+    units.clear();
+
+    std::size_t root_start = find_unit_start(archive, size, 0);
+    if(root_start == std::string::npos)
+        return 0;
+
+    std::size_t root_end = find(archive, size, ">", root_start);
+    if(root_end == std::string::npos)
+        return 0;
+    ++root_end;
+
+    // nested units of an archive never nest further
+    static const std::string unit_end = "</unit>";
+    std::size_t pos = root_end;
+    while((pos = find_unit_start(archive, size, pos)) != std::string::npos) {
+
+        // an empty unit, <unit .../>, ends with its start tag
+        std::size_t end = find(archive, size, ">", pos);
+        if(end == std::string::npos)
+            break;
+
+        if(archive[end - 1] == '/') {
+            ++end;
+        } else {
+
+            end = find(archive, size, unit_end, end);
+            if(end == std::string::npos)
+                break;
+            end += unit_end.size();
+
+        }
+
+        units.emplace_back(pos, end);
+        pos = end;
+
+    }
+
+    return root_end;
+
+}
+
+std::string unit_attribute(const char * unit, std::size_t size, const std::string & name) {
+
+    std::size_t start = find_unit_start(unit, size, 0);
+    if(start == std::string::npos)
+        return "";
+
+    std::size_t end = find(unit, size, ">", start);
+    if(end == std::string::npos)
+        return "";
+
+    // the attribute must follow whitespace, so filename does not match in a longer name
+    const std::string attribute = name + "=\"";
+    for(std::size_t pos = find(unit, end, attribute, start); pos != std::string::npos; pos = find(unit, end, attribute, pos + 1)) {
+
+        if(!isspace(unit[pos - 1]))
+            continue;
+
+        std::size_t value = pos + attribute.size();
+        std::size_t value_end = find(unit, end, "\"", value);
+        if(value_end == std::string::npos)
+            return "";
+
+        return std::string(unit + value, value_end - value);
+
+    }
+
+    return "";
+
+}
+
+std::size_t split_unit_ranges(const char * archive, std::size_t size, std::size_t number_chunks,
+                              std::vector<std::pair<std::size_t, std::size_t>> & chunks) {
+
+    chunks.clear();
+    if(number_chunks < 2)
+        return 0;
+
+    std::vector<std::pair<std::size_t, std::size_t>> units;
+    std::size_t root_end = find_unit_ranges(archive, size, units);
+
+    if(units.size() < 2)
+        return 0;
+
+    if(number_chunks > units.size())
+        number_chunks = units.size();
+
+    const std::size_t total_size = units.back().second - units.front().first;
+    const std::size_t chunk_size = total_size / number_chunks + 1;
+
+    std::size_t unit_pos = 0;
+    while(unit_pos < units.size()) {
+
+        std::size_t chunk_begin = units[unit_pos].first;
+        std::size_t chunk_end = units[unit_pos].second;
+        ++unit_pos;
+
+        // leave at least one unit for each remaining chunk
+        while(unit_pos < units.size()
+            && chunk_end - chunk_begin < chunk_size
+            && units.size() - unit_pos > number_chunks - chunks.size() - 1) {
+            chunk_end = units[unit_pos].second;
+            ++unit_pos;
+        }
+
+        chunks.emplace_back(chunk_begin, chunk_end);
+
+    }
+
+    return root_end;
+
+}
+
+std::uint64_t hash(const char * data, std::size_t size, std::uint64_t seed) {
+
+    // FNV-1a
+    std::uint64_t value = seed;
+    for(std::size_t pos = 0; pos < size; ++pos) {
+        value ^= static_cast<unsigned char>(data[pos]);
+        value *= 1099511628211ULL;
+    }
+
+    return value;
+
+}
+
+std::string json_escape(const std::string & text) {
+
+    std::string escaped;
+    for(char character : text) {
+
+        if(character == '"' || character == '\\') {
+            escaped += '\\';
+            escaped += character;
+        } else if(static_cast<unsigned char>(character) < 32) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", character);
+            escaped += code;
+        } else {
+            escaped += character;
+        }
+
+    }
+
+    return escaped;
+
+}
+
+std::string json_number(double value) {
+
+    char digits[32];
+    std::snprintf(digits, sizeof(digits), "%.2f", value);
+
+    std::string text = digits;
+    if(text.find('.') != std::string::npos) {
+        text.erase(text.find_last_not_of('0') + 1);
+        if(text.back() == '.')
+            text.pop_back();
+    }
+
+    return text;
+
+}
+
+std::vector<std::string> split_units(const std::string & archive, std::size_t number_chunks) {
+
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    std::size_t header_size = split_unit_ranges(archive.data(), archive.size(), number_chunks, ranges);
+    if(header_size == 0)
+        return { archive };
+
+    std::vector<std::string> chunks;
+    for(const std::pair<std::size_t, std::size_t> & range : ranges) {
+
+        std::string chunk = archive.substr(0, header_size);
+        chunk += "\n\n";
+        chunk.append(archive, range.first, range.second - range.first);
+        chunk += unit_chunk_footer;
+        chunks.push_back(std::move(chunk));
+
+    }
+
+    return chunks;
+
+}
+
 }
@@ -22,12 +22,120 @@
 #ifndef INCLUDED_SRCUML_UTILITIES_HPP
 #define INCLUDED_SRCUML_UTILITIES_HPP
 
+#include <srcuml_allocation.hpp>
+
 #include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <exception>
 
 namespace srcuml {
 
 std::string & trim(std::string & str);
 
+/** splits at each delimiter and trims the pieces, e.g. a comma separated option */
+std::vector<std::string> split(const std::string & str, char delimiter);
+
+/**
+ * Finds the byte range of every nested unit of a srcML archive, in document order.
+ * Returns the size of the archive header, or 0 if there is no root unit.
+ * A document that is a single unit has a header but no nested units.
+ */
+std::size_t find_unit_ranges(const char * archive, std::size_t size,
+                             std::vector<std::pair<std::size_t, std::size_t>> & units);
+
+/**
+ * Finds the byte ranges of at most number_chunks runs of contiguous units in a
+ * srcML archive, in document order.  Returns the size of the archive header
+ * (everything up to and including the root start tag), or 0 if the document
+ * has fewer than two units and cannot be split.
+ *
+ * A chunk is parsed as header + "\n\n" + range + unit_chunk_footer.
+ */
+std::size_t split_unit_ranges(const char * archive, std::size_t size, std::size_t number_chunks,
+                              std::vector<std::pair<std::size_t, std::size_t>> & chunks);
+
+extern const char * const unit_chunk_footer;
+
+/** value of the attribute name of the first unit start tag in [unit, unit + size), empty if it has none */
+std::string unit_attribute(const char * unit, std::size_t size, const std::string & name);
+
+/**
+ * Splits a srcML archive at its <unit> boundaries into at most number_chunks
+ * well-formed archives of contiguous units, in document order.
+ * A document with fewer than two units is returned unchanged.
+ */
+std::vector<std::string> split_units(const std::string & archive, std::size_t number_chunks);
+
+/**
+ * Calls apply(first, last) on at most number_threads contiguous ranges of
+ * [0, count) at once, the calling thread taking the first range.  The first
+ * exception thrown by a range is rethrown once every range has finished.
+ * Allocations of every range count for the phase of the calling thread.
+ */
+template<typename function>
+void parallel_ranges(std::size_t count, std::size_t number_threads, function apply) {
+
+    if(number_threads > count)
+        number_threads = count;
+
+    if(number_threads < 2) {
+        if(count) apply(std::size_t(0), count);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(number_threads);
+    const std::size_t range_size = (count + number_threads - 1) / number_threads;
+
+    const int phase = srcuml_allocation::get_phase();
+
+    std::vector<std::thread> workers;
+    for(std::size_t thread_pos = 1; thread_pos < number_threads; ++thread_pos) {
+
+        workers.emplace_back([&, thread_pos]() {
+
+            srcuml_allocation::phase_scope scope(phase);
+
+            try {
+                std::size_t first = thread_pos * range_size;
+                if(first < count)
+                    apply(first, std::min(count, first + range_size));
+            } catch(...) {
+                errors[thread_pos] = std::current_exception();
+            }
+
+        });
+
+    }
+
+    try {
+        apply(std::size_t(0), range_size);
+    } catch(...) {
+        errors[0] = std::current_exception();
+    }
+
+    for(std::thread & worker : workers)
+        worker.join();
+
+    for(const std::exception_ptr & error : errors)
+        if(error)
+            std::rethrow_exception(error);
+
+}
+
+/** text as the content of a JSON string: quotes and backslashes escaped, control characters as unicode escapes */
+std::string json_escape(const std::string & text);
+
+/** a JSON number of two decimals, trailing zeros dropped */
+std::string json_number(double value);
+
+/** 64-bit content hash, stable across runs and machines */
+std::uint64_t hash(const char * data, std::size_t size, std::uint64_t seed = 14695981039346656037ULL);
+
 }
 
 #endif
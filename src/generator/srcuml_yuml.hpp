@@ -0,0 +1,436 @@
+/**
+ * @file srcuml_yuml.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SRCUML_YUML_HPP
+#define INCLUDED_SRCUML_YUML_HPP
+
+#include <srcuml_relationship.hpp>
+#include <srcuml_model.hpp>
+#include <dot_outputter.hpp>
+#include <static_outputter.hpp>
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <fstream>
+#include <cstring>
+
+/**
+ * srcuml_yuml_listener
+ *
+ * Told of each class box and relationship of a yUML diagram as it is read.
+ */
+class srcuml_yuml_listener {
+
+public:
+
+    virtual ~srcuml_yuml_listener() {}
+
+    /**
+     * A box, [name|attributes|operations].  Called for the boxes of relationships
+     * too, which usually have only the name.  compartments counts the name.
+     */
+    virtual void on_class(const std::string & name, const std::vector<std::string> & attributes,
+                          const std::vector<std::string> & operations, std::size_t compartments) = 0;
+
+    virtual void on_relationship(const std::string & source, relationship_type type,
+                                 const std::string & label, const std::string & destination) = 0;
+
+};
+
+/**
+ * srcuml_yuml_reader
+ *
+ * Single pass reader of the yUML class diagrams yuml_outputter writes:
+ *
+ *   [name|attribute;attribute;|operation;operation;]
+ *   [source]connector[destination]
+ *
+ * where the connector is -.-> (dependency), -label> (association), <-label>
+ * (bidirectional), <>-label> (aggregation), ++-label> (composition), ^-
+ * (generalization) or ^-.- (realization).  Expressions may also be separated
+ * by commas, and lines starting with // are comments.
+ */
+class srcuml_yuml_reader {
+
+private:
+
+    srcuml_yuml_listener & listener;
+    std::size_t line_number;
+
+public:
+
+    srcuml_yuml_reader(srcuml_yuml_listener & listener) : listener(listener), line_number(0) {}
+
+    void read(std::istream & in) {
+
+        std::string line;
+        while(std::getline(in, line))
+            read_line(line);
+
+    }
+
+    void read_line(const std::string & line) {
+
+        ++line_number;
+
+        std::size_t pos = skip_space(line, 0);
+        if(line.compare(pos, 2, "//") == 0)
+            return;
+
+        while(pos < line.size()) {
+
+            const std::string source = read_box(line, pos);
+            pos = skip_space(line, pos);
+
+            if(pos == line.size() || line[pos] == ',') {
+
+                pos = skip_space(line, pos + (pos < line.size()));
+                continue;
+
+            }
+
+            std::size_t destination_start = line.find('[', pos);
+            if(destination_start == std::string::npos)
+                throw error("a relationship without a destination");
+
+            std::string label;
+            relationship_type type = parse_connector(line.substr(pos, destination_start - pos), label);
+
+            pos = destination_start;
+            const std::string destination = read_box(line, pos);
+            listener.on_relationship(source, type, label, destination);
+
+            pos = skip_space(line, pos);
+            if(pos < line.size() && line[pos] == ',')
+                pos = skip_space(line, pos + 1);
+
+        }
+
+    }
+
+private:
+
+    std::string error(const char * what) const {
+
+        return std::string("Error: yUML line ") + std::to_string(line_number) + " has " + what;
+
+    }
+
+    static std::size_t skip_space(const std::string & line, std::size_t pos) {
+
+        while(pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+            ++pos;
+
+        return pos;
+
+    }
+
+    /** the box at pos, reported to the listener, its name is returned and pos moved past it */
+    std::string read_box(const std::string & line, std::size_t & pos) {
+
+        if(pos >= line.size() || line[pos] != '[')
+            throw error("no [ where a class is expected");
+
+        const std::size_t end = line.find(']', pos);
+        if(end == std::string::npos)
+            throw error("a class without a closing ]");
+
+        std::vector<std::string> compartments;
+        std::size_t start = pos + 1;
+        while(true) {
+
+            const std::size_t bar = line.find('|', start);
+            if(bar == std::string::npos || bar > end) {
+                compartments.push_back(line.substr(start, end - start));
+                break;
+            }
+
+            compartments.push_back(line.substr(start, bar - start));
+            start = bar + 1;
+
+        }
+
+        pos = end + 1;
+
+        std::vector<std::string> attributes, operations;
+        if(compartments.size() > 1)
+            attributes = split_members(compartments[1]);
+        if(compartments.size() > 2)
+            operations = split_members(compartments[2]);
+
+        listener.on_class(compartments.front(), attributes, operations, compartments.size());
+
+        return compartments.front();
+
+    }
+
+    static std::vector<std::string> split_members(const std::string & compartment) {
+
+        std::vector<std::string> members;
+        std::size_t start = 0;
+        while(start < compartment.size()) {
+
+            std::size_t end = compartment.find(';', start);
+            if(end == std::string::npos)
+                end = compartment.size();
+
+            if(end > start)
+                members.push_back(compartment.substr(start, end - start));
+
+            start = end + 1;
+
+        }
+
+        return members;
+
+    }
+
+    /** the type of connector, label is what is left once its ends are taken off */
+    relationship_type parse_connector(std::string connector, std::string & label) const {
+
+        bool is_bidirectional = false;
+        if(connector.compare(0, 2, "<>") != 0 && connector.compare(0, 1, "<") == 0) {
+            is_bidirectional = true;
+            connector.erase(0, 1);
+        }
+
+        static const std::pair<const char *, relationship_type> starts[] = {
+            { "<>-", AGGREGATION }, { "++-", COMPOSITION }, { "^-.-", REALIZATION }, { "^-", GENERALIZATION },
+            { "-.-", DEPENDENCY }, { "-", ASSOCIATION }
+        };
+
+        for(const std::pair<const char *, relationship_type> & start : starts) {
+
+            const std::size_t length = std::strlen(start.first);
+            if(connector.compare(0, length, start.first) != 0)
+                continue;
+
+            label = connector.substr(length);
+            if(!label.empty() && label.back() == '>')
+                label.pop_back();
+
+            if(is_bidirectional && start.second == ASSOCIATION)
+                return BIDIRECTIONAL;
+
+            return start.second;
+
+        }
+
+        throw error("an unknown connector");
+
+    }
+
+};
+
+/**
+ * srcuml_yuml_dot_writer
+ *
+ * Writes a yUML diagram as the DOT dot_outputter would have written it for the
+ * same classes, while it is read.  A class is written when first seen and again
+ * when a later box of it has members.
+ */
+class srcuml_yuml_dot_writer : public srcuml_yuml_listener {
+
+private:
+
+    std::ostream & out;
+    std::unordered_map<std::string, std::string> class_nodes;
+
+public:
+
+    srcuml_yuml_dot_writer(std::ostream & out) : out(out), class_nodes() {
+
+        out << "digraph hierarchy {\n";
+        out << "node[shape=record,style=filled,fillcolor=gray95]\n";
+        out << "edge[dir=\"both\", arrowtail=\"empty\", arrowhead=\"empty\", labeldistance=\"2.0\"]\n";
+
+    }
+
+    /** converts yUML read from in to DOT written to out */
+    static void convert(std::istream & in, std::ostream & out) {
+
+        srcuml_yuml_dot_writer writer(out);
+        srcuml_yuml_reader(writer).read(in);
+        writer.finish();
+
+    }
+
+    void finish() {
+
+        out << '}' << '\n';
+
+    }
+
+    virtual void on_class(const std::string & name, const std::vector<std::string> & attributes,
+                          const std::vector<std::string> & operations, std::size_t compartments) override {
+
+        const std::size_t number = class_nodes.size();
+        std::pair<std::unordered_map<std::string, std::string>::iterator, bool> node
+            = class_nodes.emplace(name, std::string());
+        if(node.second)
+            node.first->second = "class" + std::to_string(number);
+        else if(compartments == 1)
+            return;
+
+        out << node.first->second << "[label = \"{ " << name;
+        if(compartments > 1)
+            out << '|';
+
+        for(const std::string & attribute : attributes)
+            out << attribute << "\\n";
+
+        if(compartments > 2)
+            out << '|';
+
+        for(const std::string & operation : operations)
+            out << operation << "\\n";
+
+        out << "}\"]\n";
+
+    }
+
+    virtual void on_relationship(const std::string & source, relationship_type type,
+                                 const std::string &, const std::string & destination) override {
+
+        out << class_nodes[source] << "->" << class_nodes[destination] << dot_outputter::edge_attributes(type) << '\n';
+
+    }
+
+};
+
+/**
+ * srcuml_yuml_model_builder
+ *
+ * Builds a srcuml_model from a yUML diagram so it can be laid out by any
+ * outputter without srcML.  The relationships are kept as read, so they are
+ * not analyzed again.
+ */
+class srcuml_yuml_model_builder : public srcuml_yuml_listener {
+
+private:
+
+    std::vector<std::shared_ptr<srcuml_class>> classes;
+    std::unordered_map<std::string, std::size_t> class_positions;
+    std::vector<srcuml_relationship> relationships;
+
+    /** name without the kind prefix get_srcuml_name adds */
+    static std::string strip_prefix(const std::string & name, const char * prefix, bool & has_prefix) {
+
+        has_prefix = name.compare(0, std::strlen(prefix), prefix) == 0;
+        return has_prefix ? name.substr(std::strlen(prefix)) : name;
+
+    }
+
+    static std::string plain_name(const std::string & name, bool & is_interface, bool & is_abstract, bool & is_datatype) {
+
+        std::string plain = strip_prefix(name, "«interface»", is_interface);
+        if(!is_interface)
+            plain = strip_prefix(plain, "｛abstract｝", is_abstract);
+        else
+            is_abstract = false;
+        if(!is_interface && !is_abstract)
+            plain = strip_prefix(plain, "«datatype»", is_datatype);
+        else
+            is_datatype = false;
+
+        return plain;
+
+    }
+
+    /** static members are underlined with combining low lines, see yuml_outputter */
+    static std::vector<srcuml_member_label> member_labels(const std::vector<std::string> & members) {
+
+        std::vector<srcuml_member_label> labels;
+        for(const std::string & member : members){
+
+            srcuml_member_label label{ member, false };
+            label.is_static = static_outputter::remove_underline(label.text);
+            labels.push_back(label);
+
+        }
+
+        return labels;
+
+    }
+
+public:
+
+    srcuml_yuml_model_builder() : classes(), class_positions(), relationships() {}
+
+    /** reads the yUML diagram in filename */
+    static srcuml_model load(const std::string & filename) {
+
+        std::ifstream in(filename);
+        if(!in)
+            throw std::string("Error: Unable to open ") + filename;
+
+        srcuml_yuml_model_builder builder;
+        srcuml_yuml_reader(builder).read(in);
+
+        return builder.get_model();
+
+    }
+
+    srcuml_model get_model() const {
+
+        return srcuml_model(classes, relationships);
+
+    }
+
+    virtual void on_class(const std::string & name, const std::vector<std::string> & attributes,
+                          const std::vector<std::string> & operations, std::size_t compartments) override {
+
+        std::unordered_map<std::string, std::size_t>::iterator position = class_positions.find(name);
+        if(position != class_positions.end() && compartments == 1)
+            return;
+
+        bool is_interface, is_abstract, is_datatype;
+        const std::string plain = plain_name(name, is_interface, is_abstract, is_datatype);
+        std::shared_ptr<srcuml_class> aclass = std::make_shared<srcuml_class>(plain, is_interface, is_abstract, is_datatype,
+                                                                              member_labels(attributes), member_labels(operations),
+                                                                              compartments > 1, compartments > 2);
+
+        if(position != class_positions.end()){
+            classes[position->second] = aclass;
+            return;
+        }
+
+        class_positions.emplace(name, classes.size());
+        classes.push_back(aclass);
+
+    }
+
+    virtual void on_relationship(const std::string & source, relationship_type type,
+                                 const std::string & label, const std::string & destination) override {
+
+        relationships.emplace_back(classes[class_positions.at(source)]->get_name_symbol(),
+                                   classes[class_positions.at(destination)]->get_name_symbol(),
+                                   type, label.empty() ? 0 : srcuml::intern(label));
+
+    }
+
+};
+
+#endif
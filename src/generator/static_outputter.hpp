@@ -22,15 +22,35 @@
 #ifndef INCLUDED_STATIC_OUTPUTTER_HPP
 #define INCLUDED_STATIC_OUTPUTTER_HPP
 
+#include <srcuml_text_sink.hpp>
+
 #include <string>
 #include <ostream>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
 
-#define COMBINING_LOW_LINE "\u0332"
+/**
+ * static_outputter
+ *
+ * Underlines the text of static members by following each code point with a
+ * combining low line.  The text is underlined into a buffer the caller
+ * provides, nothing is allocated for it.
+ */
 class static_outputter {
 
 public:
 
+    // UTF-8 of the combining low line U+0332
+    static constexpr char LOW_LINE_FIRST = '\xcc';
+    static constexpr char LOW_LINE_SECOND = '\xb2';
+
+    enum : std::size_t { LOW_LINE_SIZE = 2 };
+
+    // text underlined on the stack when written to a stream
+    enum : std::size_t { STACK_SIZE = 1024 };
+
     static std::size_t num_utf_bytes(const unsigned char & character) {
 
         if(character > 0xC0 && character <= 0xdf) return 2;
@@ -40,51 +60,112 @@ public:
         return 1;
     }
 
-    template <typename T>
-    static std::ostream & output(std::ostream & out, const T & t) {
+    /** the most characters text of size characters takes once underlined */
+    static std::size_t underlined_size(std::size_t size) {
+        return size * (1 + LOW_LINE_SIZE);
+    }
 
-        std::ostringstream str_out;
-        str_out << t;
+    /**
+     * Writes text underlined to buffer, which holds underlined_size(size) characters,
+     * and returns the number of characters written.  Runs of ASCII are found eight
+     * bytes at a time and underlined without decoding each character.
+     */
+    static std::size_t underline(const char * text, std::size_t size, char * buffer) {
+
+        char * out = buffer;
+
+        std::size_t pos = 0;
+        while(pos < size) {
+
+            // eight ASCII characters, none with the high bit set
+            if(pos + 8 <= size) {
+
+                std::uint64_t word;
+                std::memcpy(&word, text + pos, sizeof(word));
+                if((word & 0x8080808080808080ull) == 0) {
 
-        const std::string & str = str_out.str();
-        std::size_t size = str.size();
-        for(std::size_t pos = 0; pos < size;) {
+                    for(std::size_t byte = 0; byte < 8; ++byte) {
+                        out[0] = text[pos + byte];
+                        out[1] = LOW_LINE_FIRST;
+                        out[2] = LOW_LINE_SECOND;
+                        out += 3;
+                    }
 
-            std::size_t num_bytes = num_utf_bytes(str[pos]);
+                    pos += 8;
+                    continue;
 
+                }
+
+            }
+
+            std::size_t num_bytes = std::min(num_utf_bytes(text[pos]), size - pos);
             while(num_bytes--)
-               out << str[pos++];
+                *out++ = text[pos++];
 
-            out << COMBINING_LOW_LINE;
+            *out++ = LOW_LINE_FIRST;
+            *out++ = LOW_LINE_SECOND;
 
         }
 
-        return out;
+        return out - buffer;
 
     }
 
-};
+    /** removes the underline from text, returns whether it had any */
+    static bool remove_underline(std::string & text) {
+
+        std::size_t out = 0;
+        for(std::size_t pos = 0; pos < text.size(); ++pos) {
+
+            if(text[pos] == LOW_LINE_FIRST && pos + 1 < text.size() && text[pos + 1] == LOW_LINE_SECOND) {
+                ++pos;
+                continue;
+            }
 
+            text[out++] = text[pos];
 
-template <>
-std::ostream & static_outputter::output<std::string>(std::ostream & out, const std::string & t) {
+        }
 
-    const std::string & str = t;
-    std::size_t size = str.size();
-    for(std::size_t pos = 0; pos < size;) {
+        const bool underlined = out != text.size();
+        text.resize(out);
 
-        std::size_t num_bytes = static_outputter::num_utf_bytes(str[pos]);
+        return underlined;
 
-        while(num_bytes--)
-           out << str[pos++];
+    }
 
-        out << COMBINING_LOW_LINE;
+    template <typename T>
+    static std::ostream & output(std::ostream & out, const T & t) {
+
+        std::ostringstream str_out;
+        str_out << t;
+
+        return output(out, str_out.str());
 
     }
 
-    return out;
+    static std::ostream & output(std::ostream & out, const std::string & str) {
 
-}
-#undef COMBINING_LOW_LINE
-#endif
+        char stack[STACK_SIZE * (1 + LOW_LINE_SIZE)];
+        if(str.size() <= STACK_SIZE) {
+            out.write(stack, underline(str.data(), str.size(), stack));
+            return out;
+        }
+
+        std::string underlined(underlined_size(str.size()), '\0');
+        underlined.resize(underline(str.data(), str.size(), &underlined[0]));
 
+        return out << underlined;
+
+    }
+
+    /** str underlined straight into the buffer of the sink */
+    static void output(srcuml_text_sink & out, const std::string & str) {
+
+        char * buffer = out.extend(underlined_size(str.size()));
+        out.shrink(underlined_size(str.size()) - underline(str.data(), str.size(), buffer));
+
+    }
+
+};
+
+#endif
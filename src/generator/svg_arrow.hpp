@@ -0,0 +1,36 @@
+/**
+ * @file svg_arrow.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_ARROW_HPP
+#define INCLUDED_SVG_ARROW_HPP
+
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/EdgeArray.h>
+
+#include <utility>
+
+/** arrow head drawn at an end of an edge */
+enum EndType { NoEnd, FilledTriangle, HollowTriangle, FilledDiamond, HollowDiamond };
+
+/** arrow heads of each edge, source end then target end */
+typedef ogdf::EdgeArray<std::pair<EndType, EndType>> svg_arrows;
+
+#endif
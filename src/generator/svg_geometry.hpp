@@ -0,0 +1,634 @@
+/**
+ * @file svg_geometry.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_GEOMETRY_HPP
+#define INCLUDED_SVG_GEOMETRY_HPP
+
+#include <svg_arrow.hpp>
+
+#include <ogdf/basic/GraphAttributes.h>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * svg_node_grid
+ *
+ * Uniform grid over the rectangles of the laid out nodes, so a segment is only
+ * tested against the nodes of the cells it passes over instead of every node.
+ * The cells are about the size of an average node and hold the positions of the
+ * nodes overlapping them in one array, each cell's run starting at first_in_cell.
+ */
+class svg_node_grid {
+
+private:
+
+	// rectangles of the nodes by position, grown by the margin
+	std::vector<ogdf::node> nodes;
+	std::vector<double> left, top, right, bottom;
+
+	double origin_x, origin_y, cell_size;
+	std::size_t columns, rows;
+
+	// positions of the nodes overlapping each cell, one past the last cell
+	std::vector<std::size_t> first_in_cell;
+	std::vector<std::size_t> cell_nodes;
+
+	std::size_t column_of(double x) const {
+		const double column = std::floor((x - origin_x) / cell_size);
+		return column <= 0 ? 0 : std::min(columns - 1, static_cast<std::size_t>(column));
+	}
+
+	std::size_t row_of(double y) const {
+		const double row = std::floor((y - origin_y) / cell_size);
+		return row <= 0 ? 0 : std::min(rows - 1, static_cast<std::size_t>(row));
+	}
+
+	/** whether the segment from (x1, y1) to (x2, y2) meets the rectangle of the node at pos */
+	bool crosses(std::size_t pos, double x1, double y1, double x2, double y2) const {
+
+		double enter = 0, leave = 1;
+		const double deltas[] = { x2 - x1, y2 - y1 };
+		const double starts[] = { x1, y1 };
+		const double lows[] = { left[pos], top[pos] };
+		const double highs[] = { right[pos], bottom[pos] };
+
+		for(std::size_t axis = 0; axis < 2; ++axis) {
+
+			if(deltas[axis] == 0) {
+				if(starts[axis] < lows[axis] || starts[axis] > highs[axis])
+					return false;
+				continue;
+			}
+
+			double low = (lows[axis] - starts[axis]) / deltas[axis];
+			double high = (highs[axis] - starts[axis]) / deltas[axis];
+			if(low > high)
+				std::swap(low, high);
+
+			enter = std::max(enter, low);
+			leave = std::min(leave, high);
+			if(enter > leave)
+				return false;
+
+		}
+
+		return true;
+
+	}
+
+public:
+
+	svg_node_grid() : origin_x(0), origin_y(0), cell_size(1), columns(0), rows(0) {}
+
+	/** indexes the nodes of the attributes, replacing those indexed before */
+	void build(const ogdf::GraphAttributes & attributes, double margin) {
+
+		nodes.clear();
+		left.clear();
+		top.clear();
+		right.clear();
+		bottom.clear();
+
+		double area = 0;
+		for(ogdf::node v : attributes.constGraph().nodes) {
+
+			nodes.push_back(v);
+			left.push_back(attributes.x(v) - attributes.width(v) / 2 - margin);
+			right.push_back(attributes.x(v) + attributes.width(v) / 2 + margin);
+			top.push_back(attributes.y(v) - attributes.height(v) / 2 - margin);
+			bottom.push_back(attributes.y(v) + attributes.height(v) / 2 + margin);
+			area += (right.back() - left.back()) * (bottom.back() - top.back());
+
+		}
+
+		first_in_cell.assign(1, 0);
+		cell_nodes.clear();
+		columns = rows = 0;
+		if(nodes.empty())
+			return;
+
+		origin_x = *std::min_element(left.begin(), left.end());
+		origin_y = *std::min_element(top.begin(), top.end());
+		const double width = *std::max_element(right.begin(), right.end()) - origin_x;
+		const double height = *std::max_element(bottom.begin(), bottom.end()) - origin_y;
+
+		// no more cells than nodes, however far apart they are
+		cell_size = std::max({ std::sqrt(area / nodes.size()), std::sqrt(width * height / nodes.size()), 1.0 });
+		columns = static_cast<std::size_t>(width / cell_size) + 1;
+		rows = static_cast<std::size_t>(height / cell_size) + 1;
+
+		// counted, then filled
+		first_in_cell.assign(columns * rows + 1, 0);
+		for(std::size_t pos = 0; pos < nodes.size(); ++pos)
+			for(std::size_t row = row_of(top[pos]); row <= row_of(bottom[pos]); ++row)
+				for(std::size_t column = column_of(left[pos]); column <= column_of(right[pos]); ++column)
+					++first_in_cell[row * columns + column + 1];
+
+		for(std::size_t cell = 1; cell < first_in_cell.size(); ++cell)
+			first_in_cell[cell] += first_in_cell[cell - 1];
+
+		cell_nodes.resize(first_in_cell.back());
+		std::vector<std::size_t> next(first_in_cell.begin(), first_in_cell.end() - 1);
+		for(std::size_t pos = 0; pos < nodes.size(); ++pos)
+			for(std::size_t row = row_of(top[pos]); row <= row_of(bottom[pos]); ++row)
+				for(std::size_t column = column_of(left[pos]); column <= column_of(right[pos]); ++column)
+					cell_nodes[next[row * columns + column]++] = pos;
+
+	}
+
+	/** whether the segment passes over the rectangle of a node other than source and target */
+	bool crosses_other(const ogdf::DPoint & p1, const ogdf::DPoint & p2, ogdf::node source, ogdf::node target) const {
+
+		if(nodes.empty())
+			return false;
+
+		const std::size_t first_row = row_of(std::min(p1.m_y, p2.m_y)), last_row = row_of(std::max(p1.m_y, p2.m_y));
+		const std::size_t first_column = column_of(std::min(p1.m_x, p2.m_x)), last_column = column_of(std::max(p1.m_x, p2.m_x));
+
+		for(std::size_t row = first_row; row <= last_row; ++row)
+			for(std::size_t column = first_column; column <= last_column; ++column) {
+
+				const std::size_t cell = row * columns + column;
+				for(std::size_t index = first_in_cell[cell]; index < first_in_cell[cell + 1]; ++index) {
+
+					const std::size_t pos = cell_nodes[index];
+					if(nodes[pos] != source && nodes[pos] != target && crosses(pos, p1.m_x, p1.m_y, p2.m_x, p2.m_y))
+						return true;
+
+				}
+
+			}
+
+		return false;
+
+	}
+
+};
+
+/**
+ * svg_edge_paths
+ *
+ * The drawn paths of a set of edges: from where an edge leaves its source to
+ * where it enters its target, shortened by the arrow heads drawn at its ends.
+ * All edges are clipped in one pass before any is drawn.  Their points and the
+ * node rectangles they are tested against are kept as separate arrays of
+ * coordinates, so the containment tests run as one branch free loop the
+ * compiler can vectorize.  The arrays are reused by later passes, nothing is
+ * allocated once they have grown to the largest set of edges.  Paths may also
+ * be tested for passing over nodes other than their own, through a grid of the
+ * nodes built once per pass.
+ */
+class svg_edge_paths {
+
+private:
+
+	const ogdf::GraphAttributes & attributes;
+	const svg_arrows & arrows;
+
+	// how far around a node a point still counts as inside it
+	double margin;
+
+	// how far the marker of an end type extends from the end of the path
+	double (*marker_length)(EndType);
+
+	// layout points of all edges, ends and bends, structure of arrays
+	std::vector<double> xs, ys;
+
+	// rectangles of the source and target node of each point, grown by margin
+	std::vector<double> source_left, source_top, source_right, source_bottom;
+	std::vector<double> target_left, target_top, target_right, target_bottom;
+
+	// whether each point lies in the rectangle of its source and target node
+	std::vector<std::uint8_t> in_source, in_target;
+
+	// of each clipped edge, the first of its layout points, one past the last edge
+	std::vector<std::size_t> first_point;
+
+	// drawn points of all edges and of each edge the first of them, one past the last edge
+	std::vector<ogdf::DPoint> path_points;
+	std::vector<std::size_t> first_path_point;
+
+	// arrow heads at the ends of each path
+	std::vector<EndType> source_ends, target_ends;
+
+	// position of each edge in the last pass by edge index
+	std::vector<std::size_t> position;
+
+	// how far in pixels a simplified path may stray from the traced one
+	double tolerance;
+
+	// of the points being simplified, whether each is kept, and the spans still to split
+	std::vector<std::uint8_t> is_kept;
+	std::vector<std::pair<std::size_t, std::size_t>> spans;
+
+	// whether the paths are tested against the other nodes, and of each edge whether it passes over one
+	bool is_finding_crossings;
+	svg_node_grid grid;
+	std::vector<std::uint8_t> crossings;
+
+public:
+
+	svg_edge_paths(const ogdf::GraphAttributes & attributes, const svg_arrows & arrows, double margin, double (*marker_length)(EndType))
+		: attributes(attributes), arrows(arrows), margin(margin), marker_length(marker_length), tolerance(0.5), is_finding_crossings(false) {}
+
+	/** sets how far in pixels a drawn path may stray from its traced points, 0 only merges collinear points */
+	void set_tolerance(double pixels) {
+		tolerance = pixels;
+	}
+
+	/** sets whether clip also finds the paths passing over other nodes, see crosses_other */
+	void set_find_crossings(bool is_finding) {
+		is_finding_crossings = is_finding;
+	}
+
+	/** clips the paths of the edges, replacing those of the last pass */
+	void clip(const std::vector<ogdf::edge> & edges) {
+
+		gather(edges);
+		contain();
+
+		path_points.clear();
+		first_path_point.clear();
+		source_ends.clear();
+		target_ends.clear();
+
+		for(std::size_t pos = 0; pos < edges.size(); ++pos) {
+
+			first_path_point.push_back(path_points.size());
+			trace(edges[pos], first_point[pos], first_point[pos + 1]);
+			simplify(first_path_point.back());
+
+		}
+
+		first_path_point.push_back(path_points.size());
+
+		crossings.clear();
+		if(!is_finding_crossings)
+			return;
+
+		grid.build(attributes, 0);
+		for(std::size_t pos = 0; pos < edges.size(); ++pos) {
+
+			std::uint8_t is_crossing = 0;
+			for(std::size_t point = first_path_point[pos]; point + 1 < first_path_point[pos + 1] && !is_crossing; ++point)
+				is_crossing = grid.crosses_other(path_points[point], path_points[point + 1], edges[pos]->source(), edges[pos]->target());
+
+			crossings.push_back(is_crossing);
+
+		}
+
+	}
+
+	/** number of points drawn for a clipped edge, fewer than 2 if its nodes overlap */
+	std::size_t size(ogdf::edge e) const {
+
+		const std::size_t pos = position[e->index()];
+		return first_path_point[pos + 1] - first_path_point[pos];
+
+	}
+
+	/** whether the path of a clipped edge passes over a node other than its own, false unless set_find_crossings */
+	bool crosses_other(ogdf::edge e) const {
+		return !crossings.empty() && crossings[position[e->index()]];
+	}
+
+	const ogdf::DPoint * points(ogdf::edge e) const {
+		return path_points.data() + first_path_point[position[e->index()]];
+	}
+
+	EndType source_end(ogdf::edge e) const {
+		return source_ends[position[e->index()]];
+	}
+
+	EndType target_end(ogdf::edge e) const {
+		return target_ends[position[e->index()]];
+	}
+
+	/**
+	 * Where a segment from start ends at the border of a node rectangle, given by its
+	 * center and half its size, pulled back by length for the marker drawn there.
+	 */
+	static ogdf::DPoint clip_end(const ogdf::DPoint & start, ogdf::DPoint end,
+								 double center_x, double center_y, double half_width, double half_height,
+								 double margin, double length) {
+
+		const double dx = end.m_x - start.m_x;
+		const double dy = end.m_y - start.m_y;
+
+		if(dx == 0) {
+
+			const int sign = dy > 0 ? 1 : -1;
+			end.m_y = center_y - half_height * sign - sign * length;
+			return end;
+
+		}
+
+		// the tip is on the vertical side facing start unless that is beyond the rectangle
+		const double slope = dy / dx;
+		int sign = dx > 0 ? 1 : -1;
+
+		double x = center_x - half_width * sign;
+		double y = start.m_y + (x - start.m_x) * slope;
+
+		if(y < center_y - half_height - margin || y > center_y + half_height + margin) {
+
+			sign = dy > 0 ? 1 : -1;
+			y = center_y - half_height * sign;
+			x = start.m_x + (y - start.m_y) / slope;
+
+		}
+
+		end.m_x = x;
+		end.m_y = y;
+
+		if(length > 0) {
+
+			const double vx = start.m_x - end.m_x;
+			const double vy = start.m_y - end.m_y;
+			const double magnitude = std::sqrt(vx * vx + vy * vy);
+
+			end.m_x += length * (vx / magnitude);
+			end.m_y += length * (vy / magnitude);
+
+		}
+
+		return end;
+
+	}
+
+private:
+
+	/** lays out the points of the edges and the rectangles they are tested against */
+	void gather(const std::vector<ogdf::edge> & edges) {
+
+		xs.clear();
+		ys.clear();
+		source_left.clear();
+		source_top.clear();
+		source_right.clear();
+		source_bottom.clear();
+		target_left.clear();
+		target_top.clear();
+		target_right.clear();
+		target_bottom.clear();
+		first_point.clear();
+
+		if(position.size() < static_cast<std::size_t>(attributes.constGraph().maxEdgeIndex() + 1))
+			position.resize(attributes.constGraph().maxEdgeIndex() + 1);
+
+		for(std::size_t pos = 0; pos < edges.size(); ++pos) {
+
+			const ogdf::edge e = edges[pos];
+			position[e->index()] = pos;
+			first_point.push_back(xs.size());
+
+			const ogdf::node source = e->source();
+			const ogdf::node target = e->target();
+
+			add_point(e, attributes.x(source), attributes.y(source));
+			for(const ogdf::DPoint & bend : attributes.bends(e))
+				add_point(e, bend.m_x, bend.m_y);
+			add_point(e, attributes.x(target), attributes.y(target));
+
+		}
+
+		first_point.push_back(xs.size());
+
+	}
+
+	void add_point(ogdf::edge e, double x, double y) {
+
+		xs.push_back(x);
+		ys.push_back(y);
+
+		const ogdf::node source = e->source();
+		source_left.push_back(attributes.x(source) - attributes.width(source) / 2 - margin);
+		source_right.push_back(attributes.x(source) + attributes.width(source) / 2 + margin);
+		source_top.push_back(attributes.y(source) - attributes.height(source) / 2 - margin);
+		source_bottom.push_back(attributes.y(source) + attributes.height(source) / 2 + margin);
+
+		const ogdf::node target = e->target();
+		target_left.push_back(attributes.x(target) - attributes.width(target) / 2 - margin);
+		target_right.push_back(attributes.x(target) + attributes.width(target) / 2 + margin);
+		target_top.push_back(attributes.y(target) - attributes.height(target) / 2 - margin);
+		target_bottom.push_back(attributes.y(target) + attributes.height(target) / 2 + margin);
+
+	}
+
+	/** tests every point against the rectangles of its edge's nodes */
+	void contain() {
+
+		const std::size_t count = xs.size();
+		in_source.resize(count);
+		in_target.resize(count);
+
+		const double * x = xs.data();
+		const double * y = ys.data();
+		std::uint8_t * source = in_source.data();
+		std::uint8_t * target = in_target.data();
+
+		for(std::size_t pos = 0; pos < count; ++pos) {
+
+			source[pos] = (x[pos] >= source_left[pos]) & (x[pos] <= source_right[pos])
+						& (y[pos] >= source_top[pos]) & (y[pos] <= source_bottom[pos]);
+			target[pos] = (x[pos] >= target_left[pos]) & (x[pos] <= target_right[pos])
+						& (y[pos] >= target_top[pos]) & (y[pos] <= target_bottom[pos]);
+
+		}
+
+	}
+
+	/** the drawn points of an edge from its layout points first to last */
+	void trace(ogdf::edge e, std::size_t first, std::size_t last) {
+
+		// arrow heads are drawn if the graph is directed or arrow types are given for the edge
+		bool has_source_arrow = false;
+		bool has_target_arrow = false;
+
+		if(attributes.has(ogdf::GraphAttributes::edgeArrow)) {
+
+			switch(attributes.arrowType(e)) {
+
+				case ogdf::EdgeArrow::Undefined:
+					has_target_arrow = attributes.directed();
+					break;
+				case ogdf::EdgeArrow::Last:
+					has_target_arrow = true;
+					break;
+				case ogdf::EdgeArrow::Both:
+					has_target_arrow = true;
+					has_source_arrow = true;
+					break;
+				case ogdf::EdgeArrow::First:
+					has_source_arrow = true;
+					break;
+				default:
+					break;
+
+			}
+
+		}
+
+		EndType source_end = NoEnd;
+		EndType target_end = NoEnd;
+
+		bool is_drawn = false;
+		bool is_finished = false;
+
+		for(std::size_t pos = first; pos + 1 < last && !is_finished; ++pos) {
+
+			ogdf::DPoint p1(xs[pos], ys[pos]);
+			ogdf::DPoint p2(xs[pos + 1], ys[pos + 1]);
+
+			// segment leaving the source
+			if(in_source[pos] && !in_source[pos + 1]) {
+
+				if(!is_drawn && has_source_arrow) {
+					source_end = arrows[e].first;
+					p1 = clip(p2, p1, e->source(), source_end);
+				}
+
+				is_drawn = true;
+
+			}
+
+			// segment entering the target
+			if(!in_target[pos] && in_target[pos + 1]) {
+
+				is_finished = true;
+
+				if(has_target_arrow) {
+					target_end = arrows[e].second;
+					p2 = clip(p1, p2, e->target(), target_end);
+				}
+
+			}
+
+			if(is_drawn)
+				path_points.push_back(p1);
+
+			if(is_finished)
+				path_points.push_back(p2);
+
+		}
+
+		source_ends.push_back(source_end);
+		target_ends.push_back(target_end);
+
+	}
+
+	/**
+	 * Drops the points of the path from first on that do not change its shape: repeated
+	 * points and bends on the line through their neighbours, then what a Douglas-Peucker
+	 * pass finds within tolerance.  The ends are kept, so are the arrow heads.
+	 */
+	void simplify(std::size_t first) {
+
+		std::size_t last = first;
+		for(std::size_t pos = first; pos < path_points.size(); ++pos) {
+
+			const ogdf::DPoint & point = path_points[pos];
+			if(last > first && point == path_points[last - 1])
+				continue;
+
+			// a bend going on in the same direction
+			if(last > first + 1 && pos + 1 < path_points.size()) {
+
+				const ogdf::DPoint & previous = path_points[last - 1];
+				const ogdf::DPoint & next = path_points[pos + 1];
+				const double cross = (point.m_x - previous.m_x) * (next.m_y - point.m_y) - (point.m_y - previous.m_y) * (next.m_x - point.m_x);
+				const double dot = (point.m_x - previous.m_x) * (next.m_x - point.m_x) + (point.m_y - previous.m_y) * (next.m_y - point.m_y);
+				if(cross == 0 && dot > 0)
+					continue;
+
+			}
+
+			path_points[last++] = point;
+
+		}
+
+		path_points.resize(last);
+		if(tolerance <= 0 || last - first < 3)
+			return;
+
+		is_kept.assign(last - first, 0);
+		is_kept.front() = is_kept.back() = 1;
+
+		spans.clear();
+		spans.emplace_back(first, last - 1);
+		while(!spans.empty()) {
+
+			const std::pair<std::size_t, std::size_t> span = spans.back();
+			spans.pop_back();
+
+			const ogdf::DPoint & start = path_points[span.first];
+			const ogdf::DPoint & end = path_points[span.second];
+			const double dx = end.m_x - start.m_x;
+			const double dy = end.m_y - start.m_y;
+			const double length = std::sqrt(dx * dx + dy * dy);
+
+			std::size_t farthest = span.first;
+			double distance = tolerance;
+			for(std::size_t pos = span.first + 1; pos < span.second; ++pos) {
+
+				const double px = path_points[pos].m_x - start.m_x;
+				const double py = path_points[pos].m_y - start.m_y;
+				const double away = length == 0 ? std::sqrt(px * px + py * py) : std::abs(px * dy - py * dx) / length;
+				if(away > distance) {
+					distance = away;
+					farthest = pos;
+				}
+
+			}
+
+			if(farthest == span.first)
+				continue;
+
+			is_kept[farthest - first] = 1;
+			spans.emplace_back(span.first, farthest);
+			spans.emplace_back(farthest, span.second);
+
+		}
+
+		std::size_t kept = first;
+		for(std::size_t pos = first; pos < last; ++pos)
+			if(is_kept[pos - first])
+				path_points[kept++] = path_points[pos];
+
+		path_points.resize(kept);
+
+	}
+
+	ogdf::DPoint clip(const ogdf::DPoint & start, const ogdf::DPoint & end, ogdf::node v, EndType end_type) const {
+
+		return clip_end(start, end, attributes.x(v), attributes.y(v), attributes.width(v) / 2, attributes.height(v) / 2,
+						margin, marker_length(end_type));
+
+	}
+
+};
+
+#endif
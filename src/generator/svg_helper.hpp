@@ -48,11 +48,11 @@
 #include <ogdf/cluster/ClusterGraphAttributes.h>
 //===================================================================
 
+#include <svg_arrow.hpp>
+
 using namespace ogdf;
 using namespace ogdf::internal;
 
-enum EndType { FilledTriangle, HollowTriangle, FilledDiamond, HollowDiamond };
-
 class svg_helper{
 private:
 
@@ -0,0 +1,170 @@
+#ifndef INCLUDED_SVG_HIERARCHY_OUTPUTTER_HPP
+#define INCLUDED_SVG_HIERARCHY_OUTPUTTER_HPP
+
+#include <svg_outputter.hpp>
+
+#include <numeric>
+
+/**
+ * svg_hierarchy_outputter
+ *
+ * Inheritance only: the generalizations and realizations of the classes, laid
+ * out as a forest by TreeLayout in linear time, each parent above its children.
+ * A class with several parents hangs below the first of them, the other
+ * generalizations, and any closing a cycle, are drawn straight over the forest.
+ */
+class svg_hierarchy_outputter : public svg_outputter {
+
+public:
+
+	svg_hierarchy_outputter(){
+		init_attributes();
+	}
+
+	bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+		srcuml_stats::timer graph_timer(get_stats(), "graph");
+		reset_graph();
+
+		srcuml_relationships relationships = analyze_relationships(classes);
+
+		//Forest
+		//===============================================================================================================
+		//parent to child, a child's first parent is its tree edge
+		std::unordered_map<srcuml_symbol, std::size_t> positions;
+		positions.reserve(classes.size());
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			positions.emplace(classes[pos]->get_name_symbol(), pos);
+		}
+
+		std::vector<std::size_t> roots(classes.size());
+		std::iota(roots.begin(), roots.end(), std::size_t(0));
+		const auto find_root = [&roots](std::size_t pos){
+			while(roots[pos] != pos)
+				pos = roots[pos] = roots[roots[pos]];
+			return pos;
+		};
+
+		std::vector<char> has_parent(classes.size(), 0);
+		std::vector<srcuml_edge> tree_edges, other_edges;
+		for(const srcuml_relationship & relationship : relationships.get_relationships()){
+			if(relationship.get_type() != GENERALIZATION && relationship.get_type() != REALIZATION)
+				continue;
+
+			std::unordered_map<srcuml_symbol, std::size_t>::const_iterator parent = positions.find(relationship.get_source_symbol());
+			std::unordered_map<srcuml_symbol, std::size_t>::const_iterator child = positions.find(relationship.get_destination_symbol());
+			if(parent == positions.end() || child == positions.end() || parent->second == child->second)
+				continue;
+
+			const srcuml_edge edge = { relationship.get_source_symbol(), relationship.get_destination_symbol(), relationship.get_type() };
+			const std::size_t parent_root = find_root(parent->second), child_root = find_root(child->second);
+			if(has_parent[child->second] || parent_root == child_root){
+				other_edges.push_back(edge);
+				continue;
+			}
+
+			has_parent[child->second] = 1;
+			roots[child_root] = parent_root;
+			tree_edges.push_back(edge);
+		}
+
+		std::vector<node> nodes;
+		std::vector<ogdf::edge> edges;
+		build_graph(g, classes, tree_edges, nodes, edges);
+		init_attributes();
+		//===============================================================================================================
+
+		//Classes/Nodes
+		//===============================================================================================================
+		std::vector<svg_label> labels(classes.size());
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			node cur_node = nodes[pos];
+
+			ga.label(cur_node) = classes[pos]->get_srcuml_name();
+			int num_lines = 0;
+			int longest_line = 0;
+			set_label(labels, cur_node, generate_label(classes[pos], num_lines, longest_line));
+
+			ga.height(cur_node) = num_lines * 1.3 * 10;
+			ga.width(cur_node) = longest_line * .75 * 10;
+			ga.fillColor(cur_node) = Color(Color::Name::Antiquewhite);
+		}
+		//===============================================================================================================
+
+		//Layout
+		//===============================================================================================================
+		graph_timer.stop();
+		srcuml_stats::timer layout_timer(get_stats(), "layout");
+
+		TreeLayout tree;
+		tree.orthogonalLayout(true);
+		tree.levelDistance(50.0);
+		tree.siblingDistance(30.0);
+		tree.subtreeDistance(30.0);
+		tree.treeDistance(50.0);
+
+		{
+			srcuml_trace::span span("TreeLayout", "ogdf");
+			tree.call(ga);
+		}
+
+		layout_timer.stop();
+		//===============================================================================================================
+
+		//Relationships/Edges
+		//===============================================================================================================
+		//added once laid out, TreeLayout only takes a forest
+		for(const srcuml_edge & edge : other_edges){
+			edges.push_back(g.newEdge(nodes[positions.at(edge.source)], nodes[positions.at(edge.destination)]));
+		}
+
+		svg_arrows arrows(g, std::make_pair(NoEnd, NoEnd));
+		for(ogdf::edge cur_edge : edges){
+			ga.strokeWidth(cur_edge) = 2;
+			ga.strokeType(cur_edge) = StrokeType::Dash;
+			ga.arrowType(cur_edge) = EdgeArrow::Both;
+			ga.type(cur_edge) = Graph::EdgeType::generalization;
+			arrows[cur_edge] = std::make_pair(HollowTriangle, NoEnd);
+		}
+		//===============================================================================================================
+
+		const std::string layout_description = "srcUML layout: TreeLayout, " + std::to_string(tree_edges.size()) + " tree edges, "
+											 + std::to_string(other_edges.size()) + " other generalizations";
+		if(get_stats())
+			get_stats()->set_note("svg_hierarchy layout", layout_description);
+
+		GraphIO::SVGSettings svg_settings;
+		if(!drawSVG(ga, out, svg_settings, arrows, labels, layout_description)){
+			throw std::string("Error: Unable to write the svg_hierarchy drawing");
+		}
+		drawTiles(ga, svg_settings, arrows, labels);
+
+		return true;
+	}
+
+private:
+
+	/** an empty graph without attributes, so every output starts afresh, see output */
+	void reset_graph(){
+		ga.init(g, 0);
+		g.clear();
+	}
+
+	/** the attributes of the graph built, see build_graph */
+	void init_attributes(){
+		ga.init(g,
+		GraphAttributes::nodeGraphics |
+		GraphAttributes::edgeGraphics |
+		GraphAttributes::nodeLabel |
+		GraphAttributes::edgeType |
+		GraphAttributes::edgeArrow |
+		GraphAttributes::nodeStyle |
+		GraphAttributes::edgeStyle);
+	}
+
+	Graph g;
+
+	GraphAttributes ga;
+
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file svg_label.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_LABEL_HPP
+#define INCLUDED_SVG_LABEL_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+/** code points first to last taking cells of the monospace font, all others take one */
+struct svg_glyph_range {
+
+	char32_t first;
+	char32_t last;
+	unsigned char cells;
+
+};
+
+/** glyph widths by code point, sorted, combining marks and East Asian wide and full-width ranges */
+static const svg_glyph_range svg_glyph_widths[] = {
+
+	{ 0x0300, 0x036f, 0 }, { 0x0483, 0x0489, 0 }, { 0x0591, 0x05bd, 0 }, { 0x0610, 0x061a, 0 },
+	{ 0x064b, 0x065f, 0 }, { 0x0e31, 0x0e31, 0 }, { 0x0e34, 0x0e3a, 0 }, { 0x0e47, 0x0e4e, 0 },
+	{ 0x1100, 0x115f, 2 }, { 0x1ab0, 0x1aff, 0 }, { 0x1dc0, 0x1dff, 0 }, { 0x200b, 0x200f, 0 },
+	{ 0x202a, 0x202e, 0 }, { 0x2060, 0x2064, 0 }, { 0x20d0, 0x20ff, 0 }, { 0x231a, 0x231b, 2 },
+	{ 0x2329, 0x232a, 2 }, { 0x2e80, 0x303e, 2 }, { 0x3041, 0x33ff, 2 }, { 0x3400, 0x4dbf, 2 },
+	{ 0x4e00, 0x9fff, 2 }, { 0xa000, 0xa4cf, 2 }, { 0xa960, 0xa97f, 2 }, { 0xac00, 0xd7a3, 2 },
+	{ 0xf900, 0xfaff, 2 }, { 0xfe00, 0xfe0f, 0 }, { 0xfe10, 0xfe19, 2 }, { 0xfe20, 0xfe2f, 0 },
+	{ 0xfe30, 0xfe6f, 2 }, { 0xfeff, 0xfeff, 0 }, { 0xff00, 0xff60, 2 }, { 0xffe0, 0xffe6, 2 },
+	{ 0x1f300, 0x1f64f, 2 }, { 0x1f900, 0x1f9ff, 2 }, { 0x20000, 0x2fffd, 2 }, { 0x30000, 0x3fffd, 2 },
+	{ 0xe0100, 0xe01ef, 0 }
+
+};
+
+/** a line of a node label, static members are underlined */
+struct svg_label_line {
+
+	std::string text;
+	bool is_static;
+
+};
+
+/**
+ * svg_label
+ *
+ * Text of a class box as compartments of lines, e.g. name, attributes and
+ * operations, with a divider between compartments.  Built once by the
+ * outputter and used both to size the node and by SvgPrinter to draw it.
+ */
+struct svg_label {
+
+	std::vector<std::vector<svg_label_line>> compartments;
+
+	/** lines and dividers, the height of the box in rows */
+	std::size_t number_rows() const {
+
+		std::size_t rows = compartments.empty() ? 0 : compartments.size() - 1;
+		for(const std::vector<svg_label_line> & compartment : compartments)
+			rows += compartment.size();
+
+		return rows;
+
+	}
+
+	/** monospace cells of the longest line, the width of the box in columns */
+	std::size_t longest_line() const {
+
+		std::size_t longest = 0;
+		for(const std::vector<svg_label_line> & compartment : compartments)
+			for(const svg_label_line & line : compartment)
+				longest = std::max(longest, columns(line.text));
+
+		return longest;
+
+	}
+
+	/**
+	 * Monospace cells the UTF-8 text takes in the font of the drawing.  ASCII
+	 * takes one cell a byte, otherwise each code point is looked up in
+	 * svg_glyph_widths, so guillemets take one cell, full-width brackets two
+	 * and combining underlines none.
+	 */
+	static std::size_t columns(const std::string & text) {
+
+		std::size_t pos = 0;
+		while(pos < text.size() && static_cast<unsigned char>(text[pos]) < 0x80)
+			++pos;
+
+		if(pos == text.size())
+			return pos;
+
+		std::size_t cells = pos;
+		while(pos < text.size()) {
+
+			const unsigned char lead = static_cast<unsigned char>(text[pos]);
+			std::size_t bytes = lead < 0x80 ? 1 : lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+			char32_t code_point = bytes == 1 ? lead : lead & (0x7f >> bytes);
+			for(std::size_t next = 1; next < bytes; ++next) {
+
+				if(pos + next == text.size() || (static_cast<unsigned char>(text[pos + next]) & 0xc0) != 0x80) {
+					bytes = next;
+					break;
+				}
+				code_point = (code_point << 6) | (static_cast<unsigned char>(text[pos + next]) & 0x3f);
+
+			}
+
+			cells += glyph_width(code_point);
+			pos += bytes;
+
+		}
+
+		return cells;
+
+	}
+
+	/** cells of a code point, 0 for combining marks and 2 for wide and full-width ones */
+	static std::size_t glyph_width(char32_t code_point) {
+
+		if(code_point < 0x300)
+			return 1;
+
+		const svg_glyph_range * const end = svg_glyph_widths + sizeof(svg_glyph_widths) / sizeof(svg_glyph_widths[0]);
+		const svg_glyph_range * range = std::upper_bound(svg_glyph_widths, end, code_point,
+			[](char32_t point, const svg_glyph_range & range) { return point < range.first; });
+
+		if(range == svg_glyph_widths || code_point > (--range)->last)
+			return 1;
+
+		return range->cells;
+
+	}
+
+};
+
+#endif
@@ -0,0 +1,743 @@
+/**
+ * @file svg_layout.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_LAYOUT_HPP
+#define INCLUDED_SVG_LAYOUT_HPP
+
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/GraphAttributes.h>
+#include <ogdf/layered/SugiyamaLayout.h>
+#include <ogdf/layered/OptimalRanking.h>
+#include <ogdf/layered/LongestPathRanking.h>
+#include <ogdf/layered/MedianHeuristic.h>
+#include <ogdf/layered/BarycenterHeuristic.h>
+#include <ogdf/layered/SplitHeuristic.h>
+#include <ogdf/layered/OptimalHierarchyLayout.h>
+#include <ogdf/layered/FastHierarchyLayout.h>
+#include <ogdf/layered/FastSimpleHierarchyLayout.h>
+
+#include <srcuml_utilities.hpp>
+#include <svg_layout_cache.hpp>
+#include <srcuml_cancel.hpp>
+#include <srcuml_trace.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+enum layout_engine { OPTIMAL_LAYOUT, FAST_LAYOUT, FAST_SIMPLE_LAYOUT };
+
+/**
+ * svg_layout
+ *
+ * Sugiyama layout with the ranking and hierarchy layout chosen by graph size.
+ * OptimalRanking and OptimalHierarchyLayout solve LPs that do not scale, so
+ * larger graphs use LongestPathRanking with FastHierarchyLayout and the largest
+ * FastSimpleHierarchyLayout.  With a time budget the optimal layout runs on a
+ * copy of the graph, which is abandoned for the fast layout if the budget runs out.
+ * The fast layout runs alongside it, so when the budget runs out its drawing is
+ * used at once instead of only being started then.
+ * With a cancellation token the layouts are supervised alike until its deadline:
+ * an abandoned optimal layout falls back to the fast layout, an abandoned fast
+ * layout to FastSimpleHierarchyLayout, which always runs to the end.  Once
+ * cancelled only FastSimpleHierarchyLayout is used.  Nothing waits for an
+ * abandoned layout, it runs on until it finishes or the process ends.
+ *
+ * Optionally each connected component is laid out on its own, in parallel,
+ * and the components are packed into rows.  Given a layout cache, components
+ * drawn before are restored from it rather than laid out again.  Several
+ * crossing minimization runs, each with its own heuristic, can be made in
+ * parallel, keeping the drawing with the fewest crossings.
+ */
+class svg_layout {
+
+public:
+
+	// largest graphs, in nodes, laid out by each engine, the optimal one unless set otherwise
+	static const int OPTIMAL_LIMIT = 300;
+	static const int FAST_LIMIT = 3000;
+
+	// space between packed components
+	static constexpr double COMPONENT_SPACING = 50.0;
+
+private:
+
+	// milliseconds, 0 lets the optimal layout take as long as it takes
+	std::size_t budget;
+
+	bool split_components;
+	std::size_t threads;
+	std::size_t crossmin_runs;
+
+	// deadline the layouts are supervised until, nullptr for none
+	const srcuml_cancel * cancel = nullptr;
+
+	// largest graphs, in nodes, given the optimal layout
+	int optimal_limit = OPTIMAL_LIMIT;
+
+public:
+
+	/** nodes and edges of a part of a graph, e.g. a connected component, in graph order */
+	struct component {
+
+		std::vector<ogdf::node> nodes;
+		std::vector<ogdf::edge> edges;
+
+	};
+
+	/** graph of some nodes of another with their sizes, laid out and copied back */
+	struct layout_copy {
+
+		ogdf::Graph graph;
+		ogdf::GraphAttributes attributes;
+
+		// in the order of the source's nodes and edges
+		std::vector<ogdf::node> nodes;
+		std::vector<ogdf::edge> edges;
+
+		/** a seed other than 0 creates the nodes and edges in an order shuffled by it, which is where the crossing minimization starts */
+		layout_copy(const ogdf::GraphAttributes & source, const component & part, std::uint64_t seed = 0)
+			: graph(), attributes(), nodes(part.nodes.size()), edges(part.edges.size()) {
+
+			std::vector<std::size_t> node_order(part.nodes.size());
+			std::iota(node_order.begin(), node_order.end(), 0);
+			std::vector<std::size_t> edge_order(part.edges.size());
+			std::iota(edge_order.begin(), edge_order.end(), 0);
+			if(seed != 0) {
+				std::mt19937_64 random(seed);
+				std::shuffle(node_order.begin(), node_order.end(), random);
+				std::shuffle(edge_order.begin(), edge_order.end(), random);
+			}
+
+			// sized to the part, not the whole graph, as there is a copy for each component
+			std::unordered_map<ogdf::node, ogdf::node> copies;
+			copies.reserve(part.nodes.size());
+
+			attributes.init(graph, ogdf::GraphAttributes::nodeGraphics | ogdf::GraphAttributes::edgeGraphics);
+			for(std::size_t pos : node_order) {
+
+				ogdf::node v = part.nodes[pos];
+				ogdf::node copy = graph.newNode();
+				copies[v] = copy;
+				nodes[pos] = copy;
+				attributes.width(copy) = source.width(v);
+				attributes.height(copy) = source.height(v);
+
+			}
+
+			for(std::size_t pos : edge_order)
+				edges[pos] = graph.newEdge(copies.at(part.edges[pos]->source()), copies.at(part.edges[pos]->target()));
+
+		}
+
+		/** moved by dx and dy */
+		void copy_to(ogdf::GraphAttributes & target, const component & part, double dx, double dy) const {
+
+			for(std::size_t pos = 0; pos < part.nodes.size(); ++pos) {
+				target.x(part.nodes[pos]) = attributes.x(nodes[pos]) + dx;
+				target.y(part.nodes[pos]) = attributes.y(nodes[pos]) + dy;
+			}
+
+			for(std::size_t pos = 0; pos < part.edges.size(); ++pos) {
+
+				ogdf::DPolyline & bends = target.bends(part.edges[pos]);
+				bends.clear();
+				for(const ogdf::DPoint & point : attributes.bends(edges[pos]))
+					bends.pushBack(ogdf::DPoint(point.m_x + dx, point.m_y + dy));
+
+			}
+
+		}
+
+	};
+
+private:
+
+	/** a layout running on a copy of a graph on a thread of its own, see start, joined once destroyed unless abandoned */
+	struct supervised_layout {
+
+		component whole;
+		std::shared_ptr<layout_copy> copy;
+		std::future<void> finished;
+
+		// skips the remaining crossing minimization runs once set
+		std::shared_ptr<std::atomic<bool>> abandoned = std::make_shared<std::atomic<bool>>(false);
+		std::thread worker;
+
+		supervised_layout() = default;
+		supervised_layout(supervised_layout &&) = default;
+		supervised_layout & operator=(supervised_layout &&) = default;
+
+		~supervised_layout() {
+
+			if(!worker.joinable())
+				return;
+
+			abandoned->store(true);
+			worker.join();
+
+		}
+
+	};
+
+	/**
+	 * Layouts no longer waited for, kept as long as the process runs so no outputter waits
+	 * for them once destroyed.  Each only holds its own copy of the graph, so those still
+	 * running at exit are detached.
+	 */
+	struct abandoned_pool {
+
+		std::mutex mutex;
+		std::vector<supervised_layout> layouts;
+
+		/** joins the layouts that finished, keeps the others, mutex held */
+		void reap() {
+
+			std::vector<supervised_layout> running;
+			for(supervised_layout & layout : layouts)
+				if(layout.finished.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+					running.push_back(std::move(layout));
+			layouts.swap(running);
+
+		}
+
+		~abandoned_pool() {
+
+			for(supervised_layout & layout : layouts)
+				if(layout.worker.joinable())
+					layout.worker.detach();
+
+		}
+
+	};
+
+	static abandoned_pool & abandoned_layouts() {
+
+		static abandoned_pool pool;
+		return pool;
+
+	}
+
+public:
+
+	svg_layout(std::size_t budget = 0, bool split_components = false, std::size_t threads = 1, std::size_t crossmin_runs = 1)
+		: budget(budget), split_components(split_components), threads(threads), crossmin_runs(std::max<std::size_t>(1, crossmin_runs)) {}
+
+	/** graphs of more than nodes nodes are not given the optimal layout, 0 gives it to none */
+	void use_optimal_limit(std::size_t nodes) {
+		optimal_limit = static_cast<int>(std::min<std::size_t>(nodes, FAST_LIMIT));
+	}
+
+	/** the layouts give up at the deadline of cancel, see the class comment */
+	void use_cancel(const srcuml_cancel * cancel) {
+		this->cancel = cancel;
+	}
+
+	/**
+	 * Number of abandoned layouts still running.  An optimal layout cannot be interrupted, so a
+	 * process with output written need not wait for them and may end with std::_Exit.
+	 */
+	static std::size_t running_abandoned() {
+
+		abandoned_pool & pool = abandoned_layouts();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.reap();
+
+		return pool.layouts.size();
+
+	}
+
+	/** lays out attributes, returns how for the SVG metadata */
+	std::string call(ogdf::GraphAttributes & attributes, svg_layout_cache * cache = nullptr) const {
+
+		std::vector<component> components;
+		if(split_components)
+			components = find_components(attributes.constGraph());
+
+		if(components.size() < 2) {
+
+			if(!cache)
+				return layout_graph(attributes, threads);
+
+			component whole = whole_graph(attributes.constGraph());
+			std::uint64_t fingerprint = svg_layout_cache::fingerprint(attributes, whole.nodes, whole.edges);
+			if(restore(cache, fingerprint, attributes, whole))
+				return describe_cached(whole.nodes.size());
+
+			std::string description = layout_graph(attributes, threads);
+			// a drawing degraded by the deadline is not kept
+			if(!srcuml_cancel::is_cancelled(cancel))
+				cache->store(fingerprint, attributes, whole.nodes, whole.edges);
+			return description;
+
+		}
+
+		std::vector<std::unique_ptr<layout_copy>> copies(components.size());
+		std::vector<std::string> descriptions(components.size());
+		std::vector<std::uint64_t> fingerprints(components.size());
+		std::vector<std::size_t> misses;
+		std::vector<int> positions;
+		for(std::size_t pos = 0; pos < components.size(); ++pos) {
+
+			copies[pos].reset(new layout_copy(attributes, components[pos]));
+			if(!cache) {
+				misses.push_back(pos);
+				continue;
+			}
+
+			// restored into the copy, so cached and new components are packed alike
+			fingerprints[pos] = svg_layout_cache::fingerprint(attributes, components[pos].nodes, components[pos].edges, positions);
+			component copied = { copies[pos]->nodes, copies[pos]->edges };
+			if(restore(cache, fingerprints[pos], copies[pos]->attributes, copied))
+				descriptions[pos] = describe_cached(components[pos].nodes.size());
+			else
+				misses.push_back(pos);
+
+		}
+
+		srcuml::parallel_ranges(misses.size(), threads, [&](std::size_t first, std::size_t last) {
+
+			for(std::size_t pos = first; pos < last; ++pos)
+				descriptions[misses[pos]] = layout_graph(copies[misses[pos]]->attributes, misses.size() > 1 ? 1 : threads);
+
+		});
+
+		if(cache && !srcuml_cancel::is_cancelled(cancel)) {
+
+			for(std::size_t pos : misses)
+				cache->store(fingerprints[pos], copies[pos]->attributes, copies[pos]->nodes, copies[pos]->edges);
+
+		}
+
+		pack(attributes, components, copies);
+
+		// components are found in node order, describe the largest
+		std::size_t largest = 0;
+		for(std::size_t pos = 1; pos < components.size(); ++pos)
+			if(components[pos].nodes.size() > components[largest].nodes.size())
+				largest = pos;
+
+		std::string description = std::to_string(components.size()) + " components laid out separately";
+		if(cache)
+			description += ", " + std::to_string(components.size() - misses.size()) + " from the layout cache";
+
+		return description + ", largest: " + descriptions[largest];
+
+	}
+
+	/** smallest x and y followed by the width and height of the drawing */
+	static std::vector<double> extent(const ogdf::GraphAttributes & attributes) {
+
+		double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+		bool is_empty = true;
+
+		for(ogdf::node v : attributes.constGraph().nodes) {
+
+			double left = attributes.x(v) - attributes.width(v) / 2, right = attributes.x(v) + attributes.width(v) / 2;
+			double top = attributes.y(v) - attributes.height(v) / 2, bottom = attributes.y(v) + attributes.height(v) / 2;
+			if(is_empty || left < min_x)   min_x = left;
+			if(is_empty || right > max_x)  max_x = right;
+			if(is_empty || top < min_y)    min_y = top;
+			if(is_empty || bottom > max_y) max_y = bottom;
+			is_empty = false;
+
+		}
+
+		for(ogdf::edge e : attributes.constGraph().edges) {
+
+			for(const ogdf::DPoint & point : attributes.bends(e)) {
+				min_x = std::min(min_x, point.m_x);
+				max_x = std::max(max_x, point.m_x);
+				min_y = std::min(min_y, point.m_y);
+				max_y = std::max(max_y, point.m_y);
+			}
+
+		}
+
+		return { min_x, min_y, max_x - min_x, max_y - min_y };
+
+	}
+
+	/**
+	 * candidate picks the crossing minimization heuristic, returns the crossings.  A candidate of
+	 * several makes a single run: OGDF's random number generator is process-wide, so its repeated
+	 * runs from random permutations differ with what else runs on other threads.
+	 */
+	static int run(ogdf::GraphAttributes & attributes, layout_engine engine, std::size_t candidate = 0, bool is_candidate = false) {
+
+		ogdf::SugiyamaLayout sl;
+		if(candidate % 3 == 0)
+			sl.setCrossMin(new ogdf::MedianHeuristic);
+		else if(candidate % 3 == 1)
+			sl.setCrossMin(new ogdf::BarycenterHeuristic);
+		else
+			sl.setCrossMin(new ogdf::SplitHeuristic);
+		if(is_candidate)
+			sl.runs(1);
+
+		if(engine == OPTIMAL_LAYOUT) {
+
+			sl.setRanking(new ogdf::OptimalRanking);
+
+			ogdf::OptimalHierarchyLayout * ohl = new ogdf::OptimalHierarchyLayout;
+			ohl->layerDistance(50.0);
+			ohl->nodeDistance(50.0);
+			ohl->weightBalancing(1);
+			sl.setLayout(ohl);
+
+		} else if(engine == FAST_LAYOUT) {
+
+			sl.setRanking(new ogdf::LongestPathRanking);
+
+			ogdf::FastHierarchyLayout * fhl = new ogdf::FastHierarchyLayout;
+			fhl->layerDistance(50.0);
+			fhl->nodeDistance(50.0);
+			sl.setLayout(fhl);
+
+		} else {
+
+			sl.setRanking(new ogdf::LongestPathRanking);
+
+			ogdf::FastSimpleHierarchyLayout * fshl = new ogdf::FastSimpleHierarchyLayout;
+			fshl->layerDistance(50.0);
+			fshl->nodeDistance(50.0);
+			sl.setLayout(fshl);
+
+		}
+
+		srcuml_trace::span span(engine == OPTIMAL_LAYOUT ? "SugiyamaLayout optimal"
+								: engine == FAST_LAYOUT ? "SugiyamaLayout fast" : "SugiyamaLayout fast simple", "ogdf");
+		if(span)
+			span.set_detail(std::to_string(attributes.constGraph().numberOfNodes()) + " nodes, candidate " + std::to_string(candidate));
+		sl.call(attributes);
+		span.end();
+
+		return sl.numberOfCrossings();
+
+	}
+
+	/**
+	 * Runs candidates in parallel on copies and keeps the drawing with the fewest crossings, the first on a tie.
+	 * Each candidate after the first starts from a copy shuffled by its own seed, so the drawing kept does not
+	 * depend on the threads.  Once abandoned is set no further candidate is started and attributes are left as they are.
+	 */
+	static void run_best(ogdf::GraphAttributes & attributes, layout_engine engine, std::size_t runs, std::size_t threads,
+						 const std::atomic<bool> * abandoned = nullptr) {
+
+		if(runs <= 1) {
+			run(attributes, engine);
+			return;
+		}
+
+		component whole = whole_graph(attributes.constGraph());
+		std::vector<std::unique_ptr<layout_copy>> copies(runs);
+		std::vector<int> crossings(runs);
+		srcuml::parallel_ranges(runs, threads, [&](std::size_t first, std::size_t last) {
+
+			for(std::size_t pos = first; pos < last && !(abandoned && abandoned->load()); ++pos) {
+				copies[pos].reset(new layout_copy(attributes, whole, pos));
+				crossings[pos] = run(copies[pos]->attributes, engine, pos, true);
+			}
+
+		});
+
+		if(abandoned && abandoned->load())
+			return;
+
+		std::size_t best = std::min_element(crossings.begin(), crossings.end()) - crossings.begin();
+		copies[best]->copy_to(attributes, whole, 0, 0);
+
+	}
+
+private:
+
+	/** threads are used for the crossing minimization runs */
+	std::string layout_graph(ogdf::GraphAttributes & attributes, std::size_t run_threads) const {
+
+		const int number_nodes = attributes.constGraph().numberOfNodes();
+
+		if(srcuml_cancel::is_cancelled(cancel)) {
+			run_best(attributes, FAST_SIMPLE_LAYOUT, 1, run_threads);
+			return describe(FAST_SIMPLE_LAYOUT, number_nodes, "deadline reached before the layout");
+		}
+
+		if(number_nodes > FAST_LIMIT) {
+			run_best(attributes, FAST_SIMPLE_LAYOUT, crossmin_runs, run_threads);
+			return describe(FAST_SIMPLE_LAYOUT, number_nodes, "graph too large for the fast layout");
+		}
+
+		std::string reason;
+		if(number_nodes > optimal_limit) {
+
+			reason = "graph too large for the optimal layout";
+
+		} else {
+
+			std::size_t deadline = srcuml_cancel::remaining(cancel);
+			std::size_t wait = budget == 0 ? deadline : std::min(budget, deadline);
+			if(wait == srcuml_cancel::NO_DEADLINE) {
+				run_best(attributes, OPTIMAL_LAYOUT, crossmin_runs, run_threads);
+				return describe(OPTIMAL_LAYOUT, number_nodes, "");
+			}
+
+			// the fast drawing is ready if the optimal one is not
+			supervised_layout optimal = start(attributes, OPTIMAL_LAYOUT, run_threads);
+			supervised_layout fallback = start(attributes, FAST_LAYOUT, run_threads);
+			if(finish(optimal, attributes, wait)) {
+				abandon(fallback);
+				return describe(OPTIMAL_LAYOUT, number_nodes, "");
+			}
+
+			reason = wait < deadline ? "optimal layout exceeded the " + std::to_string(budget) + " ms budget"
+									 : std::string("deadline reached during the optimal layout");
+
+			deadline = srcuml_cancel::remaining(cancel);
+			if(deadline != 0 && finish(fallback, attributes, deadline))
+				return describe(FAST_LAYOUT, number_nodes, reason);
+			if(deadline == 0)
+				abandon(fallback);
+
+			run_best(attributes, FAST_SIMPLE_LAYOUT, 1, run_threads);
+			return describe(FAST_SIMPLE_LAYOUT, number_nodes, "deadline reached during the fast layout");
+
+		}
+
+		std::size_t deadline = srcuml_cancel::remaining(cancel);
+		if(deadline == srcuml_cancel::NO_DEADLINE) {
+			run_best(attributes, FAST_LAYOUT, crossmin_runs, run_threads);
+			return describe(FAST_LAYOUT, number_nodes, reason);
+		}
+
+		if(deadline != 0 && run_supervised(attributes, FAST_LAYOUT, run_threads, deadline))
+			return describe(FAST_LAYOUT, number_nodes, reason);
+
+		run_best(attributes, FAST_SIMPLE_LAYOUT, 1, run_threads);
+		return describe(FAST_SIMPLE_LAYOUT, number_nodes, "deadline reached during the fast layout");
+
+	}
+
+	/**
+	 * Runs the engine on a copy of attributes on a thread of its own.  A layout
+	 * cannot be interrupted, an abandoned one only skips its remaining crossing
+	 * minimization runs, see abandon.
+	 */
+	supervised_layout start(const ogdf::GraphAttributes & attributes, layout_engine engine, std::size_t run_threads) const {
+
+		supervised_layout layout;
+		layout.whole = whole_graph(attributes.constGraph());
+		layout.copy = std::make_shared<layout_copy>(attributes, layout.whole);
+
+		std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+		layout.finished = done->get_future();
+
+		std::shared_ptr<layout_copy> copy = layout.copy;
+		std::shared_ptr<std::atomic<bool>> abandoned = layout.abandoned;
+		const std::size_t runs = crossmin_runs;
+		layout.worker = std::thread([copy, done, abandoned, engine, runs, run_threads]() {
+
+			try {
+				run_best(copy->attributes, engine, runs, run_threads, abandoned.get());
+				done->set_value();
+			} catch(...) {
+				done->set_exception(std::current_exception());
+			}
+
+		});
+
+		return layout;
+
+	}
+
+	/** hands a layout no longer waited for to the abandoned pool, those already finished are joined */
+	static void abandon(supervised_layout & layout) {
+
+		layout.abandoned->store(true);
+
+		abandoned_pool & pool = abandoned_layouts();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.reap();
+		pool.layouts.push_back(std::move(layout));
+
+	}
+
+	/** copies the layout back if it finishes within milliseconds, NO_DEADLINE waits for it, otherwise it is abandoned */
+	bool finish(supervised_layout & layout, ogdf::GraphAttributes & attributes, std::size_t milliseconds) const {
+
+		if(milliseconds == srcuml_cancel::NO_DEADLINE)
+			layout.finished.wait();
+		else if(layout.finished.wait_for(std::chrono::milliseconds(milliseconds)) != std::future_status::ready) {
+			abandon(layout);
+			return false;
+		}
+
+		layout.finished.get();
+		layout.copy->copy_to(attributes, layout.whole, 0, 0);
+		return true;
+
+	}
+
+	/** runs the engine on a copy of attributes, copied back if it finishes within milliseconds */
+	bool run_supervised(ogdf::GraphAttributes & attributes, layout_engine engine, std::size_t run_threads, std::size_t milliseconds) const {
+
+		supervised_layout layout = start(attributes, engine, run_threads);
+		return finish(layout, attributes, milliseconds);
+
+	}
+
+	static component whole_graph(const ogdf::Graph & graph) {
+
+		component whole;
+		for(ogdf::node v : graph.nodes)
+			whole.nodes.push_back(v);
+		for(ogdf::edge e : graph.edges)
+			whole.edges.push_back(e);
+
+		return whole;
+
+	}
+
+	/** false on a miss, or an entry for a different graph with the same fingerprint */
+	static bool restore(svg_layout_cache * cache, std::uint64_t fingerprint, ogdf::GraphAttributes & attributes, const component & part) {
+
+		const svg_layout_cache::drawing * entry = cache->find(fingerprint);
+		if(!entry || entry->positions.size() != part.nodes.size() || entry->bends.size() != part.edges.size())
+			return false;
+
+		svg_layout_cache::apply(*entry, attributes, part.nodes, part.edges);
+		return true;
+
+	}
+
+	static std::vector<component> find_components(const ogdf::Graph & graph) {
+
+		// union-find over node indices
+		std::vector<int> roots(graph.maxNodeIndex() + 1);
+		std::iota(roots.begin(), roots.end(), 0);
+
+		auto find_root = [&roots](int index) {
+			while(roots[index] != index)
+				index = roots[index] = roots[roots[index]];
+			return index;
+		};
+
+		for(ogdf::edge e : graph.edges)
+			roots[find_root(e->source()->index())] = find_root(e->target()->index());
+
+		std::vector<int> component_of(roots.size(), -1);
+		std::vector<component> components;
+		for(ogdf::node v : graph.nodes) {
+
+			int & number = component_of[find_root(v->index())];
+			if(number < 0) {
+				number = components.size();
+				components.emplace_back();
+			}
+
+			components[number].nodes.push_back(v);
+
+		}
+
+		for(ogdf::edge e : graph.edges)
+			components[component_of[find_root(e->source()->index())]].edges.push_back(e);
+
+		return components;
+
+	}
+
+	/** shelf packing, tallest components first, in rows about as wide as the packing is tall */
+	static void pack(ogdf::GraphAttributes & attributes, const std::vector<component> & components,
+					 const std::vector<std::unique_ptr<layout_copy>> & copies) {
+
+		std::vector<std::vector<double>> extents;
+		double total_area = 0, widest = 0;
+		for(const std::unique_ptr<layout_copy> & copy : copies) {
+
+			extents.push_back(extent(copy->attributes));
+			total_area += (extents.back()[2] + COMPONENT_SPACING) * (extents.back()[3] + COMPONENT_SPACING);
+			widest = std::max(widest, extents.back()[2]);
+
+		}
+
+		std::vector<std::size_t> order(copies.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&extents](std::size_t first, std::size_t second) {
+			return extents[first][3] > extents[second][3];
+		});
+
+		const double row_width = std::max(widest, std::sqrt(total_area));
+
+		double x = 0, y = 0, row_height = 0;
+		for(std::size_t pos : order) {
+
+			const std::vector<double> & extent = extents[pos];
+			if(x > 0 && x + extent[2] > row_width) {
+				x = 0;
+				y += row_height + COMPONENT_SPACING;
+				row_height = 0;
+			}
+
+			copies[pos]->copy_to(attributes, components[pos], x - extent[0], y - extent[1]);
+
+			x += extent[2] + COMPONENT_SPACING;
+			row_height = std::max(row_height, extent[3]);
+
+		}
+
+	}
+
+	static std::string describe_cached(std::size_t number_nodes) {
+		return "srcUML layout: " + std::to_string(number_nodes) + " classes from the layout cache";
+	}
+
+	std::string describe(layout_engine engine, int number_nodes, const std::string & reason) const {
+
+		static const char * const engines[] = {
+			"OptimalRanking, OptimalHierarchyLayout",
+			"LongestPathRanking, FastHierarchyLayout",
+			"LongestPathRanking, FastSimpleHierarchyLayout"
+		};
+
+		std::string description = std::string("srcUML layout: ") + engines[engine] + ", " + std::to_string(number_nodes) + " classes";
+		if(crossmin_runs > 1)
+			description += ", fewest crossings of " + std::to_string(crossmin_runs) + " runs";
+		if(!reason.empty())
+			description += " (" + reason + ")";
+
+		return description;
+
+	}
+
+};
+
+#endif
@@ -0,0 +1,366 @@
+/**
+ * @file svg_layout_cache.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_LAYOUT_CACHE_HPP
+#define INCLUDED_SVG_LAYOUT_CACHE_HPP
+
+#include <srcuml_serialize.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/GraphAttributes.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+/**
+ * svg_layout_cache
+ *
+ * Laid out drawings of graphs keyed by a fingerprint of their node labels,
+ * sizes and edges, kept in a file between runs.  Each save counts as a
+ * generation of the file, and a drawing not used for KEPT_GENERATIONS saves
+ * is dropped, so the file does not grow with every edit.
+ */
+class svg_layout_cache {
+
+public:
+
+	static const std::uint64_t VERSION = 2;
+
+	// saves a drawing outlives its last use by
+	static const std::uint64_t KEPT_GENERATIONS = 16;
+
+	/** node positions and the bends of each edge, in graph order */
+	struct drawing {
+
+		std::vector<ogdf::DPoint> positions;
+		std::vector<std::vector<ogdf::DPoint>> bends;
+
+		// generation of the file that last saved it as used
+		std::uint64_t generation = 0;
+
+	};
+
+private:
+
+	std::string path;
+	std::unordered_map<std::uint64_t, drawing> drawings;
+	std::unordered_set<std::uint64_t> used;
+
+	// lookups of find that found an entry and that did not
+	std::size_t hits;
+	std::size_t misses;
+
+public:
+
+	/** an unreadable or outdated file starts an empty cache */
+	svg_layout_cache(const std::string & path) : path(path), drawings(), used(), hits(0), misses(0) {
+
+		read(path, drawings);
+
+	}
+
+	static std::uint64_t fingerprint(const ogdf::GraphAttributes & attributes,
+									 const std::vector<ogdf::node> & nodes, const std::vector<ogdf::edge> & edges) {
+
+		std::vector<int> positions;
+		return fingerprint(attributes, nodes, edges, positions);
+
+	}
+
+	/**
+	 * positions is a buffer shared by the parts of one graph, e.g. its components:
+	 * it is sized to the graph once and only the entries of the nodes are reset.
+	 */
+	static std::uint64_t fingerprint(const ogdf::GraphAttributes & attributes,
+									 const std::vector<ogdf::node> & nodes, const std::vector<ogdf::edge> & edges,
+									 std::vector<int> & positions) {
+
+		if(positions.size() < static_cast<std::size_t>(attributes.constGraph().maxNodeIndex() + 1))
+			positions.resize(attributes.constGraph().maxNodeIndex() + 1, -1);
+
+		std::uint64_t value = srcuml::hash(nullptr, 0);
+		for(std::size_t pos = 0; pos < nodes.size(); ++pos) {
+
+			positions[nodes[pos]->index()] = pos;
+
+			const std::string & label = attributes.label(nodes[pos]);
+			value = srcuml::hash(label.data(), label.size(), value);
+			value = hash_value(attributes.width(nodes[pos]), value);
+			value = hash_value(attributes.height(nodes[pos]), value);
+
+		}
+
+		for(ogdf::edge e : edges) {
+			value = hash_value(positions[e->source()->index()], value);
+			value = hash_value(positions[e->target()->index()], value);
+		}
+
+		for(ogdf::node v : nodes)
+			positions[v->index()] = -1;
+
+		return value;
+
+	}
+
+	/** nullptr on a miss */
+	const drawing * find(std::uint64_t fingerprint) {
+
+		std::unordered_map<std::uint64_t, drawing>::const_iterator itr = drawings.find(fingerprint);
+		if(itr == drawings.end()) {
+			++misses;
+			return nullptr;
+		}
+
+		++hits;
+		used.insert(fingerprint);
+		return &itr->second;
+
+	}
+
+	/** lookups of find that found an entry */
+	std::size_t get_hits() const {
+		return hits;
+	}
+
+	/** lookups of find that found none */
+	std::size_t get_misses() const {
+		return misses;
+	}
+
+	void store(std::uint64_t fingerprint, const ogdf::GraphAttributes & attributes,
+			   const std::vector<ogdf::node> & nodes, const std::vector<ogdf::edge> & edges) {
+
+		drawing & entry = drawings[fingerprint];
+		entry.positions.clear();
+		entry.bends.clear();
+
+		for(ogdf::node v : nodes)
+			entry.positions.emplace_back(attributes.x(v), attributes.y(v));
+
+		for(ogdf::edge e : edges) {
+
+			entry.bends.emplace_back();
+			for(const ogdf::DPoint & point : attributes.bends(e))
+				entry.bends.back().push_back(point);
+
+		}
+
+		used.insert(fingerprint);
+
+	}
+
+	static void apply(const drawing & entry, ogdf::GraphAttributes & attributes,
+					  const std::vector<ogdf::node> & nodes, const std::vector<ogdf::edge> & edges) {
+
+		for(std::size_t pos = 0; pos < nodes.size(); ++pos) {
+			attributes.x(nodes[pos]) = entry.positions[pos].m_x;
+			attributes.y(nodes[pos]) = entry.positions[pos].m_y;
+		}
+
+		for(std::size_t pos = 0; pos < edges.size(); ++pos) {
+
+			ogdf::DPolyline & bends = attributes.bends(edges[pos]);
+			bends.clear();
+			for(const ogdf::DPoint & point : entry.bends[pos])
+				bends.pushBack(point);
+
+		}
+
+	}
+
+	/**
+	 * Merges the drawings found or stored since the cache was loaded into the file
+	 * as it is now, under a lock, so outputters sharing the file, e.g. svg_sugiyama
+	 * and layout_json, or other runs keep each other's drawings.  The merge is
+	 * written to a temporary file that is renamed, so the file is never read partial.
+	 */
+	void save() const {
+
+		const boost::filesystem::path cache_path(path);
+		const std::string lock_path = path + ".lock";
+		const int lock = ::open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+		if(lock == -1 || ::flock(lock, LOCK_EX) == -1) {
+			if(lock != -1)
+				::close(lock);
+			throw std::string("Error: Unable to lock layout cache ") + path;
+		}
+
+		try {
+
+			std::unordered_map<std::uint64_t, drawing> merged;
+			const std::uint64_t generation = read(path, merged) + 1;
+
+			for(std::unordered_map<std::uint64_t, drawing>::iterator itr = merged.begin(); itr != merged.end();) {
+				if(itr->second.generation + KEPT_GENERATIONS < generation)
+					itr = merged.erase(itr);
+				else
+					++itr;
+			}
+
+			for(std::uint64_t fingerprint : used) {
+				drawing & entry = merged[fingerprint] = drawings.at(fingerprint);
+				entry.generation = generation;
+			}
+
+			const boost::filesystem::path temp_path = cache_path.parent_path() / boost::filesystem::unique_path(cache_path.filename().string() + ".%%%%-%%%%.tmp");
+			{
+				std::ofstream out(temp_path.string(), std::ios::binary);
+				if(!out)
+					throw std::string("Error: Unable to write layout cache ") + path;
+
+				write(out, generation, merged);
+			}
+
+			boost::filesystem::rename(temp_path, cache_path);
+
+		} catch(...) {
+			::close(lock);
+			throw;
+		}
+
+		// closing releases the lock
+		::close(lock);
+
+	}
+
+private:
+
+	/** the drawings of the file at path, returns its generation, an unreadable or outdated file has none */
+	static std::uint64_t read(const std::string & path, std::unordered_map<std::uint64_t, drawing> & drawings) {
+
+		std::ifstream in(path, std::ios::binary);
+		if(!in) return 0;
+
+		try {
+
+			if(srcuml::read_size(in) != VERSION)
+				return 0;
+
+			const std::uint64_t generation = srcuml::read_size(in);
+			std::uint64_t number_drawings = srcuml::read_size(in);
+			for(std::uint64_t pos = 0; pos < number_drawings; ++pos) {
+
+				std::uint64_t fingerprint = srcuml::read_size(in);
+				drawing & entry = drawings[fingerprint];
+				entry.generation = srcuml::read_size(in);
+
+				std::uint64_t number_nodes = srcuml::read_size(in);
+				for(std::uint64_t node_pos = 0; node_pos < number_nodes; ++node_pos)
+					entry.positions.push_back(read_point(in));
+
+				std::uint64_t number_edges = srcuml::read_size(in);
+				entry.bends.resize(number_edges);
+				for(std::vector<ogdf::DPoint> & bends : entry.bends) {
+
+					std::uint64_t number_bends = srcuml::read_size(in);
+					for(std::uint64_t bend_pos = 0; bend_pos < number_bends; ++bend_pos)
+						bends.push_back(read_point(in));
+
+				}
+
+			}
+
+			return generation;
+
+		} catch(const std::string &) {
+			drawings.clear();
+			return 0;
+		}
+
+	}
+
+	static void write(std::ostream & out, std::uint64_t generation, const std::unordered_map<std::uint64_t, drawing> & drawings) {
+
+		srcuml::write_size(out, VERSION);
+		srcuml::write_size(out, generation);
+		srcuml::write_size(out, drawings.size());
+		for(const std::pair<const std::uint64_t, drawing> & fingerprint_entry : drawings) {
+
+			const drawing & entry = fingerprint_entry.second;
+			srcuml::write_size(out, fingerprint_entry.first);
+			srcuml::write_size(out, entry.generation);
+
+			srcuml::write_size(out, entry.positions.size());
+			for(const ogdf::DPoint & point : entry.positions)
+				write_point(out, point);
+
+			srcuml::write_size(out, entry.bends.size());
+			for(const std::vector<ogdf::DPoint> & bends : entry.bends) {
+
+				srcuml::write_size(out, bends.size());
+				for(const ogdf::DPoint & point : bends)
+					write_point(out, point);
+
+			}
+
+		}
+
+	}
+
+	template<typename value_type>
+	static std::uint64_t hash_value(value_type value, std::uint64_t seed) {
+		return srcuml::hash(reinterpret_cast<const char *>(&value), sizeof(value), seed);
+	}
+
+	static void write_double(std::ostream & out, double value) {
+
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		srcuml::write_size(out, bits);
+
+	}
+
+	static double read_double(std::istream & in) {
+
+		std::uint64_t bits = srcuml::read_size(in);
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+
+	}
+
+	static void write_point(std::ostream & out, const ogdf::DPoint & point) {
+		write_double(out, point.m_x);
+		write_double(out, point.m_y);
+	}
+
+	static ogdf::DPoint read_point(std::istream & in) {
+
+		double x = read_double(in);
+		return ogdf::DPoint(x, read_double(in));
+
+	}
+
+};
+
+#endif
@@ -3,189 +3,200 @@
 
 
 #include <svg_outputter.hpp>
-
+#include <svg_layout.hpp>
+#include <srcuml_options.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <map>
+#include <set>
+#include <memory>
+#include <fstream>
+
+/**
+ * svg_multi_outputter
+ *
+ * Multi-cluster layout from layout_design.txt.  Classes are clustered by
+ * namespace or by the directory of their unit, each cluster is laid out on
+ * its own in parallel, and the clusters are placed by laying out the graph
+ * of clusters.  Writes the summary, every cluster boxed in place, and
+ * optionally one SVG per cluster.
+ */
 class svg_multi_outputter : public svg_outputter {
 
 public:
 
-	svg_multi_outputter(){
-		ga.init(g,
-		GraphAttributes::nodeGraphics |
-		GraphAttributes::edgeGraphics |
-		GraphAttributes::nodeLabel |
-		GraphAttributes::edgeLabel |
-		GraphAttributes::nodeStyle |
-		GraphAttributes::edgeStyle |
-		GraphAttributes::nodeTemplate);
+	// space around the classes of a cluster inside its box
+	static constexpr double CLUSTER_MARGIN = 20.0;
+
+	/** an empty directory only writes the summary, layout_budget in milliseconds, see svg_layout */
+	svg_multi_outputter(cluster_source source = NAMESPACE_CLUSTERS, const std::string & directory = "",
+						std::size_t threads = 1, std::size_t layout_budget = 0)
+		: source(source), directory(directory), threads(threads), layout(layout_budget) {
+		reset_graph();
+	}
+
+	/** graphs of more than nodes classes use a fast layout, see svg_layout */
+	void use_optimal_limit(std::size_t nodes){
+		layout.use_optimal_limit(nodes);
 	}
 
 	bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+		srcuml_stats::timer graph_timer(get_stats(), "graph");
+		reset_graph();
+
 		//transfer information from srcUML to ogdf
 		srcuml_relationships relationships = analyze_relationships(classes);
-		std::map<std::string, node> class_node_map;
+		std::unordered_map<srcuml_symbol, std::size_t> class_positions;
 
-		//Classes/Nodes
+		//Clusters
 		//===============================================================================================================
+		std::map<std::string, std::size_t> cluster_numbers;
+		std::vector<std::unique_ptr<cluster_drawing>> clusters;
+		std::vector<std::size_t> cluster_of;
 		for(const std::shared_ptr<srcuml_class> & aclass : classes){
-			node cur_node = g.newNode();
-			//Insert into map the node class pairing
-			class_node_map.insert(std::pair<std::string, node>(aclass->get_srcuml_name(), cur_node));
+			std::string name = cluster_name(*aclass);
+			std::map<std::string, std::size_t>::const_iterator itr = cluster_numbers.find(name);
+			if(itr == cluster_numbers.end()){
+				itr = cluster_numbers.emplace(name, clusters.size()).first;
+				clusters.emplace_back(new cluster_drawing(name));
+			}
+			cluster_of.push_back(itr->second);
+		}
+		//===============================================================================================================
+
+		//Classes/Nodes
+		//===============================================================================================================
+		std::vector<node> class_nodes;
+		std::vector<svg_label> labels;
+		std::vector<node> cluster_nodes;
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			const std::shared_ptr<srcuml_class> & aclass = classes[pos];
+			//a name defined twice is the last definition, as in srcuml_class_table
+			class_positions[aclass->get_name_symbol()] = pos;
 
-			std::string& label = ga.label(cur_node);
 			int num_lines = 0;
 			int longest_line = 0;
-			label = generate_label(aclass, num_lines, longest_line);
+			const svg_label label = generate_label(aclass, num_lines, longest_line);
+
+			class_nodes.push_back(add_node(g, cga, aclass->get_srcuml_name(), num_lines, longest_line));
+			set_label(labels, class_nodes.back(), label);
+			cluster_drawing & cluster = *clusters[cluster_of[pos]];
+			cluster_nodes.push_back(add_node(cluster.graph, cluster.attributes, aclass->get_srcuml_name(), num_lines, longest_line));
+			set_label(cluster.labels, cluster_nodes.back(), label);
+			cluster.nodes.push_back(class_nodes.back());
+			cluster.cluster_nodes.push_back(cluster_nodes.back());
+		}
+		//===============================================================================================================
 
-			double& h = ga.height(cur_node);
-			h = num_lines * 1.3 * 10;//num_lines * 50;
+		//Relationships/Edges
+		//===============================================================================================================
+		svg_arrows arrows(g, std::make_pair(NoEnd, NoEnd));
+		std::set<std::pair<std::size_t, std::size_t>> cluster_edges;
+		std::vector<ogdf::edge> edges_between;
+
+		//relationships between the same classes are merged into the strongest
+		for(const srcuml_edge & edge : merge_edges(relationships, false)){
 
-			double& w = ga.width(cur_node);
-			w = longest_line * .75 * 10;//longest_line * 10;
-		
-			Color& color = ga.fillColor(cur_node);
-			color = Color(Color::Name::Antiquewhite);
+			const std::size_t lhs = class_positions[edge.source];
+			const std::size_t rhs = class_positions[edge.destination];
+
+			ogdf::edge cur_edge = add_edge(g, cga, class_nodes[lhs], class_nodes[rhs], edge.type, arrows, edge.weight);
+
+			if(cluster_of[lhs] == cluster_of[rhs]){
+				cluster_drawing & cluster = *clusters[cluster_of[lhs]];
+				cluster.edges.push_back(cur_edge);
+				cluster.cluster_edges.push_back(add_edge(cluster.graph, cluster.attributes, cluster_nodes[lhs], cluster_nodes[rhs], edge.type, cluster.arrows, edge.weight));
+			}else{
+				cluster_edges.insert(std::make_pair(std::min(cluster_of[lhs], cluster_of[rhs]), std::max(cluster_of[lhs], cluster_of[rhs])));
+				edges_between.push_back(cur_edge);
+			}
 		}
 		//===============================================================================================================
 
+		//Layout
+		//===============================================================================================================
+		graph_timer.stop();
+		srcuml_stats::timer layout_timer(get_stats(), "layout");
+		layout.use_cancel(get_cancel());
+
+		srcuml::parallel_ranges(clusters.size(), threads, [&](std::size_t first, std::size_t last) {
+			for(std::size_t pos = first; pos < last; ++pos)
+				layout.call(clusters[pos]->attributes);
+		});
+
+		//each cluster is a node of the size of its drawing
+		Graph quotient;
+		GraphAttributes quotient_attributes(quotient, GraphAttributes::nodeGraphics | GraphAttributes::edgeGraphics);
+		std::vector<node> quotient_nodes;
+		std::vector<std::vector<double>> extents;
+		for(const std::unique_ptr<cluster_drawing> & cluster : clusters){
+			extents.push_back(svg_layout::extent(cluster->attributes));
+			quotient_nodes.push_back(quotient.newNode());
+			quotient_attributes.width(quotient_nodes.back()) = extents.back()[2] + 2 * CLUSTER_MARGIN;
+			quotient_attributes.height(quotient_nodes.back()) = extents.back()[3] + 2 * CLUSTER_MARGIN;
+		}
 
-		 
+		for(const std::pair<std::size_t, std::size_t> & cluster_edge : cluster_edges)
+			quotient.newEdge(quotient_nodes[cluster_edge.first], quotient_nodes[cluster_edge.second]);
 
-		//Relationships/Edges
-		//===============================================================================================================
-		std::multimap<std::pair<node, node>, relationship_type> edge_type_map;
-		std::map<std::pair<node, edge>, std::string> ne_arrow;
+		const std::string layout_description = layout.call(quotient_attributes);
 
-		for(const srcuml_relationship relationship : relationships.get_relationships()){
-			//get the nodes from graph g, create edge and add appropriate info.
-			node lhs, rhs;
+		//move each cluster drawing into the box of its node
+		for(std::size_t pos = 0; pos < clusters.size(); ++pos){
+			const cluster_drawing & drawing = *clusters[pos];
+			const double dx = quotient_attributes.x(quotient_nodes[pos]) - (extents[pos][0] + extents[pos][2] / 2);
+			const double dy = quotient_attributes.y(quotient_nodes[pos]) - (extents[pos][1] + extents[pos][3] / 2);
 
-			std::map<std::string, node>::iterator src_it = class_node_map.find(relationship.get_source());
-			if(src_it != class_node_map.end()){
-				lhs = src_it->second;
+			SList<node> members;
+			for(std::size_t node_pos = 0; node_pos < drawing.nodes.size(); ++node_pos){
+				cga.x(drawing.nodes[node_pos]) = drawing.attributes.x(drawing.cluster_nodes[node_pos]) + dx;
+				cga.y(drawing.nodes[node_pos]) = drawing.attributes.y(drawing.cluster_nodes[node_pos]) + dy;
+				members.pushBack(drawing.nodes[node_pos]);
 			}
 
-			std::map<std::string, node>::iterator dest_it = class_node_map.find(relationship.get_destination());
-			if(dest_it != class_node_map.end()){
-				rhs = dest_it->second;
+			for(std::size_t edge_pos = 0; edge_pos < drawing.edges.size(); ++edge_pos){
+				DPolyline & bends = cga.bends(drawing.edges[edge_pos]);
+				bends.clear();
+				for(const DPoint & point : drawing.attributes.bends(drawing.cluster_edges[edge_pos]))
+					bends.pushBack(DPoint(point.m_x + dx, point.m_y + dy));
 			}
 
-			//find possible occurnce of edge already
-			auto itr = edge_type_map.find( std::pair<node, node>(lhs, rhs) );
+			cluster c = cg.createCluster(members);
+			cga.label(c) = drawing.name;
+			cga.x(c) = extents[pos][0] + dx - CLUSTER_MARGIN;
+			cga.y(c) = extents[pos][1] + dy - CLUSTER_MARGIN;
+			cga.width(c) = extents[pos][2] + 2 * CLUSTER_MARGIN;
+			cga.height(c) = extents[pos][3] + 2 * CLUSTER_MARGIN;
+			cga.strokeColor(c) = Color(0, 0, 0, 255);
+			cga.strokeWidth(c) = 1.5;
+		}
 
-			//If edge doesn't exist, add it
-			if(itr == edge_type_map.end()){
-				edge_type_map.insert(std::pair<std::pair<node,node>, 
-					relationship_type> (std::pair<node,node>(lhs,rhs), relationship.get_type()) );
-				edge_type_map.insert(std::pair<std::pair<node,node>, 
-					relationship_type> (std::pair<node,node>(rhs,lhs), NONE_TYPE ) );
+		//edges between clusters are drawn straight
+		for(ogdf::edge e : edges_between)
+			cga.bends(e).clear();
 
-			//if edge does exist, check that the new relation isn't stronger
-			}else{
-				if(itr->second == ASSOCIATION && (relationship.get_type() == BIDIRECTIONAL 
-											   || relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}else if(itr->second == BIDIRECTIONAL && (relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}else if(itr->second == AGGREGATION && (relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}
-			}
-			
-		}
+		layout_timer.stop();
 
-		//after do a loop to add to graph
-		for(auto edge : edge_type_map){
-
-			if(edge.second == NONE_TYPE)continue;
-			//edge.first.first  = source 
-			//edge.first.second = destination
-			//edge.second       = relationship type
-
-			ogdf::edge cur_edge = g.newEdge(edge.first.first, edge.first.second);
-
-			ga.strokeWidth(cur_edge) = 2;
-
-			StrokeType &st = ga.strokeType(cur_edge);
-			EdgeArrow &ea = ga.arrowType(cur_edge);
-			Graph::EdgeType &et = ga.type(cur_edge);
-
-			const relationship_type r_type = edge.second;
-			switch(r_type){
-			case DEPENDENCY:
-				st = StrokeType::Dash;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::dependency;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "none"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
-				break;
-			case ASSOCIATION:
-				st = StrokeType::Solid;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "none"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
-				break;
-			case BIDIRECTIONAL:
-				st = StrokeType::Solid;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "filled_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
-				break;
-			case AGGREGATION:
-				st = StrokeType::Solid;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_diamond"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
-				break;
-			case COMPOSITION:
-				st = StrokeType::Solid;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "filled_diamond"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
-				break;
-			case GENERALIZATION:
-				st = StrokeType::Dash;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::generalization;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
-				break;
-			case REALIZATION:
-				st = StrokeType::Dash;
-				ea = EdgeArrow::Both;
-				et = Graph::EdgeType::generalization;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
-				break;
+		GraphIO::SVGSettings svg_settings;
+
+		if(!directory.empty()){
+			for(const std::unique_ptr<cluster_drawing> & cluster : clusters){
+				std::ofstream cluster_out(directory + "/" + file_name(cluster->name) + ".svg");
+				if(!cluster_out)
+					throw std::string("Error: Unable to write cluster SVG to ") + directory;
+
+				drawSVG(cluster->attributes, cluster_out, svg_settings, cluster->arrows, cluster->labels, cluster->name);
 			}
 		}
-		//===============================================================================================================
 
-		//Layout
-		//===============================================================================================================
+		const std::string description = std::to_string(clusters.size()) + " clusters, " + layout_description;
+		if(get_stats())
+			get_stats()->set_note("svg_multi layout", description);
 
-		SugiyamaLayout sl;
-		sl.setRanking(new OptimalRanking);
-		sl.setCrossMin(new MedianHeuristic);
- 
-		OptimalHierarchyLayout *ohl = new OptimalHierarchyLayout;
-		ohl->layerDistance(50.0);
-		ohl->nodeDistance(50.0);
-		ohl->weightBalancing(1);
-		sl.setLayout(ohl);
-
-		sl.call(ga);
-
-		GraphIO::SVGSettings * svg_settings = new ogdf::GraphIO::SVGSettings();
-		
-		if(!drawSVG(ga, out, *svg_settings, ne_arrow)){
-			std::cout << "Error Write" << std::endl;
+		if(!drawSVG(cga, out, svg_settings, arrows, labels, description)){
+			throw std::string("Error: Unable to write the svg_multi drawing");
 		}
+		drawTiles(cga, svg_settings, arrows, labels);
 
 		//===============================================================================================================
 
@@ -195,9 +206,158 @@ public:
 
 private:
 
-	Graph g;
+	/** graph of the classes of one cluster, laid out on its own */
+	struct cluster_drawing {
+
+		std::string name;
+
+		Graph graph;
+		GraphAttributes attributes;
+
+		// summary and cluster graph nodes and edges of the same classes, in the same order
+		std::vector<node> nodes;
+		std::vector<node> cluster_nodes;
+		std::vector<ogdf::edge> edges;
+		std::vector<ogdf::edge> cluster_edges;
+
+		svg_arrows arrows;
+		std::vector<svg_label> labels;
+
+		cluster_drawing(const std::string & name) : name(name), graph(), attributes(), nodes(), cluster_nodes(), edges(), cluster_edges(), arrows(graph, std::make_pair(NoEnd, NoEnd)), labels() {
+			attributes.init(graph,
+			GraphAttributes::nodeGraphics |
+			GraphAttributes::edgeGraphics |
+			GraphAttributes::nodeLabel |
+			GraphAttributes::edgeLabel |
+			GraphAttributes::nodeStyle |
+			GraphAttributes::edgeStyle |
+			GraphAttributes::nodeTemplate);
+		}
+
+	};
+
+	std::string cluster_name(const srcuml_class & aclass) const {
+
+		if(source == DIRECTORY_CLUSTERS){
+			const std::string & filename = aclass.get_filename();
+			std::string::size_type end = filename.find_last_of("/\\");
+			return end == std::string::npos ? "." : filename.substr(0, end);
+		}
+
+		//qualifier the class was defined with
+		const std::string & qualified = srcuml::symbol_name(aclass.get_name_symbol());
+		const std::string suffix = "::" + aclass.get_name();
+		if(qualified.size() > suffix.size() && qualified.compare(qualified.size() - suffix.size(), suffix.size(), suffix) == 0)
+			return qualified.substr(0, qualified.size() - suffix.size());
+
+		return "(global)";
+
+	}
+
+	static std::string file_name(const std::string & cluster) {
+
+		std::string name = cluster;
+		for(char & c : name)
+			if(!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.')
+				c = '_';
+
+		return name;
+
+	}
+
+	static node add_node(Graph & graph, GraphAttributes & attributes, const std::string & label, int num_lines, int longest_line) {
 
-	GraphAttributes ga;
+		node cur_node = graph.newNode();
+
+		attributes.label(cur_node) = label;
+		attributes.height(cur_node) = num_lines * 1.3 * 10;//num_lines * 50;
+		attributes.width(cur_node) = longest_line * .75 * 10;//longest_line * 10;
+		attributes.fillColor(cur_node) = Color(Color::Name::Antiquewhite);
+
+		return cur_node;
+
+	}
+
+	static ogdf::edge add_edge(Graph & graph, GraphAttributes & attributes, node lhs, node rhs, relationship_type r_type,
+							   svg_arrows & arrows, std::size_t weight = 1) {
+
+		ogdf::edge cur_edge = graph.newEdge(lhs, rhs);
+
+		attributes.strokeWidth(cur_edge) = edge_width(2, weight);
+
+		StrokeType &st = attributes.strokeType(cur_edge);
+		EdgeArrow &ea = attributes.arrowType(cur_edge);
+		Graph::EdgeType &et = attributes.type(cur_edge);
+
+		switch(r_type){
+		case DEPENDENCY:
+			st = StrokeType::Dash;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::dependency;
+			arrows[cur_edge] = std::make_pair(NoEnd, FilledTriangle);
+			break;
+		case ASSOCIATION:
+			st = StrokeType::Solid;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::association;
+			arrows[cur_edge] = std::make_pair(NoEnd, FilledTriangle);
+			break;
+		case BIDIRECTIONAL:
+			st = StrokeType::Solid;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::association;
+			arrows[cur_edge] = std::make_pair(FilledTriangle, FilledTriangle);
+			break;
+		case AGGREGATION:
+			st = StrokeType::Solid;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::association;
+			arrows[cur_edge] = std::make_pair(HollowDiamond, NoEnd);
+			break;
+		case COMPOSITION:
+			st = StrokeType::Solid;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::association;
+			arrows[cur_edge] = std::make_pair(FilledDiamond, NoEnd);
+			break;
+		case GENERALIZATION:
+			st = StrokeType::Dash;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::generalization;
+			arrows[cur_edge] = std::make_pair(HollowTriangle, NoEnd);
+			break;
+		case REALIZATION:
+			st = StrokeType::Dash;
+			ea = EdgeArrow::Both;
+			et = Graph::EdgeType::generalization;
+			arrows[cur_edge] = std::make_pair(HollowTriangle, NoEnd);
+			break;
+		}
+
+		return cur_edge;
+
+	}
+
+	/** an empty graph, so every output starts afresh, see output */
+	void reset_graph(){
+		g.clear();
+		cg.init(g);
+		cga.init(cg,
+		GraphAttributes::nodeGraphics |
+		GraphAttributes::edgeGraphics |
+		GraphAttributes::nodeLabel |
+		GraphAttributes::edgeLabel |
+		GraphAttributes::nodeStyle |
+		GraphAttributes::edgeStyle |
+		GraphAttributes::nodeTemplate);
+	}
+
+	cluster_source source;
+	std::string directory;
+	std::size_t threads;
+	svg_layout layout;
+
+	Graph g;
 
 	ClusterGraph cg;
 
@@ -205,4 +365,4 @@ private:
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -48,6 +48,9 @@
 //Input_Output_Include===============================================
 #include <ogdf/fileformats/GraphIO.h>
 #include <svg_printer.hpp>
+#include <svg_label.hpp>
+#include <svg_tiles.hpp>
+#include <svg_patch.hpp>
 //===================================================================
 
 //Layout_Include=====================================================
@@ -65,82 +68,256 @@
 #include <ogdf/module/HierarchyClusterLayoutModule.h>
 //===================================================================
 
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
 
 using namespace ogdf;
 using namespace ogdf::internal;
 
 class svg_outputter : public srcuml_outputter{
 
+private:
+
+	// drawings also written as tiles
+	svg_tiles tiles;
+	// threads SvgPrinter draws nodes and edges on
+	std::size_t draw_threads = 1;
+	// attribute and operation lines of a class beyond which they are drawn as counts
+	std::size_t member_lines = static_cast<std::size_t>(-1);
+	// attributes, and operations, of a class drawn before the rest is drawn as a count, 0 draws every one
+	std::size_t max_members = 0;
+	// whether edges passing over other nodes are drawn over them, see SvgPrinter::setRaiseCrossingEdges
+	bool raise_edges = false;
+	// file the changes to the drawing are written to and file of the drawing they are made against, see svg_patch
+	std::string patch_file;
+	std::string patch_state;
+
 public:
 
 	virtual bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes) = 0;
 
-	std::string generate_label(const std::shared_ptr<srcuml_class> & aclass, int &num_lines, int &longest_line){
-		std::string label;
-		if(aclass->get_srcuml_name() != aclass->get_name()){
-			label += aclass->get_srcuml_name().substr(0, aclass->get_srcuml_name().find(aclass->get_name())) + "<svg_new_line>";
-			++num_lines;
-			if(aclass->get_srcuml_name().length() > longest_line){longest_line = aclass->get_srcuml_name().length();}
+	/** compartments of name, attributes and operations, num_lines and longest_line size the box */
+	svg_label generate_label(const std::shared_ptr<srcuml_class> & aclass, int &num_lines, int &longest_line){
+		svg_label label;
+
+		std::vector<svg_label_line> name;
+		// the kind prefix, if any, is drawn on a line of its own
+		const std::string & srcuml_name = aclass->get_srcuml_name();
+		if(srcuml_name.size() != aclass->get_name().size()){
+			name.push_back({ srcuml_name.substr(0, srcuml_name.size() - aclass->get_name().size()), false });
 		}
-		label += aclass->get_name();
-		++num_lines;
-		if(aclass->get_name().length() > longest_line){longest_line = aclass->get_name().length();}
-		label += "<svg_box_divide>";
-		++num_lines;
-		for(const srcuml_attribute & attribute : aclass->get_attributes()){
-			label += attribute.get_string_attribute() + "<svg_new_line>";
-			++num_lines;
-			if(attribute.get_string_attribute().length() > longest_line){longest_line = attribute.get_string_attribute().length();}
+		name.push_back({ aclass->get_name(), false });
+		label.compartments.push_back(name);
+
+		const std::vector<srcuml_member_label> & attributes = aclass->get_attribute_labels();
+		const std::vector<srcuml_member_label> & operations = aclass->get_operation_labels();
+		if(attributes.size() + operations.size() > member_lines){
+			label.compartments.push_back({ { std::to_string(attributes.size()) + " attributes", false } });
+			label.compartments.push_back({ { std::to_string(operations.size()) + " operations", false } });
+		}else{
+			label.compartments.emplace_back();
+			add_members(label.compartments.back(), attributes);
+
+			label.compartments.emplace_back();
+			add_members(label.compartments.back(), operations);
+		}
+
+		num_lines = label.number_rows();
+		longest_line = label.longest_line();
+		return label;
+	}
+
+	/** visibility prefixes, public members are kept before protected and private ones */
+	static int visibility_rank(const srcuml_member_label &member){
+		switch(member.text.empty() ? ' ' : member.text[0]){
+			case '+': return 0;
+			case '#': return 1;
+			case '-': return 2;
+			default: return 3;
 		}
-		label += "<svg_box_divide>";
-		++num_lines;
+	}
 
+	/** with max_members, only the first members by visibility are drawn, in their own order, then how many are not */
+	void add_members(std::vector<svg_label_line> &compartment, const std::vector<srcuml_member_label> &members) const {
+		if(max_members == 0 || members.size() <= max_members){
+			for(const srcuml_member_label & member : members){
+				compartment.push_back({ member.text, member.is_static });
+			}
+			return;
+		}
 
-		for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
-			for(const FunctionPolicy::FunctionData * function : aclass->get_data().methods[access]) { //private members
-				srcuml_operation op(function, (ClassPolicy::AccessSpecifier)access);
+		std::vector<std::size_t> order(members.size());
+		for(std::size_t pos = 0; pos < order.size(); ++pos)
+			order[pos] = pos;
+		std::stable_sort(order.begin(), order.end(), [&members](std::size_t first, std::size_t second){
+			return visibility_rank(members[first]) < visibility_rank(members[second]);
+		});
+		order.resize(max_members);
+		std::sort(order.begin(), order.end());
 
-				std::string func = op.get_string_function();
+		for(std::size_t pos : order){
+			compartment.push_back({ members[pos].text, members[pos].is_static });
+		}
+		compartment.push_back({ "\xe2\x80\xa6 " + std::to_string(members.size() - max_members) + " more", false });
+	}
 
-				if(op.get_stereotypes().count("set") > 0){continue;}
-				if(op.get_stereotypes().count("get") > 0){continue;}
-				
+	bool drawSVG(const GraphAttributes &A, const std::string &filename, const GraphIO::SVGSettings &settings, const svg_arrows &arrows,
+				 const std::vector<svg_label> &labels){
+		std::ofstream os(filename);
+		return drawSVG(A, os, settings, arrows, labels);
+	}
 
-				label += func;
+	bool drawSVG(const ClusterGraphAttributes &A, const std::string &filename, const GraphIO::SVGSettings &settings, const svg_arrows &arrows,
+				 const std::vector<svg_label> &labels){
+		std::ofstream os(filename);
+		return drawSVG(A, os, settings, arrows, labels);
+	}
 
+	/**
+	 * Adds a node per class to the empty g, nodes by class position, then an edge per merged
+	 * edge, in their order.  Build before attaching the attributes, so their arrays are
+	 * allocated once at the size of the graph instead of growing with it.  A name shared by
+	 * classes ends its edges at the first of them.
+	 */
+	static void build_graph(Graph &g, const std::vector<std::shared_ptr<srcuml_class>> &classes, const std::vector<srcuml_edge> &merged,
+							std::vector<node> &nodes, std::vector<ogdf::edge> &edges){
+		std::unordered_map<srcuml_symbol, node> class_nodes;
+		class_nodes.reserve(classes.size());
 
-				label += "<svg_new_line>";
-				++num_lines;
+		nodes.clear();
+		nodes.reserve(classes.size());
+		for(const std::shared_ptr<srcuml_class> & aclass : classes){
+			nodes.push_back(g.newNode());
+			class_nodes.emplace(aclass->get_name_symbol(), nodes.back());
+		}
 
+		edges.clear();
+		edges.reserve(merged.size());
+		for(const srcuml_edge & edge : merged){
+			edges.push_back(g.newEdge(class_nodes.at(edge.source), class_nodes.at(edge.destination)));
+		}
+	}
 
-				if(func.length() > longest_line){longest_line = func.length();}
-			}
+	static void set_label(std::vector<svg_label> &labels, node v, const svg_label &label){
+		if(labels.size() <= (std::size_t)v->index()){
+			labels.resize(v->index() + 1);
 		}
-		//create proper string such that SvgPrinter can parse.
-		//\n will be <svg_new_line> box divider will be <svg_box_divide>
-		return label;
+		labels[v->index()] = label;
 	}
 
-	bool drawSVG(const GraphAttributes &A, const std::string &filename, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &ne_arrow){
-		std::ofstream os(filename);
-		return drawSVG(A, os, settings, ne_arrow);
+	/** stroke of an edge standing for weight bundled edges, see srcuml_edge_filter */
+	static float edge_width(float width, std::size_t weight){
+		return width + static_cast<float>(std::log2(static_cast<double>(weight)));
 	}
 
-	bool drawSVG(const ClusterGraphAttributes &A, const std::string &filename, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &ne_arrow){
-		std::ofstream os(filename);
-		return drawSVG(A, os, settings, ne_arrow);
+	/** nodes and edges of every drawing, including those of single clusters */
+	void count_drawn(const GraphAttributes &attr){
+		if(get_stats()){
+			get_stats()->add_count("nodes drawn", attr.constGraph().numberOfNodes());
+			get_stats()->add_count("edges drawn", attr.constGraph().numberOfEdges());
+		}
+	}
+
+	/** drawings are also written as tiles, see svg_tiles */
+	void use_tiles(const svg_tiles &tiles){
+		this->tiles = tiles;
+	}
+
+	/** nodes and edges of a drawing are drawn on threads threads, see SvgPrinter::setThreads */
+	void use_draw_threads(std::size_t threads){
+		draw_threads = threads;
+	}
+
+	/** classes with more than lines attributes and operations show how many of each instead */
+	void use_member_lines(std::size_t lines){
+		member_lines = lines;
+	}
+
+	/** classes draw at most members attributes and members operations, see add_members */
+	void use_max_members(std::size_t members){
+		max_members = members;
+	}
+
+	/** edges passing over nodes other than their own are drawn over them */
+	void use_raise_edges(bool raise){
+		raise_edges = raise;
+	}
+
+	/** the changes to each drawing since the last one are written to patch_file, see svg_patch */
+	void use_patch(const std::string &patch_file, const std::string &patch_state){
+		this->patch_file = patch_file;
+		this->patch_state = patch_state;
+	}
+
+	/** the tiles of the main drawing, if any were asked for */
+	template<class attributes_type>
+	void drawTiles(const attributes_type &attr, const GraphIO::SVGSettings &settings, const svg_arrows &arrows,
+				   const std::vector<svg_label> &labels){
+		// tiles of a drawing cut short by the deadline are not written
+		if(tiles.is_enabled() && !srcuml_cancel::is_cancelled(get_cancel())){
+			srcuml_stats::timer timer(get_stats(), "render.tiles");
+			tiles.write(attr, settings, arrows, labels);
+		}
 	}
 
-	bool drawSVG(const GraphAttributes &attr, std::ostream &os, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &ne_arrow){
-		SvgPrinter printer(attr, settings, ne_arrow);
-		return printer.draw(os);
+	/** labels by node index, nodes without one are drawn with their plain label */
+	bool drawSVG(const GraphAttributes &attr, std::ostream &os, const GraphIO::SVGSettings &settings, const svg_arrows &arrows,
+				 const std::vector<svg_label> &labels, const std::string &metadata = ""){
+		srcuml_stats::timer timer(get_stats(), "render");
+		count_drawn(attr);
+
+		SvgPrinter printer(attr, settings, arrows);
+		printer.setLabels(&labels);
+		printer.setMetadata(metadata);
+		printer.setThreads(draw_threads);
+		printer.setCancel(get_cancel());
+		printer.setRaiseCrossingEdges(raise_edges);
+		return drawPatched(printer, os);
+	}
+
+	bool drawSVG(const ClusterGraphAttributes &attr, std::ostream &os, const GraphIO::SVGSettings &settings, const svg_arrows &arrows,
+				 const std::vector<svg_label> &labels, const std::string &metadata = ""){
+		srcuml_stats::timer timer(get_stats(), "render");
+		count_drawn(attr);
+
+		SvgPrinter printer(attr, settings, arrows);
+		printer.setLabels(&labels);
+		printer.setMetadata(metadata);
+		printer.setThreads(draw_threads);
+		printer.setCancel(get_cancel());
+		printer.setRaiseCrossingEdges(raise_edges);
+		return drawPatched(printer, os);
 	}
 
-	bool drawSVG(const ClusterGraphAttributes &attr, std::ostream &os, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &ne_arrow){
-		SvgPrinter printer(attr, settings, ne_arrow);
-		return printer.draw(os);
+private:
+
+	/** draws, recording the drawing to the patch if one was asked for */
+	bool drawPatched(SvgPrinter &printer, std::ostream &os){
+		if(patch_file.empty()){
+			return printer.draw(os);
+		}
+
+		svg_patch patch(patch_state);
+		printer.setPatch(&patch);
+		if(!printer.draw(os)){
+			return false;
+		}
+
+		std::ofstream patch_out(patch_file);
+		if(!patch_out){
+			throw std::string("Error: Unable to write SVG patch ") + patch_file;
+		}
+
+		const std::size_t changes = patch.write(patch_out);
+		patch.save();
+		if(get_stats()){
+			get_stats()->add_count("patched elements", changes);
+		}
+
+		return true;
 	}
-	
+
 };
 
 #endif
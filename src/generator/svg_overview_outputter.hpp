@@ -0,0 +1,122 @@
+#ifndef INCLUDED_SVG_OVERVIEW_OUTPUTTER_HPP
+#define INCLUDED_SVG_OVERVIEW_OUTPUTTER_HPP
+
+#include <ogdf/energybased/FMMMLayout.h>
+#include <svg_outputter.hpp>
+
+/**
+ * svg_overview_outputter
+ *
+ * Whole-system overview: each class is a box with only its name, laid out
+ * with the multilevel force-directed FMMMLayout, which handles tens of
+ * thousands of classes where the Sugiyama layouts do not.
+ */
+class svg_overview_outputter : public svg_outputter {
+
+public:
+
+	svg_overview_outputter(){
+		init_attributes();
+	}
+
+	bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+		srcuml_stats::timer graph_timer(get_stats(), "graph");
+		reset_graph();
+
+		srcuml_relationships relationships = analyze_relationships(classes);
+		const std::vector<srcuml_edge> merged = merge_edges(relationships, false);
+
+		std::vector<node> nodes;
+		std::vector<ogdf::edge> edges;
+		build_graph(g, classes, merged, nodes, edges);
+		init_attributes();
+
+		//Classes/Nodes
+		//===============================================================================================================
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			const std::shared_ptr<srcuml_class> & aclass = classes[pos];
+			node cur_node = nodes[pos];
+
+			ga.label(cur_node) = aclass->get_srcuml_name();
+			ga.height(cur_node) = 1.3 * 10;
+			ga.width(cur_node) = svg_label::columns(aclass->get_srcuml_name()) * .75 * 10;
+			ga.fillColor(cur_node) = Color(Color::Name::Antiquewhite);
+		}
+		//===============================================================================================================
+
+		//Relationships/Edges
+		//===============================================================================================================
+		//no arrow heads at this scale, only the stroke tells uses from structure
+		for(std::size_t pos = 0; pos < merged.size(); ++pos){
+
+			const srcuml_edge & edge = merged[pos];
+			ogdf::edge cur_edge = edges[pos];
+
+			ga.strokeWidth(cur_edge) = edge_width(1, edge.weight);
+			ga.strokeType(cur_edge) = edge.type == DEPENDENCY || edge.type == GENERALIZATION || edge.type == REALIZATION
+									? StrokeType::Dash : StrokeType::Solid;
+
+		}
+		//===============================================================================================================
+
+		//Layout
+		//===============================================================================================================
+		graph_timer.stop();
+		srcuml_stats::timer layout_timer(get_stats(), "layout");
+
+		FMMMLayout fmmm;
+		fmmm.useHighLevelOptions(true);
+		fmmm.unitEdgeLength(50.0);
+		fmmm.newInitialPlacement(true);
+		fmmm.qualityVersusSpeed(FMMMOptions::QualityVsSpeed::NiceAndIncredibleSpeed);
+
+		{
+			srcuml_trace::span span("FMMMLayout", "ogdf");
+			fmmm.call(ga);
+		}
+
+		layout_timer.stop();
+
+		GraphIO::SVGSettings svg_settings;
+		svg_arrows arrows(g, std::make_pair(NoEnd, NoEnd));
+		//the plain labels are the names
+		const std::vector<svg_label> labels;
+
+		const std::string layout_description = "srcUML layout: FMMMLayout, " + std::to_string(classes.size()) + " classes";
+		if(get_stats())
+			get_stats()->set_note("svg_overview layout", layout_description);
+
+		if(!drawSVG(ga, out, svg_settings, arrows, labels, layout_description)){
+			throw std::string("Error: Unable to write the svg_overview drawing");
+		}
+		drawTiles(ga, svg_settings, arrows, labels);
+		//===============================================================================================================
+
+		return true;
+	}
+
+private:
+
+	/** an empty graph without attributes, so every output starts afresh, see output */
+	void reset_graph(){
+		ga.init(g, 0);
+		g.clear();
+	}
+
+	/** the attributes of the graph built, see build_graph */
+	void init_attributes(){
+		ga.init(g,
+		GraphAttributes::nodeGraphics |
+		GraphAttributes::edgeGraphics |
+		GraphAttributes::nodeLabel |
+		GraphAttributes::nodeStyle |
+		GraphAttributes::edgeStyle);
+	}
+
+	Graph g;
+
+	GraphAttributes ga;
+
+};
+
+#endif
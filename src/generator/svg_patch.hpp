@@ -0,0 +1,259 @@
+/**
+ * @file svg_patch.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_PATCH_HPP
+#define INCLUDED_SVG_PATCH_HPP
+
+#include <srcuml_serialize.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <unordered_map>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+/**
+ * svg_patch
+ *
+ * What changed in an SVG drawing since the last one drawn with the same state
+ * file, so a live viewer applies a delta instead of reloading the document.
+ * SvgPrinter gives every node and edge group a stable id and records the markup
+ * of each, see SvgPrinter::setPatch.  The patch is written as JSON lines in
+ * the order they apply:
+ *
+ *   {"op": "header", "viewBox": "0 0 800 600", "style": "..."}
+ *   {"op": "remove", "id": "e5f3a..."}
+ *   {"op": "add", "id": "n9c1d...", "layer": "nodes", "svg": "<g id=...>...</g>"}
+ *   {"op": "replace", "id": "n9c1d...", "svg": "<g id=...>...</g>"}
+ *   {"op": "move", "id": "n9c1d...", "transform": "translate(10, 20)"}
+ *
+ * Edge groups are children of the group with id "edges", node groups of the
+ * root element, and edges raised over the nodes of the group with id
+ * "raised_edges" after them, see SvgPrinter::setRaiseCrossingEdges.  An element
+ * changing layers is removed and added again.  A node whose markup only
+ * differs in its transform is moved.
+ * Without a readable state every element is added, after a header line.
+ */
+class svg_patch {
+
+public:
+
+	static const std::uint64_t VERSION = 1;
+
+	enum layer : std::uint8_t { EDGE_LAYER, NODE_LAYER, RAISED_EDGE_LAYER };
+
+private:
+
+	struct element {
+
+		std::string id;
+		layer in_layer;
+		// hash of the markup without its transform
+		std::uint64_t hash;
+		std::string transform;
+		// markup, only kept for the elements drawn by this run
+		std::string markup;
+
+	};
+
+	std::string path;
+
+	std::uint64_t previous_header;
+	std::unordered_map<std::string, element> previous;
+
+	std::uint64_t header;
+	std::string view_box;
+	std::string style;
+	std::vector<element> current;
+
+public:
+
+	/** an unreadable or outdated state file patches an empty drawing */
+	svg_patch(const std::string & path)
+		: path(path), previous_header(0), previous(), header(0), view_box(), style(), current() {
+
+		std::ifstream in(path, std::ios::binary);
+		if(!in) return;
+
+		try {
+
+			if(srcuml::read_size(in) != VERSION)
+				return;
+
+			previous_header = srcuml::read_size(in);
+			std::uint64_t number_elements = srcuml::read_size(in);
+			for(std::uint64_t pos = 0; pos < number_elements; ++pos) {
+
+				element entry;
+				entry.id = srcuml::read_string(in);
+				entry.in_layer = static_cast<layer>(srcuml::read_size(in));
+				entry.hash = srcuml::read_size(in);
+				entry.transform = srcuml::read_string(in);
+				previous.emplace(entry.id, entry);
+
+			}
+
+		} catch(const std::string &) {
+			previous_header = 0;
+			previous.clear();
+		}
+
+	}
+
+	/** the viewBox and the CSS of the style element */
+	void record_header(const std::string & view_box, const std::string & style) {
+
+		this->view_box = view_box;
+		this->style = style;
+		header = srcuml::hash(view_box.data(), view_box.size());
+		header = srcuml::hash(style.data(), style.size(), header);
+
+	}
+
+	/** a node or edge group as drawn, in document order */
+	void record(const std::string & id, layer in_layer, const std::string & markup) {
+
+		element entry;
+		entry.id = id;
+		entry.in_layer = in_layer;
+		entry.markup = markup;
+
+		// the transform is on the start tag of a node group
+		const std::string::size_type line_end = markup.find('\n');
+		const std::string::size_type start = in_layer == NODE_LAYER ? markup.find(" transform=\"") : std::string::npos;
+		if(start != std::string::npos && start < line_end) {
+
+			const std::string::size_type value_start = start + std::strlen(" transform=\"");
+			const std::string::size_type value_end = markup.find('"', value_start);
+			entry.transform = markup.substr(value_start, value_end - value_start);
+
+			std::string body = markup;
+			body.erase(start, value_end + 1 - start);
+			entry.hash = srcuml::hash(body.data(), body.size());
+
+		} else {
+			entry.hash = srcuml::hash(markup.data(), markup.size());
+		}
+
+		current.push_back(std::move(entry));
+
+	}
+
+	/** writes the changes since the state was saved, returns how many there are */
+	std::size_t write(std::ostream & out) const {
+
+		std::size_t changes = 0;
+		if(header != previous_header) {
+			out << "{\"op\": \"header\", \"viewBox\": \"" << srcuml::json_escape(view_box) << "\", \"style\": \"" << srcuml::json_escape(style) << "\"}\n";
+			++changes;
+		}
+
+		std::unordered_map<std::string, std::size_t> drawn;
+		for(std::size_t pos = 0; pos < current.size(); ++pos)
+			drawn.emplace(current[pos].id, pos);
+
+		for(const std::pair<const std::string, element> & old : previous)
+			if(!drawn.count(old.first)) {
+				out << "{\"op\": \"remove\", \"id\": \"" << srcuml::json_escape(old.first) << "\"}\n";
+				++changes;
+			}
+
+		for(const element & entry : current) {
+
+			std::unordered_map<std::string, element>::const_iterator old = previous.find(entry.id);
+			if(old != previous.end() && old->second.in_layer != entry.in_layer) {
+				out << "{\"op\": \"remove\", \"id\": \"" << srcuml::json_escape(entry.id) << "\"}\n";
+				++changes;
+			}
+
+			if(old == previous.end() || old->second.in_layer != entry.in_layer) {
+				out << "{\"op\": \"add\", \"id\": \"" << srcuml::json_escape(entry.id) << "\", \"layer\": \""
+					<< layer_name(entry.in_layer) << "\", \"svg\": \"" << srcuml::json_escape(entry.markup) << "\"}\n";
+			} else if(old->second.hash != entry.hash) {
+				out << "{\"op\": \"replace\", \"id\": \"" << srcuml::json_escape(entry.id) << "\", \"svg\": \"" << srcuml::json_escape(entry.markup) << "\"}\n";
+			} else if(old->second.transform != entry.transform) {
+				out << "{\"op\": \"move\", \"id\": \"" << srcuml::json_escape(entry.id) << "\", \"transform\": \"" << srcuml::json_escape(entry.transform) << "\"}\n";
+			} else {
+				continue;
+			}
+
+			++changes;
+
+		}
+
+		return changes;
+
+	}
+
+	/** keeps what was drawn for the next patch, written to a temporary file that is renamed */
+	void save() const {
+
+		const boost::filesystem::path state_path(path);
+		const boost::filesystem::path temp_path = state_path.parent_path() / boost::filesystem::unique_path(state_path.filename().string() + ".%%%%-%%%%.tmp");
+		{
+			std::ofstream out(temp_path.string(), std::ios::binary);
+			if(!out)
+				throw std::string("Error: Unable to write SVG patch state ") + path;
+
+			srcuml::write_size(out, VERSION);
+			srcuml::write_size(out, header);
+			srcuml::write_size(out, current.size());
+			for(const element & entry : current) {
+
+				srcuml::write_string(out, entry.id);
+				srcuml::write_size(out, entry.in_layer);
+				srcuml::write_size(out, entry.hash);
+				srcuml::write_string(out, entry.transform);
+
+			}
+		}
+
+		boost::filesystem::rename(temp_path, state_path);
+
+	}
+
+	/** an id made of a hash of the text, e.g. the label of a node */
+	static std::string make_id(char prefix, const std::string & text) {
+
+		char digits[24];
+		std::snprintf(digits, sizeof(digits), "%c%016llx", prefix,
+					  static_cast<unsigned long long>(srcuml::hash(text.data(), text.size())));
+		return digits;
+
+	}
+
+private:
+
+	static const char * layer_name(layer in_layer) {
+
+		return in_layer == NODE_LAYER ? "nodes" : in_layer == RAISED_EDGE_LAYER ? "raised_edges" : "edges";
+
+	}
+
+};
+
+#endif
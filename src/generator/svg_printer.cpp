@@ -30,6 +30,7 @@
  */
 
 #include "svg_printer.hpp"
+#include <srcuml_utilities.hpp>
 
 using namespace ogdf;
 
@@ -47,220 +48,436 @@ GraphIO::SVGSettings::SVGSettings(){
 }
 
 bool SvgPrinter::draw(std::ostream &os){
-	pugi::xml_document doc;
-	pugi::xml_node rootNode = writeHeader(doc);
+	svg_writer writer(os, m_precision);
+	collectStyles(writer);
+	if(m_patch) {
+		assignIds();
+	}
+	writeHeader(writer);
 
 	if(m_clsAttr) {
-		drawClusters(rootNode);
+		drawClusters(writer);
+	}
+
+	drawEdges(writer);
+	drawNodes(writer);
+
+	if(!m_raisedEdges.empty()) {
+		drawEdgeGroup(writer, "raised_edges", m_raisedEdges, svg_patch::RAISED_EDGE_LAYER);
 	}
 
-	//drawNodes(rootNode);
-	drawEdges(rootNode);
-	drawNodes(rootNode);
-	
-	
-	doc.save(os);
+	writer.end();
+	writer.flush();
 
 	return true;
 }
 
-pugi::xml_node SvgPrinter::writeHeader(pugi::xml_document &doc){
-	pugi::xml_node rootNode = doc.append_child("svg");
-	rootNode.append_attribute("xmlns") = "http://www.w3.org/2000/svg";
-	rootNode.append_attribute("xmlns:xlink") = "http://www.w3.org/1999/xlink";
-	rootNode.append_attribute("xmlns:ev") = "http://www.w3.org/2001/xml-events";
-	rootNode.append_attribute("version") = "1.1";
-	rootNode.append_attribute("baseProfile") = "full";
-	rootNode.append_attribute("style") = "background: white";
+void SvgPrinter::writeHeader(svg_writer &writer){
+	writer.start("svg");
+	writer.attribute("xmlns", "http://www.w3.org/2000/svg");
+	writer.attribute("xmlns:xlink", "http://www.w3.org/1999/xlink");
+	writer.attribute("xmlns:ev", "http://www.w3.org/2001/xml-events");
+	writer.attribute("version", "1.1");
+	writer.attribute("baseProfile", "full");
+	writer.attribute("style", "background: white");
 
 	if(!m_settings.width().empty()) {
-		rootNode.append_attribute("width") = m_settings.width().c_str();
+		writer.attribute("width", m_settings.width());
 	}
 
 	if(!m_settings.height().empty()) {
-		rootNode.append_attribute("height") = m_settings.height().c_str();
+		writer.attribute("height", m_settings.height());
 	}
 
-	DRect box = m_clsAttr ? m_clsAttr->boundingBox() : m_attr.boundingBox();
+	DRect box = m_tile ? *m_tile : m_clsAttr ? m_clsAttr->boundingBox() : m_attr.boundingBox();
 
-	double margin = m_settings.margin();
-	std::stringstream is;
-	is << (box.p1().m_x - margin);
-	is << " " << (box.p1().m_y - margin);
-	is << " " << (box.width() + 2*margin);
-	is << " " << (box.height() + 2*margin);
-	rootNode.append_attribute("viewBox") = is.str().c_str();
+	// neighbouring tiles meet without a margin
+	double margin = m_tile ? 0 : m_settings.margin();
+	std::string viewBox;
+	appendNumbers(writer, viewBox, {box.p1().m_x - margin, box.p1().m_y - margin, box.width() + 2*margin, box.height() + 2*margin});
+	std::replace(viewBox.begin(), viewBox.end(), ',', ' ');
+	writer.attribute("viewBox", viewBox);
 
-	pugi::xml_node style_node = rootNode.append_child("style");
-	style_node.text() = (".font_style {font: " + std::to_string(m_settings.fontSize()) + "px monospace;}").c_str();
-	//std::cerr << std::to_string(m_settings.fontSize()) << std::endl;
-	pugi::xml_node back_color = rootNode.append_child("rect");
-	back_color.append_attribute("width") = "200%";
-	back_color.append_attribute("height") = "200%";
-	back_color.append_attribute("fill") = "white";
+	if(!m_metadata.empty()) {
+		writer.start("metadata");
+		writer.text(m_metadata);
+		writer.end();
+	}
 
-	return rootNode;
+	writer.start("style");
+	std::string css = ".font_style {font: " + std::to_string(m_settings.fontSize()) + "px monospace;}\n";
+	css += ".font_style text {fill: " + m_settings.fontColor() + "; text-anchor: start;}\n";
+	css += ".separator {stroke: black; stroke-width: 1px;}\n";
+	css += "path {fill: none;}";
+	for(std::size_t style = 0; style < m_styles.size(); ++style) {
+		css += "\n.s" + std::to_string(style) + " {" + m_styles[style] + "}";
+	}
+	writer.text(css);
+	writer.end();
+
+	if(m_patch) {
+		m_patch->record_header(viewBox, css);
+	}
+
+	writeMarkers(writer);
+
+	writer.start("rect");
+	writer.attribute("width", "200%");
+	writer.attribute("height", "200%");
+	writer.attribute("fill", "white");
+	writer.end();
 }
 
-void SvgPrinter::writeDashArray(pugi::xml_node xmlNode, StrokeType lineStyle, double lineWidth){
+void SvgPrinter::writeDashArray(const svg_writer &writer, std::string &css, StrokeType lineStyle, double lineWidth){
 	if(lineStyle != StrokeType::None && lineStyle != StrokeType::Solid) {
-		std::stringstream is;
+		css += " stroke-dasharray: ";
 
 		switch(lineStyle) {
 		case StrokeType::Dash:
-			is << 4*lineWidth << "," << 2*lineWidth;
+			appendNumbers(writer, css, {4*lineWidth, 2*lineWidth});
 			break;
 		case StrokeType::Dot:
-			is << 1*lineWidth << "," << 2*lineWidth;
+			appendNumbers(writer, css, {1*lineWidth, 2*lineWidth});
 			break;
 		case StrokeType::Dashdot:
-			is << 4*lineWidth << "," << 2*lineWidth << "," << 1*lineWidth << "," << 2*lineWidth;
+			appendNumbers(writer, css, {4*lineWidth, 2*lineWidth, 1*lineWidth, 2*lineWidth});
 			break;
 		case StrokeType::Dashdotdot:
-			is << 4*lineWidth << "," << 2*lineWidth << "," << 1*lineWidth << "," << 2*lineWidth << "," << 1*lineWidth << "," << 2*lineWidth;
+			appendNumbers(writer, css, {4*lineWidth, 2*lineWidth, 1*lineWidth, 2*lineWidth, 1*lineWidth, 2*lineWidth});
 			break;
 		default:
 			// will never happen
 			break;
 		}
 
-		xmlNode.append_attribute("stroke-dasharray") = is.str().c_str();
+		css += ";";
 	}
 }
 
-void SvgPrinter::drawNode(pugi::xml_node xmlNode, node v){
-	pugi::xml_node g_node; 
-	pugi::xml_node shape;
-	pugi::xml_node text_node;
-	pugi::xml_node line_node;
+void SvgPrinter::appendNumbers(const svg_writer &writer, std::string &css, std::initializer_list<double> numbers){
+	char digits[svg_writer::NUMBER_SIZE];
+	bool first = true;
+
+	for(double number : numbers) {
+		if(!first) {
+			css += ",";
+		}
+		css.append(digits, writer.format(number, digits));
+		first = false;
+	}
+}
 
-	std::stringstream is;
+std::size_t SvgPrinter::addStyle(const std::string &css){
+	std::pair<std::unordered_map<std::string, std::size_t>::iterator, bool> inserted = m_styleIndex.emplace(css, m_styles.size());
+	if(inserted.second) {
+		m_styles.push_back(css);
+	}
 
-	double x = m_attr.x(v);//center coord
-	double y = m_attr.y(v);//center coord
-	g_node = xmlNode.append_child("g");
-	g_node.append_attribute("class") = "font_style";
-	g_node.append_attribute("transform") = ("translate(" + std::to_string(x - m_attr.width(v)/2) + ", " + std::to_string(y - m_attr.height(v)/2) + ")").c_str();
+	return inserted.first->second;
+}
 
-	shape = g_node.append_child("rect");
+void SvgPrinter::collectStyles(const svg_writer &writer){
+	const Graph &graph = m_attr.constGraph();
+	std::string css;
 
 	if (m_attr.has(GraphAttributes::nodeStyle)) {
-		shape.append_attribute("fill") = m_attr.fillColor(v).toString().c_str();
-		shape.append_attribute("fill-opacity") = (to_string((double)m_attr.fillColor(v).alpha()/255)).c_str();
-		shape.append_attribute("stroke-width") = (to_string(m_attr.strokeWidth(v)) + "px").c_str();
-
-		StrokeType lineStyle = m_attr.has(GraphAttributes::nodeStyle) ? m_attr.strokeType(v) : StrokeType::Solid;
+		m_nodeStyles.assign(graph.maxNodeIndex() + 1, NO_STYLE);
+
+		for(node v : graph.nodes) {
+			css = "fill: " + m_attr.fillColor(v).toString() + "; fill-opacity: ";
+			appendNumbers(writer, css, {(double)m_attr.fillColor(v).alpha()/255});
+			css += "; stroke-width: ";
+			appendNumbers(writer, css, {m_attr.strokeWidth(v)});
+			css += "px;";
+
+			StrokeType lineStyle = m_attr.strokeType(v);
+
+			if(lineStyle == StrokeType::None) {
+				css += " stroke: none;";
+			} else {
+				css += " stroke: " + m_attr.strokeColor(v).toString() + ";";
+				writeDashArray(writer, css, lineStyle, m_attr.strokeWidth(v));
+			}
 
-		if(lineStyle == StrokeType::None) {
-			shape.append_attribute("stroke") = "none";
-		} else {
-			shape.append_attribute("stroke") = m_attr.strokeColor(v).toString().c_str();
-			writeDashArray(shape, lineStyle, m_attr.strokeWidth(v));
+			m_nodeStyles[v->index()] = addStyle(css);
 		}
 	}
 
-	std::string full_text = m_attr.label(v).c_str();
-	//std::cerr << "Full Text: " << full_text << '\n';
-	int num_lines = 0;
-	int prev = 0;
-	int largest_line = 0;
-	bool new_line = false;
-	bool box_divide = false;
+	if (m_attr.has(GraphAttributes::edgeGraphics)) {
+		m_edgeStyles.assign(graph.maxEdgeIndex() + 1, NO_STYLE);
 
-	for(int i = 0; i < full_text.size(); i++){//count number of lines
-		//look for my inserted tags
-		if(full_text.substr(i, 16) == "<svg_box_divide>"){
-			box_divide = true;
-		}
-		if(full_text.substr(i, 14) == "<svg_new_line>"){
-			new_line = true;
+		for(edge e : graph.edges) {
+			StrokeType lineStyle = m_attr.has(GraphAttributes::edgeStyle) ? m_attr.strokeType(e) : StrokeType::Solid;
+
+			if(lineStyle == StrokeType::None) {
+				continue;
+			}
+
+			if (m_attr.has(GraphAttributes::edgeStyle)) {
+				css = "stroke: " + m_attr.strokeColor(e).toString() + "; stroke-width: ";
+				appendNumbers(writer, css, {m_attr.strokeWidth(e)});
+				css += "px;";
+				writeDashArray(writer, css, lineStyle, m_attr.strokeWidth(e));
+			} else {
+				css = "stroke: #000000;";
+			}
+
+			m_edgeStyles[e->index()] = addStyle(css);
 		}
-		if(new_line || box_divide){
-			if(i-prev > largest_line){//track largest line for box size.
-				largest_line = i-prev;
+	}
+}
+
+const char *SvgPrinter::markerName(EndType endType){
+	switch(endType) {
+	case FilledTriangle:
+		return "filled_triangle";
+	case HollowTriangle:
+		return "hollow_triangle";
+	case FilledDiamond:
+		return "filled_diamond";
+	case HollowDiamond:
+		return "hollow_diamond";
+	default:
+		return "";
+	}
+}
+
+double SvgPrinter::markerLength(EndType endType){
+	switch(endType) {
+	case FilledTriangle:
+	case HollowTriangle:
+		return s_arrowSize;
+	case FilledDiamond:
+	case HollowDiamond:
+		return 2*s_arrowSize;
+	default:
+		return 0;
+	}
+}
+
+void SvgPrinter::writeMarkers(svg_writer &writer){
+	const double size = s_arrowSize;
+
+	writer.start("defs");
+
+	for(EndType endType : {FilledTriangle, HollowTriangle, FilledDiamond, HollowDiamond}) {
+		for(bool atSource : {false, true}) {
+			// drawn from the end of the path towards the node, backwards at the source end
+			const double sign = atSource ? -1 : 1;
+
+			writer.start("marker");
+			writer.start_attribute("id");
+			writer << markerName(endType) << (atSource ? "_start" : "");
+			writer.end_attribute();
+			writer.attribute("markerUnits", "userSpaceOnUse");
+			writer.attribute("orient", "auto");
+			writer.attribute("overflow", "visible");
+
+			writer.start("polygon");
+			writer.start_attribute("points");
+			if(endType == FilledTriangle || endType == HollowTriangle) {
+				writer << 0 << "," << -size/2.5 << " " << sign*size << "," << 0 << " " << 0 << "," << size/2.5;
+			} else {
+				writer << 0 << "," << 0 << " " << sign*size << "," << -size/2.5 << " " << sign*2*size << "," << 0 << " " << sign*size << "," << size/2.5;
 			}
-			prev = i + 14;
-			if(box_divide){
-				prev += 2;
+			writer.end_attribute();
+			if(endType == HollowTriangle || endType == HollowDiamond) {
+				writer.attribute("stroke", "#000000");
+				writer.attribute("fill-opacity", "0");
 			}
+			writer.end();
+
+			writer.end();
 		}
-		new_line = false;
-		box_divide = false;
 	}
 
-	prev = 0;
+	writer.end();
+}
+
+void SvgPrinter::drawNode(svg_writer &writer, node v){
+	double x = m_attr.x(v);//center coord
+	double y = m_attr.y(v);//center coord
+	writer.start("g");
+	if(m_patch) {
+		writer.attribute("id", m_nodeIds[v->index()]);
+	}
+	writer.attribute("class", "font_style");
+	writer.start_attribute("transform");
+	writer << "translate(" << x - m_attr.width(v)/2 << ", " << y - m_attr.height(v)/2 << ")";
+	writer.end_attribute();
 
-	for(int i = 0; i < full_text.size(); i++){
-		//look for my inserted tags
-		if(full_text.substr(i, 16) == "<svg_box_divide>"){
-			box_divide = true;
+	writer.start("rect");
+
+	if (m_attr.has(GraphAttributes::nodeStyle)) {
+		writer.start_attribute("class");
+		writer << "s" << (double)m_nodeStyles[v->index()];
+		writer.end_attribute();
+	}
+
+	writer.attribute("width", m_attr.width(v));//(std::to_string(largest_line * .75) + "em").c_str();
+	writer.attribute("height", m_attr.height(v));//(std::to_string(num_lines * 1.3) + "em").c_str();
+	writer.end();
+
+	// nodes without a structured label, e.g. in an overview, show their plain label
+	if(!m_labels || v->index() >= (int)m_labels->size()) {
+		svg_label plain;
+		plain.compartments.push_back({ { m_attr.label(v), false } });
+		drawLabel(writer, plain, m_attr.width(v));
+	} else {
+		drawLabel(writer, (*m_labels)[v->index()], m_attr.width(v));
+	}
+
+	writer.end();
+}
+
+void SvgPrinter::drawLabel(svg_writer &writer, const svg_label &label, double width){
+	int row = 0;
+
+	for(std::size_t pos = 0; pos < label.compartments.size(); ++pos){
+		const std::vector<svg_label_line> &compartment = label.compartments[pos];
+
+		for(const svg_label_line &line : compartment){
+			++row;
+			writer.start("text");
+			writer.start_attribute("dy");
+			writer << .83 + ((row - 1) * 1.1) << "em";
+			writer.end_attribute();
+			writer.attribute("dx", ".17em");
+			writer.start_attribute("textLength");
+			writer << svg_label::columns(line.text) * .67 << "em";
+			writer.end_attribute();
+			writer.attribute("lengthAdjust", "spacingAndGlyphs");
+			if(line.is_static){
+				writer.attribute("text-decoration", "underline");
+			}
+			writer.text(line.text);
+			writer.end();
 		}
-		if(full_text.substr(i, 14) == "<svg_new_line>"){
-			new_line = true;
+
+		if(pos + 1 == label.compartments.size()){
+			break;
 		}
-		//if I found one of my tags take action
-		//if new line, add text element
-		//if box divide, add text element and line element 
-		if(new_line || box_divide){
-			num_lines++;
-			text_node = g_node.append_child("text");
-			text_node.append_attribute("dy") = (std::to_string(.83 + ((num_lines - 1) * 1.1)) + "em").c_str();
-			text_node.append_attribute("dx") = ".17em";
-			text_node.append_attribute("text-anchor") = "start";
-			text_node.append_attribute("fill") = m_settings.fontColor().c_str();
-			text_node.append_attribute("textLength") = (std::to_string((i-prev) * .67) + "em").c_str();
-			text_node.append_attribute("lengthAdjust") = "spacingAndGlyphs";
-			text_node.text() = full_text.substr(prev, i-prev).c_str();
-
-			prev = i + 14;//move past new line
-
-			if(box_divide){
-				line_node = g_node.append_child("line");
-				line_node.append_attribute("x1") = "0";
-				line_node.append_attribute("y1") = (std::to_string(.83 + ((num_lines - 1) * 1.1) + .34) + "em").c_str();
-				line_node.append_attribute("x2") = m_attr.width(v);
-				line_node.append_attribute("y2") = (std::to_string(.83 + ((num_lines - 1) * 1.1) + .34) + "em").c_str();
-				line_node.append_attribute("stroke") = "black";
-				line_node.append_attribute("stroke-width") = "1px";
-				prev += 2;//move further for box_divide
-			}
+
+		//an empty compartment still takes a row
+		if(compartment.empty()){
+			++row;
 		}
 
-		new_line = false;
-		box_divide = false;
+		writer.start("line");
+		writer.attribute("class", "separator");
+		writer.attribute("x1", "0");
+		writer.start_attribute("y1");
+		writer << .83 + ((row - 1) * 1.1) + .34 << "em";
+		writer.end_attribute();
+		writer.attribute("x2", width);
+		writer.start_attribute("y2");
+		writer << .83 + ((row - 1) * 1.1) + .34 << "em";
+		writer.end_attribute();
+		writer.end();
 	}
+}
 
+void SvgPrinter::drawCluster(svg_writer &writer, cluster c){
+	OGDF_ASSERT(m_clsAttr);
 
-	shape.append_attribute("width") = m_attr.width(v);//(std::to_string(largest_line * .75) + "em").c_str();
-	shape.append_attribute("height") = m_attr.height(v);//(std::to_string(num_lines * 1.3) + "em").c_str();
+	writer.attribute("class", "font_style");
+	writer.start("text");
+	writer.text(m_clsAttr->label(c));
+	writer.end();
+
+	if (c != m_clsAttr->constClusterGraph().rootCluster()) {
+		writer.start("rect");
+		writer.attribute("x", m_clsAttr->x(c));
+		writer.attribute("y", m_clsAttr->y(c));
+		writer.attribute("width", m_clsAttr->width(c));
+		writer.attribute("height", m_clsAttr->height(c));
+		writer.attribute("fill", m_clsAttr->fillPattern(c) == FillPattern::None ? std::string("none") : m_clsAttr->fillColor(c).toString());
+		writer.attribute("fill-opacity", (double)m_clsAttr->fillColor(c).alpha()/255);
+		writer.attribute("stroke", m_clsAttr->strokeType(c) == StrokeType::None ? std::string("none") : m_clsAttr->strokeColor(c).toString());
+		writer.start_attribute("stroke-width");
+		writer << m_clsAttr->strokeWidth(c) << "px";
+		writer.end_attribute();
+		writer.end();
+	}
 }
 
-void SvgPrinter::drawCluster(pugi::xml_node xmlNode, cluster c){
-	OGDF_ASSERT(m_clsAttr);
+template<class T, class Draw>
+void SvgPrinter::drawInParts(svg_writer &writer, const std::vector<T> &elements, Draw draw){
+	const std::size_t parts = std::min(m_threads, elements.size() / s_minElementsPerThread);
+
+	// checked once per s_minElementsPerThread elements
+	auto isCancelled = [this](std::size_t pos) {
+		return m_cancel && pos % s_minElementsPerThread == 0 && m_cancel->is_cancelled();
+	};
+
+	if(parts < 2) {
+		for(std::size_t pos = 0; pos < elements.size() && !isCancelled(pos); ++pos) {
+			draw(writer, elements[pos]);
+		}
+		return;
+	}
 
-	pugi::xml_node cluster;
+	// each part is drawn into a fragment of the writer, appended once all are drawn
+	std::vector<svg_writer> fragments;
+	fragments.reserve(parts);
+	for(std::size_t part = 0; part < parts; ++part) {
+		fragments.emplace_back(writer, std::size_t(1) << 16);
+	}
 
-	xmlNode.append_attribute("class") = "font_style";
-	pugi::xml_node text_node = xmlNode.append_child("text");
-	//text_node.append_attribute("text-anchor") = "start";
-	text_node.text() = m_clsAttr->label(c).c_str();
+	srcuml::parallel_ranges(parts, parts, [&](std::size_t first, std::size_t last) {
+		for(std::size_t part = first; part < last; ++part) {
+			const std::size_t begin = elements.size() * part / parts;
+			const std::size_t end = elements.size() * (part + 1) / parts;
+			for(std::size_t pos = begin; pos < end && !isCancelled(pos - begin); ++pos) {
+				draw(fragments[part], elements[pos]);
+			}
+		}
+	});
 
-	if (c == m_clsAttr->constClusterGraph().rootCluster()) {
-		cluster = xmlNode;
-	} else {
-		pugi::xml_node clusterXmlNode = xmlNode.append_child("rect");
-		clusterXmlNode.append_attribute("x") = m_clsAttr->x(c);
-		clusterXmlNode.append_attribute("y") = m_clsAttr->y(c);
-		clusterXmlNode.append_attribute("width") = m_clsAttr->width(c);
-		clusterXmlNode.append_attribute("height") = m_clsAttr->height(c);
-		clusterXmlNode.append_attribute("fill") = m_clsAttr->fillPattern(c) == FillPattern::None ? "none" : m_clsAttr->fillColor(c).toString().c_str();
-		clusterXmlNode.append_attribute("fill-opacity") = (to_string((double)m_clsAttr->fillColor(c).alpha()/255)).c_str();
-		clusterXmlNode.append_attribute("stroke") = m_clsAttr->strokeType(c) == StrokeType::None ? "none" : m_clsAttr->strokeColor(c).toString().c_str();
-		clusterXmlNode.append_attribute("stroke-width") = (to_string(m_clsAttr->strokeWidth(c)) + "px").c_str();
+	for(const svg_writer &fragment : fragments) {
+		writer.append(fragment);
+	}
+}
+
+void SvgPrinter::assignIds(){
+	const Graph &graph = m_attr.constGraph();
+	auto labelOf = [this](node v) {
+		return m_attr.has(GraphAttributes::nodeLabel) ? m_attr.label(v) : std::to_string(v->index());
+	};
+
+	std::unordered_map<std::string, std::size_t> occurrences;
+	auto makeId = [&occurrences](char prefix, const std::string &text) {
+		const std::size_t occurrence = occurrences[std::string(1, prefix) + text]++;
+		return svg_patch::make_id(prefix, occurrence ? text + "\n" + std::to_string(occurrence) : text);
+	};
+
+	m_nodeIds.assign(graph.maxNodeIndex() + 1, std::string());
+	m_nodeMarkup.assign(m_nodeIds.size(), std::string());
+	for(node v : graph.nodes) {
+		m_nodeIds[v->index()] = makeId('n', labelOf(v));
+	}
+
+	m_edgeIds.assign(graph.maxEdgeIndex() + 1, std::string());
+	m_edgeMarkup.assign(m_edgeIds.size(), std::string());
+	for(edge e : graph.edges) {
+		m_edgeIds[e->index()] = makeId('e', labelOf(e->source()) + "\n" + labelOf(e->target()));
 	}
 }
 
-void SvgPrinter::drawNodes(pugi::xml_node xmlNode){
+template<class Draw>
+void SvgPrinter::drawRecorded(svg_writer &writer, std::vector<std::string> &markup, int index, Draw draw){
+	if(!m_patch) {
+		draw(writer);
+		return;
+	}
+
+	svg_writer element(writer, 1024);
+	draw(element);
+	markup[index] = element.contents();
+	writer.append(element);
+}
+
+void SvgPrinter::drawNodes(svg_writer &writer){
 	List<node> nodes;
 	m_attr.constGraph().allNodes(nodes);
 
@@ -268,12 +485,28 @@ void SvgPrinter::drawNodes(pugi::xml_node xmlNode){
 		nodes.quicksort(GenericComparer<node, double>([&](node v) { return m_attr.z(v); }));
 	}
 
+	std::vector<node> visible;
 	for(node v : nodes) {
-		drawNode(xmlNode, v);
+		if(isVisible(v)) {
+			visible.push_back(v);
+		}
+	}
+
+	drawInParts(writer, visible, [this](svg_writer &part, node v) {
+		drawRecorded(part, m_nodeMarkup, v->index(), [this, v](svg_writer &element) { drawNode(element, v); });
+	});
+
+	if(m_patch) {
+		for(node v : visible) {
+			// nodes left out once the drawing is cancelled are not recorded
+			if(!m_nodeMarkup[v->index()].empty()) {
+				m_patch->record(m_nodeIds[v->index()], svg_patch::NODE_LAYER, m_nodeMarkup[v->index()]);
+			}
+		}
 	}
 }
 
-void SvgPrinter::drawClusters(pugi::xml_node xmlNode){
+void SvgPrinter::drawClusters(svg_writer &writer){
 	OGDF_ASSERT(m_clsAttr);
 
 	Queue<cluster> queue;
@@ -281,7 +514,11 @@ void SvgPrinter::drawClusters(pugi::xml_node xmlNode){
 
 	while(!queue.empty()) {
 		cluster c = queue.pop();
-		drawCluster(xmlNode.append_child("g"), c);
+		if(c == m_clsAttr->constClusterGraph().rootCluster() || isVisible(c)) {
+			writer.start("g");
+			drawCluster(writer, c);
+			writer.end();
+		}
 
 		for(cluster child : c->children) {
 			queue.append(child);
@@ -289,216 +526,156 @@ void SvgPrinter::drawClusters(pugi::xml_node xmlNode){
 	}
 }
 
-void SvgPrinter::drawEdges(pugi::xml_node xmlNode){
+void SvgPrinter::drawEdges(svg_writer &writer){
+	m_raisedEdges.clear();
 	if (m_attr.has(GraphAttributes::edgeGraphics)) {
-		xmlNode = xmlNode.append_child("g");
-
+		std::vector<edge> visible;
 		for(edge e : m_attr.constGraph().edges) {
-			drawEdge(xmlNode, e);
+			if(isVisible(e)) {
+				visible.push_back(e);
+			}
 		}
-	}
-}
-
-void SvgPrinter::appendLineStyle(pugi::xml_node line, edge e) {
 
-	StrokeType lineStyle = m_attr.has(GraphAttributes::edgeStyle) ? m_attr.strokeType(e) : StrokeType::Solid;
+		// all paths are clipped before any is drawn
+		m_paths.clip(visible);
 
-	if(lineStyle != StrokeType::None) {
-		if (m_attr.has(GraphAttributes::edgeStyle)) {
-			line.append_attribute("stroke") = m_attr.strokeColor(e).toString().c_str();
-			line.append_attribute("stroke-width") = (to_string(m_attr.strokeWidth(e)) + "px").c_str();
-			writeDashArray(line, lineStyle, m_attr.strokeWidth(e));
-		} else {
-			line.append_attribute("stroke") = "#000000";
+		if(m_raiseEdges) {
+			std::vector<edge> lowered;
+			for(edge e : visible) {
+				(m_paths.crosses_other(e) ? m_raisedEdges : lowered).push_back(e);
+			}
+			visible.swap(lowered);
 		}
+
+		drawEdgeGroup(writer, "edges", visible, svg_patch::EDGE_LAYER);
 	}
 }
 
-pugi::xml_node SvgPrinter::drawPolygon(pugi::xml_node xmlNode, const std::list<double> points) {
-	pugi::xml_node result = xmlNode.append_child("polygon");
-	OGDF_ASSERT(points.size() % 2 == 0);
-
-	std::stringstream is;
-	bool writeSpace = false;
-
-	for(double p : points) {
-		is << p << (writeSpace ? " " : ",");
+void SvgPrinter::drawEdgeGroup(svg_writer &writer, const char *id, const std::vector<edge> &edges, svg_patch::layer layer){
+	writer.start("g");
+	if(m_patch) {
+		writer.attribute("id", id);
 	}
 
-	result.append_attribute("points") = is.str().c_str();
+	drawInParts(writer, edges, [this](svg_writer &part, edge e) {
+		drawRecorded(part, m_edgeMarkup, e->index(), [this, e](svg_writer &element) { drawEdge(element, e); });
+	});
 
-	return result;
-}
-
-double SvgPrinter::getArrowSize(edge e, node v) {
-	double result = 0;
-
-	if(m_attr.has(GraphAttributes::edgeArrow) || m_attr.directed()) {
-		const double minSize = 3;//(m_attr.has(GraphAttributes::edgeStyle) ? m_attr.strokeWidth(e) : 1) * 3;
-		node w = e->opposite(v);
-		result = std::max(minSize, (m_attr.width(v) + m_attr.height(v) + m_attr.width(w) + m_attr.height(w)) / 16.0);
+	if(m_patch) {
+		for(edge e : edges) {
+			if(!m_edgeMarkup[e->index()].empty()) {
+				m_patch->record(m_edgeIds[e->index()], layer, m_edgeMarkup[e->index()]);
+			}
+		}
 	}
 
-	//return result;
-	return 20.0;
+	writer.end();
 }
 
-//determines if the point is covered by node v
-bool SvgPrinter::isCoveredBy(const DPoint &point, edge e, node v) {
-	double arrowSize = getArrowSize(e, v);
-
-	return point.m_x >= m_attr.x(v) - m_attr.width(v)/2 - arrowSize
-	    && point.m_x <= m_attr.x(v) + m_attr.width(v)/2 + arrowSize
-	    && point.m_y >= m_attr.y(v) - m_attr.height(v)/2 - arrowSize
-	    && point.m_y <= m_attr.y(v) + m_attr.height(v)/2 + arrowSize;
+bool SvgPrinter::isVisible(double left, double top, double right, double bottom) const {
+	return !m_tile
+	    || (left <= m_tile->p2().m_x && right >= m_tile->p1().m_x
+	     && top <= m_tile->p2().m_y && bottom >= m_tile->p1().m_y);
 }
 
-void SvgPrinter::drawEdge(pugi::xml_node xmlNode, edge e) {
-	// draw arrows if G is directed or if arrow types are defined for the edge
-	bool drawSourceArrow = false;
-	bool drawTargetArrow = false;
-	static int edge_count = 0;
-	++edge_count;
-
-	if (m_attr.has(GraphAttributes::edgeArrow)) {
-		switch (m_attr.arrowType(e)) {
-		case EdgeArrow::Undefined:
-			drawTargetArrow = m_attr.directed();
-			break;
-		case EdgeArrow::Last:
-			drawTargetArrow = true;
-			break;
-		case EdgeArrow::Both:
-			drawTargetArrow = true;
-			OGDF_CASE_FALLTHROUGH;
-		case EdgeArrow::First:
-			drawSourceArrow = true;
-			break;
-		default:
-			// don't draw any arrows
-			break;
-		}
-	}
-
-	xmlNode = xmlNode.append_child("g");
-	bool drawLabel = m_attr.has(GraphAttributes::edgeLabel) && !m_attr.label(e).empty();
-	pugi::xml_node label;
+bool SvgPrinter::isVisible(node v) const {
+	return isVisible(m_attr.x(v) - m_attr.width(v)/2, m_attr.y(v) - m_attr.height(v)/2,
+	                 m_attr.x(v) + m_attr.width(v)/2, m_attr.y(v) + m_attr.height(v)/2);
+}
 
-	if(false) {//drawLabel
-		label = xmlNode.append_child("text");
-		label.append_attribute("text-anchor") = "middle";
-		label.append_attribute("dominant-baseline") = "middle";
-		label.append_attribute("font-family") = m_settings.fontFamily().c_str();
-		label.append_attribute("font-size") = m_settings.fontSize();
-		label.append_attribute("fill") = m_settings.fontColor().c_str();
-		//label.text() = m_attr.label(e).c_str();
-		label.text() = to_string(edge_count).c_str();
+bool SvgPrinter::isVisible(edge e) const {
+	if(!m_tile) {
+		return true;
 	}
 
-
-	//creates a path whose only points are the two nodes that start and end the edge
-	//along with anything in bends
-	DPolyline path = m_attr.bends(e);
 	node s = e->source();
 	node t = e->target();
-	path.pushFront(DPoint(m_attr.x(s), m_attr.y(s)));
-	path.pushBack(DPoint(m_attr.x(t), m_attr.y(t)));
-
-	bool drawSegment = false;
-	bool finished = false;
-
-	List<DPoint> points;
-
-	for(ListConstIterator<DPoint> it = path.begin(); it.succ().valid() && !finished; it++) {
-		DPoint p1 = *it;
-		DPoint p2 = *(it.succ());
-
-		// leaving segment at source node ?
-		if(isCoveredBy(p1, e, s) && !isCoveredBy(p2, e, s)) {
-			if(!drawSegment && drawSourceArrow) {
-				drawArrowHead(xmlNode, p2, p1, s, e);
-			}
-
-			drawSegment = true;
-		}
-
-		// entering segment at target node ?
-		if(!isCoveredBy(p1, e, t) && isCoveredBy(p2, e, t)) {
-			finished = true;
-
-			if(drawTargetArrow) {
-				drawArrowHead(xmlNode, p1, p2, t, e);
-			}
-		}
+	double left = std::min(m_attr.x(s), m_attr.x(t)), right = std::max(m_attr.x(s), m_attr.x(t));
+	double top = std::min(m_attr.y(s), m_attr.y(t)), bottom = std::max(m_attr.y(s), m_attr.y(t));
+
+	for(const DPoint &bend : m_attr.bends(e)) {
+		left = std::min(left, bend.m_x);
+		right = std::max(right, bend.m_x);
+		top = std::min(top, bend.m_y);
+		bottom = std::max(bottom, bend.m_y);
+	}
 
-		if(drawSegment && drawLabel) {
-			label.append_attribute("x") = (p1.m_x + p2.m_x) / 2;
-			label.append_attribute("y") = (p1.m_y + p2.m_y) / 2;
+	return isVisible(left, top, right, bottom);
+}
 
-			drawLabel = false;
-		}
+bool SvgPrinter::isVisible(cluster c) const {
+	return isVisible(m_clsAttr->x(c), m_clsAttr->y(c), m_clsAttr->x(c) + m_clsAttr->width(c), m_clsAttr->y(c) + m_clsAttr->height(c));
+}
 
-		if(drawSegment) {
-			points.pushBack(p1);
-		}
+void SvgPrinter::appendLineStyle(svg_writer &writer, edge e) {
+	if(m_edgeStyles[e->index()] != NO_STYLE) {
+		writer.start_attribute("class");
+		writer << "s" << (double)m_edgeStyles[e->index()];
+		writer.end_attribute();
+	}
+}
 
-		if(finished) {
-			points.pushBack(p2);
-		}
+void SvgPrinter::drawEdge(svg_writer &writer, edge e) {
+	// edge labels are not drawn, their position is only known once the path is
+	writer.start("g");
+	if(m_patch) {
+		writer.attribute("id", m_edgeIds[e->index()]);
 	}
 
-	if(points.size() < 2) {
+	if(m_paths.size(e) < 2) {
 		GraphIO::logger.lout() << "Could not draw edge since nodes are overlapping: " << e << std::endl;
 	} else {
-		drawCurve(xmlNode, e, points);
+		drawCurve(writer, e, m_paths.points(e), m_paths.size(e), m_paths.source_end(e), m_paths.target_end(e));
 	}
+
+	writer.end();
 }
 
-void SvgPrinter::drawLine(std::stringstream &ss, const DPoint &p1, const DPoint &p2) {
-	ss << " M" << p1.m_x << "," << p1.m_y << " L" << p2.m_x << "," << p2.m_y;
+void SvgPrinter::drawLine(svg_writer &writer, const DPoint &p1, const DPoint &p2) {
+	writer << " M" << p1.m_x << "," << p1.m_y << " L" << p2.m_x << "," << p2.m_y;
 }
 
-void SvgPrinter::drawBezier(std::stringstream &ss, const DPoint &p1, const DPoint &p2, const DPoint &c1, const DPoint &c2) {
-	ss << " M" << p1.m_x << "," << p1.m_y << " C" << c1.m_x << "," << c1.m_y << "  " << c2.m_x << "," << c2.m_y << " " << p2.m_x << "," << p2.m_y;
+void SvgPrinter::drawBezier(svg_writer &writer, const DPoint &p1, const DPoint &p2, const DPoint &c1, const DPoint &c2) {
+	writer << " M" << p1.m_x << "," << p1.m_y << " C" << c1.m_x << "," << c1.m_y << "  " << c2.m_x << "," << c2.m_y << " " << p2.m_x << "," << p2.m_y;
 }
 
-void SvgPrinter::drawBezierPath(std::stringstream &ss, List<DPoint> &points) {
+void SvgPrinter::drawBezierPath(svg_writer &writer, const DPoint *points, std::size_t count) {
 	const double c = m_settings.curviness();
-	DPoint cLast = 0.5 * (points.front() + *points.get(1));
+	DPoint cLast = 0.5 * (points[0] + points[1]);
 
-	while(points.size() >= 3) {
-		const DPoint p1 = points.popFrontRet();
-		const DPoint p2 = points.front();
-		const DPoint p3 = *points.get(1);
+	for(; count >= 3; ++points, --count) {
+		const DPoint p1 = points[0];
+		const DPoint p2 = points[1];
+		const DPoint p3 = points[2];
 
 		const DPoint delta = p2 - 0.5 * (p1+p3);
 		const DPoint c1 = p1 + c * delta + (1-c) * (p2-p1);
 		const DPoint c2 = p3 + c * delta + (1-c) * (p2-p3);
 
-		drawBezier(ss, p1, p2, cLast, c1);
+		drawBezier(writer, p1, p2, cLast, c1);
 
 		cLast = c2;
 	}
 
-	const DPoint p1 = points.popFrontRet();
-	const DPoint p2 = points.popFrontRet();
+	const DPoint p1 = points[0];
+	const DPoint p2 = points[1];
 	const DPoint c1 = 0.5 * (p2 + p1);
 
-	drawBezier(ss, p1, p2, cLast, c1);
+	drawBezier(writer, p1, p2, cLast, c1);
 }
 
-void SvgPrinter::drawRoundPath(std::stringstream &ss, List<DPoint> &points) {
+void SvgPrinter::drawRoundPath(svg_writer &writer, const DPoint *points, std::size_t count) {
 	const double c = m_settings.curviness();
 
-	DPoint p1 = points.front();
-	DPoint p2 = *points.get(1);
+	DPoint p1 = points[0];
+	DPoint p2 = points[1];
 
-	drawLine(ss, p1, .5 * ((p1+p2) + (1-c) * (p2-p1)));
+	drawLine(writer, p1, .5 * ((p1+p2) + (1-c) * (p2-p1)));
 
-	while(points.size() >= 3) {
-		p1 = points.popFrontRet();
-		p2 = points.front();
-		DPoint p3 = *points.get(1);
+	for(; count >= 3; ++points, --count) {
+		p1 = points[0];
+		p2 = points[1];
+		DPoint p3 = points[2];
 
 		DPoint v1 = (p1 - p2);
 		DPoint v2 = (p3 - p2);
@@ -511,375 +688,60 @@ void SvgPrinter::drawRoundPath(std::stringstream &ss, List<DPoint> &points) {
 		DPoint pA = p2 + v1;
 		DPoint pB = p2 + v2;
 
-		drawLine(ss, 0.5 * (p1+p2), pA);
-		drawLine(ss, 0.5 * (p3+p2), pB);
+		drawLine(writer, 0.5 * (p1+p2), pA);
+		drawLine(writer, 0.5 * (p3+p2), pB);
 
 		DPoint vA = p2 - p1;
 		DPoint vB = p3 - p1;
 		bool doSweep = vA.m_x*vB.m_y - vA.m_y*vB.m_x > 0;
 
-		ss << " M" << pA.m_x << "," << pA.m_y << " A" << length << "," << length << " 0 0 " << (doSweep ? 1 : 0) << " " << pB.m_x << "," << pB.m_y << "";
+		writer << " M" << pA.m_x << "," << pA.m_y << " A" << length << "," << length << " 0 0 " << (doSweep ? 1 : 0) << " " << pB.m_x << "," << pB.m_y << "";
 	}
 
-	p1 = points.popFrontRet();
-	p2 = points.popFrontRet();
+	p1 = points[0];
+	p2 = points[1];
 
-	drawLine(ss, p2, .5 * ((p1 + p2) + (1-c) * (p1-p2)));
+	drawLine(writer, p2, .5 * ((p1 + p2) + (1-c) * (p1-p2)));
 }
 
-void SvgPrinter::drawLines(std::stringstream &ss, List<DPoint> &points) {
-	while(points.size() > 1) {
-		DPoint p = points.popFrontRet();
-		drawLine(ss, p, points.front());
+void SvgPrinter::drawLines(svg_writer &writer, const DPoint *points, std::size_t count) {
+	for(std::size_t pos = 1; pos < count; ++pos) {
+		drawLine(writer, points[pos - 1], points[pos]);
 	}
 }
 
-pugi::xml_node SvgPrinter::drawCurve(pugi::xml_node xmlNode, edge e, List<DPoint> &points) {
-	OGDF_ASSERT(points.size() >= 2);
-
-	pugi::xml_node line = xmlNode.append_child("path");
-	std::stringstream ss;
+void SvgPrinter::drawCurve(svg_writer &writer, edge e, const DPoint *points, std::size_t count, EndType sourceEnd, EndType targetEnd) {
+	OGDF_ASSERT(count >= 2);
 
-	if(points.size() == 2) {
-		const DPoint p1 = points.popFrontRet();
-		const DPoint p2 = points.popFrontRet();
+	writer.start("path");
+	writer.start_attribute("d");
 
-		drawLine(ss, p1, p2);
+	if(count == 2) {
+		drawLine(writer, points[0], points[1]);
 	} else {
 		if(m_settings.curviness() == 0) {
-			drawLines(ss, points);
+			drawLines(writer, points, count);
 		} else if(m_settings.bezierInterpolation()) {
-			drawBezierPath(ss, points);
+			drawBezierPath(writer, points, count);
 		} else {
-			drawRoundPath(ss, points);
+			drawRoundPath(writer, points, count);
 		}
 	}
 
-	line.append_attribute("fill") = "none";
-	line.append_attribute("d") = ss.str().c_str();
-	appendLineStyle(line, e);
-
-	return line;
-}
-
-DPoint* line_intersection(const DPoint &line1_p1,  //A
-						  const DPoint &line1_p2,  //B
-						  const DPoint &line2_p1,  //C
-						  const DPoint &line2_p2)  //D
-{ 
-	DPoint *result = new DPoint();
-
-	/*
-		double m1 = (line1_p2.m_y - line1_p1.m_y)/(line1_p2.m_x - line1_p1.m_x);
-		double m2 = (line2_p2.m_y - line2_p1.m_y)/(line2_p2.m_x - line2_p1.m_x);
-
-		double x = ((m1*line1_p1.m_x)-(line1_p1.m_y)-(m2*line2_p1.m_x)+(line2_p1.m_y))/(m1 - m2);
-		double y = (m1*x)-(m1*line1_p1.m_x)+(line1_p1.m_y);
-
-		result->m_x = x;
-		result->m_y = y;
-	*/
-
-	double x1 = line1_p2.m_y - line1_p1.m_y;
-	double y1 = line1_p1.m_x - line1_p2.m_x;
-	double z1 = x1*(line1_p1.m_x) + y1*(line1_p1.m_y);
-
-	double x2 = line2_p2.m_y - line2_p1.m_y;
-	double y2 = line2_p1.m_x - line2_p2.m_x;
-	double z2 = x2*(line2_p1.m_x) + y2*(line2_p1.m_y);
-
-	double d = (x1*y2) - (x2*y1);
-
-	if(d == 0){
-		std::cerr << "DETERMINATE 0\n";
-		//lines are parallel
-		return nullptr;
-	}else{
-
-		double x = ((y2*z1) - (y1*z2))/d;
-		double y = ((x1*z2) - (x2*z1))/d;
-
-		result->m_x = x;
-		result->m_y = y;
-
-		//std::cerr << "Line Cross Run: \n";
-		//std::cerr << "\tInter: (" << x << ", " << y << ")\n";
-
-		if(result->m_x <= std::max(line1_p1.m_x, line1_p2.m_x) &&
-		   result->m_x >= std::min(line1_p1.m_x, line1_p2.m_x) &&
-
-		   result->m_y <= std::max(line1_p1.m_y, line1_p2.m_y) &&
-		   result->m_y >= std::min(line1_p1.m_y, line1_p2.m_y) &&
+	writer.end_attribute();
+	appendLineStyle(writer, e);
 
-		   result->m_x <= std::max(line2_p1.m_x, line2_p2.m_x) &&
-		   result->m_x >= std::min(line2_p1.m_x, line2_p2.m_x) &&
-
-		   result->m_y <= std::max(line2_p1.m_y, line2_p2.m_y) &&
-		   result->m_y >= std::min(line2_p1.m_y, line2_p2.m_y)
-		   ){
-			//std::cerr << "result: " << result->m_x << ", " << result->m_y << "\n";
-			return result;
-		}else{
-			//std::cerr << "Failed. Didn't cross.\n";
-			return nullptr; 
-		}
+	if(sourceEnd != NoEnd) {
+		writer.start_attribute("marker-start");
+		writer << "url(#" << markerName(sourceEnd) << "_start)";
+		writer.end_attribute();
 	}
-}
-
-void SvgPrinter::drawArrowHead(pugi::xml_node xmlNode, const DPoint &start, DPoint &end, node v, edge e){
-	const double dx = end.m_x - start.m_x;
-	const double dy = end.m_y - start.m_y;
-	const double size = getArrowSize(e, v);
-
-	//bool source = false, target = false;
-
-	/*
-	std::cerr << "TYPE:\n";
-	if(NodeElement::compare(*v, *(e->source()))){
-		source = true;
-		std::cerr << "\tSOURCE\n";
-	}else if(NodeElement::compare(*v, *(e->target()))){
-		target = true;
-		std::cerr << "\tTARGET\n";
-	} 
-	*/
-
-	std::cerr << "HERE\n";
-
-	pugi::xml_node arrowHead;
-
-	if(dx == 0) {
-		int sign = dy > 0 ? 1 : -1;
-		double y = m_attr.y(v) - m_attr.height(v)/2 * sign;
-		end.m_y = y - sign * size;
-
-		std::map<std::pair<node, edge>, std::string>::iterator a_type_ptr;
-		a_type_ptr = m_node_arrow.find(std::make_pair(v, e));
-		std::list<double> coord;
-		bool hollow = false;
-		std::cerr << "Arrow Type: ";
-		if(a_type_ptr->second == "none"){
-			std::cerr << "NONE\n";
-			end.m_y = y;
-		}else if(a_type_ptr->second == "filled_arrow"){
-			std::cerr << "FILLED ARROW\n";
-			coord.push_back(end.m_x);
-			coord.push_back(y);
-			coord.push_back(end.m_x - size/2.5);
-			coord.push_back(y - size*sign);
-			coord.push_back(end.m_x + size/2.5);
-			coord.push_back(y - size*sign);
-		}else if(a_type_ptr->second == "hollow_arrow"){
-			std::cerr << "HOLLOW ARROW\n";
-			coord.push_back(end.m_x);
-			coord.push_back(y);
-			coord.push_back(end.m_x - size/2.5);
-			coord.push_back(y - size*sign);
-			coord.push_back(end.m_x + size/2.5);
-			coord.push_back(y - size*sign);
-
-			hollow = true;
-		}else if(a_type_ptr->second == "filled_diamond"){
-			std::cerr << "FILLED DIAMOND\n";
-			coord.push_back(end.m_x);
-			coord.push_back(y);
-
-			coord.push_back(end.m_x - size/2.5);
-			coord.push_back(y - size*sign);
-
-			coord.push_back(end.m_x);
-			coord.push_back(y - size*2*sign);
-
-			coord.push_back(end.m_x + size/2.5);
-			coord.push_back(y - size*sign);
-
-			end.m_y = y - size*2*sign;
-		}else if(a_type_ptr->second == "hollow_diamond"){
-			std::cerr << "HOLLOW DIAMOND\n";
-			coord.push_back(end.m_x);
-			coord.push_back(y);
-
-			coord.push_back(end.m_x - size/2.5);
-			coord.push_back(y - size*sign);
-
-			coord.push_back(end.m_x);
-			coord.push_back(y - size*2*sign);
-
-			coord.push_back(end.m_x + size/2.5);
-			coord.push_back(y - size*sign);
-
-			end.m_y = y - size*2*sign;
-
-			hollow = true;
-		}else{
-			std::cerr << "ERROR\n";
-			//Error
-		}
-
-		arrowHead = drawPolygon(xmlNode, coord);
-		if(hollow){
-			arrowHead.append_attribute("stroke") = "#000000";
-			arrowHead.append_attribute("fill-opacity") = "0";
-		}
-
-	} else {
-		// identify the position of the tip
-		DPoint *tip = nullptr;
-		std::vector<DPoint> corners;
-		corners.push_back(DPoint(m_attr.x(v), m_attr.y(v)));
-		corners.push_back(DPoint(m_attr.x(v) + m_attr.width(v), m_attr.y(v)));
-		corners.push_back(DPoint(m_attr.x(v) + m_attr.width(v), m_attr.y(v) + m_attr.height(v)));
-		corners.push_back(DPoint(m_attr.x(v), m_attr.y(v) + m_attr.height(v)));
-
-		for(int i = 0, j = 1; i < 4; ++i){
-			tip = line_intersection(start, end, corners[i], corners[j]);
-			++j; if(j == 4) j = 0;
-			if(tip != nullptr){
-				break;
-			}
-		}
 
-		double slope = dy / dx;
-		int sign = dx > 0 ? 1 : -1;
-
-		double x = m_attr.x(v) - m_attr.width(v)/2 * sign;
-		double delta = x - start.m_x;
-		double y = start.m_y + delta*slope;
-
-		if(!isCoveredBy(DPoint(x,y), e, v)) {
-			sign = dy > 0 ? 1 : -1;
-			y = m_attr.y(v) - m_attr.height(v)/2 * sign;
-			delta = y - start.m_y;
-			x = start.m_x + delta/slope;
-		}
-
-		std::cerr << "Tip Calc: ";
-		if(tip != nullptr){
-			std::cerr << " NEW\n";
-			end.m_x = tip->m_x;
-			end.m_y = tip->m_y;
-		}else{
-			std::cerr << " ORIGINAL\n";
-			end.m_x = x;
-			end.m_y = y;
-		}
-
-		//New doesn't work currently. 
-		end.m_x = x;
-		end.m_y = y;
-
-		// draw the actual arrow head
-
-		double dx2 = end.m_x - start.m_x;
-		double dy2 = end.m_y - start.m_y;
-		double length = std::sqrt(dx2*dx2 + dy2*dy2);
-		dx2 /= length;
-		dy2 /= length;
-
-		double mx = end.m_x - size * dx2;
-		double my = end.m_y - size * dy2;
-	
-		double x2 = mx - size/2.5 * dy2;
-		double y2 = my + size/2.5 * dx2;
-
-		double x3 = mx + size/2.5 * dy2;
-		double y3 = my - size/2.5 * dx2;
-
-		//determine arrowhead type
-
-		//determine arrow type from m_node_arrow
-		std::map<std::pair<node, edge>, std::string>::iterator a_type_ptr;
-		a_type_ptr = m_node_arrow.find(std::make_pair(v, e));
-		std::list<double> coord;
-		bool hollow = false;
-		std::cerr << "Arrow Type: ";
-		if(a_type_ptr->second == "none"){
-			std::cerr << "NONE\n";
-		}else if(a_type_ptr->second == "filled_arrow"){
-			std::cerr << "FILLED ARROW\n";
-			coord.push_back(end.m_x);
-			coord.push_back(end.m_y);
-			coord.push_back(x2);
-			coord.push_back(y2);
-			coord.push_back(x3);
-			coord.push_back(y3);
-
-			double vx = start.m_x - end.m_x;
-			double vy = start.m_y - end.m_y;
-			double v_mag = std::sqrt(vx*vx + vy*vy);
-			double temp = 20;
-
-			end.m_x += temp*(vx/v_mag);
-			end.m_y += temp*(vy/v_mag);
-
-		}else if(a_type_ptr->second == "hollow_arrow"){
-			std::cerr << "HOLLOW ARROW\n";
-			coord.push_back(end.m_x);
-			coord.push_back(end.m_y);
-			coord.push_back(x2);
-			coord.push_back(y2);
-			coord.push_back(x3);
-			coord.push_back(y3);
-
-			double vx = start.m_x - end.m_x;
-			double vy = start.m_y - end.m_y;
-			double v_mag = std::sqrt(vx*vx + vy*vy);
-			double temp = 20;
-
-			end.m_x += temp*(vx/v_mag);
-			end.m_y += temp*(vy/v_mag);
-
-			hollow = true;
-		}else if(a_type_ptr->second == "filled_diamond"){
-			std::cerr << "FILLED DIAMOND\n";
-			coord.push_back(end.m_x);
-			coord.push_back(end.m_y);
-			coord.push_back(x2);
-			coord.push_back(y2);
-
-			double vx = start.m_x - end.m_x;
-			double vy = start.m_y - end.m_y;
-			double v_mag = std::sqrt(vx*vx + vy*vy);
-			double temp = 44;
-
-			coord.push_back(end.m_x + temp*(vx/v_mag));
-			coord.push_back(end.m_y + temp*(vy/v_mag));
-			end.m_x += temp*(vx/v_mag);
-			end.m_y += temp*(vy/v_mag);
-
-			coord.push_back(x3);
-			coord.push_back(y3);
-		}else if(a_type_ptr->second == "hollow_diamond"){
-			std::cerr << "HOLLOW DIAMOND\n";
-			coord.push_back(end.m_x);
-			coord.push_back(end.m_y);
-			coord.push_back(x2);
-			coord.push_back(y2);
-
-			double vx = start.m_x - end.m_x;
-			double vy = start.m_y - end.m_y;
-			double v_mag = std::sqrt(vx*vx + vy*vy);
-			double temp = 40;
-
-			coord.push_back(end.m_x + temp*(vx/v_mag));
-			coord.push_back(end.m_y + temp*(vy/v_mag));
-			end.m_x += temp*(vx/v_mag);
-			end.m_y += temp*(vy/v_mag);
-
-			coord.push_back(x3);
-			coord.push_back(y3);
-
-			hollow = true;
-		}else{
-			std::cerr << "ERROR\n";
-			//Error
-		}
-
-		arrowHead = drawPolygon(xmlNode, coord);
-		if(hollow){
-			arrowHead.append_attribute("stroke") = "#000000";
-			arrowHead.append_attribute("fill-opacity") = "0";
-		}
+	if(targetEnd != NoEnd) {
+		writer.start_attribute("marker-end");
+		writer << "url(#" << markerName(targetEnd) << ")";
+		writer.end_attribute();
 	}
-	//appendLineStyle(arrowHead, e);
+
+	writer.end();
 }
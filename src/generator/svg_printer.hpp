@@ -33,11 +33,20 @@
 
 #include <list>
 #include <sstream>
-#include <ogdf/lib/pugixml/pugixml.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <initializer_list>
 #include <ogdf/fileformats/GraphIO.h>
 #include <algorithm>
 #include <cmath>
 #include <ogdf/basic/Queue.h>
+#include <svg_label.hpp>
+#include <svg_arrow.hpp>
+#include <svg_writer.hpp>
+#include <svg_geometry.hpp>
+#include <svg_patch.hpp>
+#include <srcuml_cancel.hpp>
 
 namespace ogdf
 {
@@ -61,11 +70,12 @@ public:
 	 * \param attr The attributes of the graph
 	 * \param settings The SVG configuration
 	 */
-	SvgPrinter(const GraphAttributes &attr, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &nea)
+	SvgPrinter(const GraphAttributes &attr, const GraphIO::SVGSettings &settings, const svg_arrows &arrows)
 	  : m_attr(attr)
 	  , m_clsAttr(nullptr)
 	  , m_settings(settings)
-	  , m_node_arrow(nea)
+	  , m_arrows(arrows)
+	  , m_paths(attr, arrows, s_arrowSize, &SvgPrinter::markerLength)
 	{
 	}
 
@@ -75,199 +85,402 @@ public:
 	 * \param attr The attributes of the graph
 	 * \param settings The SVG configuration
 	 */
-	SvgPrinter(const ClusterGraphAttributes &attr, const GraphIO::SVGSettings &settings, const std::map<std::pair<node, edge>, std::string> &nea)
+	SvgPrinter(const ClusterGraphAttributes &attr, const GraphIO::SVGSettings &settings, const svg_arrows &arrows)
 	  : m_attr(attr)
-	  , m_clsAttr(new ClusterGraphAttributes(attr))
+	  , m_clsAttr(&attr)
 	  , m_settings(settings)
-	  , m_node_arrow(nea)
+	  , m_arrows(arrows)
+	  , m_paths(attr, arrows, s_arrowSize, &SvgPrinter::markerLength)
 	{
 	}
 
 	/**
 	 * Prints the graph and attributes of this printer to the given output stream.
+	 * Elements are written as they are drawn, nothing is kept of the document.
 	 *
 	 * @param os The stream to print to
 	 */
 	bool draw(std::ostream &os);
 
+	/**
+	 * Sets text written to a metadata element of the SVG, e.g. how it was laid out.
+	 *
+	 * @param metadata The text, nothing is written if empty
+	 */
+	void setMetadata(const std::string &metadata) { m_metadata = metadata; }
+
+	/**
+	 * Sets the label of each node, indexed by node index.  Nodes without one are drawn
+	 * with their GraphAttributes label as a single line.
+	 *
+	 * @param labels The labels, not copied, must outlive draw
+	 */
+	void setLabels(const std::vector<svg_label> *labels) { m_labels = labels; }
+
+	/**
+	 * Sets the decimals written for coordinates and sizes, trailing zeros are dropped.
+	 *
+	 * @param precision The number of decimals, 2 unless set
+	 */
+	void setPrecision(int precision) { m_precision = precision; }
+
+	/**
+	 * Sets how far a drawn edge may stray from its routed bends.  Bends within the
+	 * tolerance of a straighter path are dropped, repeated and collinear ones always are.
+	 *
+	 * @param tolerance The distance in pixels, 0.5 unless set
+	 */
+	void setTolerance(double tolerance) { m_paths.set_tolerance(tolerance); }
+
+	/**
+	 * Restricts the drawing to a tile of the layout, which becomes the viewport.
+	 * Only the clusters, edges and nodes intersecting the tile are drawn.
+	 *
+	 * @param tile The tile, not copied, must outlive draw, \c nullptr draws everything
+	 */
+	void setTile(const DRect *tile) { m_tile = tile; }
+
+	/**
+	 * Sets the threads the nodes and edges are drawn on.  Each thread draws a contiguous
+	 * part of them into its own buffer, the parts are written in order.
+	 *
+	 * @param threads The number of threads, 1 unless set
+	 */
+	void setThreads(std::size_t threads) { m_threads = threads; }
+
+	/**
+	 * Sets the token that cuts the drawing short.  Once it is cancelled the nodes and
+	 * edges not drawn yet are left out, the document is still closed.
+	 *
+	 * @param cancel The token, not copied, \c nullptr unless set
+	 */
+	void setCancel(const srcuml_cancel *cancel) { m_cancel = cancel; }
+
+	/**
+	 * Sets the patch the drawing is recorded to.  Node and edge groups are given ids
+	 * made from the labels of their nodes, which stay the same between drawings.
+	 *
+	 * @param patch The patch, not copied, \c nullptr unless set
+	 */
+	void setPatch(svg_patch *patch) { m_patch = patch; }
+
+	/**
+	 * Sets whether edges passing over nodes other than their own are drawn after the
+	 * nodes instead of hidden beneath them.  The nodes are found through a grid built
+	 * once per drawing, see svg_node_grid.
+	 *
+	 * @param raise Whether the edges are raised, false unless set
+	 */
+	void setRaiseCrossingEdges(bool raise) { m_paths.set_find_crossings(raise); m_raiseEdges = raise; }
+
 private:
-	//! attributes of the graph to be visualized
-	GraphAttributes m_attr;
+	//! attributes of the graph to be visualized, not copied, must outlive draw
+	const GraphAttributes &m_attr;
 
-	//! attributes of the cluster graph (\c nullptr if no cluster graph)
-	ClusterGraphAttributes *m_clsAttr;
+	//! attributes of the cluster graph (\c nullptr if no cluster graph), the same object as m_attr
+	const ClusterGraphAttributes *m_clsAttr;
 
 	//! SVG configuration
-	GraphIO::SVGSettings m_settings;
+	const GraphIO::SVGSettings &m_settings;
+
+	//! arrow heads of each edge, source end then target end
+	const svg_arrows &m_arrows;
+
+	//! paths of the edges drawn, clipped to their nodes and arrow heads
+	svg_edge_paths m_paths;
+
+	//! text of the metadata element
+	std::string m_metadata;
+
+	//! structured node labels by node index (\c nullptr if none)
+	const std::vector<svg_label> *m_labels = nullptr;
+
+	//! decimals of the numbers written
+	int m_precision = 2;
+
+	//! part of the layout drawn (\c nullptr for all of it)
+	const DRect *m_tile = nullptr;
+
+	//! threads drawing the nodes and edges
+	std::size_t m_threads = 1;
+
+	//! token cutting the drawing short (\c nullptr if none)
+	const srcuml_cancel *m_cancel = nullptr;
+
+	//! whether edges passing over other nodes are drawn after the nodes
+	bool m_raiseEdges = false;
+
+	//! edges drawn after the nodes, only found with m_raiseEdges
+	std::vector<edge> m_raisedEdges;
+
+	//! patch the drawing is recorded to (\c nullptr if none)
+	svg_patch *m_patch = nullptr;
+
+	//! ids of the node and edge groups by index, only given with a patch
+	std::vector<std::string> m_nodeIds, m_edgeIds;
+
+	//! markup of each node and edge group drawn by index, only kept with a patch
+	std::vector<std::string> m_nodeMarkup, m_edgeMarkup;
 
-	std::map<std::pair<node, edge>, std::string> m_node_arrow;
+	//! fewest nodes or edges worth drawing on a thread of their own
+	enum : std::size_t { s_minElementsPerThread = 256 };
+
+	/**
+	 * Draws elements in order, in parts on up to m_threads threads, until m_cancel is cancelled.
+	 *
+	 * \param writer the writer to print to, its innermost element receives the elements
+	 * \param elements the elements to be drawn
+	 * \param draw draws an element to the writer of its part
+	 */
+	template<class T, class Draw>
+	void drawInParts(svg_writer &writer, const std::vector<T> &elements, Draw draw);
+
+	//! length of an arrow head, the markers are drawn at this size
+	static constexpr double s_arrowSize = 20.0;
+
+	//! style index of elements drawn without a style class
+	enum : std::size_t { NO_STYLE = static_cast<std::size_t>(-1) };
+
+	//! CSS declarations of the style classes, class sN is m_styles[N]
+	std::vector<std::string> m_styles;
+
+	//! style class of each distinct declaration
+	std::unordered_map<std::string, std::size_t> m_styleIndex;
+
+	//! style class of each node and edge by index (NO_STYLE if none)
+	std::vector<std::size_t> m_nodeStyles, m_edgeStyles;
+
+	/**
+	 * Gives every node and edge its id, a repeated label is told apart by its occurrence.
+	 */
+	void assignIds();
+
+	/**
+	 * Draws an element, into a fragment of its own whose markup is kept if there is a patch.
+	 *
+	 * \param writer the writer to print to
+	 * \param markup the markup of the elements by index, unused without a patch
+	 * \param index the index of the element
+	 * \param draw draws the element to a writer
+	 */
+	template<class Draw>
+	void drawRecorded(svg_writer &writer, std::vector<std::string> &markup, int index, Draw draw);
 
 	/**
 	 * Draws a rectangle for each cluster in the ogdf::ClusterGraph.
 	 *
-	 * \param xmlNode the XML-node to print to
+	 * \param writer the writer to print to
 	 */
-	void drawClusters(pugi::xml_node xmlNode);
+	void drawClusters(svg_writer &writer);
 
 	/**
 	 * Draws a sequence of lines for each edge in the graph.
 	 *
-	 * \param xmlNode the XML-node to print to
+	 * \param writer the writer to print to
+	 */
+	void drawEdges(svg_writer &writer);
+
+	/**
+	 * Draws the edges in a group of their own, recording them to the patch in layer.
+	 *
+	 * \param writer the writer to print to
+	 * \param id the id of the group, only given with a patch
+	 * \param edges the edges, already clipped
+	 * \param layer the layer of the patch they are recorded to
 	 */
-	void drawEdges(pugi::xml_node xmlNode);
+	void drawEdgeGroup(svg_writer &writer, const char *id, const std::vector<edge> &edges, svg_patch::layer layer);
 
 	/**
 	 * Draws a sequence of lines for an edge.
 	 * Arrow heads are added if requested.
 	 *
-	 * \param xmlNode the XML-node to print to
+	 * \param writer the writer to print to
 	 * \param e the edge to be visualized
 	 */
-	void drawEdge(pugi::xml_node xmlNode, edge e);
+	void drawEdge(svg_writer &writer, edge e);
 
 	/**
 	 * Draws the curve depicting a particular edge.
 	 * Draws a sequence of cubic Bézier curves if requested.
 	 * Falls back to straight lines if there are exactly two points or the curviness is set to 0.
 	 *
-	 * Note that this method clears the list of points.
-	 *
-	 * \param xmlNode the XML-node to print to
+	 * \param writer the writer to print to
 	 * \param points the points along the curve
+	 * \param count the number of points, at least 2
 	 * \param e the edge depicted by the curve
-	 * \return the XML-node of the curve
+	 * \param sourceEnd the marker drawn at the start of the curve
+	 * \param targetEnd the marker drawn at the end of the curve
 	 */
-	pugi::xml_node drawCurve(pugi::xml_node xmlNode, edge e, List<DPoint> &points);
+	void drawCurve(svg_writer &writer, edge e, const DPoint *points, std::size_t count, EndType sourceEnd, EndType targetEnd);
 
 	/**
-	 * Draws the path corresponding to a single line to the stream.
+	 * Draws the path corresponding to a single line into the path data being written.
 	 *
-	 * \param ss the output stream
+	 * \param writer the writer of the path data
 	 * \param p1 the first point of the line
 	 * \param p2 the second point of the line
 	 */
-	void drawLine(std::stringstream &ss, const DPoint &p1, const DPoint &p2);
+	void drawLine(svg_writer &writer, const DPoint &p1, const DPoint &p2);
 
 	/**
 	 * Draws a list of points using cubic Bézier interpolation.
 	 *
-	 * \param ss the output stream
+	 * \param writer the writer of the path data
 	 * \param points the points to be connected by lines
+	 * \param count the number of points, at least 2
 	 */
-	void drawBezierPath(std::stringstream &ss, List<DPoint> &points);
+	void drawBezierPath(svg_writer &writer, const DPoint *points, std::size_t count);
 
 	/**
 	 * Draws a list of points as straight lines connected by circular arcs.
 	 *
-	 * \param ss the output stream
+	 * \param writer the writer of the path data
 	 * \param points the points to be connected by lines
+	 * \param count the number of points, at least 2
 	 */
-	void drawRoundPath(std::stringstream &ss, List<DPoint> &points);
+	void drawRoundPath(svg_writer &writer, const DPoint *points, std::size_t count);
 
 	/**
 	 * Draws a list of points as straight lines.
 	 *
-	 * \param ss the output stream
+	 * \param writer the writer of the path data
 	 * \param points the points to be connected by lines
+	 * \param count the number of points, at least 2
 	 */
-	void drawLines(std::stringstream &ss, List<DPoint> &points);
+	void drawLines(svg_writer &writer, const DPoint *points, std::size_t count);
 
 	/**
 	 * Draws a cubic Bezíer path.
 	 *
-	 * \param ss the output stream
+	 * \param writer the writer of the path data
 	 * \param p1 the first point of the line
 	 * \param p2 the second point of the line
 	 * \param c1 the first control point of the line
 	 * \param c2 the second control point of the line
 	 */
-	void drawBezier(std::stringstream &ss, const DPoint &p1, const DPoint &p2, const DPoint &c1, const DPoint &c2);
+	void drawBezier(svg_writer &writer, const DPoint &p1, const DPoint &p2, const DPoint &c1, const DPoint &c2);
 
 	/**
 	 * Draws all nodes of the graph.
 	 *
-	 * \param xmlNode the XML-node to print to
+	 * \param writer the writer to print to
 	 */
-	void drawNodes(pugi::xml_node xmlNode);
+	void drawNodes(svg_writer &writer);
 
 	/**
 	 * Writes the header including the bounding box as the viewport.
+	 * The root SVG-element is left open for the drawing.
 	 *
-	 * \param doc the XML-document
-	 * \return the root SVG-node
+	 * \param writer the writer to print to
 	 */
-	pugi::xml_node writeHeader(pugi::xml_document &doc);
+	void writeHeader(svg_writer &writer);
 
 	/**
-	 * Generates a string that describes the requested dash type.
+	 * Generates a CSS declaration that describes the requested dash type.
 	 *
-	 * \param xmlNode the node to append the XML-attribute to
+	 * \param writer the writer whose number format is used
+	 * \param css the declarations to append to
 	 * \param lineStyle specifies the style of the dashes
 	 * \param lineWidth the stroke width of the respective edge
 	 */
-	void writeDashArray(pugi::xml_node xmlNode, StrokeType lineStyle, double lineWidth);
+	void writeDashArray(const svg_writer &writer, std::string &css, StrokeType lineStyle, double lineWidth);
 
 	/**
-	 * Draws a single node.
+	 * Appends comma separated numbers formatted as the writer formats them.
 	 *
-	 * \param xmlNode the XML-node to print to
-	 * \param v the node to be printed
+	 * \param writer the writer whose number format is used
+	 * \param css the declarations to append to
+	 * \param numbers the numbers
 	 */
-	void drawNode(pugi::xml_node xmlNode, node v);
+	void appendNumbers(const svg_writer &writer, std::string &css, std::initializer_list<double> numbers);
 
 	/**
-	 * Draws a single cluster as a rectangle.
+	 * Returns the style class of the declarations, adding it if it is new.
 	 *
-	 * \param xmlNode the XML-node to print to
-	 * \param c the cluster to be printed
+	 * \param css the declarations of the class
 	 */
-	void drawCluster(pugi::xml_node xmlNode, cluster c);
+	std::size_t addStyle(const std::string &css);
 
 	/**
-	 * Determines whether a candidate arrow tip lies inside the rectangle of the node.
+	 * Gives every node and edge the style class of its attributes.
+	 * Elements referencing a class instead of carrying their own style attributes keep the output small.
 	 *
-	 * \param point the candidate arrow tip
-	 * \param e the edge of the arrow head
-	 * \param v the node the arrow is facing
+	 * \param writer the writer whose number format is used
 	 */
-	bool isCoveredBy(const DPoint &point, edge e, node v);
+	void collectStyles(const svg_writer &writer);
 
 	/**
-	 * Draws an arrow head at the end of the edge.
-	 * Sets the end point of the respective edge segment to the arrow head's tip.
+	 * Writes a marker for each end type, at both ends of a path, to be referenced by the edges.
 	 *
-	 * \param xmlNode the XML-node to print to
-	 * \param start the start point of the edge segment the arrow head will be placed on
-	 * \param end the end point of the edge segment the arrow head will be placed on, this will usually be modified
-	 * \param v the node that the arrow is facing
-	 * \param e the edge that the arrow belongs to
+	 * \param writer the writer to print to
 	 */
-	void drawArrowHead(pugi::xml_node xmlNode, const DPoint &start, DPoint &end, node v, edge e);
+	void writeMarkers(svg_writer &writer);
 
 	/**
-	 * Returns the size of the arrow.
+	 * Returns the id of the marker of an end type at the target end, the source end appends "_start".
 	 *
-	 * \param e the edge that the arrow belongs to
-	 * \param v the node that the arrow is facing
+	 * \param endType the end type, not NoEnd
 	 */
-	double getArrowSize(edge e, node v);
+	static const char *markerName(EndType endType);
 
 	/**
-	 * Writes the requested line style to the line's XML-node.
+	 * Returns how far the marker of an end type extends from the end of the path to its tip.
 	 *
-	 * \param line the XML-node depicting the line
-	 * \param e the edge associated with that line
+	 * \param endType the end type
+	 */
+	static double markerLength(EndType endType);
+
+	/**
+	 * Draws a single node.
+	 *
+	 * \param writer the writer to print to
+	 * \param v the node to be printed
+	 */
+	void drawNode(svg_writer &writer, node v);
+
+	/**
+	 * Draws the compartments of a node label, divided by lines.
+	 *
+	 * \param writer the writer of the node to print to
+	 * \param label the label to be drawn
+	 * \param width the width of the node
+	 */
+	void drawLabel(svg_writer &writer, const svg_label &label, double width);
+
+	/**
+	 * Draws a single cluster as a rectangle, into the group element started for it.
+	 *
+	 * \param writer the writer to print to
+	 * \param c the cluster to be printed
+	 */
+	void drawCluster(svg_writer &writer, cluster c);
+
+	/**
+	 * Determines whether a box intersects the tile, always true without one.
+	 *
+	 * \param left the smallest x-coordinate of the box
+	 * \param top the smallest y-coordinate of the box
+	 * \param right the largest x-coordinate of the box
+	 * \param bottom the largest y-coordinate of the box
 	 */
-	void appendLineStyle(pugi::xml_node line, edge e);
+	bool isVisible(double left, double top, double right, double bottom) const;
+
+	//! whether the node's rectangle intersects the tile
+	bool isVisible(node v) const;
+
+	//! whether the bounding box of the edge's end points and bends intersects the tile
+	bool isVisible(edge e) const;
+
+	//! whether the cluster's rectangle intersects the tile
+	bool isVisible(cluster c) const;
 
 	/**
-	 * Draws a polygon with the respective points.
+	 * Writes the style class of the line to the line's element.
 	 *
-	 * \param xmlNode the XML-node to print to
-	 * \param points the list of coordinates
-	 * \return The generated XML-node
+	 * \param writer the writer of the element depicting the line
+	 * \param e the edge associated with that line
 	 */
-	pugi::xml_node drawPolygon(pugi::xml_node xmlNode, const std::list<double> points);
+	void appendLineStyle(svg_writer &writer, edge e);
 };
 
 }
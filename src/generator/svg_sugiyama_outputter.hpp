@@ -3,41 +3,50 @@
 
 
 #include <svg_outputter.hpp>
+#include <svg_layout.hpp>
 
 class svg_sugiyama_outputter : public svg_outputter {
 
 public:
 
-	svg_sugiyama_outputter(){
-		ga.init(g,
-		GraphAttributes::nodeGraphics |
-		GraphAttributes::edgeGraphics |
-		GraphAttributes::nodeLabel |
-		GraphAttributes::edgeLabel |
-		GraphAttributes::nodeType  |
-		GraphAttributes::edgeType  |
-		GraphAttributes::edgeArrow |
-		GraphAttributes::nodeStyle |
-		GraphAttributes::edgeStyle |
-		GraphAttributes::nodeTemplate);
+	/** layout_budget in milliseconds, see svg_layout, an empty layout_cache path disables the cache */
+	svg_sugiyama_outputter(std::size_t layout_budget = 0, bool layout_components = false, std::size_t threads = 1,
+						   const std::string & layout_cache = "", std::size_t crossmin_runs = 1)
+		: layout(layout_budget, layout_components, threads, crossmin_runs), layout_cache(layout_cache) {
+		init_attributes();
+	}
+
+	/** graphs of more than nodes classes use a fast layout, see svg_layout */
+	void use_optimal_limit(std::size_t nodes){
+		layout.use_optimal_limit(nodes);
 	}
 
 	bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+		srcuml_stats::timer graph_timer(get_stats(), "graph");
+		reset_graph();
+
 		//transfer information from srcUML to ogdf
 		srcuml_relationships relationships = analyze_relationships(classes);
-		std::map<std::string, node> class_node_map;
+		//relationships between the same classes are merged into the strongest
+		const std::vector<srcuml_edge> merged = merge_edges(relationships, false);
+
+		std::vector<node> nodes;
+		std::vector<ogdf::edge> edges;
+		build_graph(g, classes, merged, nodes, edges);
+		init_attributes();
+
+		std::vector<svg_label> labels(classes.size());
 
 		//Classes/Nodes
 		//===============================================================================================================
-		for(const std::shared_ptr<srcuml_class> & aclass : classes){
-			node cur_node = g.newNode();
-			//Insert into map the node class pairing
-			class_node_map.insert(std::pair<std::string, node>(aclass->get_srcuml_name(), cur_node));
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			const std::shared_ptr<srcuml_class> & aclass = classes[pos];
+			node cur_node = nodes[pos];
 
-			std::string& label = ga.label(cur_node);
+			ga.label(cur_node) = aclass->get_srcuml_name();
 			int num_lines = 0;
 			int longest_line = 0;
-			label = generate_label(aclass, num_lines, longest_line);
+			set_label(labels, cur_node, generate_label(aclass, num_lines, longest_line));
 
 			double& h = ga.height(cur_node);
 			h = num_lines * 1.3 * 10;//num_lines * 50;
@@ -55,122 +64,63 @@ public:
 
 		//Relationships/Edges
 		//===============================================================================================================
-		std::multimap<std::pair<node, node>, relationship_type> edge_type_map;
-		std::map<std::pair<node, edge>, std::string> ne_arrow;
-
-		for(const srcuml_relationship relationship : relationships.get_relationships()){
-			//get the nodes from graph g, create edge and add appropriate info.
-			node lhs, rhs;
-
-			std::map<std::string, node>::iterator src_it = class_node_map.find(relationship.get_source());
-			if(src_it != class_node_map.end()){
-				lhs = src_it->second;
-			}
-
-			std::map<std::string, node>::iterator dest_it = class_node_map.find(relationship.get_destination());
-			if(dest_it != class_node_map.end()){
-				rhs = dest_it->second;
-			}
-
-			//find possible occurnce of edge already
-			auto itr = edge_type_map.find( std::pair<node, node>(lhs, rhs) );
-
-			//If edge doesn't exist, add it
-			if(itr == edge_type_map.end()){
-				edge_type_map.insert(std::pair<std::pair<node,node>, 
-					relationship_type> (std::pair<node,node>(lhs,rhs), relationship.get_type()) );
-				edge_type_map.insert(std::pair<std::pair<node,node>, 
-					relationship_type> (std::pair<node,node>(rhs,lhs), NONE_TYPE ) );
-
-			//if edge does exist, check that the new relation isn't stronger
-			}else{
-				if(itr->second == ASSOCIATION && (relationship.get_type() == BIDIRECTIONAL 
-											   || relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}else if(itr->second == BIDIRECTIONAL && (relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}else if(itr->second == AGGREGATION && (relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-				}
-			}
-			
-		}
-
-		//after do a loop to add to graph
-		for(auto edge : edge_type_map){
+		svg_arrows arrows(g, std::make_pair(NoEnd, NoEnd));
 
-			if(edge.second == NONE_TYPE)continue;
-			//edge.first.first  = source 
-			//edge.first.second = destination
-			//edge.second       = relationship type
+		for(std::size_t pos = 0; pos < merged.size(); ++pos){
 
-			ogdf::edge cur_edge = g.newEdge(edge.first.first, edge.first.second);
+			const srcuml_edge & edge = merged[pos];
+			ogdf::edge cur_edge = edges[pos];
 
-			ga.strokeWidth(cur_edge) = 2;
+			ga.strokeWidth(cur_edge) = edge_width(2, edge.weight);
 
 			StrokeType &st = ga.strokeType(cur_edge);
 			EdgeArrow &ea = ga.arrowType(cur_edge);
 			Graph::EdgeType &et = ga.type(cur_edge);
 
-			const relationship_type r_type = edge.second;
+			const relationship_type r_type = edge.type;
+			relationship_types[cur_edge] = r_type;
 			switch(r_type){
 			case DEPENDENCY:
-				std::cerr << "Dependency\n";
 				st = StrokeType::Dash;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::dependency;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "none"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
+				arrows[cur_edge] = std::make_pair(NoEnd, FilledTriangle);
 				break;
 			case ASSOCIATION:
-				std::cerr << "Association\n";
 				st = StrokeType::Solid;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "none"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
+				arrows[cur_edge] = std::make_pair(NoEnd, FilledTriangle);
 				break;
 			case BIDIRECTIONAL:
-				std::cerr << "Bidirectional\n";
 				st = StrokeType::Solid;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "filled_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "filled_arrow"));
+				arrows[cur_edge] = std::make_pair(FilledTriangle, FilledTriangle);
 				break;
 			case AGGREGATION:
-				std::cerr << "Aggregation\n";
 				st = StrokeType::Solid;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_diamond"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
+				arrows[cur_edge] = std::make_pair(HollowDiamond, NoEnd);
 				break;
 			case COMPOSITION:
-				std::cerr << "Composition\n";
 				st = StrokeType::Solid;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::association;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "filled_diamond"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
+				arrows[cur_edge] = std::make_pair(FilledDiamond, NoEnd);
 				break;
 			case GENERALIZATION:
-				std::cerr << "Generalization\n";
 				st = StrokeType::Dash;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::generalization;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
+				arrows[cur_edge] = std::make_pair(HollowTriangle, NoEnd);
 				break;
 			case REALIZATION:
-				std::cerr << "Realization\n";
 				st = StrokeType::Dash;
 				ea = EdgeArrow::Both;
 				et = Graph::EdgeType::generalization;
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.first, cur_edge), "hollow_arrow"));
-				ne_arrow.insert(std::make_pair(std::make_pair(edge.first.second, cur_edge), "none"));
+				arrows[cur_edge] = std::make_pair(HollowTriangle, NoEnd);
 				break;
 			}
 		}
@@ -178,24 +128,28 @@ public:
 
 		//Layout
 		//===============================================================================================================
+		graph_timer.stop();
+		srcuml_stats::timer layout_timer(get_stats(), "layout");
+		layout.use_cancel(get_cancel());
+
+
+		std::unique_ptr<svg_layout_cache> cache;
+		if(!layout_cache.empty())
+			cache.reset(new svg_layout_cache(layout_cache));
+
+		const std::string layout_description = layout.call(ga, cache.get());
+		if(cache)
+			cache->save();
+		if(get_stats())
+			get_stats()->set_note("svg_sugiyama layout", layout_description);
+		if(cache && get_stats()) {
+			get_stats()->add_count("layout cache hits", cache->get_hits());
+			get_stats()->add_count("layout cache misses", cache->get_misses());
+		}
 
-		SugiyamaLayout sl;
-		sl.setRanking(new OptimalRanking);
-		sl.setCrossMin(new MedianHeuristic);
- 
-		OptimalHierarchyLayout *ohl = new OptimalHierarchyLayout;
-		ohl->layerDistance(50.0);
-		ohl->nodeDistance(50.0);
-		ohl->weightBalancing(1);
-		sl.setLayout(ohl);
-
-		sl.call(ga);
+		layout_timer.stop();
 
-		GraphIO::SVGSettings * svg_settings = new ogdf::GraphIO::SVGSettings();
-		
-		if(!drawSVG(ga, out, *svg_settings, ne_arrow)){
-			std::cout << "Error Write" << std::endl;
-		}
+		draw(out, arrows, labels, layout_description);
 
 		//===============================================================================================================
 
@@ -203,15 +157,50 @@ public:
 		return true;
 	}
 
-private:
+protected:
+
+	/** writes the laid out graph ga, by default as SVG */
+	virtual void draw(std::ostream &out, const svg_arrows &arrows, const std::vector<svg_label> &labels, const std::string &layout_description){
+		GraphIO::SVGSettings svg_settings;
+		
+		if(!drawSVG(ga, out, svg_settings, arrows, labels, layout_description)){
+			throw std::string("Error: Unable to write the svg_sugiyama drawing");
+		}
+		drawTiles(ga, svg_settings, arrows, labels);
+	}
+
+	/** an empty graph without attributes, so every output starts afresh, see output */
+	void reset_graph(){
+		ga.init(g, 0);
+		relationship_types.init();
+		g.clear();
+	}
+
+	/** the attributes of the graph built, see build_graph */
+	void init_attributes(){
+		relationship_types.init(g, NONE_TYPE);
+		ga.init(g,
+		GraphAttributes::nodeGraphics |
+		GraphAttributes::edgeGraphics |
+		GraphAttributes::nodeLabel |
+		GraphAttributes::edgeLabel |
+		GraphAttributes::nodeType  |
+		GraphAttributes::edgeType  |
+		GraphAttributes::edgeArrow |
+		GraphAttributes::nodeStyle |
+		GraphAttributes::edgeStyle |
+		GraphAttributes::nodeTemplate);
+	}
+
+	svg_layout layout;
+	std::string layout_cache;
 
 	Graph g;
 
 	GraphAttributes ga;
 
-	ClusterGraph cg;
-
-	ClusterGraphAttributes cga;
+	// relationship drawn by each edge
+	EdgeArray<relationship_type> relationship_types;
 
 };
 
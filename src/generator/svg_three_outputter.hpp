@@ -4,72 +4,98 @@
 #include <ogdf/cluster/ClusterOrthoLayout.h>
 #include <ogdf/cluster/ClusterPlanRep.h>
 #include <svg_outputter.hpp>
-
+#include <svg_layout.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <memory>
+
+/**
+ * svg_three_outputter
+ *
+ * Classes clustered by stereotype into Boundary, Control and Entity.  Laid out
+ * with ClusterPlanarizationLayout, or, with bands, each cluster is laid out on
+ * its own in parallel as a layered band, the bands are placed side by side and
+ * edges between bands are routed through the gaps between them.  A run with a
+ * deadline always uses the bands, as they can be abandoned for a fast layout.
+ */
 class svg_three_outputter : public svg_outputter {
 
 public:
 
-	svg_three_outputter(){
-		cg.init(g);
+	// space between bands, edges between bands turn in its middle
+	static constexpr double BAND_SPACING = 80.0;
+	// space around the classes of a band inside its box
+	static constexpr double BAND_MARGIN = 20.0;
 
-		cga.init(cg,
-		GraphAttributes::nodeGraphics |
-		GraphAttributes::edgeGraphics |
-		GraphAttributes::nodeLabel |
-		GraphAttributes::edgeLabel |
-		GraphAttributes::nodeStyle |
-		GraphAttributes::edgeStyle |
-		GraphAttributes::nodeTemplate);
+	/** layout_budget in milliseconds, see svg_layout, an empty layout_cache path disables the cache of the bands */
+	svg_three_outputter(bool bands = false, std::size_t threads = 1, std::size_t layout_budget = 0, const std::string & layout_cache = "")
+		: bands(bands), threads(threads), layout(layout_budget), layout_cache(layout_cache) {
+		init_attributes();
+	}
+
+	/** graphs of more than nodes classes use a fast layout, see svg_layout */
+	void use_optimal_limit(std::size_t nodes){
+		layout.use_optimal_limit(nodes);
 	}
 
 	bool output(std::ostream& out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+		srcuml_stats::timer graph_timer(get_stats(), "graph");
+		reset_graph();
+
 		//transfer information from srcUML to ogdf
 
 		srcuml_relationships relationships = analyze_relationships(classes);
-		std::map<std::string, ogdf::node> class_node_map;
+		//relationships between the same classes are merged into the strongest
+		const std::vector<srcuml_edge> merged = merge_edges(relationships, true);
+
+		std::vector<node> nodes;
+		std::vector<ogdf::edge> edges;
+		build_graph(g, classes, merged, nodes, edges);
+		init_attributes();
+
+		std::vector<svg_label> labels(classes.size());
 
 		SList<node> ctrl, bndr, enty;
+		// classes of no band, not boxed
+		std::vector<node> othr;
 
 		//Classes/Nodes
 		//===============================================================================================================
-		for(const std::shared_ptr<srcuml_class> & aclass : classes){
-			node cur_node = g.newNode();
-			//Insert into map the node class pairing
-			class_node_map.insert(std::pair<std::string, ogdf::node>(aclass->get_srcuml_name(), cur_node));
-
+		for(std::size_t pos = 0; pos < classes.size(); ++pos){
+			const std::shared_ptr<srcuml_class> & aclass = classes[pos];
+			node cur_node = nodes[pos];
 
 			int num_lines = 0;
 			int longest_line = 0;
-			cga.label(cur_node) = generate_label(aclass, num_lines, longest_line);
+			cga.label(cur_node) = aclass->get_srcuml_name();
+			set_label(labels, cur_node, generate_label(aclass, num_lines, longest_line));
 			cga.height(cur_node) = num_lines * 1.3 * 10;//num_lines * 50;
 
 			cga.width(cur_node) = longest_line * .75 * 10;
 			//longest_line * 10;
 
-			std::string stereo = "";
-			if(aclass->get_stereotypes().begin() != aclass->get_stereotypes().end()){
-				stereo = *(aclass->get_stereotypes().begin());
-			}
-
 			Color& color = cga.fillColor(cur_node);
 
-			if(stereo == "control"){
-				
+			switch(aclass->get_category()){
+			case CONTROL_CATEGORY:
 				color = Color(224, 0, 0, 100);
 				ctrl.pushBack(cur_node);
-
-			}else if(stereo == "boundary"){
-
+				break;
+			case BOUNDARY_CATEGORY:
 				color = Color(0, 224, 0, 100);
 				bndr.pushBack(cur_node);
-
-			}else if(stereo == "entity"){
-
+				break;
+			case ENTITY_CATEGORY:
 				color = Color(0, 0, 224, 100);
 				enty.pushBack(cur_node);
-
-			}else if(stereo == ""){
+				break;
+			case NO_CATEGORY:
 				color = Color(130, 130, 130, 200);
+				othr.push_back(cur_node);
+				break;
+			case OTHER_CATEGORY:
+				othr.push_back(cur_node);
+				break;
 			}
 		}
 		//===============================================================================================================
@@ -80,49 +106,11 @@ public:
 		//===============================================================================================================
 		//std::multimap<std::string, std::string> edge_map;
 		//std::map<edge, relationship_type> edge_type_map;
-		std::multimap<std::pair<node, node>, relationship_type> edge_type_map;
-		std::map<std::pair<node, edge>, std::string> ne_arrow;
-
-		for(const srcuml_relationship relationship : relationships.get_relationships()){
-			//get the nodes from graph g, create edge and add appropriate info.
-			ogdf::node lhs, rhs;
-
-			std::map<std::string, ogdf::node>::iterator src_it = class_node_map.find(relationship.get_source());
-			if(src_it != class_node_map.end()){
-				lhs = src_it->second;
-			}
-
-			std::map<std::string, ogdf::node>::iterator dest_it = class_node_map.find(relationship.get_destination());
-			if(dest_it != class_node_map.end()){
-				rhs = dest_it->second;
-			}
-
+		svg_arrows arrows(g, std::make_pair(NoEnd, NoEnd));
 
-			//find possible occurnce of edge already
-			auto itr = edge_type_map.find( std::pair<node, node>(lhs, rhs) );
-			if(itr == edge_type_map.end()){
-				edge_type_map.insert( std::pair<std::pair<node,node>, relationship_type> (std::pair<node,node>(lhs,rhs) , relationship.get_type()) );
-			}else{
-				if(itr->second == ASSOCIATION && (relationship.get_type() == BIDIRECTIONAL 
-											   || relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
+		for(std::size_t pos = 0; pos < merged.size(); ++pos){
 
-				}else if(itr->second == BIDIRECTIONAL && (relationship.get_type() == AGGREGATION
-											   || relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-
-				}else if(itr->second == AGGREGATION && (relationship.get_type() == COMPOSITION)){
-					itr->second = relationship.get_type();
-
-				}
-				//check the relationship type and chose based on the heirarchy
-			}
-			
-		}
-
-		//after do a loop to add to graph
-		for(auto edge : edge_type_map){
+			const srcuml_edge & edge = merged[pos];
 
 			/*
 				Run through the relationships and make a map of them first, determing there which is best
@@ -139,15 +127,15 @@ public:
 				}
 			*/
 
-			ogdf::edge cur_edge = g.newEdge(edge.first.first, edge.first.second);
+			ogdf::edge cur_edge = edges[pos];
 			//edge_type_map.insert(std::pair<ogdf::edge, relationship_type>(cur_edge, edge.second));
 
 			//ogdf::edge cur_edge = g.newEdge(lhs, rhs);//need to pass to ogdf::node types
-			cga.strokeWidth(cur_edge) = 2;
+			cga.strokeWidth(cur_edge) = edge_width(2, edge.weight);
 
 			StrokeType &st = cga.strokeType(cur_edge);
 
-			const relationship_type r_type = edge.second;
+			const relationship_type r_type = edge.type;
 			switch(r_type){
 			case DEPENDENCY:
 				st = StrokeType::Dash;
@@ -204,14 +192,32 @@ public:
 	
 		//===============================================================================================================
 	
-		ClusterPlanarizationLayout cpl;
-		cpl.call(g, cga, cg);
+		graph_timer.stop();
+		srcuml_stats::timer layout_timer(get_stats(), "layout");
+		layout.use_cancel(get_cancel());
+
+		// ClusterPlanarizationLayout cannot be abandoned at a deadline, the bands can
+		const bool has_deadline = srcuml_cancel::remaining(get_cancel()) != srcuml_cancel::NO_DEADLINE;
+
+		std::string layout_description;
+		if(bands || has_deadline){
+			layout_description = layout_bands({ to_vector(bndr), to_vector(ctrl), to_vector(enty), othr }, { boundary, control, entity, nullptr });
+			if(get_stats())
+				get_stats()->set_note("svg_three layout", layout_description);
+		}else{
+			ClusterPlanarizationLayout cpl;
+			srcuml_trace::span span("ClusterPlanarizationLayout", "ogdf");
+			cpl.call(g, cga, cg);
+		}
+
+		layout_timer.stop();
 
-		GraphIO::SVGSettings * svg_settings = new ogdf::GraphIO::SVGSettings();
+		GraphIO::SVGSettings svg_settings;
 		
-		if(!drawSVG(cga, out, *svg_settings, ne_arrow)){
-			std::cout << "Error Write" << std::endl;
+		if(!drawSVG(cga, out, svg_settings, arrows, labels, layout_description)){
+			throw std::string("Error: Unable to write the svg_three drawing");
 		}
+		drawTiles(cga, svg_settings, arrows, labels);
 	
 
 	/*
@@ -226,6 +232,146 @@ public:
 
 private:
 
+	static std::vector<node> to_vector(const SList<node> & list) {
+
+		std::vector<node> nodes;
+		for(node v : list)
+			nodes.push_back(v);
+
+		return nodes;
+
+	}
+
+	/** bands left to right, a band without a cluster is not boxed */
+	std::string layout_bands(const std::vector<std::vector<node>> & band_nodes, const std::vector<cluster> & band_clusters) {
+
+		std::vector<int> band_of(g.maxNodeIndex() + 1, -1);
+		std::vector<svg_layout::component> parts(band_nodes.size());
+		for(std::size_t band = 0; band < band_nodes.size(); ++band){
+			for(node v : band_nodes[band]){
+				band_of[v->index()] = band;
+				parts[band].nodes.push_back(v);
+			}
+		}
+
+		std::vector<ogdf::edge> between;
+		for(ogdf::edge e : g.edges){
+			const int source_band = band_of[e->source()->index()];
+			if(source_band == band_of[e->target()->index()])
+				parts[source_band].edges.push_back(e);
+			else
+				between.push_back(e);
+		}
+
+		std::unique_ptr<svg_layout_cache> cache;
+		if(!layout_cache.empty())
+			cache.reset(new svg_layout_cache(layout_cache));
+
+		//a band whose classes and edges are unchanged keeps its drawing
+		std::vector<std::unique_ptr<svg_layout::layout_copy>> copies(parts.size());
+		std::vector<std::uint64_t> fingerprints(parts.size());
+		std::vector<std::size_t> misses;
+		std::vector<int> positions;
+		for(std::size_t pos = 0; pos < parts.size(); ++pos){
+			copies[pos].reset(new svg_layout::layout_copy(cga, parts[pos]));
+			if(cache){
+				fingerprints[pos] = svg_layout_cache::fingerprint(cga, parts[pos].nodes, parts[pos].edges, positions);
+				const svg_layout_cache::drawing * entry = cache->find(fingerprints[pos]);
+				if(entry && entry->positions.size() == parts[pos].nodes.size() && entry->bends.size() == parts[pos].edges.size()){
+					svg_layout_cache::apply(*entry, copies[pos]->attributes, copies[pos]->nodes, copies[pos]->edges);
+					continue;
+				}
+			}
+			misses.push_back(pos);
+		}
+
+		srcuml::parallel_ranges(misses.size(), threads, [&](std::size_t first, std::size_t last) {
+			for(std::size_t pos = first; pos < last; ++pos){
+				layout.call(copies[misses[pos]]->attributes);
+			}
+		});
+
+		if(cache){
+			// a drawing degraded by the deadline is not kept
+			if(!srcuml_cancel::is_cancelled(get_cancel())){
+				for(std::size_t pos : misses)
+					cache->store(fingerprints[pos], copies[pos]->attributes, copies[pos]->nodes, copies[pos]->edges);
+			}
+			cache->save();
+
+			if(get_stats()){
+				get_stats()->add_count("layout cache hits", cache->get_hits());
+				get_stats()->add_count("layout cache misses", cache->get_misses());
+			}
+		}
+
+		//side by side with their tops aligned
+		std::vector<double> lefts(parts.size()), rights(parts.size());
+		double x = 0;
+		for(std::size_t band = 0; band < parts.size(); ++band){
+			lefts[band] = rights[band] = x;
+			if(parts[band].nodes.empty())
+				continue;
+
+			const std::vector<double> extent = svg_layout::extent(copies[band]->attributes);
+			copies[band]->copy_to(cga, parts[band], x - extent[0], -extent[1]);
+			rights[band] = x + extent[2];
+
+			if(band_clusters[band]){
+				cga.x(band_clusters[band]) = x - BAND_MARGIN;
+				cga.y(band_clusters[band]) = -BAND_MARGIN;
+				cga.width(band_clusters[band]) = extent[2] + 2 * BAND_MARGIN;
+				cga.height(band_clusters[band]) = extent[3] + 2 * BAND_MARGIN;
+			}
+
+			x = rights[band] + BAND_SPACING;
+		}
+
+		//leave the source band through the gap facing the target band
+		for(ogdf::edge e : between){
+			const int source_band = band_of[e->source()->index()];
+			const int target_band = band_of[e->target()->index()];
+			const double gap = source_band < target_band ? rights[source_band] + BAND_SPACING / 2 : lefts[source_band] - BAND_SPACING / 2;
+
+			DPolyline & bends = cga.bends(e);
+			bends.clear();
+			bends.pushBack(DPoint(gap, cga.y(e->source())));
+			bends.pushBack(DPoint(gap, cga.y(e->target())));
+		}
+
+		std::string description = "srcUML layout: " + std::to_string(parts.size()) + " bands laid out separately, ";
+		if(cache)
+			description += std::to_string(parts.size() - misses.size()) + " from the layout cache, ";
+
+		return description + std::to_string(between.size()) + " edges between bands";
+
+	}
+
+	/** an empty graph, so every output starts afresh, see output */
+	void reset_graph(){
+		cga.init(cg, 0);
+		g.clear();
+	}
+
+	/** the clusters and attributes of the graph built, see build_graph */
+	void init_attributes(){
+		cg.init(g);
+
+		cga.init(cg,
+		GraphAttributes::nodeGraphics |
+		GraphAttributes::edgeGraphics |
+		GraphAttributes::nodeLabel |
+		GraphAttributes::edgeLabel |
+		GraphAttributes::nodeStyle |
+		GraphAttributes::edgeStyle |
+		GraphAttributes::nodeTemplate);
+	}
+
+	bool bands;
+	std::size_t threads;
+	svg_layout layout;
+	std::string layout_cache;
+
 	Graph g;
 
 	ClusterGraph cg;
@@ -0,0 +1,157 @@
+/**
+ * @file svg_tiles.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_TILES_HPP
+#define INCLUDED_SVG_TILES_HPP
+
+#include <svg_printer.hpp>
+#include <svg_label.hpp>
+#include <svg_arrow.hpp>
+#include <srcuml_utilities.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * svg_tiles
+ *
+ * Draws a laid out graph as a grid of SVG tiles, each only holding the
+ * clusters, edges and nodes that intersect it, so a viewer only loads what is
+ * visible.  Tiles are drawn in parallel.  Next to them a JSON manifest gives
+ * the bounds of the drawing and of every tile, and the position and tile of
+ * every class:
+ *
+ *   {"tile_size": 2000, "bounds": [x, y, width, height], "rows": 1, "columns": 2,
+ *    "tiles": [{"file": "svg_sugiyama_0_0.svg", "row": 0, "column": 0, "bounds": [...]}, ...],
+ *    "classes": [{"name": "A", "x": 10, "y": 20, "tile": 0}, ...]}
+ */
+class svg_tiles {
+
+private:
+
+	std::string directory;
+	std::string name;
+	double tile_size;
+	std::size_t threads;
+
+public:
+
+	enum : int { DEFAULT_TILE_SIZE = 2000 };
+
+	/** an empty directory writes no tiles, name prefixes the files, tile_size is in layout units */
+	svg_tiles(const std::string & directory = "", const std::string & name = "", double tile_size = DEFAULT_TILE_SIZE, std::size_t threads = 1)
+		: directory(directory), name(name), tile_size(tile_size > 0 ? tile_size : DEFAULT_TILE_SIZE), threads(threads) {}
+
+	bool is_enabled() const {
+		return !directory.empty();
+	}
+
+	/** writes <directory>/<name>_<row>_<column>.svg and <directory>/<name>.json */
+	template<class attributes_type>
+	void write(const attributes_type & attributes, const ogdf::GraphIO::SVGSettings & settings,
+			   const svg_arrows & arrows, const std::vector<svg_label> & labels) const {
+
+		const ogdf::DRect box = attributes.boundingBox();
+		const std::size_t columns = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(box.width() / tile_size)));
+		const std::size_t rows = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(box.height() / tile_size)));
+
+		std::vector<ogdf::DRect> tiles;
+		for(std::size_t row = 0; row < rows; ++row)
+			for(std::size_t column = 0; column < columns; ++column) {
+
+				const ogdf::DPoint corner(box.p1().m_x + column * tile_size, box.p1().m_y + row * tile_size);
+				tiles.push_back(ogdf::DRect(corner, ogdf::DPoint(corner.m_x + tile_size, corner.m_y + tile_size)));
+
+			}
+
+		srcuml::parallel_ranges(tiles.size(), threads, [&](std::size_t first, std::size_t last) {
+
+			for(std::size_t pos = first; pos < last; ++pos) {
+
+				std::ofstream out(directory + "/" + file_name(pos / columns, pos % columns));
+				if(!out)
+					throw std::string("Error: Unable to write SVG tile to ") + directory;
+
+				ogdf::SvgPrinter printer(attributes, settings, arrows);
+				printer.setLabels(&labels);
+				printer.setTile(&tiles[pos]);
+				printer.draw(out);
+
+			}
+
+		});
+
+		std::ofstream manifest(directory + "/" + name + ".json");
+		if(!manifest)
+			throw std::string("Error: Unable to write tile manifest to ") + directory;
+
+		manifest << "{\"tile_size\": " << srcuml::json_number(tile_size)
+				 << ", \"bounds\": " << bounds(box)
+				 << ", \"rows\": " << rows << ", \"columns\": " << columns
+				 << ",\n \"tiles\": [";
+
+		for(std::size_t pos = 0; pos < tiles.size(); ++pos) {
+
+			manifest << (pos ? ",\n  " : "\n  ")
+					 << "{\"file\": \"" << file_name(pos / columns, pos % columns)
+					 << "\", \"row\": " << pos / columns << ", \"column\": " << pos % columns
+					 << ", \"bounds\": " << bounds(tiles[pos]) << "}";
+
+		}
+
+		manifest << "],\n \"classes\": [";
+
+		bool is_first = true;
+		for(ogdf::node v : attributes.constGraph().nodes) {
+
+			const double x = attributes.x(v);
+			const double y = attributes.y(v);
+			const std::size_t column = std::min(columns - 1, static_cast<std::size_t>(std::max(0.0, (x - box.p1().m_x) / tile_size)));
+			const std::size_t row = std::min(rows - 1, static_cast<std::size_t>(std::max(0.0, (y - box.p1().m_y) / tile_size)));
+
+			manifest << (is_first ? "\n  " : ",\n  ")
+					 << "{\"name\": \"" << srcuml::json_escape(attributes.label(v))
+					 << "\", \"x\": " << srcuml::json_number(x) << ", \"y\": " << srcuml::json_number(y)
+					 << ", \"tile\": " << row * columns + column << "}";
+			is_first = false;
+
+		}
+
+		manifest << "]}\n";
+
+	}
+
+private:
+
+	std::string file_name(std::size_t row, std::size_t column) const {
+		return name + "_" + std::to_string(row) + "_" + std::to_string(column) + ".svg";
+	}
+
+	static std::string bounds(const ogdf::DRect & rect) {
+		return "[" + srcuml::json_number(rect.p1().m_x) + ", " + srcuml::json_number(rect.p1().m_y) + ", " + srcuml::json_number(rect.width()) + ", " + srcuml::json_number(rect.height()) + "]";
+	}
+
+};
+
+#endif
@@ -0,0 +1,370 @@
+/**
+ * @file svg_writer.hpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDED_SVG_WRITER_HPP
+#define INCLUDED_SVG_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdio>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * svg_writer
+ *
+ * Writes XML elements to a stream as they are drawn instead of building a
+ * document first.  The output is formatted as pugixml saves a document with
+ * its default flags: a declaration, one element per line indented by tabs,
+ * empty elements closed with " />" and an element holding only text on one
+ * line.  Elements are started, given attributes and text, and ended in
+ * document order; attributes can only be added before the first child.
+ *
+ * Numbers are written straight into the buffer with a fixed number of
+ * decimals, trailing zeros dropped, so no string is made per coordinate.
+ * An attribute made of several values is written with start_attribute,
+ * value, or operator<<, and end_attribute.
+ *
+ * A fragment writer keeps its elements in memory so that parts of a
+ * document can be drawn on other threads, then appended in document order.
+ */
+class svg_writer {
+
+private:
+
+	enum : std::size_t { BUFFER_SIZE = 1 << 16 };
+	enum : int { MAX_PRECISION = 9 };
+
+	// nullptr for a fragment, which keeps its buffer until appended
+	std::ostream * out;
+	std::string buffer;
+
+	// elements open around a fragment, written as indentation
+	std::size_t depth;
+
+	// names of the elements not yet ended
+	std::vector<std::string> elements;
+	// the start tag of the innermost element is still open for attributes
+	bool in_start_tag;
+	// the innermost element holds text, which is written on its line
+	bool has_text;
+
+	// decimals of numbers and 10 to their power
+	int precision;
+	long long scale;
+
+public:
+
+	svg_writer(std::ostream & out, int precision = 2)
+		: out(&out), buffer(), depth(0), elements(), in_start_tag(false), has_text(false), precision(0), scale(1) {
+
+		set_precision(precision);
+
+		buffer.reserve(BUFFER_SIZE);
+		buffer += "<?xml version=\"1.0\"?>\n";
+
+	}
+
+	/** a fragment of the children of the innermost element of parent, see append */
+	svg_writer(const svg_writer & parent, std::size_t reserve)
+		: out(nullptr), buffer(), depth(parent.depth + parent.elements.size()), elements(), in_start_tag(false), has_text(false),
+		  precision(parent.precision), scale(parent.scale) {
+
+		buffer.reserve(reserve);
+
+	}
+
+	~svg_writer() {
+
+		while(!elements.empty())
+			end();
+		flush();
+
+	}
+
+	/** decimals of the numbers written from now on, at most MAX_PRECISION */
+	void set_precision(int digits) {
+
+		precision = std::max(0, std::min<int>(digits, MAX_PRECISION));
+
+		scale = 1;
+		for(int digit = 0; digit < precision; ++digit)
+			scale *= 10;
+
+	}
+
+	void start(const char * name) {
+
+		close_start_tag();
+		indent();
+		buffer += '<';
+		buffer += name;
+
+		elements.push_back(name);
+		in_start_tag = true;
+		has_text = false;
+
+	}
+
+	void attribute(const char * name, const char * text) {
+
+		start_attribute(name);
+		value(text);
+		end_attribute();
+
+	}
+
+	void attribute(const char * name, const std::string & text) {
+		attribute(name, text.c_str());
+	}
+
+	void attribute(const char * name, double number) {
+
+		start_attribute(name);
+		value(number);
+		end_attribute();
+
+	}
+
+	void attribute(const char * name, int number) {
+		attribute(name, static_cast<double>(number));
+	}
+
+	void start_attribute(const char * name) {
+
+		buffer += ' ';
+		buffer += name;
+		buffer += "=\"";
+
+	}
+
+	void value(const char * text) {
+		escape(text, true);
+	}
+
+	void value(const std::string & text) {
+		escape(text.c_str(), true);
+	}
+
+	void value(char character) {
+		buffer += character;
+	}
+
+	void value(double number) {
+
+		char digits[NUMBER_SIZE];
+		buffer.append(digits, format(number, digits));
+
+	}
+
+	void end_attribute() {
+		buffer += '"';
+	}
+
+	/** values of the attribute started last, e.g. the points of a path */
+	svg_writer & operator<<(const char * text) {
+
+		value(text);
+		return *this;
+
+	}
+
+	svg_writer & operator<<(double number) {
+
+		value(number);
+		return *this;
+
+	}
+
+	svg_writer & operator<<(int number) {
+
+		value(static_cast<double>(number));
+		return *this;
+
+	}
+
+	/** the only content of the innermost element */
+	void text(const std::string & value) {
+
+		buffer += '>';
+		escape(value.c_str(), false);
+
+		in_start_tag = false;
+		has_text = true;
+
+	}
+
+	void end() {
+
+		if(in_start_tag) {
+			buffer += " />\n";
+		} else {
+
+			if(!has_text)
+				indent(elements.size() - 1);
+
+			buffer += "</";
+			buffer += elements.back();
+			buffer += ">\n";
+
+		}
+
+		elements.pop_back();
+		in_start_tag = false;
+		has_text = false;
+
+		if(out && buffer.size() >= BUFFER_SIZE)
+			flush();
+
+	}
+
+	/** adds the elements of a fragment made for the innermost element */
+	void append(const svg_writer & fragment) {
+
+		close_start_tag();
+		buffer += fragment.buffer;
+		has_text = false;
+
+		if(out && buffer.size() >= BUFFER_SIZE)
+			flush();
+
+	}
+
+	/** the elements of a fragment not yet appended */
+	const std::string & contents() const {
+		return buffer;
+	}
+
+	void flush() {
+
+		if(!out)
+			return;
+
+		out->write(buffer.data(), buffer.size());
+		buffer.clear();
+
+	}
+
+	enum : std::size_t { NUMBER_SIZE = 32 };
+
+	/** fixed point unless too large for it, digits holds NUMBER_SIZE characters, returns the length written */
+	std::size_t format(double number, char * digits) const {
+
+		if(!std::isfinite(number) || std::fabs(number) * scale >= 9e18)
+			return static_cast<std::size_t>(std::snprintf(digits, NUMBER_SIZE, "%.17g", number));
+
+		long long scaled = std::llround(number * scale);
+
+		char * pos = digits;
+		if(scaled < 0) {
+			*pos++ = '-';
+			scaled = -scaled;
+		}
+
+		unsigned long long whole = scaled / scale;
+		unsigned long long fraction = scaled % scale;
+
+		char reversed[NUMBER_SIZE];
+		std::size_t length = 0;
+		do {
+			reversed[length++] = '0' + whole % 10;
+			whole /= 10;
+		} while(whole);
+
+		while(length)
+			*pos++ = reversed[--length];
+
+		if(fraction) {
+
+			*pos++ = '.';
+			for(unsigned long long place = scale / 10; fraction; place /= 10) {
+				*pos++ = '0' + fraction / place;
+				fraction %= place;
+			}
+
+		}
+
+		return pos - digits;
+
+	}
+
+private:
+
+	void close_start_tag() {
+
+		if(!in_start_tag)
+			return;
+
+		buffer += ">\n";
+		in_start_tag = false;
+
+	}
+
+	void indent() {
+		indent(elements.size());
+	}
+
+	void indent(std::size_t element_depth) {
+		buffer.append(depth + element_depth, '\t');
+	}
+
+	/** the characters pugixml escapes in attribute values and text */
+	void escape(const char * value, bool is_attribute) {
+
+		for(const char * pos = value; *pos; ++pos) {
+
+			const char character = *pos;
+			switch(character) {
+
+				case '&': buffer += "&amp;"; break;
+				case '<': buffer += "&lt;"; break;
+				case '>': buffer += "&gt;"; break;
+				case '"':
+					if(is_attribute)
+						buffer += "&quot;";
+					else
+						buffer += character;
+					break;
+
+				default:
+					if(static_cast<unsigned char>(character) < 32 && character != '\t'
+						&& (is_attribute || (character != '\r' && character != '\n'))) {
+
+						char reference[8];
+						std::snprintf(reference, sizeof(reference), "&#%d;", character);
+						buffer += reference;
+
+					} else {
+						buffer += character;
+					}
+					break;
+
+			}
+
+		}
+
+	}
+
+};
+
+#endif
@@ -22,68 +22,69 @@
 #ifndef INCLUDED_YUML_OUTPUTTER_HPP
 #define INCLUDED_YUML_OUTPUTTER_HPP
 
-#include <srcuml_outputter.hpp>
+#include <srcuml_text_outputter.hpp>
 
-class yuml_outputter : srcuml_outputter {
+class yuml_outputter : public srcuml_text_outputter {
+
+private:
+
+    // relationships name the class by symbol, later classes with the same name win
+    std::unordered_map<srcuml_symbol, std::string> class_names;
 
 public:
 
 	yuml_outputter(){};
 
-	bool output(std::ostream & out, std::vector<std::shared_ptr<srcuml_class>> & classes){
+	void write_header(srcuml_text_sink &){}
 
-        srcuml_relationships relationships = analyze_relationships(classes);
+	/** yUML knows a class by its name, which keeps the stereotypes known when it is written */
+	void write_class(srcuml_text_sink & out, const srcuml_class & aclass){
 
-        //Classes
+        out << '[';
 
-        for(const std::shared_ptr<srcuml_class> & aclass : classes){
+        std::string & class_name = class_names[aclass.get_name_symbol()];
+        class_name = aclass.get_srcuml_name();
+        out << class_name;
 
-            out << '[';
+        if(aclass.get_has_field() || aclass.get_has_method())
+            out << '|';
 
-            out << aclass->get_srcuml_name();
+        for(const srcuml_member_label & attribute : aclass.get_attribute_labels()) {
+            if(attribute.is_static) {
+                static_outputter::output(out, attribute.text);
+            } else {
+                out << attribute.text;
+            }
+            out << ';';
+        }
 
-            if(aclass->get_has_field() || aclass->get_has_method())
-                out << '|';
+        if(aclass.get_has_method())
+            out << '|';
 
-            for(const srcuml_attribute & attribute : aclass->get_attributes()) {
-                if(attribute.get_is_static()) {
-                    static_outputter::output(out, attribute);
-                } else {
-                    out << attribute;
-                }
-                out << ';';
+        for(const srcuml_member_label & op : aclass.get_operation_labels()) {
+            if(op.is_static) {
+                static_outputter::output(out, op.text);
+            } else {
+                out << op.text;
             }
+            out << ';';
+        }
 
-            if(aclass->get_has_method())
-                out << '|';
-
-            for(std::size_t access = 0; access <= ClassPolicy::PROTECTED; ++access) {
-                for(const FunctionPolicy::FunctionData * function : aclass->get_data().methods[access]) {
-                    srcuml_operation op(function, (ClassPolicy::AccessSpecifier)access);
-                    if(op.get_stereotypes().count("set") > 0){continue;}
-                    if(op.get_stereotypes().count("get") > 0){continue;}
-                    if(function->isStatic) {
-                        static_outputter::output(out, op);
-                    } else {
-                        out << op;
-                    }
-                    out << ';';
-                }
-            }
+        out << "]\n";
 
-            out << "]\n";
-        }
+	}
+
+	void write_relationships(srcuml_text_sink & out, const std::vector<std::shared_ptr<srcuml_class>> &,
+							 const srcuml_relationships & relationships){
 
         //Relations
 
-        for(const srcuml_relationship relationship : relationships.get_relationships()) {
-            out << '[' << relationship.get_source() << ']';
+        for(const srcuml_relationship & relationship : relationships.get_relationships()) {
+            out << '[' << class_names[relationship.get_source_symbol()] << ']';
 
             if(relationship.type == BIDIRECTIONAL)
                 out << '<';
 
-            out << relationship.get_source_label();
-
             switch(relationship.type) {
 
                 case DEPENDENCY: {
@@ -114,16 +115,16 @@ public:
 
             }
 
-            out << relationship.get_destination_label();
+            out << relationship.get_label();
 
             if(relationship.type != GENERALIZATION && relationship.type != REALIZATION)
                 out << '>';
 
-            out << '[' << relationship.get_destination() << "]\n";
+            out << '[' << class_names[relationship.get_destination_symbol()] << "]\n";
         }
 
 	}
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -24,19 +24,22 @@
 #include <srcml.h>
 #include <srcuml_handler.hpp>
 
+#include <srcuml_utilities.hpp>
+
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
 
 const size_t tester_t::COLUMN_SIZE = 80;
 
-tester_t::tester_t(const std::string & name) : name(name), test_count(0), number_passed(0), source_code(), srcml(), yuml() {}
-
+tester_t::tester_t(const std::string & name, const std::string & type)
+    : name(name), type(type), cases(), source_code(), number_passed(0), test_results() {}
 
-tester_t & tester_t::src2srcml(const std::string & src) {
-
-    source_code = src;
-    srcml = std::string();
+std::string tester_t::srcml(const std::vector<std::string> & units) {
 
     srcml_archive * archive = srcml_archive_create();
 
@@ -44,17 +47,30 @@ tester_t & tester_t::src2srcml(const std::string & src) {
     size_t size = 0;
     srcml_archive_write_open_memory(archive, &srcml_buffer, &size);
 
-    srcml_unit * unit = srcml_unit_create(archive);
-    srcml_unit_set_language(unit, "C++");
-    srcml_unit_parse_memory(unit, source_code.c_str(), source_code.size());
+    for(const std::string & source_code : units) {
+
+        srcml_unit * unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C++");
+        srcml_unit_parse_memory(unit, source_code.c_str(), source_code.size());
 
-    srcml_archive_write_unit(archive, unit);
-    srcml_unit_free(unit);
+        srcml_archive_write_unit(archive, unit);
+        srcml_unit_free(unit);
+
+    }
 
     srcml_archive_close(archive);
     srcml_archive_free(archive);
 
-    srcml.append(srcml_buffer, size);
+    std::string archive_srcml(srcml_buffer, size);
+    srcml_memory_free(srcml_buffer);
+
+    return archive_srcml;
+
+}
+
+tester_t & tester_t::src2srcml(const std::string & src) {
+
+    source_code = src;
 
     return *this;
 
@@ -62,43 +78,110 @@ tester_t & tester_t::src2srcml(const std::string & src) {
 
 tester_t & tester_t::run() {
 
-    std::ostringstream output;
+    return *this;
+
+}
+
+tester_t & tester_t::test(const std::string & expected_yuml) {
 
-    try {
+    cases.push_back(test_case{ source_code, expected_yuml, false, std::string() });
 
-        srcuml_handler handler(srcml, output);
+    return *this;
+}
 
-    } catch(...) {}
+/** output was rendered by the test, e.g. of a model or a query */
+tester_t & tester_t::check(const std::string & output, const std::string & expected) {
 
-    yuml = output.str();
+    cases.push_back(test_case{ std::string(), expected, true, output });
 
     return *this;
 
 }
 
-tester_t & tester_t::test(const std::string & expected_yuml) {
-
-    ++test_count;
+/** converts each distinct snippet once, then runs the cases, both in parallel */
+void tester_t::run_cases() const {
 
-    if(yuml == expected_yuml) {
+    std::vector<std::string> snippets;
+    std::unordered_map<std::string, size_t> snippet_index;
+    std::vector<size_t> case_snippets;
+    for(const test_case & current : cases) {
 
-        ++number_passed;
-        test_results.push_back(std::make_tuple(test_count, true, ""));
+        if(current.is_rendered) {
+            case_snippets.push_back(0);
+            continue;
+        }
 
-    } else {
+        std::unordered_map<std::string, size_t>::const_iterator found = snippet_index.find(current.source_code);
+        if(found == snippet_index.end()) {
+            found = snippet_index.emplace(current.source_code, snippets.size()).first;
+            snippets.push_back(current.source_code);
+        }
 
-        std::string error = "### expected ###\n";
-        error += expected_yuml;
-        error += "### actual ###\n";
-        error += yuml;
-        error += "### end ###\n\n";
-        test_results.push_back(std::make_tuple(test_count, false, error));
+        case_snippets.push_back(found->second);
 
     }
 
-    yuml = std::string();
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    if(const char * test_threads = std::getenv("SRCUML_TEST_THREADS"))
+        threads = std::max(1, std::atoi(test_threads));
+
+    // libxml2 must be initialized before parsers are created on other threads
+    xmlInitParser();
+
+    std::vector<std::string> archives(snippets.size());
+    srcuml::parallel_ranges(snippets.size(), threads, [&](size_t first, size_t last) {
+        for(size_t pos = first; pos < last; ++pos)
+            archives[pos] = srcml(std::vector<std::string>(1, snippets[pos]));
+    });
+
+    std::vector<std::string> outputs(cases.size());
+    srcuml::parallel_ranges(cases.size(), threads, [&](size_t first, size_t last) {
+
+        for(size_t pos = first; pos < last; ++pos) {
+
+            if(cases[pos].is_rendered) {
+                outputs[pos] = cases[pos].output;
+                continue;
+            }
+
+            std::ostringstream output;
+
+            try {
+
+                srcuml_options options;
+                options.type = type;
+                srcuml_handler handler(archives[case_snippets[pos]], output, options);
+
+            } catch(...) {}
+
+            outputs[pos] = output.str();
+
+        }
+
+    });
+
+    number_passed = 0;
+    test_results.clear();
+    for(size_t pos = 0; pos < cases.size(); ++pos) {
+
+        if(outputs[pos] == cases[pos].expected) {
+
+            ++number_passed;
+            test_results.push_back(std::make_tuple(pos + 1, true, ""));
+
+        } else {
+
+            std::string error = "### expected ###\n";
+            error += cases[pos].expected;
+            error += "### actual ###\n";
+            error += outputs[pos];
+            error += "### end ###\n\n";
+            test_results.push_back(std::make_tuple(pos + 1, false, error));
+
+        }
+
+    }
 
-    return *this;
 }
 
 static size_t number_characters(size_t number) {
@@ -114,6 +197,8 @@ static size_t number_characters(size_t number) {
 
 size_t tester_t::results() const {
 
+    run_cases();
+
     std::cout << std::setw(16) << std::left << (name + ":");
 
     size_t column_count = 0;
@@ -142,7 +227,7 @@ size_t tester_t::results() const {
 
     std::cout << "\n\n";
 
-    if(number_passed != test_count) {
+    if(number_passed != cases.size()) {
 
         for(std::tuple<int, bool, std::string> result : test_results) {
 
@@ -154,8 +239,8 @@ size_t tester_t::results() const {
     }
 
 
-    std::cout << "Passed " << number_passed << " out of " << test_count << '\n';
+    std::cout << "Passed " << number_passed << " out of " << cases.size() << '\n';
 
-    return test_count - number_passed;
+    return cases.size() - number_passed;
 
 }
@@ -26,31 +26,58 @@
 #include <vector>
 #include <tuple>
 
+/**
+ * tester_t
+ *
+ * Compares the output of srcuml for source snippets with the expected text.
+ * src2srcml, run and test only record a case, results runs every case, on
+ * as many threads as there are cores, or SRCUML_TEST_THREADS, and reports
+ * them in order.  Each distinct snippet is converted to srcML once.  An
+ * output the test rendered itself, e.g. of a model, is compared with check.
+ */
 class tester_t {
 
 private:
 
     static const size_t COLUMN_SIZE;
 
-    std::string name;
-    size_t test_count;
-    size_t number_passed;
+    struct test_case {
+
+        std::string source_code;
+        std::string expected;
 
-    std::vector<std::tuple<size_t, bool, std::string>> test_results;
+        // rendered by the test, see check, source_code is not parsed
+        bool is_rendered;
+        std::string output;
 
+    };
 
-    // intermediate test variables
+    std::string name;
+    // output type the cases are run with, see srcuml_options::type
+    std::string type;
+
+    std::vector<test_case> cases;
+
+    // snippet of the next cases
     std::string source_code;
-    std::string srcml;
-    std::string yuml;
+
+    // filled in by results
+    mutable size_t number_passed;
+    mutable std::vector<std::tuple<size_t, bool, std::string>> test_results;
+
+    void run_cases() const;
 
 public:
 
-    tester_t(const std::string & name);
+    tester_t(const std::string & name, const std::string & type = "yuml");
+
+    /** srcML archive of the units, each a snippet, for a test rendering them itself */
+    static std::string srcml(const std::vector<std::string> & units);
 
     tester_t & src2srcml(const std::string & src);
     tester_t & run();
     tester_t & test(const std::string & expected_yuml);
+    tester_t & check(const std::string & output, const std::string & expected);
 
     size_t results() const;
 
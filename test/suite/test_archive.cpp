@@ -0,0 +1,170 @@
+/**
+ * @file test_archive.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tester.hpp>
+
+#include <srcuml_archive.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+/** an archive of two entries, one over a block, its bytes are returned and the file removed */
+static std::string write_archive(const std::string & filename, const std::string & large) {
+
+    {
+        srcuml_archive archive(filename);
+        archive.add("a.svg", "hello");
+        archive.add("./dir/b.dot", large);
+        archive.close();
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    std::ostringstream bytes;
+    bytes << in.rdbuf();
+    std::remove(filename.c_str());
+
+    return bytes.str();
+
+}
+
+/** the NUL terminated field at pos */
+static std::string field(const std::string & bytes, std::size_t pos, std::size_t width) {
+
+    if(pos + width > bytes.size())
+        return std::string();
+
+    const std::string value = bytes.substr(pos, width);
+    return value.substr(0, value.find('\0'));
+
+}
+
+/** whether the checksum of the tar header at pos is right */
+static bool has_checksum(const std::string & bytes, std::size_t pos) {
+
+    if(pos + 512 > bytes.size())
+        return false;
+
+    unsigned int sum = 0;
+    for(std::size_t offset = 0; offset < 512; ++offset)
+        sum += offset >= 148 && offset < 156 ? ' ' : static_cast<unsigned char>(bytes[pos + offset]);
+
+    return std::strtoul(field(bytes, pos + 148, 8).c_str(), nullptr, 8) == sum;
+
+}
+
+static std::uint32_t little_endian(const std::string & bytes, std::size_t pos, std::size_t width) {
+
+    std::uint32_t value = 0;
+    for(std::size_t byte = 0; byte < width && pos + byte < bytes.size(); ++byte)
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[pos + byte])) << (8 * byte);
+
+    return value;
+
+}
+
+/** data decompressed by zlib, window_bits chooses raw deflate or gzip */
+static std::string inflate_all(const std::string & data, int window_bits) {
+
+    z_stream stream = z_stream();
+    if(inflateInit2(&stream, window_bits) != Z_OK)
+        return std::string();
+
+    std::string inflated;
+    char buffer[4096];
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int result = Z_OK;
+    while(result == Z_OK) {
+
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        inflated.append(buffer, sizeof(buffer) - stream.avail_out);
+
+    }
+    inflateEnd(&stream);
+
+    return result == Z_STREAM_END ? inflated : std::string();
+
+}
+
+/** what creating the archive or adding the entry to it throws */
+static std::string archive_error(const std::string & filename, const std::string & path) {
+
+    try {
+        srcuml_archive archive(filename);
+        archive.add(path, "data");
+    } catch(const std::string & error) {
+        std::remove(filename.c_str());
+        return error;
+    }
+
+    std::remove(filename.c_str());
+    return std::string();
+
+}
+
+int main(int argc, char * argv[]) {
+
+    tester_t tester("archive");
+
+    const std::string large(600, 'x');
+
+    // ustar: a header block per entry, the data padded to blocks, then two zero blocks
+    const std::string tar = write_archive("test_archive.tar", large);
+    tester.check(std::to_string(tar.size()), std::to_string(512 + 512 + 512 + 1024 + 1024));
+    tester.check(field(tar, 0, 100), "a.svg");
+    tester.check(field(tar, 257, 6), "ustar");
+    tester.check(field(tar, 124, 12), "00000000005");
+    tester.check(has_checksum(tar, 0) ? "checksum" : "bad checksum", "checksum");
+    tester.check(field(tar, 512, 5), "hello");
+    tester.check(field(tar, 1024, 100), "dir/b.dot");
+    tester.check(field(tar, 1024 + 124, 12), "00000001130");
+    tester.check(has_checksum(tar, 1024) ? "checksum" : "bad checksum", "checksum");
+    tester.check(tar.size() >= 1024 && tar.find_first_not_of('\0', tar.size() - 1024) == std::string::npos ? "end" : "no end", "end");
+
+    // gzipped as a whole, the same tar inside
+    const std::string tgz = write_archive("test_archive.tgz", large);
+    tester.check(tgz.compare(0, 2, "\x1f\x8b") == 0 ? "gzip" : "not gzip", "gzip");
+    const std::string gunzipped = inflate_all(tgz, 16 + MAX_WBITS);
+    tester.check(std::to_string(gunzipped.size()), std::to_string(tar.size()));
+    tester.check(field(gunzipped, 1024, 100), "dir/b.dot");
+
+    // zip: local headers of deflated entries, the central directory then its end record
+    const std::string zip = write_archive("test_archive.zip", large);
+    tester.check(zip.compare(0, 4, std::string("PK\x03\x04", 4)) == 0 ? "local header" : "no local header", "local header");
+    const std::size_t name_size = little_endian(zip, 26, 2);
+    const std::size_t compressed_size = little_endian(zip, 18, 4);
+    tester.check(zip.substr(30, name_size), "a.svg");
+    tester.check(std::to_string(little_endian(zip, 22, 4)), "5");
+    tester.check(inflate_all(zip.substr(30 + name_size + little_endian(zip, 28, 2), compressed_size), -MAX_WBITS), "hello");
+    tester.check(zip.size() >= 22 && zip.compare(zip.size() - 22, 4, std::string("PK\x05\x06", 4)) == 0 ? "end record" : "no end record", "end record");
+    tester.check(std::to_string(little_endian(zip, zip.size() - 22 + 10, 2)), "2");
+
+    // only known extensions and named entries
+    tester.check(archive_error("test_archive.rar", "a.svg"), "Error: Unknown archive test_archive.rar. Can be {.tar, .tar.gz, .tgz, .zip}");
+    tester.check(archive_error("test_archive.tar", "./"), "Error: An archive entry needs a name");
+
+    return tester.results();
+
+}
@@ -27,13 +27,13 @@ int main(int argc, char * argv[]) {
 
     for(const std::string& class_type : {"class", "struct"}){
 
-		tester.src2srcml(class_type + " foo{private: void f(bar a){}; };" + class_type + " bar{};").run().test("[«datatype»;foo||- f(a: bar);]\n[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
-		tester.src2srcml(class_type + " foo{private: void f(){bar a;}; };" + class_type + " bar{};").run().test("[«datatype»;foo||- f();]\n[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
-		tester.src2srcml(class_type + " foo{private: void f(bar a){bar b;}; };" + class_type + " bar{};").run().test("[«datatype»;foo||- f(a: bar);]\n[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
-		tester.src2srcml(class_type + " foo{private: void f(bar a, pan b){};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;foo||- f(a: bar, b: pan);]\n[«datatype»;bar]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
-		tester.src2srcml(class_type + " foo{private: void f(bar a){pan b;};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;foo||- f(a: bar);]\n[«datatype»;bar]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
-		tester.src2srcml(class_type + " foo{private: void f(){bar a; pan b;};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;foo||- f();]\n[«datatype»;bar]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
-		tester.src2srcml(class_type + " foo{private: void f(bar a){}; void g(pan a){}; };" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;foo||- f(a: bar);- g(a: pan);]\n[«datatype»;bar]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
+		tester.src2srcml(class_type + " foo{private: void f(bar a){}; };" + class_type + " bar{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f(a: bar);]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
+		tester.src2srcml(class_type + " foo{private: void f(){bar a;}; };" + class_type + " bar{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f();]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
+		tester.src2srcml(class_type + " foo{private: void f(bar a){bar b;}; };" + class_type + " bar{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f(a: bar);]\n[«datatype»;foo]-.->[«datatype»;bar]\n");
+		tester.src2srcml(class_type + " foo{private: void f(bar a, pan b){};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f(a: bar, b: pan);]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
+		tester.src2srcml(class_type + " foo{private: void f(bar a){pan b;};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f(a: bar);]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
+		tester.src2srcml(class_type + " foo{private: void f(){bar a; pan b;};};" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f();]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
+		tester.src2srcml(class_type + " foo{private: void f(bar a){}; void g(pan a){}; };" + class_type + " bar{};" + class_type + " pan{};").run().test("[«datatype»;bar]\n[«datatype»;foo||- f(a: bar);- g(a: pan);]\n[«datatype»;pan]\n[«datatype»;foo]-.->[«datatype»;bar]\n[«datatype»;foo]-.->[«datatype»;pan]\n");
 
 	}
 
@@ -90,37 +90,37 @@ int main(int argc, char * argv[]) {
         tester.src2srcml(class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n");
 
         // found interface inheritence
-        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : public object { public: void bar() = 0; };").run().test("[«interface»;object||+ hash();]\n[«interface»;foo||+ bar();]\n[«interface»;object]^-[«interface»;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : virtual public object { public: void bar() = 0; };").run().test("[«interface»;object||+ hash();]\n[«interface»;foo||+ bar();]\n[«interface»;object]^-[«interface»;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : private object { public: void bar() = 0; };").run().test("[«interface»;object||+ hash();]\n[«interface»;foo||+ bar();]\n[«interface»;object]^-[«interface»;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : protected object { public: void bar() = 0; };").run().test("[«interface»;object||+ hash();]\n[«interface»;foo||+ bar();]\n[«interface»;object]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : public object { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object||+ hash();]\n[«interface»;object]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : virtual public object { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object||+ hash();]\n[«interface»;object]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : private object { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object||+ hash();]\n[«interface»;object]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash() = 0; };\n" + class_type + " foo : protected object { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object||+ hash();]\n[«interface»;object]^-[«interface»;foo]\n");
 
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two { public: void clone() = 0; };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;foo]\n[«interface»;object_two]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two { public: void clone() = 0; };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;foo]\n[«interface»;object_two]^-[«interface»;foo]\n");
 
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_two]^-[«interface»;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_three||+ to_string();]\n[«interface»;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_two]^-[«interface»;foo]\n[«interface»;object_three]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_two]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_three||+ to_string();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_three]^-[«interface»;foo]\n[«interface»;object_two]^-[«interface»;foo]\n");
 
         // found concreate inheritence
-        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : public object { public: void bar() = 0; };").run().test("[«datatype»;object||+ hash();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : virtual public object { public: void bar() = 0; };").run().test("[«datatype»;object||+ hash();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : private object { public: void bar() = 0; };").run().test("[«datatype»;object||+ hash();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : protected object { public: void bar() = 0; };").run().test("[«datatype»;object||+ hash();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : public object { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object||+ hash();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : virtual public object { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object||+ hash();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : private object { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object||+ hash();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object { public: void hash(); };\n" + class_type + " foo : protected object { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object||+ hash();]\n[«datatype»;object]^-[ ｛abstract｝;foo]\n");
 
-        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two { public: void clone() = 0; };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«datatype»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one]^-[ ｛abstract｝;foo]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two { public: void clone(); };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«datatype»;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[ ｛abstract｝;foo]\n[«datatype»;object_two]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two { public: void clone(); };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[«datatype»;object_one||+ hash();]\n[«datatype»;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one]^-[ ｛abstract｝;foo]\n[«datatype»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two { public: void clone() = 0; };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«datatype»;object_one]^-[ ｛abstract｝;foo]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two { public: void clone(); };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«datatype»;object_two||+ clone();]\n[«interface»;object_one]^-[ ｛abstract｝;foo]\n[«datatype»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two { public: void clone(); };\n" + class_type + " foo : public object_one, object_two  { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one||+ hash();]\n[«datatype»;object_two||+ clone();]\n[«datatype»;object_one]^-[ ｛abstract｝;foo]\n[«datatype»;object_two]^-[ ｛abstract｝;foo]\n");
 
 
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar(); };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone(); };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[ ｛abstract｝;object_two]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[«datatype»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one]^-[ ｛abstract｝;object_two]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar(); };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone(); };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[«interface»;object_one]^-[ ｛abstract｝;object_two]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " foo : public object_two  { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[«datatype»;object_one]^-[ ｛abstract｝;object_two]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
 
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_three||+ to_string();]\n[«interface»;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_two]^-[«interface»;foo]\n[«interface»;object_three]^-[«interface»;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar(); };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_three||+ to_string();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n[«interface»;object_three]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string(); };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[«interface»;object_two||+ clone();]\n[ ｛abstract｝;object_three||+ to_string();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_one]^-[ ｛abstract｝;object_three]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n[ ｛abstract｝;object_three]^-[ ｛abstract｝;foo]\n");
-        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone(); };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[«interface»;object_three||+ to_string();]\n[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one]^-[ ｛abstract｝;object_two]\n[«interface»;object_one]^-[«interface»;object_three]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n[«interface»;object_three]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«interface»;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_three||+ to_string();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_three]^-[«interface»;foo]\n[«interface»;object_two]^-[«interface»;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar(); };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_three||+ to_string();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_one]^-[«interface»;object_two]\n[«interface»;object_three]^-[ ｛abstract｝;foo]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string(); };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[ ｛abstract｝;object_three||+ to_string();]\n[«interface»;object_two||+ clone();]\n[«interface»;object_one]^-[ ｛abstract｝;object_three]\n[«interface»;object_one]^-[«interface»;object_two]\n[ ｛abstract｝;object_three]^-[ ｛abstract｝;foo]\n[«interface»;object_two]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash() = 0; };\n" + class_type + " object_two : object_one { public: void clone(); };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«interface»;object_one||+ hash();]\n[«interface»;object_three||+ to_string();]\n[ ｛abstract｝;object_two||+ clone();]\n[«interface»;object_one]^-[«interface»;object_three]\n[«interface»;object_one]^-[ ｛abstract｝;object_two]\n[«interface»;object_three]^-[ ｛abstract｝;foo]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
 
-        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[«datatype»;object_one||+ hash();]\n[ ｛abstract｝;object_two||+ clone();]\n[ ｛abstract｝;object_three||+ to_string();]\n[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one]^-[ ｛abstract｝;object_two]\n[«datatype»;object_one]^-[ ｛abstract｝;object_three]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n[ ｛abstract｝;object_three]^-[ ｛abstract｝;foo]\n");
+        tester.src2srcml(class_type + " object_one { public: void hash(); };\n" + class_type + " object_two : object_one { public: void clone() = 0; };\n" + class_type + " object_three : object_one { public: void to_string() = 0; };\n" + class_type + " foo : public object_two, object_three { public: void bar() = 0; };").run().test("[ ｛abstract｝;foo||+ bar();]\n[«datatype»;object_one||+ hash();]\n[ ｛abstract｝;object_three||+ to_string();]\n[ ｛abstract｝;object_two||+ clone();]\n[«datatype»;object_one]^-[ ｛abstract｝;object_three]\n[«datatype»;object_one]^-[ ｛abstract｝;object_two]\n[ ｛abstract｝;object_three]^-[ ｛abstract｝;foo]\n[ ｛abstract｝;object_two]^-[ ｛abstract｝;foo]\n");
 
     }
 
@@ -0,0 +1,86 @@
+/**
+ * @file test_layout.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tester.hpp>
+
+#include <srcuml_handler.hpp>
+#include <srcuml_cancel.hpp>
+#include <svg_layout.hpp>
+
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+/** classes each holding three others, far too many crossings for the optimal layout to finish at once */
+static std::string tangle() {
+
+    const std::size_t number_classes = 280;
+
+    std::vector<std::string> units;
+    for(std::size_t pos = 0; pos < number_classes; ++pos)
+        units.push_back("class c" + std::to_string(pos) + "{ c" + std::to_string(pos * 7 % number_classes) + " a; c"
+                        + std::to_string(pos * 13 % number_classes) + " b; c" + std::to_string(pos * 29 % number_classes) + " c; };");
+
+    return tester_t::srcml(units);
+
+}
+
+/** whether the svg_sugiyama output was written, abandoned layouts left running are kept in running */
+static std::string sugiyama(const std::string & archive, srcuml_options & options, std::size_t & running) {
+
+    options.type = "svg_sugiyama";
+
+    std::ostringstream output;
+    {
+        srcuml_handler handler(archive, output, options);
+    }
+    running = svg_layout::running_abandoned();
+
+    return output.str().find("</svg>") != std::string::npos ? "svg" : "no svg";
+
+}
+
+int main(int argc, char * argv[]) {
+
+    tester_t tester("layout");
+
+    const std::string archive = tangle();
+
+    // at the deadline of the run the optimal layout is abandoned, the output is written without waiting for it
+    srcuml_cancel deadline(2000);
+    srcuml_options cancelled;
+    cancelled.cancel = &deadline;
+    std::size_t running = 0;
+    tester.check(sugiyama(archive, cancelled, running), "svg");
+    tester.check(running != 0 ? "not waited for" : "waited for", "not waited for");
+
+    // alike past the layout budget
+    srcuml_options budgeted;
+    budgeted.layout_budget = 1;
+    tester.check(sugiyama(archive, budgeted, running), "svg");
+    tester.check(running != 0 ? "not waited for" : "waited for", "not waited for");
+
+    // the abandoned layouts cannot be interrupted, the test ends without them as the client does
+    const int status = tester.results();
+    std::cout.flush();
+    std::_Exit(status);
+
+}
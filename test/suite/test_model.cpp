@@ -0,0 +1,180 @@
+/**
+ * @file test_model.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tester.hpp>
+
+#include <srcuml_handler.hpp>
+#include <srcuml_model.hpp>
+#include <srcuml_serialize.hpp>
+#include <srcuml_query.hpp>
+#include <srcuml_diff.hpp>
+
+#include <sstream>
+#include <cstdio>
+
+/** the model of an archive of the units, saved with emit_model and loaded again, the yuml rendered is kept */
+static srcuml_model emit_model(const std::vector<std::string> & units, std::string & yuml) {
+
+    srcuml_options options;
+    options.type = "yuml";
+    options.emit_model = "test_model.model";
+
+    std::ostringstream output;
+    {
+        srcuml_handler handler(tester_t::srcml(units), output, options);
+    }
+    yuml = output.str();
+
+    srcuml_model model = srcuml_model::load(options.emit_model);
+    std::remove(options.emit_model.c_str());
+
+    return model;
+
+}
+
+static std::string render(srcuml_model & model) {
+
+    srcuml_options options;
+    options.type = "yuml";
+
+    std::ostringstream output;
+    srcuml_handler handler(model, output, options);
+
+    return output.str();
+
+}
+
+/** the answer to a query of the model */
+static std::string query(srcuml_model & model, const std::string & question) {
+
+    std::ostringstream out;
+    srcuml_query(model.get_classes(), model.get_relationships()).answer(question, out);
+
+    return out.str();
+
+}
+
+/** the answer to a query of the model, or what it throws */
+static std::string query_error(srcuml_model & model, const std::string & question) {
+
+    try {
+        return query(model, question);
+    } catch(const std::string & error) {
+        return error;
+    }
+
+}
+
+/** what reading a model of bytes throws */
+static std::string read_error(const std::string & bytes) {
+
+    std::istringstream in(bytes);
+    srcuml_model model;
+
+    try {
+        model.read(in);
+    } catch(const std::string & error) {
+        return error;
+    }
+
+    return std::string();
+
+}
+
+int main(int argc, char * argv[]) {
+
+    tester_t tester("model");
+
+    const std::vector<std::string> units = { "class bar{};", "class foo{private: void f(bar a){}; };", "class pan{ bar b; };",
+                                             "class zed : public foo{};" };
+
+    // rendered from the model as from the srcML
+    std::string yuml;
+    srcuml_model model = emit_model(units, yuml);
+    tester.check(std::to_string(model.get_classes().size()), "4");
+    tester.check(model.get_is_partial() ? "partial" : "analyzed", "analyzed");
+    tester.check(render(model), yuml);
+
+    // written and read back from a stream
+    std::ostringstream written;
+    model.write(written);
+    std::istringstream in(written.str());
+    srcuml_model read;
+    read.read(in);
+    tester.check(render(read), yuml);
+
+    // not a model, or of another version
+    tester.check(read_error("srcUML diagram\n"), "Error: Not a srcUML model");
+    std::ostringstream other_version;
+    other_version << "srcUML model\n";
+    srcuml::write_size(other_version, 1);
+    tester.check(read_error(other_version.str()), "Error: Unsupported srcUML model version 1");
+
+    // same-named classes of different scopes stay apart, a name resolves from the scope using it outward
+    const std::vector<std::string> scoped = { "class a::X{};", "class b::X{};", "class b::Y{ X x; };", "class c::Z{ a::X x; };",
+                                              "class d::V{};", "class U{ V v; };" };
+    std::string scoped_yuml;
+    srcuml_model scoped_model = emit_model(scoped, scoped_yuml);
+    tester.check(std::to_string(scoped_model.get_classes().size()), "6");
+    tester.check(query(scoped_model, "dependents b::X"), "b::Y\n");
+    tester.check(query(scoped_model, "dependents a::X"), "c::Z\n");
+
+    // a name no enclosing scope has falls back to the class of that simple name
+    tester.check(query(scoped_model, "dependents d::V"), "U\n");
+
+    // what changed between two models, counted by kind of change
+    const std::vector<std::string> base_units = { "class bar{};", "class foo{ bar b; };", "class pan{};" };
+    const std::vector<std::string> head_units = { "class bar{ int x; };", "class foo{ pan p; };", "class pan{};", "class wiz{};" };
+    std::string base_yuml, head_yuml;
+    srcuml_model base = emit_model(base_units, base_yuml);
+    srcuml_model head = emit_model(head_units, head_yuml);
+
+    srcuml_diff diff(base, head);
+    tester.check(std::to_string(diff.get_classes(srcuml_diff::ADDED)) + " added, " + std::to_string(diff.get_classes(srcuml_diff::REMOVED)) + " removed, "
+                 + std::to_string(diff.get_classes(srcuml_diff::MODIFIED)) + " modified", "1 added, 0 removed, 2 modified");
+    tester.check(std::to_string(diff.get_relationships(srcuml_diff::ADDED)) + " added, " + std::to_string(diff.get_relationships(srcuml_diff::REMOVED)) + " removed",
+                 "1 added, 1 removed");
+    tester.check(diff.is_empty() ? "empty" : "changed", "changed");
+
+    // a model does not differ from itself
+    srcuml_diff same(head, head);
+    tester.check(same.is_empty() ? "empty" : "changed", "empty");
+    tester.check(std::to_string(same.get_model().get_classes().size()), "0");
+
+    // questions answered from a saved model, in the order of the model
+    const std::vector<std::string> hierarchy = { "class I{ public: virtual void f() = 0; };", "class A : public I{ public: void f(){} };",
+                                                 "class B : public A{};", "class C{ A a; };" };
+    std::string hierarchy_yuml;
+    srcuml_model hierarchy_model = emit_model(hierarchy, hierarchy_yuml);
+    tester.check(query(hierarchy_model, "interfaces"), "I\n");
+    tester.check(query(hierarchy_model, "subclasses A"), "B\n");
+    tester.check(query(hierarchy_model, "implementers I"), "A\nB\n");
+    tester.check(query(hierarchy_model, "owners A"), "C\n");
+    tester.check(query(hierarchy_model, "dependents A"), "B\nC\n");
+    tester.check(query(hierarchy_model, "dependents C"), "");
+
+    tester.check(query_error(hierarchy_model, "dependents"), "Error: Query dependents needs a class name");
+    tester.check(query_error(hierarchy_model, "dependents Z"), "Error: No class named Z");
+    tester.check(query_error(hierarchy_model, "parents A"), "Error: Unknown query parents");
+
+    return tester.results();
+
+}
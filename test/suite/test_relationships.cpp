@@ -21,6 +21,80 @@
 
 #include <tester.hpp>
 
+#include <srcuml_handler.hpp>
+#include <srcuml_relationship_graph.hpp>
+
+#include <sstream>
+#include <algorithm>
+
+/** yuml of an archive, parsed on threads */
+static std::string yuml(const std::string & archive, size_t threads) {
+
+    srcuml_options options;
+    options.type = "yuml";
+    options.threads = threads;
+
+    std::ostringstream output;
+    srcuml_handler handler(archive, output, options);
+
+    return output.str();
+
+}
+
+/** yuml of an archive of the units, parsed on threads */
+static std::string yuml(const std::vector<std::string> & units, size_t threads) {
+
+    return yuml(tester_t::srcml(units), threads);
+
+}
+
+/** the relationship lines of yuml, in the order written */
+static std::string edges(const std::string & yuml) {
+
+    std::istringstream in(yuml);
+    std::string edges;
+    for(std::string line; std::getline(in, line); )
+        if(line.find(']') + 1 != line.size())
+            edges += line + '\n';
+
+    return edges;
+
+}
+
+/** the edges, one per line in name order, so only which edges there are is compared */
+static std::string describe(const std::vector<srcuml_relationship> & relationships) {
+
+    std::vector<std::string> lines;
+    for(const srcuml_relationship & relationship : relationships)
+        lines.push_back(srcuml::symbol_name(relationship.get_source_symbol()) + ' ' + std::to_string(relationship.get_type()) + ' '
+                        + relationship.get_label() + ' ' + srcuml::symbol_name(relationship.get_destination_symbol()) + '\n');
+    std::sort(lines.begin(), lines.end());
+
+    std::string description;
+    for(const std::string & line : lines)
+        description += line;
+
+    return description;
+
+}
+
+/** updates graph with the classes of the units, the relationships analyzed from scratch are returned */
+static std::vector<srcuml_relationship> update(srcuml_relationship_graph & graph, const std::vector<std::string> & units) {
+
+    srcuml_options options;
+    options.type = "yuml";
+
+    const std::string srcml = tester_t::srcml(units);
+    srcuml_handler handler(options);
+    handler.add(srcml.data(), srcml.size());
+
+    std::vector<std::shared_ptr<srcuml_class>> classes = handler.get_classes();
+    graph.update(classes);
+
+    return srcuml_relationships(classes).get_relationships();
+
+}
+
 int main(int argc, char * argv[]) {
 
     tester_t tester("relationships");
@@ -28,6 +102,52 @@ int main(int argc, char * argv[]) {
 	//tester.src2srcml("class Parent{}; class Child: public Parent{};").run().test("[][Parent]^-[Child]");
 	//tester.src2srcml("class Parent{}; class Child: public Parent{}; class Grandchild: public Child{};lass Parent{}; class Child: public Parent{}; class Grandchild: public Child{};").run().test("")
 
+    // units parsed on several threads are merged in the order of the archive
+    const std::vector<std::string> units = { "class bar{};", "class foo{private: void f(bar a){}; };", "class pan{ bar b; };",
+                                             "class zed : public foo{};", "class wiz{ pan p; };" };
+    const std::string serial = yuml(units, 1);
+    tester.check(yuml(units, 2), serial);
+    tester.check(yuml(units, 4), serial);
+    tester.check(yuml(units, 8), serial);
+
+    // an empty unit, written <unit .../>, is a unit of its own
+    std::string with_empty = tester_t::srcml(units);
+    const std::size_t second = with_empty.find("<unit", with_empty.find("<unit", with_empty.find("<unit") + 1) + 1);
+    if(second != std::string::npos)
+        with_empty.insert(second, "<unit revision=\"1.0.0\" language=\"C++\" filename=\"empty.cpp\"/>");
+    tester.check(yuml(with_empty, 1), serial);
+    tester.check(yuml(with_empty, 4), serial);
+
+    // sorted by qualified name, reordering the units does not change the output
+    const std::vector<std::string> reversed(units.rbegin(), units.rend());
+    tester.check(yuml(reversed, 1), serial);
+    tester.check(yuml(reversed, 4), serial);
+
+    // the edges of a single output are sorted too, by destination here rather than in member order
+    const std::vector<std::string> members = { "class foo{ pan p; bar b; };", "class bar{};", "class pan{};" };
+    const std::string sorted_edges = edges(yuml(members, 1));
+    tester.check(sorted_edges.find("bar]\n") < sorted_edges.find("pan]\n") ? "sorted" : "member order", "sorted");
+    tester.check(edges(yuml(std::vector<std::string>(members.rbegin(), members.rend()), 1)), sorted_edges);
+
+    // kept between runs, only the edges of what changed are generated again
+    srcuml_relationship_graph graph;
+    const std::vector<std::string> base = { "class bar{};", "class pan{};", "class foo{ bar b; };", "class zed : public foo{};" };
+    tester.check(describe(graph.get_relationships()), "");
+    tester.check(describe(update(graph, base)), describe(graph.get_relationships()));
+    tester.check(std::to_string(graph.get_delta().removed.size()), "0");
+
+    const std::vector<std::string> changed = { "class bar{};", "class pan{};", "class foo{ pan p; };", "class zed : public foo{};" };
+    tester.check(describe(update(graph, changed)), describe(graph.get_relationships()));
+    tester.check(std::to_string(graph.get_delta().added.size()) + ' ' + std::to_string(graph.get_delta().removed.size()), "1 1");
+    if(graph.get_delta().added.size() == 1 && graph.get_delta().removed.size() == 1) {
+        tester.check(srcuml::symbol_name(graph.get_delta().added.front().get_destination_symbol()), "pan");
+        tester.check(srcuml::symbol_name(graph.get_delta().removed.front().get_destination_symbol()), "bar");
+    }
+
+    // a class removed takes its edges with it
+    const std::vector<std::string> removed = { "class bar{};", "class pan{};", "class zed : public bar{};" };
+    tester.check(describe(update(graph, removed)), describe(graph.get_relationships()));
+
     return tester.results();
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,149 @@
+/**
+ * @file test_yuml.cpp
+ *
+ * @copyright Copyright (C) 2016 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcUML.
+ *
+ * srcUML is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * srcUML is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with srcUML.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <tester.hpp>
+
+#include <srcuml_handler.hpp>
+#include <srcuml_yuml.hpp>
+
+#include <sstream>
+
+/** each relationship read as "source type label destination", one per line */
+class relationship_recorder : public srcuml_yuml_listener {
+
+public:
+
+    std::string relationships;
+
+    virtual void on_class(const std::string &, const std::vector<std::string> &,
+                          const std::vector<std::string> &, std::size_t) override {}
+
+    virtual void on_relationship(const std::string & source, relationship_type type,
+                                 const std::string & label, const std::string & destination) override {
+
+        relationships += source + ' ' + std::to_string(type) + ' ' + label + ' ' + destination + '\n';
+
+    }
+
+};
+
+/** the relationships of yuml, or what reading it throws */
+static std::string read(const std::string & yuml) {
+
+    relationship_recorder recorder;
+    std::istringstream in(yuml);
+
+    try {
+        srcuml_yuml_reader(recorder).read(in);
+    } catch(const std::string & error) {
+        return error;
+    }
+
+    return recorder.relationships;
+
+}
+
+static std::string dot(const std::string & yuml) {
+
+    std::istringstream in(yuml);
+    std::ostringstream out;
+    srcuml_yuml_dot_writer::convert(in, out);
+
+    return out.str();
+
+}
+
+static srcuml_model build(const std::string & yuml) {
+
+    std::istringstream in(yuml);
+    srcuml_yuml_model_builder builder;
+    srcuml_yuml_reader(builder).read(in);
+
+    return builder.get_model();
+
+}
+
+static std::string render(srcuml_model model) {
+
+    srcuml_options options;
+    options.type = "yuml";
+
+    std::ostringstream output;
+    srcuml_handler handler(model, output, options);
+
+    return output.str();
+
+}
+
+int main(int argc, char * argv[]) {
+
+    tester_t tester("yuml");
+
+    // each connector, with and without a label
+    tester.check(read("[A]-.-[B]"), "A " + std::to_string(DEPENDENCY) + "  B\n");
+    tester.check(read("[A]-name>[B]"), "A " + std::to_string(ASSOCIATION) + " name B\n");
+    tester.check(read("[A]<-peer>[B]"), "A " + std::to_string(BIDIRECTIONAL) + " peer B\n");
+    tester.check(read("[A]<>-items>[B]"), "A " + std::to_string(AGGREGATION) + " items B\n");
+    tester.check(read("[A]++-part>[B]"), "A " + std::to_string(COMPOSITION) + " part B\n");
+    tester.check(read("[A]^-[B]"), "A " + std::to_string(GENERALIZATION) + "  B\n");
+    tester.check(read("[A]^-.-[B]"), "A " + std::to_string(REALIZATION) + "  B\n");
+
+    // comments are skipped and expressions separated by commas
+    tester.check(read("// [A]-.-[B]\n[A|- x: int;], [A]^-[B]\n"), "A " + std::to_string(GENERALIZATION) + "  B\n");
+
+    // malformed lines name the line
+    tester.check(read("[A]\n[A]-"), "Error: yUML line 2 has a relationship without a destination");
+    tester.check(read("[A"), "Error: yUML line 1 has a class without a closing ]");
+    tester.check(read("A"), "Error: yUML line 1 has no [ where a class is expected");
+    tester.check(read("[A]~~[B]"), "Error: yUML line 1 has an unknown connector");
+
+    // converted to the DOT dot_outputter writes, a later box without members is not written again
+    tester.check(dot("[A|- x: int;|+ f();]\n[A]^-[B]\n"),
+                 "digraph hierarchy {\n"
+                 "node[shape=record,style=filled,fillcolor=gray95]\n"
+                 "edge[dir=\"both\", arrowtail=\"empty\", arrowhead=\"empty\", labeldistance=\"2.0\"]\n"
+                 "class0[label = \"{ A|- x: int\\n|+ f()\\n}\"]\n"
+                 "class1[label = \"{ B}\"]\n"
+                 "class0->class1[arrowhead=\"none\"]\n"
+                 "}\n");
+
+    // a model built from yUML keeps the kinds of classes and the relationships as read
+    srcuml_model model = build("[«interface»I]\n[C|- x: int;]\n[C]^-.-[«interface»I]\n");
+    tester.check(std::to_string(model.get_classes().size()) + ' ' + std::to_string(model.get_relationships().size()), "2 1");
+    if(model.get_classes().size() == 2 && model.get_relationships().size() == 1) {
+        tester.check(model.get_classes()[0]->get_name() + (model.get_classes()[0]->get_is_interface() ? " interface" : ""), "I interface");
+        tester.check(model.get_classes()[1]->get_name() + (model.get_classes()[1]->get_is_interface() ? " interface" : ""), "C");
+        tester.check(std::to_string(model.get_relationships()[0].type), std::to_string(REALIZATION));
+    }
+
+    // yUML rendered from srcML reads back to the same yUML
+    srcuml_options options;
+    options.type = "yuml";
+    std::ostringstream parsed;
+    {
+        srcuml_handler handler(tester_t::srcml(std::vector<std::string>{ "class bar{};", "class foo{ bar b; };", "class zed : public foo{ void f(bar a){} };" }),
+                               parsed, options);
+    }
+    tester.check(render(build(parsed.str())), parsed.str());
+
+    return tester.results();
+
+}